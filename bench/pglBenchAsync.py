@@ -0,0 +1,212 @@
+################################################################
+#   filename: pglBenchAsync.py
+#    purpose: Rendering interleaved with device input, against
+#             pglStandInServer and a simulated device (a process
+#             writing timestamped events to a pipe, like a button
+#             box on a serial port), so it needs no Mac or hardware.
+#             Compares a blocking loop that polls the device once a
+#             frame, a blocking loop with a reader thread, and one
+#             asyncio loop with pglAsync. Reports how long drawing
+#             a frame keeps the client busy before it can flush,
+#             client CPU time per frame, and how long after an event
+#             was sent it was seen. Run from the repo root with "make benchAsync"
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import os
+import sys
+import time
+import struct
+import queue
+import asyncio
+import threading
+import multiprocessing
+from pathlib import Path
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+from pgl.pglAsync import pglAsync, pglAsyncStream
+from pgl._pglStandIn import pglStandInServer, pglStandInDisplay
+from pgl import _pglTimestamp
+
+nFrames = 240
+nDots = 200
+eventFormat = '@d'
+eventLength = struct.calcsize(eventFormat)
+
+##########################
+# processes
+##########################
+def runServer(socketName, stopEvent):
+    # stand-in display in its own process so its CPU time is not counted against the client
+    server = pglStandInServer(frameRate=60, renderTime=0.002, socketName=socketName).start()
+    stopEvent.wait()
+    server.stop()
+
+def runDevice(fd, stopEvent, meanInterval, seed):
+    # sends its send time at random intervals
+    rng = np.random.default_rng(seed)
+    while not stopEvent.is_set():
+        time.sleep(rng.exponential(meanInterval))
+        os.write(fd, struct.pack(eventFormat, _pglTimestamp.getSecs()))
+
+##########################
+# helpers
+##########################
+def dotData():
+    xyz = np.random.default_rng(0).uniform(-1, 1, (nDots, 2)).astype(np.float32)
+    data = np.zeros((nDots, 11), dtype=np.float32)
+    data[:, 0:2] = xyz
+    data[:, 3:7] = 1
+    data[:, 7:9] = 4
+    data[:, 9] = 1
+    return data
+
+def parseEvents(data, seenTime):
+    # latency of each event in the bytes read
+    n = len(data) // eventLength
+    return [seenTime - sent for sent in struct.unpack(f"@{n}d", data[:n * eventLength])]
+
+def summarize(label, drawTimes, cpuTime, latencies):
+    latencies = np.array(latencies) * 1000
+    print(f"  {label:>10} {1000 * np.median(drawTimes):9.3f} {1000 * cpuTime / nFrames:10.3f} {len(latencies):7d} {np.median(latencies):9.2f} {np.percentile(latencies, 95):9.2f} {latencies.max():9.2f}")
+
+def drainDevice(fd):
+    # drop events sent while connecting
+    blocking = os.get_blocking(fd)
+    os.set_blocking(fd, False)
+    try:
+        while os.read(fd, 4096): pass
+    except BlockingIOError:
+        pass
+    os.set_blocking(fd, blocking)
+
+def drawBlocking(display, dots):
+    # draw the frame the way pglBase does, each command waits for its results
+    display.clearScreen([0.5, 0.5, 0.5])
+    display.s.writeCommand("mglDots")
+    display.s.write(np.uint32(nDots))
+    display.s.write(dots)
+    display.commandResults = display.s.readCommandResults()
+
+##########################
+# strategies
+##########################
+def benchPolling(socketName, fd, dots):
+    '''
+    Blocking flush, device polled once a frame.
+    '''
+    display = pglStandInDisplay(socketName)
+    os.set_blocking(fd, False)
+    drainDevice(fd)
+    latencies = []
+    startTime = time.process_time()
+    drawTimes = []
+    for frame in range(nFrames):
+        frameStart = time.perf_counter()
+        drawBlocking(display, dots)
+        drawTimes.append(time.perf_counter() - frameStart)
+        display.flush()
+        try:
+            latencies += parseEvents(os.read(fd, 4096), _pglTimestamp.getSecs())
+        except BlockingIOError:
+            pass
+    cpuTime = time.process_time() - startTime
+    display.close()
+    summarize("polling", drawTimes, cpuTime, latencies)
+
+def benchThread(socketName, fd, dots):
+    '''
+    Blocking flush, device read on its own thread.
+    '''
+    display = pglStandInDisplay(socketName)
+    os.set_blocking(fd, True)
+    drainDevice(fd)
+    events = queue.Queue()
+    running = True
+    def readDevice():
+        while running:
+            data = os.read(fd, 4096)
+            if not data: return
+            events.put((_pglTimestamp.getSecs(), data))
+    thread = threading.Thread(target=readDevice, daemon=True)
+    thread.start()
+    latencies = []
+    startTime = time.process_time()
+    drawTimes = []
+    for frame in range(nFrames):
+        frameStart = time.perf_counter()
+        drawBlocking(display, dots)
+        drawTimes.append(time.perf_counter() - frameStart)
+        display.flush()
+        while not events.empty():
+            seenTime, data = events.get_nowait()
+            latencies += parseEvents(data, seenTime)
+    cpuTime = time.process_time() - startTime
+    running = False
+    display.close()
+    summarize("thread", drawTimes, cpuTime, latencies)
+
+async def benchAsyncio(socketName, fd, dots):
+    '''
+    One asyncio loop: frames are drawn without waiting for each command and
+    device events are handled while the flush is outstanding.
+    '''
+    renderer = pglAsync(verbose=0)
+    await renderer.connect(socketName)
+    os.set_blocking(fd, False)
+    drainDevice(fd)
+    def readAvailable():
+        try:
+            return os.read(fd, 4096)
+        except BlockingIOError:
+            return None
+    stream = pglAsyncStream.fromFd(fd, readAvailable)
+    latencies = []
+    async def handleEvents():
+        async for seenTime, data in stream: latencies.extend(parseEvents(data, seenTime))
+    eventTask = asyncio.get_running_loop().create_task(handleEvents())
+    dotsPayload = struct.pack('@I', nDots) + dots.tobytes()
+    startTime = time.process_time()
+    drawTimes = []
+    for frame in range(nFrames):
+        frameStart = time.perf_counter()
+        renderer.clearScreen([0.5, 0.5, 0.5])
+        renderer.command("mglDots", dotsPayload)
+        drawTimes.append(time.perf_counter() - frameStart)
+        await renderer.flush()
+    cpuTime = time.process_time() - startTime
+    stream.close()
+    eventTask.cancel()
+    await renderer.close()
+    summarize("asyncio", drawTimes, cpuTime, latencies)
+
+if __name__ == "__main__":
+    multiprocessing.set_start_method("fork")
+    dots = dotData()
+    for label, meanInterval in [("events every ~20 ms", 0.020), ("events every ~2 ms", 0.002)]:
+        print(label)
+        print(f"  {'':>10} {'draw ms':>9} {'cpu ms/fr':>10} {'events':>7} {'median ms':>9} {'95th ms':>9} {'max ms':>9}")
+        for strategy in ["polling", "thread", "asyncio"]:
+            socketName = f"/tmp/pglBenchAsync.socket.{os.getpid()}"
+            stopEvent = multiprocessing.Event()
+            server = multiprocessing.Process(target=runServer, args=(socketName, stopEvent))
+            server.start()
+            readFd, writeFd = os.pipe()
+            device = multiprocessing.Process(target=runDevice, args=(writeFd, stopEvent, meanInterval, 0))
+            device.start()
+            if strategy == "polling":
+                benchPolling(socketName, readFd, dots)
+            elif strategy == "thread":
+                benchThread(socketName, readFd, dots)
+            else:
+                asyncio.run(benchAsyncio(socketName, readFd, dots))
+            stopEvent.set()
+            device.join()
+            server.join()
+            os.close(writeFd)
+            os.close(readFd)
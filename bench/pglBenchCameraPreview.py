@@ -0,0 +1,82 @@
+################################################################
+#   filename: pglBenchCameraPreview.py
+#    purpose: Eye camera preview against pglStandInServer with a
+#             fake camera, so it needs no Mac or tracker. Compares
+#             grabbing and making a new texture every display frame
+#             (as getCameraImage used to) with pglCameraPreview,
+#             which grabs in the background and updates one texture.
+#             Run from the repo root with "make benchCameraPreview"
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import sys
+from pathlib import Path
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+from pgl.pglCameraPreview import pglCameraPreview, pglCameraSourceFake
+from pgl._pglStandIn import pglStandInServer, pglStandInDisplay
+from pgl import _pglTimestamp
+
+nFrames = 180
+
+##########################
+# helpers
+##########################
+def summarize(label, frameTimes, framePeriod, extra=""):
+    '''
+    Print frame time stats and display frames missed from the presented times.
+    '''
+    intervals = np.diff(frameTimes) * 1000
+    missed = int(np.sum(np.round(np.diff(frameTimes) / framePeriod) - 1))
+    print(f"  {label:>12} {np.median(intervals):8.2f} {np.percentile(intervals, 95):8.2f} {intervals.max():8.2f} {missed:7d}  {extra}")
+
+def benchPerFrame(display, source, framePeriod):
+    '''
+    Grab in the display loop and make a new texture each frame.
+    '''
+    presented = []
+    for frame in range(nFrames):
+        image = display.imageCreate(source.grab())
+        presented.append(display.flush())
+        del image
+    summarize("per frame", np.array(presented), framePeriod)
+
+def benchPreview(display, source, framePeriod):
+    '''
+    Grab in the background and update one texture.
+    '''
+    preview = pglCameraPreview(display, source, verbose=0)
+    preview.start()
+    # wait for the first frame
+    while preview.update() is None: _pglTimestamp.getSecs()
+    presented = []
+    for frame in range(nFrames):
+        preview.update()
+        presented.append(display.flush())
+    preview.stop()
+    stats = preview.getStats(printSummary=False)
+    summarize("preview", np.array(presented), framePeriod,
+              f"{stats['nDropped']} dropped {stats['nLate']} late {stats['nMissed']} missed, latency {1000*stats['medianLatency']:.1f} ms")
+
+if __name__ == "__main__":
+    server = pglStandInServer(frameRate=60, renderTime=0.002).start()
+    display = pglStandInDisplay(server.socketName, frameRate=server.frameRate)
+    framePeriod = 1 / server.frameRate
+
+    # (label, camera frame rate, transfer time, stall probability)
+    for label, cameraRate, grabTime, stallProbability in [("60Hz camera, 4 ms transfer", 60, 0.004, 0),
+                                                          ("120Hz camera, 4 ms transfer", 120, 0.004, 0),
+                                                          ("60Hz camera, 4 ms transfer, 5% 50 ms stalls", 60, 0.004, 0.05)]:
+        print(label)
+        print(f"  {'':>12} {'median':>8} {'95th':>8} {'max ms':>8} {'missed':>7}")
+        benchPerFrame(display, pglCameraSourceFake(frameRate=cameraRate, grabTime=grabTime, stallProbability=stallProbability, seed=0), framePeriod)
+        benchPreview(display, pglCameraSourceFake(frameRate=cameraRate, grabTime=grabTime, stallProbability=stallProbability, seed=0), framePeriod)
+
+    print(f"textures left on server: {len(server.textures)}")
+    display.close()
+    server.stop()
@@ -0,0 +1,124 @@
+################################################################
+#   filename: pglBenchColor.py
+#    purpose: Benchmark and validation of pglColorEngine: engines
+#             built with the calibration and given it afterwards
+#             must convert the same, the native conversion must
+#             match numpy, and the time to convert vertex colors
+#             and texture pixels of each space.
+#             Run from the repo root with "make benchColor"
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import sys
+import time
+from pathlib import Path
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+from pgl.pglColor import pglColorEngine
+
+##########################
+# helpers
+##########################
+class calibrationData:
+    '''
+    Luminance calibration of a display with a gamma of 2.2 from 0.5 to 120 cd/m2
+    (what getMedianMeasurements of pglDisplayLuminanceCalibrationData returns)
+    '''
+    def getMedianMeasurements(self):
+        values = np.linspace(0, 1, 32)
+        measurements = 0.5 + 119.5 * values ** 2.2
+        return values, measurements, measurements, measurements
+
+# a color of each space, with the background the relative spaces are around
+testColors = {
+    "linear": [0.2, 0.5, 0.7],
+    "luminance": [40.0, 40.0, 40.0],
+    "contrast": [0.5, -0.2, 0.1],
+    "xyz": [30.0, 40.0, 20.0],
+    "xyY": [0.3127, 0.3290, 50.0],
+    "lms": [20.0, 15.0, 0.2],
+    "dkl": [0.2, 0.05, 0.3],
+}
+
+##########################
+# validation
+##########################
+def checkCalibrationPaths():
+    '''
+    An engine given the calibration after it is made converts the same as one
+    made with it (and as one whose primaries were set before the calibration).
+    '''
+    primaries = [[0.68, 0.32], [0.265, 0.69], [0.15, 0.06]]
+    built = pglColorEngine(calibrationData())
+    later = pglColorEngine()
+    later.setCalibration(calibrationData())
+    builtPrimaries = pglColorEngine(calibrationData(), primaries=primaries)
+    laterPrimaries = pglColorEngine(primaries=primaries)
+    laterPrimaries.setCalibration(calibrationData())
+    ok = True
+    for space, color in testColors.items():
+        for a, b, what in ((built, later, "default primaries"), (builtPrimaries, laterPrimaries, "display primaries")):
+            difference = np.max(np.abs(a.convert(color, space) - b.convert(color, space)))
+            if difference > 1e-5:
+                print(f"  ❌ {space} ({what}): setCalibration differs from the constructor by {difference:.6f}")
+                ok = False
+    print(f"calibration in constructor and setCalibration: {'ok' if ok else 'FAILED'}")
+    return ok
+
+def checkNative():
+    '''
+    The native conversion matches the numpy one.
+    '''
+    engine = pglColorEngine(calibrationData())
+    pixels = np.random.default_rng(0).random((64, 64, 4)) * [0.7, 0.7, 60.0, 1.0]
+    ok = True
+    if not pglColorEngine._pglColor: engine.convert(pixels[:1, :1], "xyz")
+    native = pglColorEngine._pglColor
+    if not native:
+        print("native conversion: _pglColor is not compiled, skipped")
+        return True
+    for space in testColors:
+        pglColorEngine._pglColor = native
+        nativeValues = engine.convert(pixels, space)
+        pglColorEngine._pglColor = False
+        numpyValues = engine.convert(pixels, space)
+        difference = np.max(np.abs(nativeValues - numpyValues))
+        if difference > 1e-4:
+            print(f"  ❌ {space}: native differs from numpy by {difference:.6f}")
+            ok = False
+    pglColorEngine._pglColor = native
+    print(f"native against numpy: {'ok' if ok else 'FAILED'}")
+    return ok
+
+##########################
+# timing
+##########################
+def benchTiming(nRepeats=20):
+    '''
+    Time to convert vertex colors and texture pixels of each space.
+    '''
+    engine = pglColorEngine(calibrationData())
+    vertices = np.random.default_rng(1).random((600, 3)).astype(np.float32)
+    pixels = np.random.default_rng(2).random((512, 512, 4)).astype(np.float32)
+    print(f"{'space':<10} {'600 vertices':>14} {'512x512 texture':>16}")
+    for space in testColors:
+        times = []
+        for color in (vertices, pixels):
+            start = time.perf_counter()
+            for i in range(nRepeats): engine.convert(color, space)
+            times.append((time.perf_counter() - start) / nRepeats)
+        print(f"{space:<10} {times[0]*1e6:11.1f} us {times[1]*1e3:13.3f} ms")
+
+##########################
+# main
+##########################
+if __name__ == "__main__":
+    ok = checkCalibrationPaths()
+    ok = checkNative() and ok
+    benchTiming()
+    sys.exit(0 if ok else 1)
@@ -0,0 +1,95 @@
+################################################################
+#   filename: pglBenchMultiDisplay.py
+#    purpose: Presentation skew across several displays with
+#             pglMultiDisplay, run against pglStandInServer so it
+#             needs no Mac or monitors. Compares flushing each
+#             display in turn (as with separate pgl objects),
+#             flushing in parallel, and synchronized flushes aimed
+#             at a shared target. Run from the repo root with
+#             "make benchMultiDisplay"
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import sys
+from pathlib import Path
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+from pgl.pglMultiDisplay import pglMultiDisplay
+from pgl._pglStandIn import pglStandInServer, pglStandInDisplay
+
+nFrames = 120
+
+##########################
+# helpers
+##########################
+def makeSession(displaySpecs):
+    '''
+    Start a stand-in server for each (frameRate, vsyncPhase, renderTime) and connect to them.
+    '''
+    servers = [pglStandInServer(frameRate=f, vsyncPhase=phase, renderTime=render).start() for f, phase, render in displaySpecs]
+    displays = [pglStandInDisplay(server.socketName, frameRate=server.frameRate) for server in servers]
+    return servers, pglMultiDisplay(displays, verbose=0)
+
+def summarize(label, presented, framePeriod):
+    '''
+    Print skew and dropped frame counts from an nFrames x nDisplays array of presented times.
+    '''
+    skew = np.ptp(presented, axis=1) * 1000
+    dropped = np.sum(np.diff(presented, axis=0) > 1.5 * framePeriod)
+    print(f"  {label:>14} {np.median(skew):10.3f} {np.percentile(skew, 95):10.3f} {skew.max():10.3f} {dropped:8d}")
+
+def benchRig(name, displaySpecs):
+    '''
+    Run the three flush strategies on one rig.
+    '''
+    servers, multi = makeSession(displaySpecs)
+    framePeriod = 1.0 / displaySpecs[0][0]
+    print(f"{name}")
+    print(f"  {'flush':>14} {'median ms':>10} {'95th ms':>10} {'max ms':>10} {'dropped':>8}")
+
+    # one display after another, as separate pgl objects would
+    presented = np.array([[display.flush() for display in multi] for frame in range(nFrames)])
+    summarize("sequential", presented, framePeriod)
+
+    # all at once
+    presented = np.array([multi.flush(synchronized=False) for frame in range(nFrames)])
+    summarize("parallel", presented, framePeriod)
+
+    # aimed at a shared target
+    presented = np.array([multi.flush() for frame in range(nFrames)])
+    summarize("synchronized", presented, framePeriod)
+    offsets = multi.getSkew(printSummary=False)['targetOffsets'] * 1000
+    print(f"  {'offset from target ms':>22} " + " ".join(f"{o:7.3f}" for o in offsets))
+
+    multi.close()
+    for server in servers: server.stop()
+
+def checkAddDisplay(nBefore=10, nAfter=10):
+    '''
+    A display added after some flushes: getSkew counts only the flushes both displays presented.
+    '''
+    servers, multi = makeSession([(60, 0.0, 0.002)])
+    for frame in range(nBefore): multi.flush()
+    server = pglStandInServer(frameRate=60, vsyncPhase=0.0, renderTime=0.002).start()
+    servers.append(server)
+    multi.addDisplay(pglStandInDisplay(server.socketName, frameRate=server.frameRate))
+    for frame in range(nAfter): multi.flush()
+    summary = multi.getSkew(printSummary=False)
+    ok = summary is not None and summary['nFlushes'] == nAfter and len(summary['targetOffsets']) == 2
+    print(f"display added after {nBefore} flushes: {'ok' if ok else 'FAILED'}")
+    multi.close()
+    for server in servers: server.stop()
+    return ok
+
+if __name__ == "__main__":
+    ok = checkAddDisplay()
+    # (frameRate, vsyncPhase, renderTime)
+    benchRig("2 genlocked displays (haploscope)", [(60, 0.0, 0.002), (60, 0.0, 0.002)])
+    benchRig("2 displays, vsync 4 ms apart", [(60, 0.0, 0.002), (60, 0.004, 0.002)])
+    benchRig("3 displays, one slow to render", [(60, 0.0, 0.002), (60, 0.001, 0.002), (60, 0.002, 0.012)])
+    sys.exit(0 if ok else 1)
@@ -0,0 +1,552 @@
+/////////////////////////////////////////////////////////////////////
+//  pglBenchNative.c
+//
+//  Benchmarks of the portable native cores (clock, eat key table,
+//  event ring, display mode matching, Psi staircase, polygon
+//  tessellation, colour conversion, noise frames, trace log). Builds without
+//  Python or a window system: run with "make bench"
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <math.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdatomic.h>
+#include "_pglClock.h"
+#include "_pglEventCore.h"
+#include "_pglDisplay.h"
+#include "_pglPsiCore.h"
+#include "_pglTessCore.h"
+#include "_pglColorCore.h"
+#include "_pglNoiseCore.h"
+#include "_pglTraceCore.h"
+
+////////////////////////
+//   define section   //
+////////////////////////
+#define kClockCalls 5000000
+#define kEatKeyLookups 20000000
+#define kRingEvents 1000000
+#define kRingCapacity 4096
+#define kModeSearches 20000
+#define kPsiTrials 40
+#define kTessRepeats 50
+#define kTessMaxVertices 8192
+#define kTessMaxHoles 128
+#define kColorPixels (1024 * 1024)
+#define kColorRepeats 10
+#define kColorLutSize 1024
+#define kNoiseFrames 32
+#define kNoiseSize 256
+#define kTraceRecords 200000
+#define kTraceThreads 4
+#define kTraceCapacity (1 << 18)
+#define kTraceDrainInterval 1000
+
+//////////////////////
+// global variables //
+//////////////////////
+// keeps the optimizer from removing benchmark loops
+static volatile double sink = 0;
+// trace log writers that have finished
+static atomic_int nTraceWritersDone = 0;
+
+///////////////////////////
+//   compareDoubles      //
+///////////////////////////
+static int compareDoubles(const void* a, const void* b)
+{
+  double x = *(const double*)a, y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+///////////////////////////
+//   benchClock          //
+///////////////////////////
+static void benchClock(void)
+{
+  // call overhead
+  double startTime = pglClockGetSecs();
+  double total = 0;
+  for (int i = 0; i < kClockCalls; i++) total += pglClockGetSecs();
+  double elapsed = pglClockGetSecs() - startTime;
+  sink = total;
+
+  // smallest observable step and monotonicity
+  double minStep = 1e9, last = pglClockGetSecs();
+  int backwards = 0;
+  for (int i = 0; i < kClockCalls; i++) {
+    double now = pglClockGetSecs();
+    if (now < last) backwards++;
+    else if ((now > last) && (now - last < minStep)) minStep = now - last;
+    last = now;
+  }
+
+  printf("clock (%s)\n", pglClockGetName());
+  printf("  call overhead       %8.1f ns\n", 1e9 * elapsed / kClockCalls);
+  printf("  smallest step       %8.1f ns\n", 1e9 * minStep);
+  printf("  backwards steps     %8d\n", backwards);
+}
+
+///////////////////////////
+//   benchEatKeys        //
+///////////////////////////
+static void benchEatKeys(void)
+{
+  // a typical set, the response keys plus ESC
+  int keys[64];
+  for (int i = 0; i < 64; i++) keys[i] = i * 3;
+  pglEatKeysSet(keys, 64);
+
+  double startTime = pglClockGetSecs();
+  int hits = 0;
+  for (int i = 0; i < kEatKeyLookups; i++) hits += pglEatKeysContains(i & 255);
+  double elapsed = pglClockGetSecs() - startTime;
+  sink = hits;
+  pglEatKeysClear();
+
+  printf("eat keys\n");
+  printf("  lookup              %8.1f ns\n", 1e9 * elapsed / kEatKeyLookups);
+}
+
+///////////////////////////
+//   ringProducer        //
+///////////////////////////
+static void* ringProducer(void* arg)
+{
+  pglEventRing* ring = (pglEventRing*)arg;
+  pglInputEvent event = {0};
+  event.type = pglEventKeyDown;
+  for (int i = 0; i < kRingEvents; i++) {
+    event.keyCode = i;
+    event.timestamp = pglClockGetSecs();
+    // retry when full, this measures throughput rather than drops
+    while (pglEventRingPush(ring, &event) != 0) sched_yield();
+  }
+  return NULL;
+}
+
+///////////////////////////
+//   benchEventRing      //
+///////////////////////////
+static void benchEventRing(void)
+{
+  pglEventRing ring;
+  if (pglEventRingInit(&ring, kRingCapacity) != 0) return;
+
+  double* latency = (double*)malloc(sizeof(double) * kRingEvents);
+  pthread_t producer;
+  double startTime = pglClockGetSecs();
+  pthread_create(&producer, NULL, ringProducer, &ring);
+
+  // consume and record push to pop latency
+  pglInputEvent event;
+  int received = 0, outOfOrder = 0, lastKeyCode = -1;
+  while (received < kRingEvents) {
+    if (pglEventRingPop(&ring, &event, 1.0) == 1) {
+      latency[received++] = pglClockGetSecs() - event.timestamp;
+      if (event.keyCode != lastKeyCode + 1) outOfOrder++;
+      lastKeyCode = event.keyCode;
+    }
+  }
+  double elapsed = pglClockGetSecs() - startTime;
+  pthread_join(producer, NULL);
+
+  qsort(latency, kRingEvents, sizeof(double), compareDoubles);
+  printf("event ring (capacity %d, 1 producer, 1 consumer)\n", kRingCapacity);
+  printf("  throughput          %8.2f M events/s\n", kRingEvents / elapsed / 1e6);
+  printf("  latency median      %8.1f us\n", 1e6 * latency[kRingEvents / 2]);
+  printf("  latency 99th pct    %8.1f us\n", 1e6 * latency[(int)(kRingEvents * 0.99)]);
+  printf("  full-queue retries  %8llu\n", (unsigned long long)pglEventRingDropped(&ring));
+  printf("  out of order        %8d\n", outOfOrder);
+
+  free(latency);
+  pglEventRingDestroy(&ring);
+}
+
+///////////////////////////
+//   benchModeSearch     //
+///////////////////////////
+static void benchModeSearch(void)
+{
+  // synthetic mode list the size of a large external display
+  pglDisplayMode* modes = (pglDisplayMode*)calloc(PGL_MAX_DISPLAY_MODES, sizeof(pglDisplayMode));
+  int rates[] = {0, 24, 30, 50, 60, 75, 100, 120, 144, 240};
+  int depths[] = {16, 30, 32, 64};
+  for (int i = 0; i < PGL_MAX_DISPLAY_MODES; i++) {
+    modes[i].width = 640 + 160 * (i / 40);
+    modes[i].height = (modes[i].width * 9) / 16;
+    modes[i].frameRate = rates[i % 10];
+    modes[i].bitDepth = depths[(i / 10) % 4];
+  }
+
+  double startTime = pglClockGetSecs();
+  int total = 0;
+  for (int i = 0; i < kModeSearches; i++)
+    total += pglDisplayFindBestMode(modes, PGL_MAX_DISPLAY_MODES, 1920, 1080, 120, 32, NULL);
+  double elapsed = pglClockGetSecs() - startTime;
+  sink = total;
+
+  // also exercise the mock display backend
+  pglDisplayMode current;
+  pglDisplayGetCurrentMode(0, &current);
+
+  printf("display mode search (%d modes, backend %s)\n", PGL_MAX_DISPLAY_MODES, pglDisplayGetBackendName());
+  printf("  best mode           %8.2f us\n", 1e6 * elapsed / kModeSearches);
+  free(modes);
+}
+
+///////////////////////////
+//   linspace            //
+///////////////////////////
+static void linspace(double* values, int n, double first, double last, int logSpaced)
+{
+  for (int i = 0; i < n; i++) {
+    double t = (n > 1) ? (double)i / (n - 1) : 0;
+    values[i] = logSpaced ? first * pow(last / first, t) : first + t * (last - first);
+  }
+}
+
+///////////////////////////
+//   benchPsiGrid        //
+///////////////////////////
+// one simulated staircase: per trial update + stimulus selection time
+static void benchPsiGrid(int nStimuli, int nThresholds, int nSlopes, int nLapses, int nThreads)
+{
+  int nParams = nThresholds * nSlopes * nLapses;
+  long nCells = (long)nStimuli * nParams;
+  double *stimuli = malloc(sizeof(double) * nStimuli), *thresholds = malloc(sizeof(double) * nThresholds);
+  double *slopes = malloc(sizeof(double) * nSlopes), *lapses = malloc(sizeof(double) * nLapses);
+  double *pCorrect = malloc(sizeof(double) * nCells), *logCorrect = malloc(sizeof(double) * nCells);
+  double *logIncorrect = malloc(sizeof(double) * nCells);
+  double *posterior = malloc(sizeof(double) * nParams), *expectedEntropy = malloc(sizeof(double) * nStimuli);
+  double *trialTimes = malloc(sizeof(double) * kPsiTrials);
+  linspace(stimuli, nStimuli, 0.005, 0.5, 1);
+  linspace(thresholds, nThresholds, 0.01, 0.3, 1);
+  linspace(slopes, nSlopes, 1.0, 8.0, 1);
+  linspace(lapses, nLapses, 0.0, 0.05, 0);
+
+  // likelihood tables
+  double startTime = pglClockGetSecs();
+  pglPsiWeibullTable(stimuli, nStimuli, thresholds, nThresholds, slopes, nSlopes, lapses, nLapses, 0.5,
+                     pCorrect, logCorrect, logIncorrect);
+  double tableTime = pglClockGetSecs() - startTime;
+
+  // simulated observer with threshold 0.075, slope 3 (as pglObserverModel)
+  srand(1);
+  for (int i = 0; i < nParams; i++) posterior[i] = 1.0 / nParams;
+  int stimulus = pglPsiSelectStimulus(posterior, pCorrect, logCorrect, logIncorrect, nStimuli, nParams, expectedEntropy, nThreads);
+  for (int trial = 0; trial < kPsiTrials; trial++) {
+    double pTrue = 1 - 0.5 * exp(-pow(stimuli[stimulus] / 0.075, 3.0));
+    int response = ((double)rand() / RAND_MAX) < pTrue;
+    startTime = pglClockGetSecs();
+    pglPsiUpdate(posterior, pCorrect + (long)stimulus * nParams, nParams, response);
+    stimulus = pglPsiSelectStimulus(posterior, pCorrect, logCorrect, logIncorrect, nStimuli, nParams, expectedEntropy, nThreads);
+    trialTimes[trial] = pglClockGetSecs() - startTime;
+  }
+
+  // posterior mean threshold
+  double threshold = 0;
+  for (int i = 0; i < nParams; i++) threshold += posterior[i] * thresholds[i / (nSlopes * nLapses)];
+
+  qsort(trialTimes, kPsiTrials, sizeof(double), compareDoubles);
+  printf("psi staircase (%d stimuli x %d params = %ld cells, %d thread%s)\n", nStimuli, nParams, nCells, nThreads, nThreads > 1 ? "s" : "");
+  printf("  likelihood tables   %8.2f ms\n", 1e3 * tableTime);
+  printf("  trial median        %8.2f ms\n", 1e3 * trialTimes[kPsiTrials / 2]);
+  printf("  trial max           %8.2f ms\n", 1e3 * trialTimes[kPsiTrials - 1]);
+  printf("  threshold estimate  %8.4f (true 0.0750)\n", threshold);
+  free(stimuli); free(thresholds); free(slopes); free(lapses);
+  free(pCorrect); free(logCorrect); free(logIncorrect);
+  free(posterior); free(expectedEntropy); free(trialTimes);
+}
+
+///////////////////////////
+//   benchPsi            //
+///////////////////////////
+static void benchPsi(void)
+{
+  int nCores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  // ~1e5 and ~1e6 grid cells
+  benchPsiGrid(40, 50, 20, 3, 1);
+  benchPsiGrid(50, 100, 40, 5, 1);
+  if (nCores > 1) benchPsiGrid(50, 100, 40, 5, nCores);
+}
+
+///////////////////////////
+//   ringArea            //
+///////////////////////////
+static double ringArea(const double* xy, int start, int end)
+{
+  double sum = 0;
+  for (int i = start, j = end - 1; i < end; j = i++) sum += xy[2 * j] * xy[2 * i + 1] - xy[2 * i] * xy[2 * j + 1];
+  return fabs(sum) / 2;
+}
+
+///////////////////////////
+//   benchTessShape      //
+///////////////////////////
+// time to tessellate one shape, and how far the area of the triangles
+// is from the area of the shape
+static void benchTessShape(const char* name, const double* xy, int nVertices, const int* holeStarts, int nHoles)
+{
+  uint32_t* triangles = malloc(sizeof(uint32_t) * 3 * pglTessMaxTriangles(nVertices, nHoles));
+  double times[kTessRepeats];
+  int nTriangles = 0;
+  for (int i = 0; i < kTessRepeats; i++) {
+    double startTime = pglClockGetSecs();
+    nTriangles = pglTessTriangulate(xy, nVertices, holeStarts, nHoles, triangles);
+    times[i] = pglClockGetSecs() - startTime;
+  }
+  double area = ringArea(xy, 0, nHoles ? holeStarts[0] : nVertices);
+  for (int i = 0; i < nHoles; i++) area -= ringArea(xy, holeStarts[i], (i < nHoles - 1) ? holeStarts[i + 1] : nVertices);
+  double areaError = fabs(pglTessTriangleArea(xy, triangles, nTriangles) - area) / area;
+  qsort(times, kTessRepeats, sizeof(double), compareDoubles);
+  printf("  %-26s %6d %6d %10.3f %10.3f %9.1e\n", name, nVertices, nTriangles, 1e3 * times[kTessRepeats / 2], 1e3 * times[kTessRepeats - 1], areaError);
+  free(triangles);
+}
+
+///////////////////////////
+//   benchTess           //
+///////////////////////////
+static void benchTess(void)
+{
+  double* xy = malloc(sizeof(double) * 2 * kTessMaxVertices);
+  int holeStarts[kTessMaxHoles];
+  printf("polygon tessellation (%d runs each)\n", kTessRepeats);
+  printf("  %-26s %6s %6s %10s %10s %9s\n", "", "verts", "tris", "median ms", "max ms", "area err");
+
+  // annular sector: 100 points out along each arc
+  int n = 0;
+  for (int i = 0; i < 100; i++) {
+    double a = 0.2 + 1.1 * i / 99;
+    xy[2 * n] = 5 * cos(a); xy[2 * n + 1] = 5 * sin(a); n++;
+  }
+  for (int i = 99; i >= 0; i--) {
+    double a = 0.2 + 1.1 * i / 99;
+    xy[2 * n] = 3 * cos(a); xy[2 * n + 1] = 3 * sin(a); n++;
+  }
+  benchTessShape("annular sector", xy, n, NULL, 0);
+
+  // flower: concave outline with 13 petals
+  n = 2000;
+  for (int i = 0; i < n; i++) {
+    double a = 2 * M_PI * i / n, r = 1 + 0.5 * cos(13 * a);
+    xy[2 * i] = r * cos(a); xy[2 * i + 1] = r * sin(a);
+  }
+  benchTessShape("13 petal flower", xy, n, NULL, 0);
+
+  // spiral arm three turns long
+  n = 0;
+  for (int i = 0; i < 1500; i++) {
+    double t = 6 * M_PI * i / 1499;
+    xy[2 * n] = (1 + t) * cos(t); xy[2 * n + 1] = (1 + t) * sin(t); n++;
+  }
+  for (int i = 1499; i >= 0; i--) {
+    double t = 6 * M_PI * i / 1499;
+    xy[2 * n] = (0.5 + t) * cos(t); xy[2 * n + 1] = (0.5 + t) * sin(t); n++;
+  }
+  benchTessShape("spiral", xy, n, NULL, 0);
+
+  // jagged star with random radii
+  n = 5000;
+  srand(1);
+  for (int i = 0; i < n; i++) {
+    double a = 2 * M_PI * i / n, r = 0.3 + 0.7 * rand() / RAND_MAX;
+    xy[2 * i] = r * cos(a); xy[2 * i + 1] = r * sin(a);
+  }
+  benchTessShape("random star", xy, n, NULL, 0);
+
+  // disk with a grid of round holes (an aperture of windows)
+  n = 0;
+  for (int i = 0; i < 512; i++) {
+    double a = 2 * M_PI * i / 512;
+    xy[2 * n] = 10 * cos(a); xy[2 * n + 1] = 10 * sin(a); n++;
+  }
+  int nHoles = 0;
+  for (int hx = 0; hx < 8; hx++) {
+    for (int hy = 0; hy < 8; hy++) {
+      double cx = -7 + 2 * hx, cy = -7 + 2 * hy;
+      if (cx * cx + cy * cy >= 70) continue;
+      holeStarts[nHoles++] = n;
+      for (int i = 0; i < 32; i++) {
+        double a = 2 * M_PI * i / 32;
+        xy[2 * n] = cx + 0.6 * cos(a); xy[2 * n + 1] = cy + 0.6 * sin(a); n++;
+      }
+    }
+  }
+  char name[64];
+  snprintf(name, sizeof(name), "disk with %d holes", nHoles);
+  benchTessShape(name, xy, n, holeStarts, nHoles);
+  free(xy);
+}
+
+///////////////////////////
+//   benchColor          //
+///////////////////////////
+// time to convert the pixels of a 1024 x 1024 texture to display
+// values through a made up calibration (gamma 2.2 table)
+static void benchColor(void)
+{
+  float* in = malloc(sizeof(float) * 4 * kColorPixels);
+  float* out = malloc(sizeof(float) * 4 * kColorPixels);
+  double* inDouble = malloc(sizeof(double) * 3 * kColorPixels);
+  float lut[kColorLutSize];
+  for (int i = 0; i < kColorLutSize; i++) lut[i] = (float)pow((double)i / (kColorLutSize - 1), 1 / 2.2);
+  for (long i = 0; i < kColorPixels; i++) {
+    for (int c = 0; c < 3; c++) inDouble[3 * i + c] = in[4 * i + c] = 0.3f * ((float)((i * (c + 7)) % 1000) / 1000.0f - 0.5f);
+    in[4 * i + 3] = 1;
+  }
+  // a DKL like transform around grey
+  double matrix[9] = {1, 1.5, -0.2, 1, -0.6, -0.1, 1, 0.1, 1.4};
+  double offset[3] = {0.5, 0.5, 0.5};
+  printf("colour conversion (%d pixels, %d runs each)\n", kColorPixels, kColorRepeats);
+  for (int pass = 0; pass < 3; pass++) {
+    const char* name = (pass == 0) ? "float rgba with table" : (pass == 1) ? "double rgb with table" : "float rgba linear";
+    double times[kColorRepeats];
+    long nClamped = 0;
+    for (int i = 0; i < kColorRepeats; i++) {
+      double startTime = pglClockGetSecs();
+      if (pass == 1)
+        nClamped = pglColorTransformDouble(inDouble, kColorPixels, 3, 0, matrix, offset, lut, kColorLutSize, out);
+      else
+        nClamped = pglColorTransformFloat(in, kColorPixels, 4, 0, matrix, offset, (pass == 0) ? lut : NULL, kColorLutSize, out);
+      times[i] = pglClockGetSecs() - startTime;
+      sink += out[i];
+    }
+    qsort(times, kColorRepeats, sizeof(double), compareDoubles);
+    printf("  %-26s median %8.3f ms (%6.2f ns/pixel), %ld clamped\n", name, 1e3 * times[kColorRepeats / 2], 1e9 * times[kColorRepeats / 2] / kColorPixels, nClamped);
+  }
+  free(in); free(out); free(inDouble);
+}
+
+///////////////////////////
+//   benchNoise          //
+///////////////////////////
+// time to make 256 x 256 noise frames, white and band-pass filtered,
+// on one thread and on all of them, and to expand a frame to RGBA
+static void benchNoise(void)
+{
+  int nProcessors = pglNoiseProcessorCount();
+  uint8_t* frames = malloc((size_t)kNoiseFrames * kNoiseSize * kNoiseSize);
+  float* amplitude = malloc(sizeof(float) * kNoiseSize * kNoiseSize);
+  float* rgba = malloc(sizeof(float) * 4 * kNoiseSize * kNoiseSize);
+  // one octave band around 16 cycles per frame
+  for (int y = 0; y < kNoiseSize; y++) {
+    for (int x = 0; x < kNoiseSize; x++) {
+      double fx = (x < kNoiseSize / 2) ? x : x - kNoiseSize, fy = (y < kNoiseSize / 2) ? y : y - kNoiseSize;
+      double f = sqrt(fx * fx + fy * fy);
+      amplitude[y * kNoiseSize + x] = ((f >= 16 / M_SQRT2) && (f <= 16 * M_SQRT2)) ? 1 : 0;
+    }
+  }
+  printf("noise frames (%d frames of %d x %d, %d processors)\n", kNoiseFrames, kNoiseSize, kNoiseSize, nProcessors);
+  for (int filtered = 0; filtered < 2; filtered++) {
+    pglNoiseParams params = {kNoiseSize, kNoiseSize, filtered ? amplitude : NULL, kNoiseSize, kNoiseSize, 0.25, 1};
+    for (int threads = 1; threads <= nProcessors; threads = (threads == nProcessors) ? threads + 1 : nProcessors) {
+      double startTime = pglClockGetSecs();
+      pglNoiseGenerate(&params, 0, kNoiseFrames, threads, frames);
+      double elapsed = pglClockGetSecs() - startTime;
+      sink += frames[kNoiseSize];
+      printf("  %-10s %2d thread%s %8.3f ms/frame\n", filtered ? "band-pass" : "white", threads, (threads == 1) ? " " : "s", 1e3 * elapsed / kNoiseFrames);
+    }
+  }
+  // level spread (128 is the background)
+  double sum = 0, sumSquares = 0;
+  for (long i = 0; i < (long)kNoiseFrames * kNoiseSize * kNoiseSize; i++) {
+    double c = (frames[i] - 128) / 127.0;
+    sum += c; sumSquares += c * c;
+  }
+  long n = (long)kNoiseFrames * kNoiseSize * kNoiseSize;
+  printf("  band-pass mean %.4f, rms contrast %.4f (asked for 0.25)\n", sum / n, sqrt(sumSquares / n - (sum / n) * (sum / n)));
+  float table[256 * 4];
+  for (int i = 0; i < 256; i++) table[4 * i] = table[4 * i + 1] = table[4 * i + 2] = i / 255.0f, table[4 * i + 3] = 1;
+  double startTime = pglClockGetSecs();
+  for (int i = 0; i < kNoiseFrames; i++) pglNoiseExpand(frames + (long)i * kNoiseSize * kNoiseSize, kNoiseSize * kNoiseSize, table, rgba);
+  sink += rgba[5];
+  printf("  expand to RGBA %8.3f ms/frame\n", 1e3 * (pglClockGetSecs() - startTime) / kNoiseFrames);
+  free(frames); free(amplitude); free(rgba);
+}
+
+///////////////////////////
+//   traceWriter         //
+///////////////////////////
+static void* traceWriter(void* arg)
+{
+  // cpu time of the thread, as the writers may share cores
+  double* elapsed = (double*)arg;
+  struct timespec start, end;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+  for (int i = 0; i < kTraceRecords; i++) pglTraceLog(1, i, 0, 0, 0);
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+  *elapsed = (end.tv_sec - start.tv_sec) + 1e-9 * (end.tv_nsec - start.tv_nsec);
+  atomic_fetch_add(&nTraceWritersDone, 1);
+  return NULL;
+}
+
+///////////////////////////
+//   benchTrace          //
+///////////////////////////
+// cost of a trace record from several threads at once, while one
+// reader drains the rings every millisecond (they are big enough that
+// none are dropped), and whether each thread's records come out in order
+static void benchTrace(void)
+{
+  pglTraceRecord* records = malloc(sizeof(pglTraceRecord) * kTraceCapacity);
+  int64_t* last = malloc(sizeof(int64_t) * kTraceThreads * 2);
+  for (int i = 0; i < kTraceThreads * 2; i++) last[i] = -1;
+  pglTraceEnable(kTraceCapacity);
+  pthread_t writers[kTraceThreads];
+  double elapsed[kTraceThreads];
+  for (int t = 0; t < kTraceThreads; t++) pthread_create(&writers[t], NULL, traceWriter, &elapsed[t]);
+
+  // drain until the writers are done and the rings are empty
+  long drained = 0, outOfOrder = 0, nDrains = 0, n = 0;
+  int done;
+  do {
+    done = (atomic_load(&nTraceWritersDone) == kTraceThreads);
+    n = pglTraceDrain(records, kTraceCapacity);
+    nDrains++;
+    for (long i = 0; i < n; i++) {
+      int thread = records[i].thread % (kTraceThreads * 2);
+      if ((int64_t)records[i].args[0] <= last[thread]) outOfOrder++;
+      last[thread] = (int64_t)records[i].args[0];
+    }
+    drained += n;
+    // as pglTrace does (every quarter second), but more often
+    if (!done) usleep(kTraceDrainInterval);
+  } while (!done || (n > 0));
+  for (int t = 0; t < kTraceThreads; t++) pthread_join(writers[t], NULL);
+  pglTraceDisable();
+
+  double slowest = 0;
+  for (int t = 0; t < kTraceThreads; t++) if (elapsed[t] > slowest) slowest = elapsed[t];
+  printf("trace log (%d threads writing, 1 draining every %d us, rings of %d)\n", kTraceThreads, kTraceDrainInterval, kTraceCapacity);
+  printf("  record              %8.1f ns\n", 1e9 * slowest / kTraceRecords);
+  printf("  drained             %8ld of %d (%ld drains)\n", drained, kTraceThreads * kTraceRecords, nDrains);
+  printf("  dropped (ring full) %8llu\n", (unsigned long long)pglTraceDropped());
+  printf("  out of order        %8ld\n", outOfOrder);
+  free(records); free(last);
+}
+
+///////////////////////////
+//   main                //
+///////////////////////////
+int main(int argc, char** argv)
+{
+  benchClock();
+  benchEatKeys();
+  benchEventRing();
+  benchModeSearch();
+  benchPsi();
+  benchTess();
+  benchColor();
+  benchNoise();
+  benchTrace();
+  return 0;
+}
@@ -0,0 +1,122 @@
+/////////////////////////////////////////////////////////////////////
+//  pglBenchRealtime.c
+//
+//  Wake-up latency of a periodic thread (as the render loop or an
+//  acquisition thread) with the default policy and with the real-time
+//  policy, pinning and memory locking of _pglSched.h, idle and with
+//  every core kept busy by background threads. Real-time scheduling
+//  needs privileges on Linux (CAP_SYS_NICE, or run with sudo); rows
+//  that could not be set up say why. Run with "make benchRealtime"
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "_pglClock.h"
+#include "_pglSched.h"
+
+////////////////////////
+//   define section   //
+////////////////////////
+#define kInterval 0.002
+#define kWakeups 1500
+#define kBusyTime 0.0002
+
+//////////////////////
+// global variables //
+//////////////////////
+static volatile int loadRunning = 0;
+static volatile double sink = 0;
+
+///////////////////////////
+//   compareDoubles      //
+///////////////////////////
+static int compareDoubles(const void* a, const void* b)
+{
+  double x = *(const double*)a, y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+///////////////////////////
+//   loadThread          //
+///////////////////////////
+// background work: spins, touching memory now and then
+static void* loadThread(void* arg)
+{
+  double buffer[4096];
+  long i = 0;
+  while (loadRunning) {
+    buffer[i & 4095] = (double)i;
+    if ((i & 0xFFFF) == 0) sink = buffer[(i >> 3) & 4095];
+    i++;
+  }
+  return NULL;
+}
+
+///////////////////////////
+//   measure             //
+///////////////////////////
+static void measure(const char* label, int policyType, int pin, int lock, int load)
+{
+  int nCores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  pthread_t* loadThreads = (pthread_t*)malloc(sizeof(pthread_t) * nCores);
+  double* lateness = (double*)malloc(sizeof(double) * kWakeups);
+  const char* message = NULL;
+  int setupFailed = 0;
+
+  // one busy thread per core, started first since threads inherit the
+  // policy of the thread that creates them
+  loadRunning = load;
+  if (load) for (int i = 0; i < nCores; i++) pthread_create(&loadThreads[i], NULL, loadThread, NULL);
+
+  // this thread's scheduling
+  pglSchedPolicy policy = {policyType, kInterval, kInterval / 4, kInterval / 2, 0};
+  if (pin && (pglSchedPinToCore(nCores - 1, &message) != 0)) setupFailed = 1;
+  if (!setupFailed && (pglSchedSetPolicy(&policy, &message) != 0)) setupFailed = 1;
+  if (!setupFailed && lock && (pglSchedLockMemory(1, &message) != 0)) setupFailed = 1;
+  if (!setupFailed) pglSchedMeasureWakeups(kInterval, kWakeups, kBusyTime, lateness);
+
+  // back to the default for the next row
+  pglSchedPolicy standard = {pglSchedDefault, 0, 0, 0, 0};
+  pglSchedSetPolicy(&standard, NULL);
+  pglSchedPinToCore(-1, NULL);
+  if (lock) pglSchedLockMemory(0, NULL);
+  loadRunning = 0;
+  if (load) for (int i = 0; i < nCores; i++) pthread_join(loadThreads[i], NULL);
+
+  if (setupFailed) {
+    printf("  %-34s not available: %s\n", label, message);
+  }
+  else {
+    qsort(lateness, kWakeups, sizeof(double), compareDoubles);
+    int overOneMs = 0;
+    for (int i = 0; i < kWakeups; i++) overOneMs += (lateness[i] > 0.001);
+    printf("  %-34s %8.1f %8.1f %8.1f %8.1f %8d\n", label,
+           1e6 * lateness[kWakeups / 2], 1e6 * lateness[(int)(kWakeups * 0.99)],
+           1e6 * lateness[(int)(kWakeups * 0.999)], 1e6 * lateness[kWakeups - 1], overOneMs);
+  }
+  free(loadThreads);
+  free(lateness);
+}
+
+///////////////////////////
+//   main                //
+///////////////////////////
+int main(int argc, char** argv)
+{
+  int nCores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  printf("wake-up lateness every %.1f ms, %d wakes (%s, clock %s)\n", 1e3 * kInterval, kWakeups, pglSchedGetBackendName(), pglClockGetName());
+  printf("  %-34s %8s %8s %8s %8s %8s\n", "", "med us", "99% us", "99.9% us", "max us", ">1 ms");
+  measure("default, idle", pglSchedDefault, 0, 0, 0);
+  measure("realtime, idle", pglSchedRealtime, 0, 0, 0);
+  printf("with %d busy background threads\n", nCores);
+  measure("default", pglSchedDefault, 0, 0, 1);
+  measure("realtime", pglSchedRealtime, 0, 0, 1);
+  measure("realtime, pinned, memory locked", pglSchedRealtime, 1, 1, 1);
+  measure("deadline", pglSchedDeadline, 0, 0, 1);
+  return 0;
+}
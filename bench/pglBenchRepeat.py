@@ -0,0 +1,61 @@
+################################################################
+#   filename: pglBenchRepeat.py
+#    purpose: Renderer driven frames (mglRepeat*) against the same
+#             frames driven from Python, with pglProfile.profileRepeat.
+#             Runs against pglStandInServer so it needs no Mac; give
+#             "--metal" to run against an mglMetal that pgl opens.
+#             Run from the repo root with "make benchRepeat"
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import sys
+from pathlib import Path
+from types import SimpleNamespace
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+frameCounts = (60, 300)
+objectCounts = (100, 1000, 10000)
+textureSizes = (256, 1024)
+
+##########################
+# stand-in display
+##########################
+def openStandIn():
+    '''
+    A stand-in display with the drawing and profiling methods of pgl, on a
+    server that takes a little longer to render each dot or quad.
+    '''
+    from pgl._pglStandIn import pglStandInServer, pglStandInDisplay
+    from pgl.pglDraw import pglDraw
+    from pgl.pglProfile import pglProfile
+    from pgl.pglTimestamp import pglTimestamp
+
+    class pglBenchDisplay(pglStandInDisplay, pglDraw, pglProfile, pglTimestamp):
+        # device coordinates, so degrees and pixels are the same
+        xDeg2Pix = yDeg2Pix = xPix2Deg = yPix2Deg = 1.0
+        screenWidth = SimpleNamespace(deg=2.0, pix=2.0)
+        screenHeight = SimpleNamespace(deg=2.0, pix=2.0)
+        def pauseInterrupts(self): pass
+        def restoreInterrupts(self): pass
+
+    server = pglStandInServer(frameRate=60, renderTime=0.002, objectTime=1e-6).start()
+    return server, pglBenchDisplay(server.socketName, frameRate=server.frameRate)
+
+##########################
+# main
+##########################
+if __name__ == "__main__":
+    if "--metal" in sys.argv:
+        from pgl import pgl
+        server, display = None, pgl()
+        display.open()
+    else:
+        server, display = openStandIn()
+    display.profileRepeat(frameCounts=frameCounts, objectCounts=objectCounts, textureSizes=textureSizes)
+    display.close()
+    if server is not None: server.stop()
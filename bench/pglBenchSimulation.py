@@ -0,0 +1,110 @@
+################################################################
+#   filename: pglBenchSimulation.py
+#    purpose: A 10 minute fMRI protocol (bar mapping with a
+#             fixation task answered by a pglObserverModel) run in
+#             simulated time with pglExperimentSimulator. Checks
+#             that the data has every volume and response, and
+#             reports the wall clock time it took and the time to
+#             make each frame, compared with an earlier run
+#             (--compare) so slower task code shows up.
+#             Run from the repo root with "make benchSimulation"
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import sys
+import json
+import platform
+from datetime import datetime
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+# protocol: sweeps of bar mapping, 16 volumes each
+volumePeriod = 1.5
+nSweeps = 25
+nVolumesPerSweep = 16
+# slower than this ratio of the compared run is flagged
+regressionRatio = 1.2
+reportPath = Path(__file__).resolve().parent.parent / "build" / "bench" / "pglBenchSimulation"
+
+##########################
+# simulate
+##########################
+def simulate(dataPath):
+    '''
+    Run the protocol in simulated time and return the simulator's results
+    with what the saved data holds.
+    '''
+    from pgl import pglSimulated, pglExperiment, pglExperimentSimulator, pglObserverPolicy
+    from pgl.pglSettings import pglSettings
+    from pgl.pglTasks import pglBarTask, pglFixationTaskLeftRight
+    from pgl.pglStaircase import pglObserverModel
+
+    settings = pglSettings()
+    settings.dataPath = str(dataPath)
+    settings.startOnVolumeTrigger = True
+    settings.responseKeys = "12"
+
+    display = pglSimulated(frameRate=60)
+    e = pglExperiment(display, settings=settings, experimentName="Simulated bar mapping")
+    simulator = pglExperimentSimulator(e, volumePeriod=volumePeriod, seed=1)
+    simulator.initScreen()
+
+    # bar mapping that ends the run, and a fixation task to keep the subject busy
+    barTask = pglBarTask(display, volumePeriod=volumePeriod, barSweepPeriod=nVolumesPerSweep * volumePeriod, randomSeed=1)
+    barTask.settings.nTrials = nSweeps
+    fixationTask = pglFixationTaskLeftRight(display)
+    e.addTask(barTask)
+    e.addTask(fixationTask)
+
+    simulator.policy = pglObserverPolicy(pglObserverModel(threshold=0.1),
+                                         stimulusValue=lambda task, params: task.decrement,
+                                         correctResponse=lambda task, params: 0 if params['side'] == -1 else 1,
+                                         task=fixationTask)
+    results = simulator.run()
+
+    # what the data has
+    results["nVolumeEvents"] = e.data.getNumEvents(type="volumeTrigger")
+    results["nResponseEvents"] = sum(1 for event in fixationTask.data.events if event.type == "subjectResponse")
+    results["nSweeps"] = barTask.state.currentTrial
+    results["threshold"] = float(fixationTask.staircase.get())
+    return results
+
+##########################
+# main
+##########################
+if __name__ == "__main__":
+    path = Path(sys.argv[sys.argv.index("--output") + 1]) if "--output" in sys.argv else reportPath
+    results = simulate(path.parent / "pglBenchSimulationData")
+
+    # every sweep should have had its volumes: the run starts on the first trigger and the
+    # sweeps are locked to the volumes, so the trigger after the last volume is what ends it
+    nExpected = nSweeps * nVolumesPerSweep + 1
+    print(f"(pglBenchSimulation) {results['nSweeps']} sweeps, {results['nVolumeEvents']} volumes recorded ({nExpected} expected), "
+          f"{results['nResponseEvents']} responses recorded ({results['nResponses']} made), staircase at {results['threshold']:.3f}")
+    failures = []
+    if results["nSweeps"] != nSweeps: failures.append(f"{results['nSweeps']} of {nSweeps} sweeps were run")
+    if results["nVolumeEvents"] != nExpected: failures.append(f"{results['nVolumeEvents']} volumes are in the data, {nExpected} were expected")
+    if results["nVolumeEvents"] != results["nVolumes"]: failures.append(f"{results['nVolumes']} volume triggers were sent, {results['nVolumeEvents']} recorded")
+    if results["nResponseEvents"] != results["nResponses"]: failures.append(f"{results['nResponses']} responses were made, {results['nResponseEvents']} recorded")
+    for failure in failures: print(f"(pglBenchSimulation) ❌ {failure}")
+
+    if "--compare" in sys.argv:
+        with open(sys.argv[sys.argv.index("--compare") + 1]) as f:
+            previous = json.load(f)["results"]
+        for field in ("wallTime", "frameWallMedian"):
+            ratio = results[field] / previous[field] if previous[field] > 0 else float("nan")
+            results[f"{field}Ratio"] = ratio
+            print(f"(pglBenchSimulation) {field}: {ratio:.2f}x previous{' ⚠️' if ratio > regressionRatio else ''}")
+
+    report = {"date": datetime.now().isoformat(timespec="seconds"), "python": platform.python_version(),
+              "machine": platform.machine(), "results": results}
+    path.parent.mkdir(parents=True, exist_ok=True)
+    with open(path.with_suffix(".json"), "w") as f:
+        json.dump(report, f, indent=2)
+    print(f"(pglBenchSimulation) Wrote {path.with_suffix('.json')}")
+    sys.exit(1 if failures else 0)
@@ -0,0 +1,124 @@
+################################################################
+#   filename: pglBenchStaircase.py
+#    purpose: Benchmark and validation of pglStaircasePsi: per trial
+#             compute time of the native engine against numpy and
+#             threshold recovery from pglObserverModel simulations.
+#             Run from the repo root with "make benchStaircase"
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import sys
+import random
+from pathlib import Path
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+from pgl.pglStaircase import pglStaircasePsi, pglObserverModel
+
+# frame budget that a trial's update must fit in (60Hz)
+frameBudget = 1 / 60
+
+##########################
+# helpers
+##########################
+def makeStaircase(native, nThresholds=50, nSlopes=20, nLapses=3, nStimuli=40, nTrials=60):
+    '''
+    Psi staircase over a grid of the given size, using the native engine or numpy.
+    '''
+    staircase = pglStaircasePsi(stimulusValues=np.geomspace(0.005, 0.5, nStimuli),
+                                thresholds=np.geomspace(0.01, 0.3, nThresholds),
+                                slopes=np.geomspace(1.0, 8.0, nSlopes),
+                                lapses=np.linspace(0, 0.05, nLapses),
+                                nTrials=nTrials)
+    if not native:
+        staircase._pglPsi = None
+        staircase.computeLikelihoodTables()
+    return staircase
+
+def runStaircase(staircase, observer):
+    '''
+    Run a staircase to completion on a simulated observer.
+    '''
+    staircase.startStaircase()
+    while not staircase.finished():
+        stimulus = staircase.get()
+        staircase.update(stimulus, observer.get2AFCResponse(stimulus, 0))
+    staircase.endStaircase()
+    return staircase
+
+##########################
+# timing
+##########################
+def benchTiming():
+    '''
+    Per trial update + selection time for native and numpy engines.
+    '''
+    print("per trial compute time (update + next stimulus)")
+    print(f"  {'grid':>22} {'engine':>7} {'median ms':>10} {'max ms':>8} {'within frame':>13}")
+    for grid in [(50, 20, 3, 40), (100, 40, 5, 50)]:
+        nCells = np.prod(grid[:3]) * grid[3]
+        for native in [True, False]:
+            staircase = makeStaircase(native, *grid, nTrials=30)
+            if native and staircase._pglPsi is None: continue
+            random.seed(0)
+            runStaircase(staircase, pglObserverModel())
+            times = np.array(staircase.data.computeTimes) * 1000
+            print(f"  {f'{grid[3]}x{np.prod(grid[:3])}={nCells}':>22} {'native' if native else 'numpy':>7} "
+                  f"{np.median(times):10.2f} {times.max():8.2f} {np.mean(times < frameBudget * 1000) * 100:12.0f}%")
+
+##########################
+# agreement
+##########################
+def benchAgreement():
+    '''
+    Native and numpy engines should give the same stimuli and posteriors.
+    '''
+    native = makeStaircase(True)
+    if native._pglPsi is None: return
+    reference = makeStaircase(False)
+    native.startStaircase()
+    reference.startStaircase()
+    rng = np.random.default_rng(1)
+    sameChoices = 0
+    for trial in range(40):
+        sameChoices += native.currentIndex == reference.currentIndex
+        stimulus = native.get()
+        response = rng.random() < 0.75
+        native.update(stimulus, response)
+        reference.update(stimulus, response)
+    print("native vs numpy engine")
+    print(f"  same stimulus choice  {sameChoices}/40 trials")
+    print(f"  max posterior diff    {np.max(np.abs(native.posterior - reference.posterior)):.2e}")
+    print(f"  max entropy diff      {np.max(np.abs(native.expectedEntropy - reference.expectedEntropy)):.2e}")
+
+##########################
+# validation
+##########################
+def benchValidation(nRuns=50, nTrials=60):
+    '''
+    Recover the threshold of pglObserverModel observers.
+    '''
+    print(f"threshold recovery from pglObserverModel ({nRuns} runs of {nTrials} trials)")
+    print(f"  {'threshold':>9} {'slope':>5} {'mean est':>9} {'bias %':>7} {'rmse %':>7} {'within 2SD':>11}")
+    random.seed(2)
+    staircase = makeStaircase(True, nTrials=nTrials)
+    for threshold, slope in [(0.03, 2.0), (0.075, 3.0), (0.15, 4.0)]:
+        observer = pglObserverModel(threshold=threshold, slope=slope)
+        estimates, covered = [], 0
+        for run in range(nRuns):
+            runStaircase(staircase, observer)
+            estimate = staircase.getEstimates()
+            estimates.append(estimate['threshold'])
+            covered += abs(estimate['threshold'] - threshold) < 2 * estimate['thresholdSD']
+        estimates = np.array(estimates)
+        print(f"  {threshold:9.3f} {slope:5.1f} {estimates.mean():9.4f} {100 * (estimates.mean() - threshold) / threshold:7.1f} "
+              f"{100 * np.sqrt(np.mean((estimates - threshold)**2)) / threshold:7.1f} {100 * covered / nRuns:10.0f}%")
+
+if __name__ == "__main__":
+    benchTiming()
+    benchAgreement()
+    benchValidation()
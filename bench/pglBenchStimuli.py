@@ -0,0 +1,259 @@
+################################################################
+#   filename: pglBenchStimuli.py
+#    purpose: Per frame cost of each pglStimuli stimulus over a
+#             sweep of its parameters: Python time to display a
+#             frame, and the commands and bytes it sends. Writes
+#             a JSON and a markdown report, and compares with an
+#             earlier JSON report (--compare) to catch stimuli
+#             that got slower. Runs against pglStandInServer so it
+#             needs no Mac; give "--metal" to run against an
+#             mglMetal that pgl opens.
+#             Run from the repo root with "make benchStimuli"
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import sys
+import json
+import time
+import platform
+import numpy as np
+from collections import Counter
+from datetime import datetime
+from pathlib import Path
+from types import SimpleNamespace
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+# frames displayed (after warmUpFrames) for each stimulus
+nFrames = 120
+warmUpFrames = 5
+# slower than this ratio of the compared report is flagged
+regressionRatio = 1.2
+# an image sequence keeps a texture per frame of its cycle (60 for a 4 Hz grating at 240 Hz),
+# so only warn about a site well above what one stimulus holds
+siteWarning = 256
+reportPath = Path(__file__).resolve().parent.parent / "build" / "bench" / "pglBenchStimuli"
+
+##########################
+# stimuli
+##########################
+# (stimulus, parameter, values, make(display, value), display one frame(stimulus, frame))
+stimulusSweeps = [
+    ("randomDots", "density", (1, 10, 50),
+        lambda d, v: d.randomDots(width=10, height=10, density=v),
+        lambda s, f: s.display(direction=45, coherence=0.5, speed=5)),
+    ("checkerboard sliding", "checkWidth", (0.5, 1.0, 2.0),
+        lambda d, v: d.checkerboard(width=16, height=12, checkWidth=v, checkHeight=v, type='sliding'),
+        lambda s, f: s.display()),
+    ("checkerboard flickering", "checkWidth", (0.5, 1.0, 2.0),
+        lambda d, v: d.checkerboard(width=16, height=12, checkWidth=v, checkHeight=v, type='flickering'),
+        lambda s, f: s.display()),
+    ("radialCheckerboard sliding", "checkRadialWidth", (5.0, 15.0, 30.0),
+        lambda d, v: d.radialCheckerboard(d, outerRadius=8, innerRadius=0.5, checkRadialWidth=v, type='sliding'),
+        lambda s, f: s.display()),
+    ("radialCheckerboard flickering", "checkRadialWidth", (5.0, 15.0, 30.0),
+        lambda d, v: d.radialCheckerboard(d, outerRadius=8, innerRadius=0.5, checkRadialWidth=v, type='flickering'),
+        lambda s, f: s.display()),
+    ("bar", "width", (1.0, 3.0),
+        lambda d, v: d.bar(width=v, speed=4, nVolumesPerSweep=12),
+        lambda s, f: s.display(dir=45, volumeNumber=f // 10)),
+    ("flicker", "type", ("square", "sinusoidal"),
+        lambda d, v: d.flicker(d, temporalFrequency=10, type=v, framewise=True),
+        lambda s, f: s.display()),
+    ("grating image sequence", "size", (4, 10),
+        lambda d, v: d.grating(width=v, height=v, spatialFrequency=2, temporalFrequency=4),
+        lambda s, f: s.display()),
+    ("noise", "type", ("white", "bandpass"),
+        lambda d, v: d.noise(width=8, height=8, type=v, nFrames=30, seed=1),
+        lambda s, f: s.display()),
+    ("noise regenerate", "type", ("white", "bandpass"),
+        lambda d, v: d.noise(width=8, height=8, type=v, regenerate=True, seed=1),
+        lambda s, f: s.display()),
+]
+
+##########################
+# stand-in display
+##########################
+def openStandIn():
+    '''
+    A stand-in display with the drawing, image, transform and stimulus methods
+    of pgl, in visual angle coordinates on a 1920 x 1080 screen
+    '''
+    from pgl._pglStandIn import pglStandInServer, pglStandInDisplay
+    from pgl.pglDraw import pglDraw
+    from pgl.pglColor import pglColor
+    from pgl.pglTransform import pglTransform
+    from pgl.pglStimuli import pglStimuli
+    from pgl.pglTimestamp import pglTimestamp
+
+    class pglBenchDisplay(pglStandInDisplay, pglDraw, pglColor, pglTransform, pglStimuli, pglTimestamp):
+        xDeg2Pix = yDeg2Pix = 64.0
+        xPix2Deg = yPix2Deg = 1 / 64.0
+        screenWidth = SimpleNamespace(deg=1920 / 64.0, pix=1920)
+        screenHeight = SimpleNamespace(deg=1080 / 64.0, pix=1080)
+        coordinateFrame = "visualAngle"
+        xform = xformPreRotation = np.eye(4)
+        def getDateAndTime(self): return datetime.now()
+        def getFrameRate(self): return self.frameRate
+
+    # a fast display, so the sweep spends its time in the stimuli
+    server = pglStandInServer(frameRate=240, renderTime=0.0005, renderJitter=0.0).start()
+    return server, pglBenchDisplay(server.socketName, frameRate=server.frameRate)
+
+##########################
+# countTraffic
+##########################
+def countTraffic(display):
+    '''
+    Count the commands and bytes the display sends, through the hooks
+    pglCommandReplayer records commands with
+    '''
+    traffic = SimpleNamespace(commands=Counter(), nBytes=0)
+    def logCommandValue(commandValue):
+        traffic.commands[display.s.getCommandName(commandValue)] += 1
+    def logCommandData(commandData):
+        traffic.nBytes += len(commandData)
+    display.logCommandValue = logCommandValue
+    display.logCommandData = logCommandData
+    display.commandRecording = True
+    return traffic
+
+##########################
+# measure
+##########################
+def measure(display, traffic, name, parameter, value, make, displayFrame):
+    '''
+    Make a stimulus and display it for nFrames, returning what each frame cost
+    '''
+    result = {"stimulus": name, "parameter": parameter, "value": value}
+    stimulus = None
+    try:
+        startTime = time.perf_counter()
+        stimulus = make(display, value)
+        result["setupMs"] = 1000 * (time.perf_counter() - startTime)
+        if stimulus is None: raise RuntimeError("stimulus was not made")
+        for iFrame in range(warmUpFrames):
+            displayFrame(stimulus, iFrame)
+            display.flush()
+        frameTimes = np.zeros(nFrames)
+        traffic.commands.clear()
+        traffic.nBytes = 0
+        for iFrame in range(nFrames):
+            startTime = time.perf_counter()
+            displayFrame(stimulus, iFrame)
+            frameTimes[iFrame] = time.perf_counter() - startTime
+            display.flush()
+    except Exception as e:
+        result["error"] = f"{type(e).__name__}: {e}"
+        return result
+    finally:
+        release(display, stimulus)
+    # flushes are the benchmark's, not the stimulus's
+    traffic.commands.pop("mglFlush", None)
+    nFlushBytes = 2 * nFrames
+    result.update({
+        "medianMs": 1000 * float(np.median(frameTimes)),
+        "p95Ms": 1000 * float(np.percentile(frameTimes, 95)),
+        "maxMs": 1000 * float(np.max(frameTimes)),
+        "commandsPerFrame": sum(traffic.commands.values()) / nFrames,
+        "bytesPerFrame": (traffic.nBytes - nFlushBytes) / nFrames,
+        "commands": {commandName: n / nFrames for commandName, n in sorted(traffic.commands.items())},
+    })
+    return result
+
+##########################
+# release
+##########################
+def release(display, stimulus):
+    '''
+    Delete a stimulus and its textures once its case is measured, and say if
+    anything it made is still on the renderer
+    '''
+    if stimulus is not None:
+        if hasattr(stimulus, "delete"): stimulus.delete()
+        # image sequences delete their textures when the images go
+        for images in ("imageList", "textures"):
+            if isinstance(getattr(stimulus, images, None), list): getattr(stimulus, images).clear()
+    resources = getattr(display, "resources", None)
+    if resources is not None and resources.records:
+        print(f"(pglBenchStimuli) ❌ {len(resources.records)} resources still alive after the case: {dict(resources.siteCounts)}")
+
+##########################
+# compare
+##########################
+def compare(results, previousPath):
+    '''
+    Ratio of each stimulus's median frame time to an earlier report's
+    '''
+    with open(previousPath) as f:
+        previous = {(r["stimulus"], str(r["value"])): r for r in json.load(f)["results"]}
+    for result in results:
+        before = previous.get((result["stimulus"], str(result["value"])))
+        if before is None or "medianMs" not in before or "medianMs" not in result: continue
+        result["previousMedianMs"] = before["medianMs"]
+        result["ratio"] = result["medianMs"] / before["medianMs"] if before["medianMs"] > 0 else float("nan")
+
+##########################
+# writeReport
+##########################
+def writeReport(results, where, path):
+    report = {"date": datetime.now().isoformat(timespec="seconds"), "where": where, "python": platform.python_version(),
+              "machine": platform.machine(), "nFrames": nFrames, "results": results}
+    path.parent.mkdir(parents=True, exist_ok=True)
+    with open(path.with_suffix(".json"), "w") as f:
+        json.dump(report, f, indent=2)
+
+    compared = any("ratio" in r for r in results)
+    lines = [f"# pgl stimulus benchmark ({where}, {report['date']})", "",
+             f"Python time to display a frame over {nFrames} frames, and what the frame sends.", "",
+             "| stimulus | parameter | setup ms | median ms | p95 ms | commands | bytes | " + ("vs previous |" if compared else ""),
+             "|---|---|---:|---:|---:|---:|---:|" + ("---:|" if compared else "")]
+    for r in results:
+        if "error" in r:
+            lines.append(f"| {r['stimulus']} | {r['parameter']}={r['value']} | | ❌ {r['error']} | | | |" + (" |" if compared else ""))
+            continue
+        row = (f"| {r['stimulus']} | {r['parameter']}={r['value']} | {r['setupMs']:.1f} | {r['medianMs']:.3f} | {r['p95Ms']:.3f} | "
+               f"{r['commandsPerFrame']:.1f} | {r['bytesPerFrame']:,.0f} |")
+        if compared:
+            ratio = r.get("ratio")
+            row += "" if ratio is None else f" {ratio:.2f}x{' ⚠️' if ratio > regressionRatio else ''} |"
+        lines.append(row)
+    with open(path.with_suffix(".md"), "w") as f:
+        f.write("\n".join(lines) + "\n")
+    print("\n".join(lines))
+    print(f"\n(pglBenchStimuli) Wrote {path.with_suffix('.json')} and {path.with_suffix('.md')}")
+
+##########################
+# main
+##########################
+if __name__ == "__main__":
+    path = Path(sys.argv[sys.argv.index("--output") + 1]) if "--output" in sys.argv else reportPath
+    if "--metal" in sys.argv:
+        from pgl import pgl
+        server, display = None, pgl()
+        display.open()
+        display.visualAngle()
+        where = "mglMetal"
+    else:
+        server, display = openStandIn()
+        where = "stand-in"
+    traffic = countTraffic(display)
+    display.resources.siteWarning = siteWarning
+
+    results = []
+    for name, parameter, values, make, displayFrame in stimulusSweeps:
+        for value in values:
+            result = measure(display, traffic, name, parameter, value, make, displayFrame)
+            results.append(result)
+            print(f"(pglBenchStimuli) {name} {parameter}={value}: " +
+                  (result["error"] if "error" in result else f"{result['medianMs']:.3f} ms, {result['commandsPerFrame']:.1f} commands, {result['bytesPerFrame']:,.0f} bytes per frame"))
+    if "--compare" in sys.argv: compare(results, sys.argv[sys.argv.index("--compare") + 1])
+    writeReport(results, where, path)
+
+    display.commandRecording = False
+    display.close()
+    if server is not None: server.stop()
@@ -0,0 +1,128 @@
+################################################################
+#   filename: pglBenchTransport.py
+#    purpose: Round trip latency and throughput of the unix socket
+#             against tcp through a pglRelay, with and without
+#             Nagle and with commands coalesced per frame, all
+#             against pglStandInServer so it needs no Mac. The
+#             server and relay run in their own processes. Give
+#             the address of a relay on another machine (in front
+#             of a stand-in server there, e.g. "python -m
+#             pgl.pglRelay --host <its address> --socket <stand-in
+#             socket>") to add a LAN run. Run from the repo root with
+#             "make benchTransport" or
+#             "python bench/pglBenchTransport.py tcp://host:port"
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import os
+import sys
+import time
+import multiprocessing
+from socket import IPPROTO_TCP, TCP_NODELAY
+from pathlib import Path
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+from pgl._pglStandIn import pglStandInServer, pglStandInDisplay
+from pgl.pglRelay import pglRelay
+
+nPings = 500
+nFrames = 120
+nDotsCommands = 100
+nDots = 50
+textureSize = 512
+nTextures = 8
+
+##########################
+# processes
+##########################
+def runServer(socketName, stopEvent):
+    server = pglStandInServer(frameRate=60, renderTime=0.002, socketName=socketName).start()
+    stopEvent.wait()
+    server.stop()
+
+def runRelay(socketName, portQueue, stopEvent):
+    relay = pglRelay(socketName, port=0, host="127.0.0.1", verbose=0).start()
+    portQueue.put(relay.port)
+    stopEvent.wait()
+    relay.stop()
+
+##########################
+# measurements
+##########################
+def measure(label, address, noDelay=True, coalesce=False, resultDetail="full", nPings=nPings, nFrames=nFrames, countMissed=True):
+    display = pglStandInDisplay(address)
+    if display.s.isRemote and not noDelay: display.s.s.setsockopt(IPPROTO_TCP, TCP_NODELAY, 0)
+    display.s.coalesce = coalesce
+    display.s.resultDetail = resultDetail
+    display._profileMode = 0
+    display._batchState = 0
+
+    # round trip of a command that does nothing
+    pings = []
+    for iPing in range(nPings):
+        startTime = time.perf_counter()
+        display.s.writeCommand("mglPing")
+        display.s.readCommandResults()
+        pings.append(time.perf_counter() - startTime)
+    pings = np.array(pings) * 1000
+
+    # frames of many small drawing commands: time to send them, and frames missed
+    dots = np.zeros((nDots, 11), dtype=np.float32)
+    drawTimes = []
+    presented = []
+    for iFrame in range(nFrames):
+        startTime = time.perf_counter()
+        for iCommand in range(nDotsCommands):
+            display.s.writeCommand("mglDots")
+            display.s.write(np.uint32(nDots))
+            display.s.write(dots)
+            display.s.readCommandResults()
+        drawTimes.append(time.perf_counter() - startTime)
+        presented.append(display.flush())
+    missed = f"{int(np.sum(np.round(np.diff(presented) * 60) - 1))}/{nFrames}" if countMissed else "-"
+
+    # texture upload throughput
+    image = np.random.default_rng(0).random((textureSize, textureSize, 4)).astype(np.float32)
+    startTime = time.perf_counter()
+    for iTexture in range(nTextures):
+        display.imageDelete(display.imageCreate(image))
+    megabytesPerSecond = nTextures * image.nbytes / (time.perf_counter() - startTime) / 1e6
+
+    offset = f"{1000 * display.s.clockOffset:+.3f}" if display.s.isRemote else ""
+    print(f"  {label:>28} {np.median(pings):8.3f} {np.percentile(pings, 95):8.3f} {1000 * np.median(drawTimes):9.2f} {missed:>7} {megabytesPerSecond:9.0f} {offset:>10}")
+    display.close()
+
+def measureAll(unixAddress, tcpAddress, where):
+    print(where)
+    print(f"  {'':>28} {'ping ms':>8} {'95th':>8} {'frame ms':>9} {'missed':>7} {'MB/s':>9} {'offset ms':>10}")
+    if unixAddress is not None: measure("unix socket", unixAddress)
+    # (delayed acks make this one slow, so it gets fewer repeats, too few frames
+    # to count missed ones, and every frame takes many refreshes anyway)
+    measure("tcp, Nagle on", tcpAddress, noDelay=False, nPings=50, nFrames=6, countMissed=False)
+    measure("tcp", tcpAddress)
+    measure("tcp, flushOnly", tcpAddress, resultDetail="flushOnly")
+    measure("tcp, flushOnly + coalesce", tcpAddress, coalesce=True, resultDetail="flushOnly")
+
+if __name__ == "__main__":
+    multiprocessing.set_start_method("fork")
+    socketName = f"/tmp/pglBenchTransport.socket.{os.getpid()}"
+    stopEvent = multiprocessing.Event()
+    portQueue = multiprocessing.Queue()
+    server = multiprocessing.Process(target=runServer, args=(socketName, stopEvent))
+    server.start()
+    while not os.path.exists(socketName): time.sleep(0.01)
+    relay = multiprocessing.Process(target=runRelay, args=(socketName, portQueue, stopEvent))
+    relay.start()
+    port = portQueue.get()
+
+    measureAll(socketName, f"tcp://127.0.0.1:{port}", "loopback")
+    if len(sys.argv) > 1: measureAll(None, sys.argv[1], f"LAN ({sys.argv[1]})")
+
+    stopEvent.set()
+    relay.join()
+    server.join()
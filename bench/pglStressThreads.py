@@ -0,0 +1,175 @@
+################################################################
+#   filename: pglStressThreads.py
+#    purpose: Stress test of _pglTimestamp and _pglEventListener
+#             (the event ring core) called from many threads at
+#             once. Made for a free-threaded interpreter (3.13t),
+#             where it also checks that importing them leaves the
+#             GIL off (they declare Py_mod_gil = NOT_USED), and
+#             runs on any build. Threads read getSecs, post
+#             synthetic events, and change the eat keys, while the
+#             listener drains the events; no event may be lost or
+#             delivered twice and time may never go back.
+#             Run from the repo root with "make stressThreads"
+#             (PYTHON_FT=python3.13t by default). The two extensions
+#             are built for the interpreter running this into
+#             build/stress, so nothing else (numpy) is needed.
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import sys
+import time
+import random
+import argparse
+import sysconfig
+import threading
+from pathlib import Path
+
+repoDir = Path(__file__).resolve().parent.parent
+
+##########################
+# build
+##########################
+def buildExtensions():
+    '''
+    Build _pglTimestamp and _pglEventListener (Linux backends) for this interpreter
+    and put them on the path.
+    '''
+    from setuptools import Distribution, Extension
+    buildDir = repoDir / "build" / "stress" / sys.implementation.cache_tag
+    if sysconfig.get_config_var("Py_GIL_DISABLED"): buildDir = buildDir.with_name(buildDir.name + "t")
+    clockBackend = ['pgl/_pglClockLinux.c']
+    extensions = [
+        Extension('_pglTimestamp', sources=['pgl/_pglTimestamp.c'] + clockBackend),
+        Extension('_pglEventListener', sources=['pgl/_pglEventListener.cpp', 'pgl/_pglEventCore.c', 'pgl/_pglSchedCore.c',
+                                                'pgl/_pglEventBackendLinux.c', 'pgl/_pglSchedLinux.c'] + clockBackend,
+                  extra_link_args=['-lpthread']),
+    ]
+    distribution = Distribution({"name": "pglStress", "ext_modules": extensions, "script_args": ["build_ext", "--build-lib", str(buildDir), "--build-temp", str(buildDir / "temp")]})
+    distribution.parse_command_line()
+    distribution.run_commands()
+    sys.path.insert(0, str(buildDir))
+
+##########################
+# stress
+##########################
+def stress(nProducers, nEvents, nClockThreads, nEatKeyThreads):
+    '''
+    Run the threads and check what the listener received. Returns a list of failures.
+    '''
+    import _pglTimestamp
+    import _pglEventListener
+    failures = []
+
+    # the listener delivers to this (on its own thread)
+    received = []
+    def callback(event):
+        received.append((event['keyCode'], event['keyboardType'], event['timestamp']))
+        return False
+    _pglEventListener.start(callback)
+
+    stop = threading.Event()
+    start = threading.Barrier(nProducers + nClockThreads + nEatKeyThreads)
+    nFull = [0] * nProducers
+    clockErrors = []
+    nClockReads = [0] * nClockThreads
+    nEatKeySets = [0] * nEatKeyThreads
+
+    def producer(index):
+        # keyCode says which producer, keyboardType the event's number in its sequence
+        start.wait()
+        for sequence in range(nEvents):
+            while not _pglEventListener.postEvent({"eventType": "keydown", "keyCode": index, "keyboardType": sequence}):
+                # the queue is full (like a device whose buffer filled), wait for the listener
+                nFull[index] += 1
+                time.sleep(0.0001)
+
+    def clockReader(index):
+        start.wait()
+        last = _pglTimestamp.getSecs()
+        while not stop.is_set():
+            now = _pglTimestamp.getSecs()
+            if now < last: clockErrors.append((index, last, now))
+            last = now
+            nClockReads[index] += 1
+
+    def eatKeySetter(index):
+        rng = random.Random(index)
+        start.wait()
+        while not stop.is_set():
+            _pglEventListener.setEatKeys([rng.randrange(128) for i in range(rng.randrange(16))])
+            nEatKeySets[index] += 1
+
+    threads = [threading.Thread(target=producer, args=(i,)) for i in range(nProducers)]
+    others = [threading.Thread(target=clockReader, args=(i,)) for i in range(nClockThreads)]
+    others += [threading.Thread(target=eatKeySetter, args=(i,)) for i in range(nEatKeyThreads)]
+    startTime = time.perf_counter()
+    for thread in threads + others: thread.start()
+    for thread in threads: thread.join()
+
+    # wait for the listener to drain the queue
+    expected = nProducers * nEvents
+    deadline = time.perf_counter() + 30
+    while len(received) < expected and time.perf_counter() < deadline: time.sleep(0.01)
+    # anything late would be a duplicate
+    time.sleep(0.2)
+    stop.set()
+    for thread in others: thread.join()
+    _pglEventListener.stop()
+    elapsed = time.perf_counter() - startTime
+
+    # every event exactly once, in the order each producer posted them, with time going forward
+    sequences = [[] for i in range(nProducers)]
+    lastTimestamp = [float('-inf')] * nProducers
+    for keyCode, sequence, timestamp in received:
+        sequences[keyCode].append(sequence)
+        if timestamp < lastTimestamp[keyCode]: failures.append(f"producer {keyCode}: event {sequence} has an earlier timestamp than the one before it")
+        lastTimestamp[keyCode] = timestamp
+    for index, sequence in enumerate(sequences):
+        if sorted(sequence) != list(range(nEvents)):
+            nDuplicated = len(sequence) - len(set(sequence))
+            nLost = nEvents - len(set(sequence))
+            failures.append(f"producer {index}: {nLost} events lost, {nDuplicated} duplicated")
+        elif sequence != list(range(nEvents)):
+            failures.append(f"producer {index}: events delivered out of order")
+    if clockErrors: failures.append(f"getSecs went back {len(clockErrors)} times, e.g. thread {clockErrors[0][0]}: {clockErrors[0][1]:.9f} -> {clockErrors[0][2]:.9f}")
+
+    print(f"{expected} events from {nProducers} threads received in {elapsed:.2f} s ({len(received)} delivered, "
+          f"queue full {sum(nFull)} times), {sum(nClockReads)} getSecs from {nClockThreads} threads, "
+          f"{sum(nEatKeySets)} setEatKeys from {nEatKeyThreads} threads")
+    return failures
+
+##########################
+# main
+##########################
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Stress _pglTimestamp and _pglEventListener from many threads")
+    parser.add_argument("--producers", type=int, default=8)
+    parser.add_argument("--events", type=int, default=20000, help="events posted by each producer")
+    parser.add_argument("--clockThreads", type=int, default=4)
+    parser.add_argument("--eatKeyThreads", type=int, default=2)
+    parser.add_argument("--repeats", type=int, default=3)
+    args = parser.parse_args()
+    if not sys.platform.startswith('linux'):
+        print("(pglStressThreads) Synthetic events need the Linux event backend")
+        sys.exit(0)
+
+    freeThreaded = bool(sysconfig.get_config_var("Py_GIL_DISABLED"))
+    buildExtensions()
+    import _pglTimestamp, _pglEventListener
+    failures = []
+    if freeThreaded:
+        # a module without Py_mod_gil = NOT_USED turns the GIL back on when imported
+        if sys._is_gil_enabled(): failures.append("importing _pglTimestamp and _pglEventListener enabled the GIL")
+        print(f"{sys.version.split()[0]} free-threaded, GIL {'enabled' if sys._is_gil_enabled() else 'disabled'}")
+    else:
+        print(f"{sys.version.split()[0]} with the GIL (use a free-threaded build, e.g. PYTHON_FT=python3.13t, to run without it)")
+
+    for repeat in range(args.repeats):
+        failures += stress(args.producers, args.events, args.clockThreads, args.eatKeyThreads)
+    for failure in failures: print(f"  ❌ {failure}")
+    print("ok" if not failures else "FAILED")
+    sys.exit(0 if not failures else 1)
@@ -1,20 +1,26 @@
 from .pglBase import pglBase, pglDisplayMessage
+from .pglMultiDisplay import pglMultiDisplay
 from .pglResolution import pglResolution
 from .pglDraw import pglDraw
+from .pglColor import pglColor, pglColorEngine, pglDisplayColor
 from .pglTransform import pglTransform
 from .pglProfile import pglProfile
 from .pglBatch import pglBatch
 from .pglImage import pglImage
+from .pglResources import pglResourceRegistry, pglResourceRecord
+from .pglMarkers import pglMarkers, pglMarker, pglMarkerSink, pglMarkerSinkDigital, pglMarkerSinkPixelMode, pglMarkerSinkEyeTracker, pglMarkerSinkLog, pglEventMarker
 from .pglStimuli import pglStimuli
 from .pglTimestamp import pglTimestamp
+from .pglRealtime import pglRealtime, pglRealtimeThread
+from .pglTrace import pglTrace, pglTraceLog, traceLog, pglTraceDecode
 from .pglDevice import pglDevice, pglDevices, pglDigitalIODevice, pglAnalogTraceData
 from .pglKeyboardMouse import pglKeyboardMouse, pglEventKeyboard, pglKeyBuffer
 from .pglEvent import pglEvent, pglEvents
 from .pglCommandReplayer import pglCommandReplayer
 from .pglFrameGrab import pglFrameGrab
 from .pglExperiment import pglExperiment, pglTask, pglTestTask, pglExperimentAnalysis
-from .pglParameter import pglParameter, pglParameterBlock, pglParameterNestedBlock, pglParameterBatch
-from .pglStaircase import pglStaircase, pglStaircaseUpDown
+from .pglParameter import pglParameter, pglParameterBlock, pglParameterNestedBlock, pglParameterBatch, pglParameterSequence
+from .pglStaircase import pglStaircase, pglStaircaseUpDown, pglStaircasePsi
 from .pglTasks import pglFixationTaskLeftRight, pglBarTask
 from ._pglComm import pglSerial
 from .pglCalibration import pglDisplayCalibration, pglLuminanceCalibrationDeviceMinolta, pglDisplayLuminanceCalibrationData, pglLuminanceCalibrationDeviceDebug
@@ -27,9 +33,14 @@ from .pglDialog import pglTraitsDialog
 # Device specific imports (eye trackers, etc.)
 from .pglVPixx import pglProPixx, pglDataPixx
 from .pglTrackPixx import pglTrackPixx3
+from .pglCameraPreview import pglCameraPreview, pglCameraSourceFake
+from .pglAsync import pglAsync, pglAsyncStream
+from .pglRelay import pglRelay
+from .pglRefreshTracker import pglRefreshTracker
 from .pglLabJack import pglLabJack
 from .pglEyelink import pglEyelinkData
 from .pglVWFA import pglVWFATask
+from .pglSimulation import pglSimulatedDisplay, pglVirtualClock, pglSimulatedKeyboard, pglExperimentSimulator, pglResponsePolicy, pglObserverPolicy, pglScriptedPolicy
 
 try:
     import pylink
@@ -37,7 +48,7 @@ try:
 except ImportError:
     print("(pgl) Warning: pylink not found, pglEyelink class will not be available. Download with: pip install sr-research-pylink")
 
-class pgl(pglBase, pglResolution, pglDraw, pglTransform, pglProfile, pglBatch, pglImage, pglStimuli, pglTimestamp, pglDevices, pglEvents, pglCommandReplayer, pglFrameGrab, pglGammaTable, pglSettingsManager):
+class pgl(pglBase, pglResolution, pglDraw, pglColor, pglTransform, pglProfile, pglBatch, pglImage, pglStimuli, pglTimestamp, pglDevices, pglEvents, pglCommandReplayer, pglFrameGrab, pglGammaTable, pglSettingsManager, pglRealtime, pglTrace):
     """
     purpose: psychophysics and experiment library for Python.
     License: MIT License — see LICENSE file for details.
@@ -61,5 +72,11 @@ class pgl(pglBase, pglResolution, pglDraw, pglTransform, pglProfile, pglBatch, p
       pglCommandReplayer.__init__(self, *args, **kwargs)
       pglFrameGrab.__init__(self, *args, **kwargs)
       pglSettingsManager.__init__(self, *args, **kwargs)
+
+class pglSimulated(pglSimulatedDisplay, pgl):
+    """
+    pgl in simulated time, drawing to a stand-in renderer (see pglSimulation)
+    """
+
 __version__ = "1.0.0"
 __author__ = "JLG"
\ No newline at end of file
@@ -0,0 +1,25 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglClock.h
+//
+//  Monotonic clock shared by the native extensions. The platform
+//  backend is chosen at build time: _pglClockMac.c (mach_absolute_time,
+//  same timebase as Metal) or _pglClockLinux.c (clock_gettime).
+/////////////////////////////////////////////////////////////////////
+#ifndef _PGLCLOCK_H
+#define _PGLCLOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// current monotonic time in seconds. Safe to call from any thread.
+double pglClockGetSecs(void);
+
+// name of the clock backend (for benchmarks / diagnostics)
+const char* pglClockGetName(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,25 @@
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <time.h>
+#include "_pglClock.h"
+
+////////////////////////////////
+//   pglClockGetSecs function  //
+////////////////////////////////
+double pglClockGetSecs(void)
+{
+    // CLOCK_MONOTONIC is what evdev and most Linux graphics stacks
+    // timestamp with, so it is the closest analogue to mach_absolute_time
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+////////////////////////////////
+//   pglClockGetName function  //
+////////////////////////////////
+const char* pglClockGetName(void)
+{
+    return "clock_gettime(CLOCK_MONOTONIC)";
+}
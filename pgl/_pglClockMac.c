@@ -0,0 +1,45 @@
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <stdint.h>
+#include <pthread.h>
+#include <mach/mach_time.h>
+#include "_pglClock.h"
+
+//////////////////////
+// global variables //
+//////////////////////
+// The timebase is a property of the machine, so it is kept process-wide
+// and filled in exactly once (pthread_once makes this safe when the clock
+// is first read from several threads)
+static mach_timebase_info_data_t timebaseInfo = {0,0};
+static pthread_once_t timebaseOnce = PTHREAD_ONCE_INIT;
+
+/////////////////////////////
+//   initTimebase function  //
+/////////////////////////////
+static void initTimebase(void)
+{
+    mach_timebase_info(&timebaseInfo);
+}
+
+////////////////////////////////
+//   pglClockGetSecs function  //
+////////////////////////////////
+double pglClockGetSecs(void)
+{
+    // initialize timebase info once
+    pthread_once(&timebaseOnce, initTimebase);
+
+    uint64_t absTime = mach_absolute_time();
+    double nanoseconds = (double)absTime * timebaseInfo.numer / timebaseInfo.denom;
+    return nanoseconds / 1e9;
+}
+
+////////////////////////////////
+//   pglClockGetName function  //
+////////////////////////////////
+const char* pglClockGetName(void)
+{
+    return "mach_absolute_time";
+}
@@ -0,0 +1,150 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglColor.c
+//
+//  Python layer over the colour conversion in _pglColorCore.c. Takes
+//  colours as float32 or float64 numpy arrays of any shape whose last
+//  dimension is 3 or 4 (one colour, per-vertex colours, or the
+//  pixels of a texture) and returns float32 display values of the
+//  same shape, converting with the GIL released
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <Python.h>
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+#include "_pglColorCore.h"
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+static PyObject* transform(PyObject* self, PyObject* args, PyObject* kwargs);
+
+//////////////////////////
+//   helper functions   //
+//////////////////////////
+static PyArrayObject* toDoubleArray(PyObject* obj, const char* name, npy_intp size);
+
+///////////////////////////////
+//   Python Object Defs      //
+///////////////////////////////
+// Method table
+static PyMethodDef ColorMethods[] = {
+    {"transform", (PyCFunction)(void(*)(void))transform, METH_VARARGS | METH_KEYWORDS, "Convert colors (... x 3 or 4) to display values: lut(clamp(matrix * color + offset)), returns (values, number clamped)"},
+    {NULL, NULL, 0, NULL}
+};
+
+// Module exec function, run once for each interpreter that imports the module
+static int colorExec(PyObject* module)
+{
+  // Initialize NumPy C API
+  import_array1(-1);
+  return 0;
+}
+
+// Module slots (multi-phase init). numpy does not support running under
+// a per-interpreter GIL, so only shared-GIL subinterpreters are allowed
+static PyModuleDef_Slot ColorSlots[] = {
+    {Py_mod_exec, colorExec},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_MULTIPLE_INTERPRETERS_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
+// Module definition
+static struct PyModuleDef ColorModule = {
+    PyModuleDef_HEAD_INIT,
+    "_pglColor",
+    "Colour conversion to display values",
+    0,
+    ColorMethods,
+    ColorSlots
+};
+
+PyMODINIT_FUNC PyInit__pglColor(void) {
+    return PyModuleDef_Init(&ColorModule);
+}
+
+////////////////////////////
+//   transform function   //
+////////////////////////////
+static PyObject* transform(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    static char* keywords[] = {"colors", "matrix", "offset", "lut", "xyY", NULL};
+    PyObject *pyColors, *pyMatrix, *pyOffset, *pyLut = Py_None;
+    int xyY = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|Op", keywords, &pyColors, &pyMatrix, &pyOffset, &pyLut, &xyY)) return NULL;
+
+    // colors stay float32 if they are (textures), anything else is float64
+    int inType = (PyArray_Check(pyColors) && (PyArray_TYPE((PyArrayObject*)pyColors) == NPY_FLOAT32)) ? NPY_FLOAT32 : NPY_FLOAT64;
+    PyArrayObject *colors = (PyArrayObject*)PyArray_FROM_OTF(pyColors, inType, NPY_ARRAY_IN_ARRAY);
+    if (!colors) return NULL;
+    int nDims = PyArray_NDIM(colors);
+    int nChannels = (nDims > 0) ? (int)PyArray_DIM(colors, nDims - 1) : 0;
+    if ((nChannels != 3) && (nChannels != 4)) {
+        Py_DECREF(colors);
+        PyErr_SetString(PyExc_ValueError, "(_pglColor:transform) colors must have 3 or 4 channels in their last dimension");
+        return NULL;
+    }
+
+    PyArrayObject *matrix = toDoubleArray(pyMatrix, "matrix", 9);
+    PyArrayObject *offset = toDoubleArray(pyOffset, "offset", 3);
+    PyArrayObject *lut = NULL;
+    if (pyLut != Py_None) {
+        lut = (PyArrayObject*)PyArray_FROM_OTF(pyLut, NPY_FLOAT32, NPY_ARRAY_IN_ARRAY);
+        if (lut && (PyArray_SIZE(lut) < 2)) {
+            PyErr_SetString(PyExc_ValueError, "(_pglColor:transform) lut needs at least 2 entries");
+            Py_CLEAR(lut);
+        }
+    }
+    if (!matrix || !offset || ((pyLut != Py_None) && !lut)) {
+        Py_DECREF(colors); Py_XDECREF(matrix); Py_XDECREF(offset); Py_XDECREF(lut);
+        return NULL;
+    }
+
+    PyObject *values = PyArray_SimpleNew(nDims, PyArray_DIMS(colors), NPY_FLOAT32);
+    if (!values) {
+        Py_DECREF(colors); Py_DECREF(matrix); Py_DECREF(offset); Py_XDECREF(lut);
+        return NULL;
+    }
+
+    long n = (long)(PyArray_SIZE(colors) / nChannels);
+    const double *matrixData = (const double*)PyArray_DATA(matrix), *offsetData = (const double*)PyArray_DATA(offset);
+    const float *lutData = lut ? (const float*)PyArray_DATA(lut) : NULL;
+    int lutSize = lut ? (int)PyArray_SIZE(lut) : 0;
+    float *out = (float*)PyArray_DATA((PyArrayObject*)values);
+    long nClamped;
+    Py_BEGIN_ALLOW_THREADS
+    if (inType == NPY_FLOAT32)
+        nClamped = pglColorTransformFloat((const float*)PyArray_DATA(colors), n, nChannels, xyY, matrixData, offsetData, lutData, lutSize, out);
+    else
+        nClamped = pglColorTransformDouble((const double*)PyArray_DATA(colors), n, nChannels, xyY, matrixData, offsetData, lutData, lutSize, out);
+    Py_END_ALLOW_THREADS
+
+    Py_DECREF(colors); Py_DECREF(matrix); Py_DECREF(offset); Py_XDECREF(lut);
+    return Py_BuildValue("(Nl)", values, nClamped);
+}
+
+///////////////////////////////
+//   toDoubleArray function  //
+///////////////////////////////
+// Convert to a new contiguous float64 array of the given size (new reference)
+static PyArrayObject* toDoubleArray(PyObject* obj, const char* name, npy_intp size)
+{
+    PyArrayObject *array = (PyArrayObject*)PyArray_FROM_OTF(obj, NPY_FLOAT64, NPY_ARRAY_IN_ARRAY);
+    if (!array) {
+        PyErr_Format(PyExc_ValueError, "(_pglColor:transform) Failed to convert %s to float64", name);
+        return NULL;
+    }
+    if (PyArray_SIZE(array) != size) {
+        Py_DECREF(array);
+        PyErr_Format(PyExc_ValueError, "(_pglColor:transform) %s must have %ld elements", name, (long)size);
+        return NULL;
+    }
+    return array;
+}
@@ -0,0 +1,78 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglColorCore.c
+//
+//  Portable colour conversion (see _pglColorCore.h)
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <stddef.h>
+#include "_pglColorCore.h"
+
+///////////////////////////
+//   lookup              //
+///////////////////////////
+// clamp a linear value to [0,1] (counting it if it was outside) and
+// interpolate the inverse gamma table
+static inline float lookup(double value, const float* lut, int lutSize, long* nClamped)
+{
+  if (value < 0) {
+    value = 0;
+    (*nClamped)++;
+  }
+  else if (value > 1) {
+    value = 1;
+    (*nClamped)++;
+  }
+  if (lut == NULL) return (float)value;
+  double position = value * (lutSize - 1);
+  int i = (int)position;
+  if (i >= lutSize - 1) return lut[lutSize - 1];
+  double fraction = position - i;
+  return (float)(lut[i] + fraction * (lut[i + 1] - lut[i]));
+}
+
+///////////////////////////
+//   colorTransform      //
+///////////////////////////
+// the same loop for float and double input
+#define colorTransform(inType)                                                      \
+{                                                                                   \
+  long nClamped = 0;                                                                \
+  for (long i = 0; i < n; i++) {                                                    \
+    const inType* color = in + i * nChannels;                                       \
+    float* result = out + i * nChannels;                                            \
+    double c0 = color[0], c1 = color[1], c2 = color[2];                             \
+    if (xyY) {                                                                      \
+      /* x, y, Y to X, Y, Z (black where y is 0) */                                 \
+      double x = c0, y = c1, Y = c2;                                                \
+      c0 = (y != 0) ? x * Y / y : 0;                                                \
+      c1 = Y;                                                                       \
+      c2 = (y != 0) ? (1 - x - y) * Y / y : 0;                                      \
+    }                                                                               \
+    for (int row = 0; row < 3; row++) {                                             \
+      double value = matrix[3 * row] * c0 + matrix[3 * row + 1] * c1 +              \
+                     matrix[3 * row + 2] * c2 + offset[row];                        \
+      result[row] = lookup(value, lut, lutSize, &nClamped);                         \
+    }                                                                               \
+    if (nChannels == 4) result[3] = (float)color[3];                                \
+  }                                                                                 \
+  return nClamped;                                                                  \
+}
+
+/////////////////////////////////////
+//   pglColorTransformDouble       //
+/////////////////////////////////////
+long pglColorTransformDouble(const double* in, long n, int nChannels, int xyY,
+                             const double* matrix, const double* offset,
+                             const float* lut, int lutSize, float* out)
+colorTransform(double)
+
+/////////////////////////////////////
+//   pglColorTransformFloat        //
+/////////////////////////////////////
+long pglColorTransformFloat(const float* in, long n, int nChannels, int xyY,
+                            const double* matrix, const double* offset,
+                            const float* lut, int lutSize, float* out)
+colorTransform(float)
@@ -0,0 +1,42 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglColorCore.h
+//
+//  Portable colour conversion. A colour in any space pgl knows
+//  (linear RGB, luminance, contrast, XYZ, xyY, LMS, DKL) reaches
+//  display values in one pass: xyY is first taken to XYZ, then an
+//  affine transform (worked out from the display calibration, see
+//  pglColor.py) gives linear RGB, which is clamped to [0,1] and
+//  looked up in the inverse gamma table. Each colour is handled on
+//  its own, so the same code does one colour, the vertices of a
+//  primitive and the pixels of a texture. None of this depends on
+//  Python so it can be built and benchmarked anywhere.
+/////////////////////////////////////////////////////////////////////
+#ifndef _PGLCOLORCORE_H
+#define _PGLCOLORCORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+// Convert n colors of nChannels (3, or 4 with an alpha that is copied
+// as is) from in to out. When xyY is set the first three channels are
+// x, y, Y. matrix is 3 x 3 (row major) and offset 3, so that linear
+// RGB = matrix * color + offset. lut holds lutSize display values for
+// linear values spaced evenly over [0,1] and is interpolated (NULL
+// leaves linear values as they are). Returns the number of channels
+// that were out of [0,1] and clamped
+long pglColorTransformDouble(const double* in, long n, int nChannels, int xyY,
+                             const double* matrix, const double* offset,
+                             const float* lut, int lutSize, float* out);
+long pglColorTransformFloat(const float* in, long n, int nChannels, int xyY,
+                            const double* matrix, const double* offset,
+                            const float* lut, int lutSize, float* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -4,16 +4,63 @@
 #            pgl psychophysics and experiment library
 ################################################################
 import sys, time, struct, subprocess, os, re
-from socket import socket, AF_UNIX, SOCK_STREAM
+from socket import socket, AF_UNIX, AF_INET, SOCK_STREAM, IPPROTO_TCP, TCP_NODELAY
 import numpy as np
 import time
+from . import _pglTimestamp
+from .pglTrace import traceLog
 
 
+# layout of the results that mglMetal sends after each command: the ack,
+# then commandCode, success and seven timestamps (packed, 70 bytes)
+commandResultsFields = [('commandCode', np.uint16), ('success', np.uint32), ('processedTime', np.double),
+                        ('vertexStart', np.double), ('vertexEnd', np.double), ('fragmentStart', np.double),
+                        ('fragmentEnd', np.double), ('drawableAcquired', np.double), ('drawablePresented', np.double)]
+commandResultsDtype = np.dtype([('ack', np.double)] + commandResultsFields)
+
+# sent by a remote client to start the clock offset handshake with pglRelay
+clockSyncMagic = b'PGLC'
+
+# trace log events (see pglTrace)
+traceWriteCommand = traceLog.define("_pglComm:writeCommand", "{command}", ("command:s",))
+traceWrite = traceLog.define("_pglComm:write", "{nBytes} bytes", ("nBytes",))
+traceCommandResults = traceLog.define("_pglComm:readCommandResults", "{command} success {success} processed {processedTime:.6f}", ("command:s", "success", "processedTime"))
+traceDeferredResults = traceLog.define("_pglComm:readDeferredResults", "{nResults} results, {nFailed} failed", ("nResults", "nFailed"))
+
 class _pglComm:
     # init variables
     s = None
     socketName = None
     verbose = 1
+    # how much of the results of drawing commands to read:
+    # "full" reads every command's results as it is sent (as it always has),
+    # "flushOnly" leaves the results of drawing commands unread and reads them
+    # all in one go with the next command that needs an answer (reporting only
+    # failures), "summary" does the same and adds a per frame summary
+    # (frameSummary) to the results of mglFlush.
+    resultDetailModes = ("full", "flushOnly", "summary")
+    resultDetail = "full"
+    # commands whose results can be left unread (no command specific response)
+    deferrableCommands = ("mglSetClearColor", "mglSetXform", "mglDots", "mglLine", "mglQuad", "mglPolygon", "mglBltTexture")
+    # most results left unread at once, so that mglMetal never blocks writing
+    # results that we are not reading while we block writing to it
+    maxDeferredResults = 64
+    lastCommandName = None
+    nDeferredResults = 0
+    frameSummary = None
+    _readingDeferred = False
+    # remote connections ("tcp://host:port", through a pglRelay on the
+    # stimulus machine): clockOffset is the remote clock minus ours, and
+    # timestamps in command results are converted to our clock
+    isRemote = False
+    clockOffset = 0.0
+    roundTripTime = 0.0
+    nClockProbes = 16
+    # coalesce writes into one send per read (i.e. one per round trip),
+    # which matters over a network where each send is a packet
+    coalesce = False
+    maxCoalesceBytes = 65536
+    _sendBuffer = None
 
     # Init Function
     def __init__(self, socketName, pgl=None, timeout=10):
@@ -24,13 +71,27 @@ class _pglComm:
         startTime = time.time()
         attempt = 0
 
+        # tcp://host:port connects to a pglRelay on another machine
+        address = socketName
+        if socketName.startswith("tcp://"):
+            host, port = socketName[len("tcp://"):].rsplit(":", 1)
+            address = (host, int(port))
+            self.isRemote = True
+
         # display what we are doing
         sys.stdout.write("(pgl:_pglComm) ")
         sys.stdout.flush()
         while True:
             try:
-                self.s = socket(AF_UNIX, SOCK_STREAM)
-                self.s.connect(socketName)
+                if self.isRemote:
+                    self.s = socket(AF_INET, SOCK_STREAM)
+                    # small commands go out as soon as they are written
+                    self.s.setsockopt(IPPROTO_TCP, TCP_NODELAY, 1)
+                    self.s.connect(address)
+                    self.syncClock()
+                else:
+                    self.s = socket(AF_UNIX, SOCK_STREAM)
+                    self.s.connect(address)
                 self.socketName = socketName
                 print("Connected to:", socketName)
                 return
@@ -52,10 +113,64 @@ class _pglComm:
         """
         return self.s is not None
 
+    ################################################################
+    # syncClock
+    ################################################################
+    def syncClock(self):
+        """
+        Clock offset handshake with a pglRelay (done when connecting over tcp,
+        before any commands). Sends nClockProbes of our time, the relay answers
+        each with its time, and the offset is taken from the probe with the
+        shortest round trip (assuming the trip each way takes half of it).
+
+        Returns:
+            float: The remote clock minus ours, in seconds.
+        """
+        self.s.sendall(clockSyncMagic + struct.pack('@I', self.nClockProbes))
+        probes = []
+        for iProbe in range(self.nClockProbes):
+            sendTime = _pglTimestamp.getSecs()
+            self.s.sendall(struct.pack('@d', sendTime))
+            remoteTime = struct.unpack('@d', self.recvBlocking(8))[0]
+            receiveTime = _pglTimestamp.getSecs()
+            probes.append((receiveTime - sendTime, remoteTime - (sendTime + receiveTime) / 2))
+        roundTripTime, clockOffset = min(probes)
+        self.roundTripTime = roundTripTime
+        self.clockOffset = clockOffset
+        if self.verbose > 0: print(f"(pgl:_pglComm:syncClock) Clock offset {1000*clockOffset:.3f} ms (round trip {1000*roundTripTime:.3f} ms) ", end="")
+        return clockOffset
+
+    def toLocalTime(self, remoteTime):
+        """
+        Convert a time from the stimulus machine's clock to ours (0 stays 0, as
+        it marks a timestamp that was not set).
+        """
+        if not self.isRemote or remoteTime is None: return remoteTime
+        return np.where(remoteTime != 0, remoteTime - self.clockOffset, remoteTime)
+
+    def sendBuffered(self):
+        """
+        Send what coalesce has been holding back.
+        """
+        if self._sendBuffer:
+            self.s.sendall(self._sendBuffer)
+            self._sendBuffer = bytearray()
+
     def close(self):
         """
           Close the socket connection. 
         """
+        if self.isRemote:
+            # the relay on the other end looks after mglMetal
+            try:
+                self.sendBuffered()
+                self.s.close()
+                print("(pgl:_pglComm) Closed connection:", self.socketName)
+            except Exception as e:
+                print("(pgl:_pglComm) ❌ Error closing connection:", e)
+            finally:
+                self.s = None
+            return
         if os.path.exists(self.socketName):
             try:
                 os.remove(self.socketName)
@@ -105,11 +220,16 @@ class _pglComm:
             raise TypeError("Unsupported data type")
 
         try:
-            if self.verbose>=3:print(f"(pgl:_pglComm) Sending message with length {len(packed)} bytes")
+            if traceLog.on: traceLog.record(traceWrite, len(packed))
              # if we are logging commands for replay, log the command values
             if self.pgl.commandRecording: self.pgl.logCommandData(packed)
-            # send the packed data
-            self.s.sendall(packed)
+            # send the packed data (or hold it until the next read)
+            if self.coalesce:
+                if self._sendBuffer is None: self._sendBuffer = bytearray()
+                self._sendBuffer.extend(packed)
+                if len(self._sendBuffer) >= self.maxCoalesceBytes: self.sendBuffered()
+            else:
+                self.s.sendall(packed)
             if self.verbose > 1: print("(pgl:_pglComm) Message sent:", message)
         except Exception as e:
             print("(pgl:_pglComm) ❌ Error sending message:", e)
@@ -138,8 +258,11 @@ class _pglComm:
         if self.verbose>1:
             print(f"(pgl:_pglComm) Sending command: {commandName} (value: {commandValue})")
 
+        if traceLog.on: traceLog.record(traceWriteCommand, traceLog.string(commandName))
+
         # if we are logging commands for replay, log the command
         if self.pgl.commandRecording: self.pgl.logCommandValue(commandValue)
+        self.lastCommandName = commandName
 
         # write the command value to the socket
         self.write(commandValue)
@@ -159,6 +282,9 @@ class _pglComm:
             print("(pgl:_pglComm) ❌ Not connected to socket")
             return False
         
+        self.lastCommandName = None
+        # commands coalesce is holding back were sent before this one
+        if self._sendBuffer: self.sendBuffered()
         for chunk in commandData: self.s.sendall(chunk)
  
         # read the command results
@@ -313,6 +439,11 @@ class _pglComm:
         '''
         Receive exactly numBytes from the socket. Will block until all bytes are received.
         '''
+        # anything held back has to go out before we wait for an answer
+        if self._sendBuffer: self.sendBuffered()
+        # results left unread come first
+        if self.nDeferredResults > 0 and not self._readingDeferred: self.readDeferredResults()
+
         bytesReceived = 0
         packed = bytearray()  # Use a bytearray to collect the bytes
 
@@ -341,7 +472,7 @@ class _pglComm:
             if ack is None:
                 print("(pgl:_pglComm:readAck) ❌ Error reading acknowledgment")
                 return None
-            return ack
+            return self.toLocalTime(ack)
         except Exception as e:
             print("(pgl:_pglComm:readAck) ❌ Error reading acknowledgment:", e)
             return None
@@ -356,23 +487,35 @@ class _pglComm:
             print("(pgl:_pglComm:readCommandResults) ❌ Not connected to socket")
             return None
         
+        # drawing commands can leave their results to be read later
+        if ack is None and nCommands == 1 and self.deferResults():
+            self.nDeferredResults += 1
+            if self.nDeferredResults >= self.maxDeferredResults: self.readDeferredResults()
+            return None
+
         try:
             commandResults = {}
-            # Read ack if not passed in
+            # Read ack if not passed in (an ack that was passed in was read
+            # with readAck and is already in our clock)
             if ack is None:
-                commandResults['ack'] = self.read(np.double)
+                commandResults['ack'] = self.toLocalTime(self.read(np.double))
             else:
                 commandResults['ack'] = ack
-            # Read the rest of the command results
-            commandResults['commandCode'] = self.read(np.uint16, nCommands)
-            commandResults['success'] = self.read(np.uint32, nCommands)
-            commandResults['processedTime'] = self.read(np.double, nCommands)
-            commandResults['vertexStart'] = self.read(np.double, nCommands)
-            commandResults['vertexEnd'] = self.read(np.double, nCommands)
-            commandResults['fragmentStart'] = self.read(np.double, nCommands)
-            commandResults['fragmentEnd'] = self.read(np.double, nCommands)
-            commandResults['drawableAcquired'] = self.read(np.double, nCommands)
-            commandResults['drawablePresented'] = self.read(np.double, nCommands)
+            # Read the rest of the command results in one go (each field
+            # is nCommands long) and split it up
+            fieldLengths = [np.dtype(dataType).itemsize * nCommands for _, dataType in commandResultsFields]
+            packed = self.recvBlocking(sum(fieldLengths))
+            offset = 0
+            for (name, dataType), fieldLength in zip(commandResultsFields, fieldLengths):
+                commandResults[name] = np.squeeze(np.frombuffer(packed, dtype=dataType, count=nCommands, offset=offset))
+                if dataType == np.double: commandResults[name] = self.toLocalTime(commandResults[name])
+                offset += fieldLength
+            # summary of the frame's drawing commands goes with the flush
+            if self.lastCommandName == "mglFlush" and self.resultDetail == "summary":
+                commandResults['frameSummary'] = self.frameSummary if self.frameSummary is not None else {'nCommands': 0, 'nFailed': 0}
+                self.frameSummary = None
+            if traceLog.on and nCommands == 1:
+                traceLog.record(traceCommandResults, traceLog.string(str(self.lastCommandName)), commandResults['success'], commandResults['processedTime'])
             return(commandResults)
         
         except Exception as e:
@@ -381,6 +524,46 @@ class _pglComm:
 
 
 
+    def deferResults(self):
+        '''
+        Whether the results of the last command can be left unread.
+        '''
+        if self.resultDetail == "full" or self.lastCommandName not in self.deferrableCommands: return False
+        # profiling in detail and batches need every result as it comes
+        if self.pgl is not None and (getattr(self.pgl, '_profileMode', 0) >= 2 or getattr(self.pgl, '_batchState', 0) != 0): return False
+        return True
+
+    def readDeferredResults(self):
+        '''
+        Read the results that drawing commands left unread (all in one
+        go), report any that failed and, in "summary" mode, add them to
+        frameSummary.
+
+        Returns:
+            int: Number of commands that failed.
+        '''
+        nResults = self.nDeferredResults
+        if nResults == 0: return 0
+        self.nDeferredResults = 0
+        self._readingDeferred = True
+        try:
+            results = np.frombuffer(self.recvBlocking(nResults * commandResultsDtype.itemsize), dtype=commandResultsDtype)
+        finally:
+            self._readingDeferred = False
+        failed = results['success'] == 0
+        nFailed = int(np.count_nonzero(failed))
+        if traceLog.on: traceLog.record(traceDeferredResults, nResults, nFailed)
+        if nFailed > 0:
+            failedNames = [str(self.getCommandName(np.uint16(code))) for code in results['commandCode'][failed]]
+            print(f"(pgl:_pglComm:readDeferredResults) ❌ {nFailed} command(s) failed: {', '.join(failedNames)}")
+        if self.resultDetail == "summary":
+            if self.frameSummary is None:
+                self.frameSummary = {'nCommands': 0, 'nFailed': 0, 'firstProcessedTime': float(self.toLocalTime(results['processedTime'][0])), 'lastProcessedTime': 0.0}
+            self.frameSummary['nCommands'] += nResults
+            self.frameSummary['nFailed'] += nFailed
+            self.frameSummary['lastProcessedTime'] = float(self.toLocalTime(results['processedTime'][-1]))
+        return nFailed
+
     def parseCommandValues(self, filename="mglCommandTypes.h"):
         """
         Parse the command values from the mglCommandTypes.h file.
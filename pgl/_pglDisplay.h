@@ -0,0 +1,75 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglDisplay.h
+//
+//  Display modes and gamma tables, used by _resolution and
+//  _pglGammaTable. The mode matching logic (_pglDisplayCore.c) is
+//  portable, the platform backend is chosen at build time:
+//  _pglDisplayMac.m (CoreGraphics) or _pglDisplayMock.c (a mock
+//  display with in-memory modes and gamma tables, used on Linux and
+//  by the native benchmarks).
+/////////////////////////////////////////////////////////////////////
+#ifndef _PGLDISPLAY_H
+#define _PGLDISPLAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+////////////////////////
+//   define section   //
+////////////////////////
+#define PGL_MAX_DISPLAYS 16
+#define PGL_MAX_DISPLAY_MODES 512
+
+//////////////////////
+//   display mode   //
+//////////////////////
+typedef struct {
+    int width;
+    int height;
+    int frameRate;      // 0 if the display does not report one
+    int bitDepth;
+    char encoding[64];
+} pglDisplayMode;
+
+//////////////////////////
+//   backend functions  //
+//////////////////////////
+// number of displays, or -1 if they could not be listed
+int pglDisplayGetCount(void);
+// current mode of a display. Returns 0 on success
+int pglDisplayGetCurrentMode(int displayNumber, pglDisplayMode* mode);
+// fill modes with up to maxModes available modes, returns the number
+// filled in or -1 on error
+int pglDisplayGetModes(int displayNumber, pglDisplayMode* modes, int maxModes);
+// switch to the modeIndex'th mode returned by pglDisplayGetModes.
+// Returns 0 on success
+int pglDisplaySetModeByIndex(int displayNumber, int modeIndex);
+// gamma table capacity, or -1 on error
+int pglDisplayGetGammaTableSize(int displayNumber);
+// read the gamma table into red/green/blue (each maxEntries long),
+// returns number of entries or -1 on error
+int pglDisplayGetGammaTable(int displayNumber, float* red, float* green, float* blue, int maxEntries);
+// set the gamma table, returns 0 on success or the backend error code
+int pglDisplaySetGammaTable(int displayNumber, const float* red, const float* green, const float* blue, int numEntries);
+// name of the backend (for diagnostics)
+const char* pglDisplayGetBackendName(void);
+
+///////////////////////
+//   core functions  //
+///////////////////////
+// Find the mode closest to the request: first closest width/height,
+// then closest bit depth among those, then closest frame rate. Modes
+// with no frame rate count as 60Hz. Returns the index of the chosen
+// mode (and copies it into best if not NULL), or -1 if numModes is 0
+int pglDisplayFindBestMode(const pglDisplayMode* modes, int numModes,
+                           int width, int height, int frameRate, int bitDepth,
+                           pglDisplayMode* best);
+// print the available modes of a display
+void pglDisplayPrintModes(int displayNumber);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,103 @@
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include <math.h>
+#include "_pglDisplay.h"
+
+///////////////////////////////////////
+//   pglDisplayFindBestMode function //
+///////////////////////////////////////
+int pglDisplayFindBestMode(const pglDisplayMode* modes, int numModes,
+                           int width, int height, int frameRate, int bitDepth,
+                           pglDisplayMode* best)
+{
+  int index, bestIndex = -1;
+  int bestWidth = 0, bestHeight = 0, bestBitDepth = 0, bestFrameRate = 0, thisFrameRate;
+  double minDifference, thisDifference;
+
+  if (numModes <= 0) return -1;
+
+  // check for closest match in width, height
+  minDifference = DBL_MAX;
+  for (index = 0; index < numModes; index++) {
+    // check how close the pixel match is
+    thisDifference = pow((double)modes[index].width-(double)width,2)+pow((double)modes[index].height-(double)height,2);
+    if (thisDifference<minDifference) {
+      bestWidth = modes[index].width;
+      bestHeight = modes[index].height;
+      minDifference = thisDifference;
+    }
+  }
+
+  // now that we found the mode with the closest width/height match
+  // check for best match in number of bits
+  minDifference = DBL_MAX;
+  for (index = 0; index < numModes; index++) {
+    // check that the width/height are matched to the best
+    if ((bestWidth == modes[index].width) && (bestHeight == modes[index].height)) {
+      if (fabs((double)bitDepth-(double)modes[index].bitDepth) < minDifference) {
+        minDifference = fabs((double)bitDepth-(double)modes[index].bitDepth);
+        bestBitDepth = modes[index].bitDepth;
+      }
+    }
+  }
+
+  // now that we found the mode with the closest width/height match
+  // and the best number of bits, choose the best refresh rate
+  minDifference = DBL_MAX;
+  for (index = 0; index < numModes; index++) {
+    // check that the width/height and bitDepth are matched to the best
+    if ((bestWidth == modes[index].width) && (bestHeight == modes[index].height) && (bestBitDepth == modes[index].bitDepth)) {
+      thisFrameRate = modes[index].frameRate;
+      if (thisFrameRate == 0) thisFrameRate = 60;
+      if (fabs((double)frameRate-(double)thisFrameRate) < minDifference) {
+        minDifference = fabs((double)frameRate-(double)thisFrameRate);
+        bestFrameRate = thisFrameRate;
+      }
+    }
+  }
+
+  // now find the first mode that matches all of the best settings
+  for (index = 0; index < numModes; index++) {
+    thisFrameRate = modes[index].frameRate;
+    if (thisFrameRate == 0) thisFrameRate = bestFrameRate;
+    if ((bestWidth == modes[index].width) && (bestHeight == modes[index].height) && (bestBitDepth == modes[index].bitDepth) && (bestFrameRate == thisFrameRate)) {
+      bestIndex = index;
+      break;
+    }
+  }
+
+  // copy out the best mode, with the frameRate that was matched
+  if ((bestIndex >= 0) && (best != NULL)) {
+    *best = modes[bestIndex];
+    best->frameRate = bestFrameRate;
+  }
+  return bestIndex;
+}
+
+/////////////////////////////////////
+//   pglDisplayPrintModes function //
+/////////////////////////////////////
+void pglDisplayPrintModes(int displayNumber)
+{
+  pglDisplayMode* modes = (pglDisplayMode*)malloc(sizeof(pglDisplayMode) * PGL_MAX_DISPLAY_MODES);
+  if (modes == NULL) return;
+
+  printf("(pgl:_resolution:printDisplayModes) Available video modes for display %i\n", displayNumber);
+
+  // cycle through each available mode
+  int count = pglDisplayGetModes(displayNumber, modes, PGL_MAX_DISPLAY_MODES);
+  for (int index = 0; index < count; index++) {
+    printf("%2d: %4dx%4d %3dHz %2d bits\t%s\n",
+       index,
+       modes[index].width,
+       modes[index].height,
+       modes[index].frameRate,
+       modes[index].bitDepth,
+       modes[index].encoding);
+  }
+  free(modes);
+}
@@ -0,0 +1,225 @@
+/////////////////////////
+//   include section   //
+/////////////////////////
+#import <Cocoa/Cocoa.h>
+#import <CoreGraphics/CoreGraphics.h>
+#include "_pglDisplay.h"
+
+//////////////////////////
+//   helper functions   //
+//////////////////////////
+static CGDirectDisplayID getDisplayID(int displayNumber);
+static int getBitDepth(CGDisplayModeRef displayMode);
+static void getModeInfo(CGDisplayModeRef displayMode, pglDisplayMode* mode);
+
+/////////////////////////////////////////
+//   pglDisplayGetBackendName function //
+/////////////////////////////////////////
+const char* pglDisplayGetBackendName(void)
+{
+  return "macos-coregraphics";
+}
+
+///////////////////////////////////
+//   pglDisplayGetCount function //
+///////////////////////////////////
+int pglDisplayGetCount(void)
+{
+  // start auto release pool
+  NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+  int numDisplays = (int)[[NSScreen screens] count];
+  [pool release];
+  return numDisplays;
+}
+
+/////////////////////////////////////////
+//   pglDisplayGetCurrentMode function //
+/////////////////////////////////////////
+int pglDisplayGetCurrentMode(int displayNumber, pglDisplayMode* mode)
+{
+  // start auto release pool
+  NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+
+  // get all screen array
+  NSArray *screens = [NSScreen screens];
+
+  // checkfor valid displayNumber
+  if (displayNumber < 0 || displayNumber >= [screens count]) {
+    [pool release];
+    return -1;
+  }
+
+  // get the display
+  CGDirectDisplayID whichDisplay = getDisplayID(displayNumber);
+  if (whichDisplay == kCGNullDirectDisplay) {
+    [pool release];
+    return -1;
+  }
+
+  // get bit depth, frame rate and encoding from the display settings
+  CGDisplayModeRef displayMode = CGDisplayCopyDisplayMode(whichDisplay);
+  getModeInfo(displayMode, mode);
+  CGDisplayModeRelease(displayMode);
+
+  // get the display size from the screen description (this is what
+  // the display reports as its size, rather than the backing mode size)
+  NSScreen *thisDisplay = [screens objectAtIndex:(displayNumber)];
+  NSDictionary *thisDisplayDescription = [thisDisplay deviceDescription];
+  NSSize thisDisplaySize = [[thisDisplayDescription objectForKey:@"NSDeviceSize"] sizeValue];
+  mode->width = thisDisplaySize.width;
+  mode->height = thisDisplaySize.height;
+
+  // release the autorelease pool
+  [pool release];
+  return 0;
+}
+
+///////////////////////////////////
+//   pglDisplayGetModes function //
+///////////////////////////////////
+int pglDisplayGetModes(int displayNumber, pglDisplayMode* modes, int maxModes)
+{
+  CGDirectDisplayID whichDisplay = getDisplayID(displayNumber);
+  if (whichDisplay == kCGNullDirectDisplay) return -1;
+
+  // get all available display modes
+  CFArrayRef modeList = CGDisplayCopyAllDisplayModes(whichDisplay, NULL);
+  if (modeList == NULL) return -1;
+  int count = (int)CFArrayGetCount(modeList);
+  if (count > maxModes) count = maxModes;
+
+  // cycle through each available mode
+  for (int index = 0; index < count; index++) {
+    getModeInfo((CGDisplayModeRef)CFArrayGetValueAtIndex(modeList, index), &modes[index]);
+  }
+  CFRelease(modeList);
+  return count;
+}
+
+/////////////////////////////////////////
+//   pglDisplaySetModeByIndex function //
+/////////////////////////////////////////
+int pglDisplaySetModeByIndex(int displayNumber, int modeIndex)
+{
+  CGDirectDisplayID whichDisplay = getDisplayID(displayNumber);
+  if (whichDisplay == kCGNullDirectDisplay) return -1;
+
+  // get all available display modes (same order as pglDisplayGetModes)
+  CFArrayRef modeList = CGDisplayCopyAllDisplayModes(whichDisplay, NULL);
+  if (modeList == NULL) return -1;
+  if ((modeIndex < 0) || (modeIndex >= CFArrayGetCount(modeList))) {
+    CFRelease(modeList);
+    return -1;
+  }
+  CGDisplayModeRef mode = (CGDisplayModeRef)CFArrayGetValueAtIndex(modeList, modeIndex);
+
+  // capture the appropriate display
+  CGDisplayCapture(whichDisplay);
+  // set the video mode
+  CGError err = CGDisplaySetDisplayMode(whichDisplay,mode,NULL);
+  // release the appropriate display
+  CGDisplayRelease(whichDisplay);
+
+  // release the mode list
+  CFRelease(modeList);
+  return (err == kCGErrorSuccess) ? 0 : (int)err;
+}
+
+////////////////////////////////////////////
+//   pglDisplayGetGammaTableSize function //
+////////////////////////////////////////////
+int pglDisplayGetGammaTableSize(int displayNumber)
+{
+  CGDirectDisplayID whichDisplay = getDisplayID(displayNumber);
+  if (whichDisplay == kCGNullDirectDisplay) return -1;
+  return (int)CGDisplayGammaTableCapacity(whichDisplay);
+}
+
+////////////////////////////////////////
+//   pglDisplayGetGammaTable function //
+////////////////////////////////////////
+int pglDisplayGetGammaTable(int displayNumber, float* red, float* green, float* blue, int maxEntries)
+{
+  CGDirectDisplayID whichDisplay = getDisplayID(displayNumber);
+  if (whichDisplay == kCGNullDirectDisplay) return -1;
+
+  uint32_t sampleCount = 0;
+  CGError err = CGGetDisplayTransferByTable(whichDisplay, (uint32_t)maxEntries, red, green, blue, &sampleCount);
+  if (err != kCGErrorSuccess) return -1;
+  return (int)sampleCount;
+}
+
+////////////////////////////////////////
+//   pglDisplaySetGammaTable function //
+////////////////////////////////////////
+int pglDisplaySetGammaTable(int displayNumber, const float* red, const float* green, const float* blue, int numEntries)
+{
+  CGDirectDisplayID whichDisplay = getDisplayID(displayNumber);
+  if (whichDisplay == kCGNullDirectDisplay) return -1;
+
+  // Apply the gamma table
+  CGError err = CGSetDisplayTransferByTable(whichDisplay, (uint32_t)numEntries, red, green, blue);
+  return (err == kCGErrorSuccess) ? 0 : (int)err;
+}
+
+//////////////////////////////
+//   getDisplayID function  //
+//////////////////////////////
+static CGDirectDisplayID getDisplayID(int displayNumber)
+{
+  // Get list of active displays
+  CGDirectDisplayID displays[PGL_MAX_DISPLAYS];
+  uint32_t numDisplays = 0;
+
+  CGError err = CGGetActiveDisplayList(PGL_MAX_DISPLAYS, displays, &numDisplays);
+  if (err != kCGErrorSuccess || numDisplays == 0) return kCGNullDirectDisplay;
+
+  // Select which display
+  if ((displayNumber < 0) || (displayNumber >= (int)numDisplays)) return kCGNullDirectDisplay;
+  return displays[displayNumber];
+}
+
+/////////////////////
+//   getBitDepth   //
+/////////////////////
+static int getBitDepth(CGDisplayModeRef displayMode)
+{
+  int bitDepth = 0;
+  // This call is deprecated, but there does not seem to be a good replacement yet (7/8/2025)
+  // get bit depth
+  CFStringRef pixelEncoding;
+  pixelEncoding = CGDisplayModeCopyPixelEncoding(displayMode);
+  // return an appropriate bit depth for each one of these strings
+  // defined in IOGraphicsTypes.h
+  if (CFStringCompare(pixelEncoding,CFSTR(IO32BitDirectPixels),0)==kCFCompareEqualTo)
+    bitDepth = 32;
+  else if (CFStringCompare(pixelEncoding,CFSTR(IO16BitDirectPixels),0)==kCFCompareEqualTo)
+    bitDepth = 16;
+  else if (CFStringCompare(pixelEncoding,CFSTR(IO8BitIndexedPixels),0)==kCFCompareEqualTo)
+    bitDepth = 8;
+  else if (CFStringCompare(pixelEncoding,CFSTR(kIO30BitDirectPixels),0)==kCFCompareEqualTo)
+    bitDepth = 30;
+  else if (CFStringCompare(pixelEncoding,CFSTR(kIO64BitDirectPixels),0)==kCFCompareEqualTo)
+    bitDepth = 64;
+  // release the pixel encoding
+  CFRelease(pixelEncoding);
+  return(bitDepth);
+}
+
+/////////////////////
+//   getModeInfo   //
+/////////////////////
+static void getModeInfo(CGDisplayModeRef displayMode, pglDisplayMode* mode)
+{
+  mode->width = (int)CGDisplayModeGetWidth(displayMode);
+  mode->height = (int)CGDisplayModeGetHeight(displayMode);
+  mode->frameRate = (int)CGDisplayModeGetRefreshRate(displayMode);
+  mode->bitDepth = getBitDepth(displayMode);
+
+  // get pixel encoding string
+  CFStringRef pixelEncoding = CGDisplayModeCopyPixelEncoding(displayMode);
+  if (!CFStringGetCString(pixelEncoding, mode->encoding, sizeof(mode->encoding), kCFStringEncodingUTF8)) {
+    strcpy(mode->encoding, "Unknown");
+  }
+  CFRelease(pixelEncoding);
+}
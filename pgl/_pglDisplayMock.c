@@ -0,0 +1,171 @@
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "_pglDisplay.h"
+
+////////////////////////
+//   define section   //
+////////////////////////
+// The mock display stands in for real hardware so that the resolution
+// and gamma code paths can run on machines without a display server
+#define kMockNumDisplays 2
+#define kMockGammaTableSize 1024
+
+//////////////////////
+// global variables //
+//////////////////////
+static const pglDisplayMode mockModes[] = {
+  {1280,  720,  60, 32, "PPPPPPPP-RRRRRRRR-GGGGGGGG-BBBBBBBB"},
+  {1920, 1080,  60, 32, "PPPPPPPP-RRRRRRRR-GGGGGGGG-BBBBBBBB"},
+  {1920, 1080, 120, 32, "PPPPPPPP-RRRRRRRR-GGGGGGGG-BBBBBBBB"},
+  {1920, 1080,  60, 30, "--RRRRRRRRRR-GGGGGGGGGG-BBBBBBBBBB"},
+  {2560, 1440,  60, 32, "PPPPPPPP-RRRRRRRR-GGGGGGGG-BBBBBBBB"},
+  {2560, 1440, 144, 32, "PPPPPPPP-RRRRRRRR-GGGGGGGG-BBBBBBBB"},
+  {3840, 2160,  60, 32, "PPPPPPPP-RRRRRRRR-GGGGGGGG-BBBBBBBB"},
+  {3840, 2160,   0, 30, "--RRRRRRRRRR-GGGGGGGGGG-BBBBBBBBBB"},
+};
+#define kMockNumModes ((int)(sizeof(mockModes)/sizeof(mockModes[0])))
+
+// per display state, guarded by mockMutex
+static pthread_mutex_t mockMutex = PTHREAD_MUTEX_INITIALIZER;
+static int mockInitialized = 0;
+static int currentModeIndex[kMockNumDisplays];
+static float gammaTable[kMockNumDisplays][3][kMockGammaTableSize];
+
+///////////////////////////////////
+//   initMockDisplays function   //
+///////////////////////////////////
+// call with mockMutex held
+static void initMockDisplays(void)
+{
+  if (mockInitialized) return;
+  for (int displayNumber = 0; displayNumber < kMockNumDisplays; displayNumber++) {
+    // 1920x1080 60Hz 32 bits, identity gamma
+    currentModeIndex[displayNumber] = 1;
+    for (int channel = 0; channel < 3; channel++)
+      for (int i = 0; i < kMockGammaTableSize; i++)
+        gammaTable[displayNumber][channel][i] = (float)i / (float)(kMockGammaTableSize - 1);
+  }
+  mockInitialized = 1;
+}
+
+/////////////////////////////////
+//   validDisplay function     //
+/////////////////////////////////
+static int validDisplay(int displayNumber)
+{
+  return (displayNumber >= 0) && (displayNumber < kMockNumDisplays);
+}
+
+/////////////////////////////////////////
+//   pglDisplayGetBackendName function //
+/////////////////////////////////////////
+const char* pglDisplayGetBackendName(void)
+{
+  return "linux-mock";
+}
+
+///////////////////////////////////
+//   pglDisplayGetCount function //
+///////////////////////////////////
+int pglDisplayGetCount(void)
+{
+  return kMockNumDisplays;
+}
+
+/////////////////////////////////////////
+//   pglDisplayGetCurrentMode function //
+/////////////////////////////////////////
+int pglDisplayGetCurrentMode(int displayNumber, pglDisplayMode* mode)
+{
+  if (!validDisplay(displayNumber)) return -1;
+  pthread_mutex_lock(&mockMutex);
+  initMockDisplays();
+  *mode = mockModes[currentModeIndex[displayNumber]];
+  pthread_mutex_unlock(&mockMutex);
+  return 0;
+}
+
+///////////////////////////////////
+//   pglDisplayGetModes function //
+///////////////////////////////////
+int pglDisplayGetModes(int displayNumber, pglDisplayMode* modes, int maxModes)
+{
+  if (!validDisplay(displayNumber)) return -1;
+  int count = (kMockNumModes < maxModes) ? kMockNumModes : maxModes;
+  memcpy(modes, mockModes, count * sizeof(pglDisplayMode));
+  return count;
+}
+
+/////////////////////////////////////////
+//   pglDisplaySetModeByIndex function //
+/////////////////////////////////////////
+int pglDisplaySetModeByIndex(int displayNumber, int modeIndex)
+{
+  if (!validDisplay(displayNumber) || (modeIndex < 0) || (modeIndex >= kMockNumModes)) return -1;
+  pthread_mutex_lock(&mockMutex);
+  initMockDisplays();
+  currentModeIndex[displayNumber] = modeIndex;
+  pthread_mutex_unlock(&mockMutex);
+  return 0;
+}
+
+////////////////////////////////////////////
+//   pglDisplayGetGammaTableSize function //
+////////////////////////////////////////////
+int pglDisplayGetGammaTableSize(int displayNumber)
+{
+  if (!validDisplay(displayNumber)) return -1;
+  return kMockGammaTableSize;
+}
+
+////////////////////////////////////////
+//   pglDisplayGetGammaTable function //
+////////////////////////////////////////
+int pglDisplayGetGammaTable(int displayNumber, float* red, float* green, float* blue, int maxEntries)
+{
+  if (!validDisplay(displayNumber)) return -1;
+  int count = (kMockGammaTableSize < maxEntries) ? kMockGammaTableSize : maxEntries;
+  pthread_mutex_lock(&mockMutex);
+  initMockDisplays();
+  memcpy(red, gammaTable[displayNumber][0], count * sizeof(float));
+  memcpy(green, gammaTable[displayNumber][1], count * sizeof(float));
+  memcpy(blue, gammaTable[displayNumber][2], count * sizeof(float));
+  pthread_mutex_unlock(&mockMutex);
+  return count;
+}
+
+////////////////////////////////////////
+//   pglDisplaySetGammaTable function //
+////////////////////////////////////////
+int pglDisplaySetGammaTable(int displayNumber, const float* red, const float* green, const float* blue, int numEntries)
+{
+  if (!validDisplay(displayNumber) || (numEntries <= 0) || (numEntries > kMockGammaTableSize)) return -1;
+
+  pthread_mutex_lock(&mockMutex);
+  initMockDisplays();
+  if (numEntries == kMockGammaTableSize) {
+    memcpy(gammaTable[displayNumber][0], red, numEntries * sizeof(float));
+    memcpy(gammaTable[displayNumber][1], green, numEntries * sizeof(float));
+    memcpy(gammaTable[displayNumber][2], blue, numEntries * sizeof(float));
+  }
+  else {
+    // like CoreGraphics, a shorter table is linearly interpolated
+    // over the full hardware table
+    const float* source[3] = {red, green, blue};
+    for (int channel = 0; channel < 3; channel++) {
+      for (int i = 0; i < kMockGammaTableSize; i++) {
+        double position = (numEntries == 1) ? 0 : (double)i * (numEntries - 1) / (kMockGammaTableSize - 1);
+        int lower = (int)position;
+        int upper = (lower + 1 < numEntries) ? lower + 1 : lower;
+        double fraction = position - lower;
+        gammaTable[displayNumber][channel][i] = (float)((1 - fraction) * source[channel][lower] + fraction * source[channel][upper]);
+      }
+    }
+  }
+  pthread_mutex_unlock(&mockMutex);
+  return 0;
+}
@@ -0,0 +1,53 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglEventBackend.h
+//
+//  Interface between the _pglEventListener Python module and the
+//  platform event source. _pglEventBackendMac.c uses a CGEventTap,
+//  _pglEventBackendLinux.c is a synthetic source fed by
+//  pglEventBackendPost (evdev-style records, no window system needed).
+/////////////////////////////////////////////////////////////////////
+#ifndef _PGLEVENTBACKEND_H
+#define _PGLEVENTBACKEND_H
+
+#include "_pglEventCore.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// called on the backend thread for each event. Return 1 to eat the
+// event (suppress it from the OS, where the backend supports that)
+typedef int (*pglEventHandler)(const pglInputEvent* event, void* context);
+
+typedef struct pglEventBackend pglEventBackend;
+
+// name of the backend (for diagnostics)
+const char* pglEventBackendGetName(void);
+
+// returns 1 if the process may listen to events. If not, message is
+// set to a human readable explanation
+int pglEventBackendCheckPermission(const char** message);
+
+pglEventBackend* pglEventBackendCreate(pglEventHandler handler, void* context);
+
+// run the event loop on the calling thread until pglEventBackendStop is
+// called. Returns 0 on a clean stop and -1 if the event source could not
+// be opened
+int pglEventBackendRun(pglEventBackend* backend);
+
+// ask the event loop to return. Safe from any thread (including from
+// inside the handler) and safe to call more than once
+void pglEventBackendStop(pglEventBackend* backend);
+
+// free the backend. Only call once pglEventBackendRun has returned
+void pglEventBackendDestroy(pglEventBackend* backend);
+
+// inject a synthetic event. Returns 0 if queued, -1 if the queue was
+// full and -2 if the backend does not take synthetic events
+int pglEventBackendPost(const pglInputEvent* event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
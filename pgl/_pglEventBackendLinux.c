@@ -0,0 +1,117 @@
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <stdlib.h>
+#include <pthread.h>
+#include "_pglEventBackend.h"
+
+////////////////////////
+//   define section   //
+////////////////////////
+#define kSyntheticQueueSize 4096
+#define kPollInterval 0.05
+
+////////////////////////
+//   backend struct   //
+////////////////////////
+struct pglEventBackend {
+    pglEventHandler handler;
+    void* context;
+    volatile int stopRequested;
+};
+
+//////////////////////
+// global variables //
+//////////////////////
+// The synthetic event queue stands in for an input device, so like a
+// device it exists for the life of the process, whether or not a
+// listener is running
+static pglEventRing syntheticQueue;
+static pthread_once_t syntheticQueueOnce = PTHREAD_ONCE_INIT;
+static int syntheticQueueOK = 0;
+
+///////////////////////////////////////
+//   initSyntheticQueue function     //
+///////////////////////////////////////
+static void initSyntheticQueue(void)
+{
+    syntheticQueueOK = (pglEventRingInit(&syntheticQueue, kSyntheticQueueSize) == 0);
+}
+
+///////////////////////////////////////
+//   pglEventBackendGetName function //
+///////////////////////////////////////
+const char* pglEventBackendGetName(void)
+{
+    return "linux-synthetic";
+}
+
+///////////////////////////////////////////////
+//   pglEventBackendCheckPermission function //
+///////////////////////////////////////////////
+int pglEventBackendCheckPermission(const char** message)
+{
+    // synthetic events need no permissions
+    return 1;
+}
+
+//////////////////////////////////////
+//   pglEventBackendCreate function //
+//////////////////////////////////////
+pglEventBackend* pglEventBackendCreate(pglEventHandler handler, void* context)
+{
+    pthread_once(&syntheticQueueOnce, initSyntheticQueue);
+    if (!syntheticQueueOK) return NULL;
+
+    pglEventBackend* backend = (pglEventBackend*)calloc(1, sizeof(pglEventBackend));
+    if (backend == NULL) return NULL;
+    backend->handler = handler;
+    backend->context = context;
+    return backend;
+}
+
+///////////////////////////////////
+//   pglEventBackendRun function //
+///////////////////////////////////
+int pglEventBackendRun(pglEventBackend* backend)
+{
+    pglInputEvent event;
+    while (!backend->stopRequested) {
+        // wait for the next event, the timeout means a missed wake
+        // can only delay stop by kPollInterval
+        if (pglEventRingPop(&syntheticQueue, &event, kPollInterval) == 1) {
+            // nothing to suppress on a synthetic source, but the eat key
+            // table and the handler return value are still honoured the
+            // same way as on macOS, so the handler is always called
+            backend->handler(&event, backend->context);
+        }
+    }
+    return 0;
+}
+
+////////////////////////////////////
+//   pglEventBackendStop function //
+////////////////////////////////////
+void pglEventBackendStop(pglEventBackend* backend)
+{
+    backend->stopRequested = 1;
+    pglEventRingWake(&syntheticQueue);
+}
+
+///////////////////////////////////////
+//   pglEventBackendDestroy function //
+///////////////////////////////////////
+void pglEventBackendDestroy(pglEventBackend* backend)
+{
+    free(backend);
+}
+
+////////////////////////////////////
+//   pglEventBackendPost function //
+////////////////////////////////////
+int pglEventBackendPost(const pglInputEvent* event)
+{
+    pthread_once(&syntheticQueueOnce, initSyntheticQueue);
+    if (!syntheticQueueOK) return -1;
+    return pglEventRingPush(&syntheticQueue, event);
+}
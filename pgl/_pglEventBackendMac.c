@@ -0,0 +1,229 @@
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <ApplicationServices/ApplicationServices.h>
+#include "_pglEventBackend.h"
+
+////////////////////////
+//   define section   //
+////////////////////////
+// how often the run loop comes back to check for a stop request
+#define kRunLoopInterval 0.1
+
+////////////////////////
+//   backend struct   //
+////////////////////////
+struct pglEventBackend {
+    pglEventHandler handler;
+    void* context;
+    CFMachPortRef eventTap;
+    CFRunLoopRef runLoop;
+    volatile int stopRequested;
+};
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type,
+                                CGEventRef event, void *refcon);
+
+///////////////////////////////////////
+//   pglEventBackendGetName function //
+///////////////////////////////////////
+const char* pglEventBackendGetName(void)
+{
+    return "macos-cgeventtap";
+}
+
+///////////////////////////////////////////////
+//   pglEventBackendCheckPermission function //
+///////////////////////////////////////////////
+int pglEventBackendCheckPermission(const char** message)
+{
+    // Check accessibility permissions
+    if (!AXIsProcessTrusted()) {
+        *message = "Accessibility permission required. Go to System Preferences > "
+                   "Security & Privacy > Privacy > Accessibility and add Python/Terminal";
+        return 0;
+    }
+    return 1;
+}
+
+//////////////////////////////////////
+//   pglEventBackendCreate function //
+//////////////////////////////////////
+pglEventBackend* pglEventBackendCreate(pglEventHandler handler, void* context)
+{
+    pglEventBackend* backend = (pglEventBackend*)calloc(1, sizeof(pglEventBackend));
+    if (backend == NULL) return NULL;
+    backend->handler = handler;
+    backend->context = context;
+    return backend;
+}
+
+///////////////////////////////////
+//   pglEventBackendRun function //
+///////////////////////////////////
+int pglEventBackendRun(pglEventBackend* backend)
+{
+    CGEventMask eventMask = 
+        (1 << kCGEventKeyDown) | 
+        (1 << kCGEventKeyUp) |
+        (1 << kCGEventLeftMouseDown) | 
+        (1 << kCGEventLeftMouseUp) |
+        (1 << kCGEventRightMouseDown) | 
+        (1 << kCGEventRightMouseUp) |
+        (1 << kCGEventOtherMouseDown) |
+        (1 << kCGEventOtherMouseUp) |
+        (1 << kCGEventMouseMoved) |
+        (1 << kCGEventLeftMouseDragged) |
+        (1 << kCGEventRightMouseDragged);
+    
+    backend->eventTap = CGEventTapCreate(
+        kCGSessionEventTap,
+        kCGHeadInsertEventTap,
+        kCGEventTapOptionDefault,
+        eventMask,
+        eventCallback,
+        backend
+    );
+    
+    if (!backend->eventTap) {
+        fprintf(stderr, "(_pglEventListener) Failed to create event tap\n");
+        return -1;
+    }
+    
+    CFRunLoopSourceRef runLoopSource = 
+        CFMachPortCreateRunLoopSource(kCFAllocatorDefault, backend->eventTap, 0);
+    
+    // retained so that stop can safely call CFRunLoopStop on it
+    // until the backend is destroyed
+    CFRunLoopRef runLoop = CFRunLoopGetCurrent();
+    CFRetain(runLoop);
+    CFRunLoopAddSource(runLoop, runLoopSource, kCFRunLoopCommonModes);
+    CGEventTapEnable(backend->eventTap, true);
+    CFRelease(runLoopSource);
+    backend->runLoop = runLoop;
+    
+    // Run the event loop. Run in slices rather than with CFRunLoopRun,
+    // since a CFRunLoopStop issued before the loop starts is ignored
+    while (!backend->stopRequested) {
+        CFRunLoopRunInMode(kCFRunLoopDefaultMode, kRunLoopInterval, false);
+    }
+    
+    // Cleanup
+    CGEventTapEnable(backend->eventTap, false);
+    CFRelease(backend->eventTap);
+    backend->eventTap = NULL;
+    
+    return 0;
+}
+
+////////////////////////////////////
+//   pglEventBackendStop function //
+////////////////////////////////////
+void pglEventBackendStop(pglEventBackend* backend)
+{
+    backend->stopRequested = 1;
+    if (backend->runLoop) {
+        CFRunLoopStop(backend->runLoop);
+    }
+}
+
+///////////////////////////////////////
+//   pglEventBackendDestroy function //
+///////////////////////////////////////
+void pglEventBackendDestroy(pglEventBackend* backend)
+{
+    if (backend->runLoop) {
+        CFRelease(backend->runLoop);
+    }
+    free(backend);
+}
+
+////////////////////////////////////
+//   pglEventBackendPost function //
+////////////////////////////////////
+int pglEventBackendPost(const pglInputEvent* event)
+{
+    // events come from the OS event tap
+    return -2;
+}
+
+/*
+ * Event callback - called by OS on each event
+ */
+static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type,
+                                CGEventRef event, void *refcon) {
+    pglEventBackend *backend = (pglEventBackend*)refcon;
+
+    // The OS disables the tap if a callback is too slow, re-enable it
+    if (type == kCGEventTapDisabledByTimeout || type == kCGEventTapDisabledByUserInput) {
+        if (backend->eventTap) CGEventTapEnable(backend->eventTap, true);
+        return event;
+    }
+
+    CGEventRef returnEvent = event;  // Default: pass event through
+    pglInputEvent pglEvent = {0};
+
+    // Common fields
+    pglEvent.timestamp = (double)CGEventGetTimestamp(event) / 1e9;
+    
+    // Type-specific fields
+    if (type == kCGEventKeyDown || type == kCGEventKeyUp) {
+        pglEvent.type = (type == kCGEventKeyDown) ? pglEventKeyDown : pglEventKeyUp;
+        pglEvent.keyCode = (int)CGEventGetIntegerValueField(event, kCGKeyboardEventKeycode);
+        pglEvent.keyboardType = (int)CGEventGetIntegerValueField(event, kCGKeyboardEventKeyboardType);
+
+        CGEventFlags flags = CGEventGetFlags(event);
+        if (flags & kCGEventFlagMaskShift) pglEvent.flags |= PGL_EVENT_FLAG_SHIFT;
+        if (flags & kCGEventFlagMaskControl) pglEvent.flags |= PGL_EVENT_FLAG_CONTROL;
+        if (flags & kCGEventFlagMaskAlternate) pglEvent.flags |= PGL_EVENT_FLAG_ALT;
+        if (flags & kCGEventFlagMaskCommand) pglEvent.flags |= PGL_EVENT_FLAG_COMMAND;
+        if (flags & kCGEventFlagMaskAlphaShift) pglEvent.flags |= PGL_EVENT_FLAG_CAPSLOCK;
+
+        // Check if we should eat this key event BEFORE processing
+        if (pglEatKeysContains(pglEvent.keyCode)) {
+            // Suppress this event - don't pass to other applications
+            returnEvent = NULL;
+        }
+    }
+    else if (type == kCGEventLeftMouseDown || type == kCGEventLeftMouseUp ||
+             type == kCGEventRightMouseDown || type == kCGEventRightMouseUp ||
+             type == kCGEventOtherMouseDown || type == kCGEventOtherMouseUp) {
+        if (type == kCGEventLeftMouseDown) pglEvent.type = pglEventLeftMouseDown;
+        else if (type == kCGEventLeftMouseUp) pglEvent.type = pglEventLeftMouseUp;
+        else if (type == kCGEventRightMouseDown) pglEvent.type = pglEventRightMouseDown;
+        else if (type == kCGEventRightMouseUp) pglEvent.type = pglEventRightMouseUp;
+        else if (type == kCGEventOtherMouseDown) pglEvent.type = pglEventOtherMouseDown;
+        else pglEvent.type = pglEventOtherMouseUp;
+
+        pglEvent.button = (int)CGEventGetIntegerValueField(event, kCGMouseEventButtonNumber);
+        pglEvent.clickState = (int)CGEventGetIntegerValueField(event, kCGMouseEventClickState);
+        CGPoint location = CGEventGetLocation(event);
+        pglEvent.x = location.x;
+        pglEvent.y = location.y;
+    }
+    else if (type == kCGEventMouseMoved || 
+             type == kCGEventLeftMouseDragged ||
+             type == kCGEventRightMouseDragged) {
+        if (type == kCGEventMouseMoved) pglEvent.type = pglEventMouseMoved;
+        else if (type == kCGEventLeftMouseDragged) pglEvent.type = pglEventLeftMouseDragged;
+        else pglEvent.type = pglEventRightMouseDragged;
+
+        CGPoint location = CGEventGetLocation(event);
+        pglEvent.x = location.x;
+        pglEvent.y = location.y;
+    }
+    else {
+        return event;
+    }
+
+    // hand to the listener, which may also ask for the event to be eaten
+    if (backend->handler(&pglEvent, backend->context)) returnEvent = NULL;
+    
+    // Return NULL to suppress event, or event to pass it through
+    return returnEvent;
+}
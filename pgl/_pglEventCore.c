@@ -0,0 +1,314 @@
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/time.h>
+#include "_pglEventCore.h"
+
+//////////////////////
+// global variables //
+//////////////////////
+const char* pglInputEventTypeNames[pglEventNumTypes] = {
+    "keydown",
+    "keyup",
+    "leftMouseDown",
+    "leftMouseUp",
+    "rightMouseDown",
+    "rightMouseUp",
+    "otherMouseDown",
+    "otherMouseUp",
+    "mouseMoved",
+    "leftMouseDragged",
+    "rightMouseDragged"
+};
+
+// eat keys as a bitmap over the keyCode range
+static pthread_mutex_t eatKeysMutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t eatKeysBitmap[PGL_NUM_KEYCODES/64];
+static int numEatKeys = 0;
+
+// recent onsets, as a ring of the last PGL_ONSET_HISTORY
+static pthread_mutex_t onsetMutex = PTHREAD_MUTEX_INITIALIZER;
+static double onsetTimes[PGL_ONSET_HISTORY];
+static int64_t onsetIds[PGL_ONSET_HISTORY];
+static int onsetNext = 0;
+static int numOnsets = 0;
+
+//////////////////////////////////////////
+//   pglInputEventTypeFromName function  //
+//////////////////////////////////////////
+int pglInputEventTypeFromName(const char* name)
+{
+    for (int i = 0; i < pglEventNumTypes; i++) {
+        if (strcmp(name, pglInputEventTypeNames[i]) == 0) return i;
+    }
+    return -1;
+}
+
+////////////////////////////////////
+//   event type helper functions  //
+////////////////////////////////////
+int pglInputEventIsKey(int type)
+{
+    return (type == pglEventKeyDown) || (type == pglEventKeyUp);
+}
+
+int pglInputEventIsMouseButton(int type)
+{
+    return (type >= pglEventLeftMouseDown) && (type <= pglEventOtherMouseUp);
+}
+
+int pglInputEventIsMouseMove(int type)
+{
+    return (type >= pglEventMouseMoved) && (type <= pglEventRightMouseDragged);
+}
+
+//////////////////////////////
+//   pglEatKeysSet function  //
+//////////////////////////////
+void pglEatKeysSet(const int* keyCodes, int numKeys)
+{
+    // build the new bitmap outside of the lock
+    static uint64_t newBitmap[PGL_NUM_KEYCODES/64];
+    static pthread_mutex_t buildMutex = PTHREAD_MUTEX_INITIALIZER;
+
+    pthread_mutex_lock(&buildMutex);
+    memset(newBitmap, 0, sizeof(newBitmap));
+    int count = 0;
+    for (int i = 0; i < numKeys; i++) {
+        int keyCode = keyCodes[i];
+        if ((keyCode < 0) || (keyCode >= PGL_NUM_KEYCODES)) continue;
+        uint64_t bit = (uint64_t)1 << (keyCode & 63);
+        if (!(newBitmap[keyCode >> 6] & bit)) count++;
+        newBitmap[keyCode >> 6] |= bit;
+    }
+
+    pthread_mutex_lock(&eatKeysMutex);
+    memcpy(eatKeysBitmap, newBitmap, sizeof(eatKeysBitmap));
+    numEatKeys = count;
+    pthread_mutex_unlock(&eatKeysMutex);
+    pthread_mutex_unlock(&buildMutex);
+}
+
+////////////////////////////////
+//   pglEatKeysClear function  //
+////////////////////////////////
+void pglEatKeysClear(void)
+{
+    pthread_mutex_lock(&eatKeysMutex);
+    memset(eatKeysBitmap, 0, sizeof(eatKeysBitmap));
+    numEatKeys = 0;
+    pthread_mutex_unlock(&eatKeysMutex);
+}
+
+///////////////////////////////////
+//   pglEatKeysContains function  //
+///////////////////////////////////
+int pglEatKeysContains(int keyCode)
+{
+    if ((keyCode < 0) || (keyCode >= PGL_NUM_KEYCODES)) return 0;
+
+    pthread_mutex_lock(&eatKeysMutex);
+    int shouldEat = (eatKeysBitmap[keyCode >> 6] >> (keyCode & 63)) & 1;
+    pthread_mutex_unlock(&eatKeysMutex);
+
+    return shouldEat;
+}
+
+////////////////////////////////
+//   pglEatKeysCount function  //
+////////////////////////////////
+int pglEatKeysCount(void)
+{
+    pthread_mutex_lock(&eatKeysMutex);
+    int count = numEatKeys;
+    pthread_mutex_unlock(&eatKeysMutex);
+    return count;
+}
+
+////////////////////////////////
+//   pglOnsetPublish function  //
+////////////////////////////////
+void pglOnsetPublish(double presentedTime, int64_t onsetId)
+{
+    pthread_mutex_lock(&onsetMutex);
+    onsetTimes[onsetNext] = presentedTime;
+    onsetIds[onsetNext] = onsetId;
+    onsetNext = (onsetNext + 1) % PGL_ONSET_HISTORY;
+    if (numOnsets < PGL_ONSET_HISTORY) numOnsets++;
+    pthread_mutex_unlock(&onsetMutex);
+}
+
+//////////////////////////////
+//   pglOnsetClear function  //
+//////////////////////////////
+void pglOnsetClear(void)
+{
+    pthread_mutex_lock(&onsetMutex);
+    onsetNext = 0;
+    numOnsets = 0;
+    pthread_mutex_unlock(&onsetMutex);
+}
+
+///////////////////////////////
+//   pglOnsetLookup function  //
+///////////////////////////////
+int pglOnsetLookup(double timestamp, double* onsetTime, int64_t* onsetId)
+{
+    // onsets are published in order, but do not count on it - take the
+    // latest one that is not after timestamp
+    int found = 0;
+    double bestTime = 0;
+    int64_t bestId = 0;
+    pthread_mutex_lock(&onsetMutex);
+    for (int i = 0; i < numOnsets; i++) {
+        double t = onsetTimes[i];
+        if ((t <= timestamp) && (!found || (t > bestTime))) {
+            found = 1;
+            bestTime = t;
+            bestId = onsetIds[i];
+        }
+    }
+    pthread_mutex_unlock(&onsetMutex);
+
+    if (found) {
+        if (onsetTime) *onsetTime = bestTime;
+        if (onsetId) *onsetId = bestId;
+    }
+    return found;
+}
+
+//////////////////////////////
+//   pglOnsetCount function  //
+//////////////////////////////
+int pglOnsetCount(void)
+{
+    pthread_mutex_lock(&onsetMutex);
+    int count = numOnsets;
+    pthread_mutex_unlock(&onsetMutex);
+    return count;
+}
+
+/////////////////////////////////
+//   pglEventRingInit function  //
+/////////////////////////////////
+int pglEventRingInit(pglEventRing* ring, int capacity)
+{
+    memset(ring, 0, sizeof(pglEventRing));
+    ring->events = (pglInputEvent*)calloc(capacity, sizeof(pglInputEvent));
+    if (ring->events == NULL) return -1;
+    ring->capacity = capacity;
+    pthread_mutex_init(&ring->mutex, NULL);
+    pthread_cond_init(&ring->cond, NULL);
+    return 0;
+}
+
+////////////////////////////////////
+//   pglEventRingDestroy function  //
+////////////////////////////////////
+void pglEventRingDestroy(pglEventRing* ring)
+{
+    if (ring->events == NULL) return;
+    pthread_mutex_destroy(&ring->mutex);
+    pthread_cond_destroy(&ring->cond);
+    free(ring->events);
+    ring->events = NULL;
+}
+
+/////////////////////////////////
+//   pglEventRingPush function  //
+/////////////////////////////////
+int pglEventRingPush(pglEventRing* ring, const pglInputEvent* event)
+{
+    pthread_mutex_lock(&ring->mutex);
+
+    // full, keep the events already queued (they are older, so
+    // the consumer needs them first) and count the drop
+    if (ring->count == ring->capacity) {
+        ring->dropped++;
+        pthread_mutex_unlock(&ring->mutex);
+        return -1;
+    }
+
+    ring->events[(ring->head + ring->count) % ring->capacity] = *event;
+    ring->count++;
+    ring->pushed++;
+
+    pthread_cond_signal(&ring->cond);
+    pthread_mutex_unlock(&ring->mutex);
+    return 0;
+}
+
+////////////////////////////////
+//   pglEventRingPop function  //
+////////////////////////////////
+int pglEventRingPop(pglEventRing* ring, pglInputEvent* event, double timeoutSecs)
+{
+    // compute the absolute deadline (condition variables use wall clock)
+    struct timespec deadline;
+    if (timeoutSecs >= 0) {
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        double t = (double)now.tv_sec + (double)now.tv_usec / 1e6 + timeoutSecs;
+        deadline.tv_sec = (time_t)t;
+        deadline.tv_nsec = (long)((t - (double)deadline.tv_sec) * 1e9);
+    }
+
+    pthread_mutex_lock(&ring->mutex);
+    while ((ring->count == 0) && !ring->wake) {
+        if (timeoutSecs < 0) {
+            pthread_cond_wait(&ring->cond, &ring->mutex);
+        }
+        else if (pthread_cond_timedwait(&ring->cond, &ring->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+
+    int gotEvent = 0;
+    if (ring->count > 0) {
+        *event = ring->events[ring->head];
+        ring->head = (ring->head + 1) % ring->capacity;
+        ring->count--;
+        gotEvent = 1;
+    }
+    ring->wake = 0;
+    pthread_mutex_unlock(&ring->mutex);
+
+    return gotEvent;
+}
+
+/////////////////////////////////
+//   pglEventRingWake function  //
+/////////////////////////////////
+void pglEventRingWake(pglEventRing* ring)
+{
+    pthread_mutex_lock(&ring->mutex);
+    ring->wake = 1;
+    pthread_cond_broadcast(&ring->cond);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+//////////////////////////////////
+//   pglEventRingCount function  //
+//////////////////////////////////
+int pglEventRingCount(pglEventRing* ring)
+{
+    pthread_mutex_lock(&ring->mutex);
+    int count = ring->count;
+    pthread_mutex_unlock(&ring->mutex);
+    return count;
+}
+
+////////////////////////////////////
+//   pglEventRingDropped function  //
+////////////////////////////////////
+uint64_t pglEventRingDropped(pglEventRing* ring)
+{
+    pthread_mutex_lock(&ring->mutex);
+    uint64_t dropped = ring->dropped;
+    pthread_mutex_unlock(&ring->mutex);
+    return dropped;
+}
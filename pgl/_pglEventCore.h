@@ -0,0 +1,129 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglEventCore.h
+//
+//  Portable part of the event listener: the event record that the
+//  platform backends fill in, the table of keys to eat and a bounded
+//  ring buffer for backends that produce events asynchronously. None
+//  of this depends on Python or on a window system, so it can be built
+//  and benchmarked anywhere.
+/////////////////////////////////////////////////////////////////////
+#ifndef _PGLEVENTCORE_H
+#define _PGLEVENTCORE_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+////////////////////////
+//   define section   //
+////////////////////////
+#define PGL_MAX_EAT_KEYS 1024
+#define PGL_NUM_KEYCODES 65536
+#define PGL_ONSET_HISTORY 64
+
+// modifier flags
+#define PGL_EVENT_FLAG_SHIFT     0x01
+#define PGL_EVENT_FLAG_CONTROL   0x02
+#define PGL_EVENT_FLAG_ALT       0x04
+#define PGL_EVENT_FLAG_COMMAND   0x08
+#define PGL_EVENT_FLAG_CAPSLOCK  0x10
+
+// event types (names in pglInputEventTypeNames are what Python sees)
+typedef enum {
+    pglEventKeyDown = 0,
+    pglEventKeyUp,
+    pglEventLeftMouseDown,
+    pglEventLeftMouseUp,
+    pglEventRightMouseDown,
+    pglEventRightMouseUp,
+    pglEventOtherMouseDown,
+    pglEventOtherMouseUp,
+    pglEventMouseMoved,
+    pglEventLeftMouseDragged,
+    pglEventRightMouseDragged,
+    pglEventNumTypes
+} pglInputEventType;
+
+//////////////////////
+//   event record   //
+//////////////////////
+typedef struct {
+    double timestamp;
+    int type;
+    int keyCode;
+    int keyboardType;
+    unsigned int flags;
+    int button;
+    int clickState;
+    double x;
+    double y;
+} pglInputEvent;
+
+extern const char* pglInputEventTypeNames[pglEventNumTypes];
+
+// returns the event type for a name, or -1 if unknown
+int pglInputEventTypeFromName(const char* name);
+int pglInputEventIsKey(int type);
+int pglInputEventIsMouseButton(int type);
+int pglInputEventIsMouseMove(int type);
+
+////////////////////////
+//   eat key table    //
+////////////////////////
+// Process-wide set of keyCodes to suppress. Lookups are a bitmap test
+// so they are cheap enough for the event tap callback.
+void pglEatKeysSet(const int* keyCodes, int numKeys);
+void pglEatKeysClear(void);
+int pglEatKeysContains(int keyCode);
+int pglEatKeysCount(void);
+
+////////////////////////
+//   onset table      //
+////////////////////////
+// Process-wide record of the presentation times of recent stimulus
+// onsets (published after flush), so that input events can be stamped
+// with their latency from the most recent onset at the event's own
+// timestamp rather than at the frame the loop got to it.
+void pglOnsetPublish(double presentedTime, int64_t onsetId);
+void pglOnsetClear(void);
+// latest onset at or before timestamp. Returns 1 and fills in onsetTime
+// and onsetId, or 0 if there is none
+int pglOnsetLookup(double timestamp, double* onsetTime, int64_t* onsetId);
+int pglOnsetCount(void);
+
+////////////////////////
+//   event ring       //
+////////////////////////
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pglInputEvent* events;
+    int capacity;
+    int head;
+    int count;
+    int wake;
+    uint64_t pushed;
+    uint64_t dropped;
+} pglEventRing;
+
+// returns 0 on success, -1 if memory could not be allocated
+int pglEventRingInit(pglEventRing* ring, int capacity);
+void pglEventRingDestroy(pglEventRing* ring);
+// returns 0 if queued, -1 if the ring was full (event dropped and counted)
+int pglEventRingPush(pglEventRing* ring, const pglInputEvent* event);
+// waits up to timeoutSecs (<0 waits forever) for an event. Returns 1 if
+// an event was copied out, 0 on timeout or if woken by pglEventRingWake
+int pglEventRingPop(pglEventRing* ring, pglInputEvent* event, double timeoutSecs);
+// wake any thread blocked in pglEventRingPop
+void pglEventRingWake(pglEventRing* ring);
+int pglEventRingCount(pglEventRing* ring);
+uint64_t pglEventRingDropped(pglEventRing* ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
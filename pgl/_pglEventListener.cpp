@@ -1,6 +1,7 @@
 /*
- * macOS Event Tap Listener
- * Captures keyboard and mouse events via CGEventTap
+ * Event Listener
+ * Captures keyboard and mouse events from the platform event source
+ * (CGEventTap on macOS, a synthetic source on Linux - see _pglEventBackend.h)
  * Calls Python callback with event data
  * author: Justin Gardner (modified from mglEventListener with help from Claude)
  * date: 2026-02-16
@@ -8,30 +9,56 @@
 
 #include <Python.h>
 #include <pthread.h>
-#include <ApplicationServices/ApplicationServices.h>
+#include <stdlib.h>
+#include "_pglEventCore.h"
+#include "_pglEventBackend.h"
+#include "_pglClock.h"
+#include "_pglSched.h"
 
 // Constants
-#define MAX_EAT_KEYS 1024
+#define MAX_EAT_KEYS PGL_MAX_EAT_KEYS
+
+// Listener context. One is allocated for each start() and handed to
+// the event thread (and to the backend as the handler context). The
+// callback is always run in the interpreter that called start(), using
+// a thread state the event thread creates for that interpreter
+// (PyGILState_Ensure only knows about the main interpreter)
+typedef struct {
+    PyObject *callback;
+    PyInterpreterState *interp;
+    PyThreadState *tstate;
+    pthread_t thread;
+    pglEventBackend *backend;
+    int detached;
+    int appliedPolicyGeneration;
+} listenerContext;
 
 // Globals
-static CFMachPortRef eventTap = NULL;
-static CFRunLoopRef runLoop = NULL;
-static pthread_t eventThread;
-static PyObject *callbackObj = NULL;
-static int listenerRunning = 0;
-static pthread_mutex_t eatKeysMutex; 
-static int eatKeys[MAX_EAT_KEYS];
-static int numEatKeys = 0;
+// There is only one event source per process, so the running listener
+// is process-wide. listenerMutex guards it, so that start/stop/isRunning
+// are safe without the GIL (free-threaded builds) and across
+// subinterpreters. The eat keys table lives in _pglEventCore.
+static pthread_mutex_t listenerMutex = PTHREAD_MUTEX_INITIALIZER;
+static listenerContext *runningListener = NULL;
+
+// Scheduling of the event thread (see setThreadPolicy). The policy is
+// per thread, so the event thread applies it itself: when it starts and
+// at the next event after it changes. Also guarded by listenerMutex
+static pglSchedPolicy eventThreadPolicy = {0};
+static int eventThreadCore = -1;
+static int eventThreadPolicyGeneration = 0;
+static const char *eventThreadPolicyError = NULL;
 
 
 // Forward declarations
 static void* eventLoopThread(void* arg);
-static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type, 
-                                CGEventRef event, void *refcon);
-static int shouldEatKey(CGKeyCode keyCode);
+static int dispatchEvent(const pglInputEvent *event, void *context);
+static PyObject* eventToDict(const pglInputEvent *event);
+static int stopListener(PyInterpreterState *interp);
+static void applyThreadPolicy(listenerContext *listener);
 
 /*
- * Initialize and start the event tap
+ * Initialize and start the event listener
  */
 static PyObject* listenerStart(PyObject* self, PyObject* args) {
     PyObject *callback;
@@ -45,88 +72,124 @@ static PyObject* listenerStart(PyObject* self, PyObject* args) {
         return NULL;
     }
     
-    if (listenerRunning) {
-        PyErr_SetString(PyExc_RuntimeError, "Listener already running");
+    // Check permissions (accessibility on macOS)
+    const char *message = NULL;
+    if (!pglEventBackendCheckPermission(&message)) {
+        PyErr_SetString(PyExc_PermissionError, message);
         return NULL;
     }
     
-    // Check accessibility permissions
-    if (!AXIsProcessTrusted()) {
-        PyErr_SetString(PyExc_PermissionError, 
-            "Accessibility permission required. Go to System Preferences > "
-            "Security & Privacy > Privacy > Accessibility and add Python/Terminal");
+    pthread_mutex_lock(&listenerMutex);
+
+    if (runningListener) {
+        pthread_mutex_unlock(&listenerMutex);
+        PyErr_SetString(PyExc_RuntimeError, "Listener already running");
         return NULL;
     }
     
-    // Initialize mutex for eatKeys array
-    pthread_mutex_init(&eatKeysMutex, NULL);
-    numEatKeys = 0;
+    listenerContext *listener = (listenerContext*)calloc(1, sizeof(listenerContext));
+    if (listener) listener->backend = pglEventBackendCreate(dispatchEvent, listener);
+    if (!listener || !listener->backend) {
+        free(listener);
+        pthread_mutex_unlock(&listenerMutex);
+        return PyErr_NoMemory();
+    }
 
-    // Store callback reference
+    // Clear eatKeys
+    pglEatKeysClear();
+
+    // Store callback reference and the calling interpreter
     Py_INCREF(callback);
-    Py_XDECREF(callbackObj);
-    callbackObj = callback;
+    listener->callback = callback;
+    listener->interp = PyInterpreterState_Get();
     
     // Start event loop in separate thread
     pthread_attr_t attr;
     pthread_attr_init(&attr);
     pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
     
-    int err = pthread_create(&eventThread, &attr, eventLoopThread, NULL);
+    int err = pthread_create(&listener->thread, &attr, eventLoopThread, listener);
     pthread_attr_destroy(&attr);
     
     if (err != 0) {
-        Py_DECREF(callbackObj);
-        callbackObj = NULL;
-        pthread_mutex_destroy(&eatKeysMutex); 
+        Py_DECREF(listener->callback);
+        pglEventBackendDestroy(listener->backend);
+        free(listener);
+        pthread_mutex_unlock(&listenerMutex);
         PyErr_SetString(PyExc_RuntimeError, "Failed to create thread");
         return NULL;
     }
     
-    listenerRunning = 1;
+    runningListener = listener;
+    pthread_mutex_unlock(&listenerMutex);
 
     Py_RETURN_NONE;
 }
 
 /*
- * Stop the event tap
+ * Stop the event listener
  */
 static PyObject* listenerStop(PyObject* self, PyObject* args) {
-    if (!listenerRunning) {
-        Py_RETURN_NONE;
+    if (stopListener(PyInterpreterState_Get()) < 0) {
+        PyErr_SetString(PyExc_RuntimeError,
+            "Listener was started from a different interpreter");
+        return NULL;
     }
-    
-    // Stop the run loop
-    if (runLoop) {
-        CFRunLoopStop(runLoop);
+    Py_RETURN_NONE;
+}
+
+/*
+ * Stop the running listener if it was started from interp. Must be
+ * called attached to interp. Returns 0 if stopped (or not running) and
+ * -1 if the listener belongs to another interpreter.
+ */
+static int stopListener(PyInterpreterState *interp) {
+    pthread_mutex_lock(&listenerMutex);
+
+    listenerContext *listener = runningListener;
+    if (!listener) {
+        pthread_mutex_unlock(&listenerMutex);
+        return 0;
     }
-    
-    // Wait for thread to finish
-    pthread_join(eventThread, NULL);
-    
-    // Cleanup
-    if (eventTap) {
-        CGEventTapEnable(eventTap, false);
-        CFRelease(eventTap);
-        eventTap = NULL;
+    if (listener->interp != interp) {
+        pthread_mutex_unlock(&listenerMutex);
+        return -1;
+    }
+    runningListener = NULL;
+    pthread_mutex_unlock(&listenerMutex);
+
+    // Called from within the callback (e.g. double ESC) - the event
+    // thread cannot join itself, so stop the backend and let the thread
+    // clean up after the callback returns
+    if (pthread_equal(pthread_self(), listener->thread)) {
+        listener->detached = 1;
+        pglEventBackendStop(listener->backend);
+        pthread_detach(listener->thread);
+        return 0;
     }
     
-    Py_XDECREF(callbackObj);
-    callbackObj = NULL;
-    listenerRunning = 0;
-    runLoop = NULL;
+    // Stop the event loop and wait for thread to finish. The event thread
+    // may be waiting to run the callback, so release the GIL while joining
+    pglEventBackendStop(listener->backend);
+    Py_BEGIN_ALLOW_THREADS
+    pthread_join(listener->thread, NULL);
+    Py_END_ALLOW_THREADS
     
-    // Destroy mutex
-    pthread_mutex_destroy(&eatKeysMutex);
+    // Cleanup
+    pglEventBackendDestroy(listener->backend);
+    free(listener);
     
-    Py_RETURN_NONE;
+    return 0;
 }
 
 /*
  * Check if listener is running
  */
 static PyObject* listenerIsRunning(PyObject* self, PyObject* args) {
-    return PyBool_FromLong(listenerRunning);
+    pthread_mutex_lock(&listenerMutex);
+    int running = (runningListener != NULL);
+    pthread_mutex_unlock(&listenerMutex);
+    return PyBool_FromLong(running);
 }
 
 /*
@@ -144,211 +207,335 @@ static PyObject* listenerSetEatKeys(PyObject* self, PyObject* args) {
         return NULL;
     }
     
-    Py_ssize_t listSize = PyList_Size(keyList);
+    // Take a snapshot of the list, since without the GIL another thread
+    // could be modifying it while we read it
+    PyObject *keyTuple = PySequence_Tuple(keyList);
+    if (keyTuple == NULL) {
+        return NULL;
+    }
+    Py_ssize_t listSize = PyTuple_GET_SIZE(keyTuple);
     
     if (listSize > MAX_EAT_KEYS) {
+        Py_DECREF(keyTuple);
         PyErr_Format(PyExc_ValueError, "Too many keys to eat (max %d)", MAX_EAT_KEYS);
         return NULL;
     }
     
-    pthread_mutex_lock(&eatKeysMutex);
-    
-    numEatKeys = 0;
+    int newEatKeys[MAX_EAT_KEYS];
     for (Py_ssize_t i = 0; i < listSize; i++) {
-        PyObject *item = PyList_GetItem(keyList, i);
+        PyObject *item = PyTuple_GET_ITEM(keyTuple, i);
         if (!PyLong_Check(item)) {
-            pthread_mutex_unlock(&eatKeysMutex);
+            Py_DECREF(keyTuple);
             PyErr_SetString(PyExc_TypeError, "All items must be integers");
             return NULL;
         }
-        eatKeys[numEatKeys++] = (int)PyLong_AsLong(item);
+        newEatKeys[i] = (int)PyLong_AsLong(item);
     }
+    Py_DECREF(keyTuple);
     
-    pthread_mutex_unlock(&eatKeysMutex);
+    pglEatKeysSet(newEatKeys, (int)listSize);
     
     Py_RETURN_NONE;
 }
 
 /*
- * Check if a keycode should be eaten (suppressed)
+ * Post a synthetic event (backends without an OS event source, i.e. Linux)
  */
-static int shouldEatKey(CGKeyCode keyCode) {
-    int shouldEat = 0;
+static PyObject* listenerPostEvent(PyObject* self, PyObject* args) {
+    PyObject *eventDict;
     
-    pthread_mutex_lock(&eatKeysMutex);
+    if (!PyArg_ParseTuple(args, "O!", &PyDict_Type, &eventDict)) {
+        return NULL;
+    }
     
-    for (int i = 0; i < numEatKeys; i++) {
-        if (eatKeys[i] == (int)keyCode) {
-            shouldEat = 1;
-            break;
-        }
+    // event type is required
+    PyObject *eventType = PyDict_GetItemString(eventDict, "eventType");
+    if (!eventType || !PyUnicode_Check(eventType)) {
+        PyErr_SetString(PyExc_ValueError, "Event must have an eventType string");
+        return NULL;
+    }
+    pglInputEvent event = {0};
+    event.type = pglInputEventTypeFromName(PyUnicode_AsUTF8(eventType));
+    if (event.type < 0) {
+        PyErr_Format(PyExc_ValueError, "Unknown eventType %R", eventType);
+        return NULL;
     }
     
-    pthread_mutex_unlock(&eatKeysMutex);
+    // everything else is optional, timestamp defaults to now
+    PyObject *value;
+    event.timestamp = pglClockGetSecs();
+    if ((value = PyDict_GetItemString(eventDict, "timestamp"))) event.timestamp = PyFloat_AsDouble(value);
+    if ((value = PyDict_GetItemString(eventDict, "keyCode"))) event.keyCode = (int)PyLong_AsLong(value);
+    if ((value = PyDict_GetItemString(eventDict, "keyboardType"))) event.keyboardType = (int)PyLong_AsLong(value);
+    if ((value = PyDict_GetItemString(eventDict, "button"))) event.button = (int)PyLong_AsLong(value);
+    if ((value = PyDict_GetItemString(eventDict, "clickState"))) event.clickState = (int)PyLong_AsLong(value);
+    if ((value = PyDict_GetItemString(eventDict, "x"))) event.x = PyFloat_AsDouble(value);
+    if ((value = PyDict_GetItemString(eventDict, "y"))) event.y = PyFloat_AsDouble(value);
+    if (PyErr_Occurred()) return NULL;
+    
+    const char *flagNames[] = {"shift", "control", "alt", "command", "capsLock"};
+    const unsigned int flagBits[] = {PGL_EVENT_FLAG_SHIFT, PGL_EVENT_FLAG_CONTROL, PGL_EVENT_FLAG_ALT,
+                                     PGL_EVENT_FLAG_COMMAND, PGL_EVENT_FLAG_CAPSLOCK};
+    for (int i = 0; i < 5; i++) {
+        value = PyDict_GetItemString(eventDict, flagNames[i]);
+        if (value && PyObject_IsTrue(value)) event.flags |= flagBits[i];
+    }
+    
+    int status = pglEventBackendPost(&event);
+    if (status == -2) {
+        PyErr_Format(PyExc_NotImplementedError,
+            "The %s event backend does not accept synthetic events", pglEventBackendGetName());
+        return NULL;
+    }
     
-    return shouldEat;
+    // False if the queue was full and the event was dropped
+    return PyBool_FromLong(status == 0);
 }
 
 /*
- * Event loop thread
+ * Publish the presentation time of a stimulus onset (called after flush)
  */
-static void* eventLoopThread(void* arg) {
-    CGEventMask eventMask = 
-        (1 << kCGEventKeyDown) | 
-        (1 << kCGEventKeyUp) |
-        (1 << kCGEventLeftMouseDown) | 
-        (1 << kCGEventLeftMouseUp) |
-        (1 << kCGEventRightMouseDown) | 
-        (1 << kCGEventRightMouseUp) |
-        (1 << kCGEventOtherMouseDown) |
-        (1 << kCGEventOtherMouseUp) |
-        (1 << kCGEventMouseMoved) |
-        (1 << kCGEventLeftMouseDragged) |
-        (1 << kCGEventRightMouseDragged);
-    
-    eventTap = CGEventTapCreate(
-        kCGSessionEventTap,
-        kCGHeadInsertEventTap,
-        kCGEventTapOptionDefault,
-        eventMask,
-        eventCallback,
-        NULL
-    );
-    
-    if (!eventTap) {
-        fprintf(stderr, "(_pglEventListener) Failed to create event tap\n");
+static PyObject* listenerPublishOnset(PyObject* self, PyObject* args) {
+    double presentedTime;
+    long long onsetId;
+    
+    if (!PyArg_ParseTuple(args, "dL", &presentedTime, &onsetId)) {
         return NULL;
     }
+    pglOnsetPublish(presentedTime, (int64_t)onsetId);
+    Py_RETURN_NONE;
+}
+
+/*
+ * Forget all published onsets
+ */
+static PyObject* listenerClearOnsets(PyObject* self, PyObject* args) {
+    pglOnsetClear();
+    Py_RETURN_NONE;
+}
+
+/*
+ * Latency of a timestamp from the most recent onset at or before it.
+ * Returns (latency, onsetId), or None if there is no such onset
+ */
+static PyObject* listenerOnsetLatency(PyObject* self, PyObject* args) {
+    double timestamp, onsetTime;
+    int64_t onsetId;
     
-    CFRunLoopSourceRef runLoopSource = 
-        CFMachPortCreateRunLoopSource(kCFAllocatorDefault, eventTap, 0);
-    
-    runLoop = CFRunLoopGetCurrent();
-    CFRunLoopAddSource(runLoop, runLoopSource, kCFRunLoopCommonModes);
-    CGEventTapEnable(eventTap, true);
+    if (!PyArg_ParseTuple(args, "d", &timestamp)) {
+        return NULL;
+    }
+    if (!pglOnsetLookup(timestamp, &onsetTime, &onsetId)) {
+        Py_RETURN_NONE;
+    }
+    return Py_BuildValue("(dL)", timestamp - onsetTime, (long long)onsetId);
+}
+
+/*
+ * Set the scheduling policy and core of the event thread
+ */
+static PyObject* listenerSetThreadPolicy(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static const char *keywords[] = {"policy", "period", "computation", "constraint", "priority", "core", NULL};
+    const char *name;
+    pglSchedPolicy policy = {0};
+    int core = -1;
     
-    CFRelease(runLoopSource);
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|dddii", (char**)keywords, &name, &policy.period, &policy.computation, &policy.constraint, &policy.priority, &core)) {
+        return NULL;
+    }
+    policy.policy = pglSchedPolicyFromName(name);
+    if (policy.policy < 0) {
+        PyErr_Format(PyExc_ValueError, "Unknown policy '%s' (default, realtime, fifo or deadline)", name);
+        return NULL;
+    }
+    // time constraint defaults as _pglRealtime.setPolicy
+    if (policy.period <= 0) policy.period = 1.0 / 60.0;
+    if (policy.computation <= 0) policy.computation = policy.period / 4;
+    if (policy.constraint <= 0) policy.constraint = policy.period / 2;
+
+    pthread_mutex_lock(&listenerMutex);
+    eventThreadPolicy = policy;
+    eventThreadCore = core;
+    eventThreadPolicyGeneration++;
+    eventThreadPolicyError = NULL;
+    pthread_mutex_unlock(&listenerMutex);
+    Py_RETURN_NONE;
+}
+
+/*
+ * Whether the event thread has applied the policy, and why not if it failed.
+ * Returns (applied, errorMessage or None)
+ */
+static PyObject* listenerGetThreadPolicyStatus(PyObject* self, PyObject* args) {
+    pthread_mutex_lock(&listenerMutex);
+    int applied = runningListener && (runningListener->appliedPolicyGeneration == eventThreadPolicyGeneration);
+    const char *error = eventThreadPolicyError;
+    pthread_mutex_unlock(&listenerMutex);
+    if (error) return Py_BuildValue("(Os)", Py_False, error);
+    return Py_BuildValue("(OO)", applied ? Py_True : Py_False, Py_None);
+}
+
+/*
+ * Name of the platform event backend
+ */
+static PyObject* listenerGetBackendName(PyObject* self, PyObject* args) {
+    return PyUnicode_FromString(pglEventBackendGetName());
+}
+
+/*
+ * Event loop thread
+ */
+static void* eventLoopThread(void* arg) {
+    listenerContext *listener = (listenerContext*)arg;
+
+    // Thread state in the owning interpreter for running the callback
+    listener->tstate = PyThreadState_New(listener->interp);
+
+    // Scheduling policy, if one was set before start
+    applyThreadPolicy(listener);
+
+    // Run the backend event loop until stopped
+    pglEventBackendRun(listener->backend);
+
+    // Release the callback and thread state in the owning interpreter
+    if (listener->tstate) {
+        PyEval_RestoreThread(listener->tstate);
+        Py_CLEAR(listener->callback);
+        PyThreadState_Clear(listener->tstate);
+        PyThreadState_DeleteCurrent();
+        listener->tstate = NULL;
+    }
     
-    // Run the event loop
-    CFRunLoopRun();
+    // If stop was called from the callback nobody is going to join
+    // this thread, so free the context here. Otherwise stop frees it
+    // after joining
+    if (listener->detached) {
+        pglEventBackendDestroy(listener->backend);
+        free(listener);
+    }
     
     return NULL;
 }
 
 /*
- * Event callback - called by OS on each event
+ * Event handler - called by the backend on the event thread for each event
  */
-static CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type,
-                                CGEventRef event, void *refcon) {
-    if (!callbackObj) {
-        return event;
-    }
-
-    // Check if we should eat this key event BEFORE processing
-    CGEventRef returnEvent = event;  // Default: pass event through
-    
-    if (type == kCGEventKeyDown || type == kCGEventKeyUp) {
-        CGKeyCode keyCode = (CGKeyCode)CGEventGetIntegerValueField(
-            event, kCGKeyboardEventKeycode);
-        
-        if (shouldEatKey(keyCode)) {
-            // Suppress this event - don't pass to other applications
-            returnEvent = NULL;
-        }
+static int dispatchEvent(const pglInputEvent *event, void *context) {
+    listenerContext *listener = (listenerContext*)context;
+    int eatEvent = 0;
+
+    if (!listener->callback || !listener->tstate) {
+        return 0;
     }
 
-    // Acquire GIL for Python callback
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    // pick up a scheduling policy set since the last event
+    applyThreadPolicy(listener);
+
+    // Attach to the interpreter that started the listener (acquires
+    // its GIL, if it has one) for the Python callback
+    PyEval_RestoreThread(listener->tstate);
     
     // Create event dictionary
-    PyObject *eventDict = PyDict_New();
-    
-    // Common fields
-    double timestamp = (double)CGEventGetTimestamp(event) / 1e9;
-    PyDict_SetItemString(eventDict, "timestamp", PyFloat_FromDouble(timestamp));
-    
-    // Type-specific fields
-    if (type == kCGEventKeyDown || type == kCGEventKeyUp) {
-
-        PyDict_SetItemString(eventDict, "eventType", 
-            PyUnicode_FromString(type == kCGEventKeyDown ? "keydown" : "keyup"));
-        
-        CGKeyCode keyCode = (CGKeyCode)CGEventGetIntegerValueField(
-            event, kCGKeyboardEventKeycode);
-        PyDict_SetItemString(eventDict, "keyCode", PyLong_FromLong(keyCode));
-        
-        int64_t keyboardType = CGEventGetIntegerValueField(
-            event, kCGKeyboardEventKeyboardType);
-        PyDict_SetItemString(eventDict, "keyboardType", PyLong_FromLong(keyboardType));
-        
-        CGEventFlags flags = CGEventGetFlags(event);
-        PyDict_SetItemString(eventDict, "shift", PyBool_FromLong(flags & kCGEventFlagMaskShift));
-        PyDict_SetItemString(eventDict, "control", PyBool_FromLong(flags & kCGEventFlagMaskControl));
-        PyDict_SetItemString(eventDict, "alt", PyBool_FromLong(flags & kCGEventFlagMaskAlternate));
-        PyDict_SetItemString(eventDict, "command", PyBool_FromLong(flags & kCGEventFlagMaskCommand));
-        PyDict_SetItemString(eventDict, "capsLock", PyBool_FromLong(flags & kCGEventFlagMaskAlphaShift));
-    }
-    else if (type == kCGEventLeftMouseDown || type == kCGEventLeftMouseUp ||
-             type == kCGEventRightMouseDown || type == kCGEventRightMouseUp ||
-             type == kCGEventOtherMouseDown || type == kCGEventOtherMouseUp) {
-        
-        const char *typeStr = NULL;
-        if (type == kCGEventLeftMouseDown) typeStr = "leftMouseDown";
-        else if (type == kCGEventLeftMouseUp) typeStr = "leftMouseUp";
-        else if (type == kCGEventRightMouseDown) typeStr = "rightMouseDown";
-        else if (type == kCGEventRightMouseUp) typeStr = "rightMouseUp";
-        else if (type == kCGEventOtherMouseDown) typeStr = "otherMouseDown";
-        else if (type == kCGEventOtherMouseUp) typeStr = "otherMouseUp";
-        
-        PyDict_SetItemString(eventDict, "eventType", PyUnicode_FromString(typeStr));
-        
-        int64_t button = CGEventGetIntegerValueField(event, kCGMouseEventButtonNumber);
-        PyDict_SetItemString(eventDict, "button", PyLong_FromLong(button));
-        
-        int64_t clickState = CGEventGetIntegerValueField(event, kCGMouseEventClickState);
-        PyDict_SetItemString(eventDict, "clickState", PyLong_FromLong(clickState));
-        
-        CGPoint location = CGEventGetLocation(event);
-        PyDict_SetItemString(eventDict, "x", PyFloat_FromDouble(location.x));
-        PyDict_SetItemString(eventDict, "y", PyFloat_FromDouble(location.y));
-    }
-    else if (type == kCGEventMouseMoved || 
-             type == kCGEventLeftMouseDragged ||
-             type == kCGEventRightMouseDragged) {
-        
-        const char *typeStr = NULL;
-        if (type == kCGEventMouseMoved) typeStr = "mouseMoved";
-        else if (type == kCGEventLeftMouseDragged) typeStr = "leftMouseDragged";
-        else if (type == kCGEventRightMouseDragged) typeStr = "rightMouseDragged";
-        
-        PyDict_SetItemString(eventDict, "eventType", PyUnicode_FromString(typeStr));
-        
-        CGPoint location = CGEventGetLocation(event);
-        PyDict_SetItemString(eventDict, "x", PyFloat_FromDouble(location.x));
-        PyDict_SetItemString(eventDict, "y", PyFloat_FromDouble(location.y));
-    }
+    PyObject *eventDict = eventToDict(event);
     
     // Call Python callback
-    PyObject *result = PyObject_CallFunctionObjArgs(callbackObj, eventDict, NULL);
+    PyObject *result = eventDict ? PyObject_CallFunctionObjArgs(listener->callback, eventDict, NULL) : NULL;
     
     // Check for errors
     if (result == NULL) {
         PyErr_Print();
     } else {
         // If callback returns True, eat the event
-        if (PyBool_Check(result) && (result == Py_True)) returnEvent = NULL;
+        if (PyBool_Check(result) && (result == Py_True)) eatEvent = 1;
 
         // Decrement reference count for result
         Py_DECREF(result);
     }
     
-    Py_DECREF(eventDict);
+    Py_XDECREF(eventDict);
+    
+    // Detach from the interpreter
+    PyEval_SaveThread();
+    
+    return eatEvent;
+}
+
+/*
+ * Apply the event thread policy on the event thread, if it has changed
+ */
+static void applyThreadPolicy(listenerContext *listener) {
+    pthread_mutex_lock(&listenerMutex);
+    int generation = eventThreadPolicyGeneration;
+    pglSchedPolicy policy = eventThreadPolicy;
+    int core = eventThreadCore;
+    pthread_mutex_unlock(&listenerMutex);
+    if (generation == listener->appliedPolicyGeneration) return;
+
+    // pin first, SCHED_DEADLINE threads cannot be pinned afterwards
+    const char *message = NULL, *pinMessage = NULL;
+    if ((core >= 0) || (policy.policy != pglSchedDeadline)) {
+        if (pglSchedPinToCore(core, &pinMessage) == 0 || core < 0) pinMessage = NULL;
+    }
+    if (pglSchedSetPolicy(&policy, &message) == 0) message = pinMessage;
+
+    pthread_mutex_lock(&listenerMutex);
+    listener->appliedPolicyGeneration = generation;
+    if (generation == eventThreadPolicyGeneration) eventThreadPolicyError = message;
+    pthread_mutex_unlock(&listenerMutex);
+}
+
+/*
+ * Set a dictionary item, stealing the reference to value
+ */
+static void setDictItem(PyObject *dict, const char *key, PyObject *value) {
+    if (value) {
+        PyDict_SetItemString(dict, key, value);
+        Py_DECREF(value);
+    }
+}
+
+/*
+ * Convert an event record to the dictionary passed to the callback
+ */
+static PyObject* eventToDict(const pglInputEvent *event) {
+    PyObject *eventDict = PyDict_New();
+    if (!eventDict) return NULL;
+    
+    // Common fields
+    setDictItem(eventDict, "timestamp", PyFloat_FromDouble(event->timestamp));
+    setDictItem(eventDict, "eventType", PyUnicode_FromString(pglInputEventTypeNames[event->type]));
+    
+    // Latency from the most recent stimulus onset, for responses
+    double onsetTime;
+    int64_t onsetId;
+    if ((pglInputEventIsKey(event->type) || pglInputEventIsMouseButton(event->type)) &&
+        pglOnsetLookup(event->timestamp, &onsetTime, &onsetId)) {
+        setDictItem(eventDict, "onsetLatency", PyFloat_FromDouble(event->timestamp - onsetTime));
+        setDictItem(eventDict, "onsetId", PyLong_FromLongLong((long long)onsetId));
+    }
     
-    // Release GIL
-    PyGILState_Release(gstate);
+    // Type-specific fields
+    if (pglInputEventIsKey(event->type)) {
+        setDictItem(eventDict, "keyCode", PyLong_FromLong(event->keyCode));
+        setDictItem(eventDict, "keyboardType", PyLong_FromLong(event->keyboardType));
+        setDictItem(eventDict, "shift", PyBool_FromLong(event->flags & PGL_EVENT_FLAG_SHIFT));
+        setDictItem(eventDict, "control", PyBool_FromLong(event->flags & PGL_EVENT_FLAG_CONTROL));
+        setDictItem(eventDict, "alt", PyBool_FromLong(event->flags & PGL_EVENT_FLAG_ALT));
+        setDictItem(eventDict, "command", PyBool_FromLong(event->flags & PGL_EVENT_FLAG_COMMAND));
+        setDictItem(eventDict, "capsLock", PyBool_FromLong(event->flags & PGL_EVENT_FLAG_CAPSLOCK));
+    }
+    else if (pglInputEventIsMouseButton(event->type)) {
+        setDictItem(eventDict, "button", PyLong_FromLong(event->button));
+        setDictItem(eventDict, "clickState", PyLong_FromLong(event->clickState));
+        setDictItem(eventDict, "x", PyFloat_FromDouble(event->x));
+        setDictItem(eventDict, "y", PyFloat_FromDouble(event->y));
+    }
+    else if (pglInputEventIsMouseMove(event->type)) {
+        setDictItem(eventDict, "x", PyFloat_FromDouble(event->x));
+        setDictItem(eventDict, "y", PyFloat_FromDouble(event->y));
+    }
     
-    // Return NULL to suppress event, or event to pass it through
-    return returnEvent;
+    return eventDict;
 }
 
 /*
@@ -359,18 +546,52 @@ static PyMethodDef listenerMethods[] = {
     {"stop", listenerStop, METH_NOARGS, "Stop the event listener"},
     {"isRunning", listenerIsRunning, METH_NOARGS, "Check if listener is running"},
     {"setEatKeys", listenerSetEatKeys, METH_VARARGS, "Set which keys to suppress from OS"},
+    {"postEvent", listenerPostEvent, METH_VARARGS, "Post a synthetic event dictionary (Linux backend only)"},
+    {"getBackendName", listenerGetBackendName, METH_NOARGS, "Get the name of the platform event backend"},
+    {"publishOnset", listenerPublishOnset, METH_VARARGS, "Publish the presentation time and id of a stimulus onset"},
+    {"clearOnsets", listenerClearOnsets, METH_NOARGS, "Forget all published stimulus onsets"},
+    {"onsetLatency", listenerOnsetLatency, METH_VARARGS, "Get (latency, onsetId) of a timestamp from the most recent onset, or None"},
+    {"setThreadPolicy", (PyCFunction)(void(*)(void))listenerSetThreadPolicy, METH_VARARGS | METH_KEYWORDS, "Set the scheduling policy (and core) of the event thread, applied at start or at the next event"},
+    {"getThreadPolicyStatus", listenerGetThreadPolicyStatus, METH_NOARGS, "Get (applied, errorMessage) for the event thread scheduling policy"},
      {NULL, NULL, 0, NULL}
 };
 
+/*
+ * Module free - if the interpreter that owns the listener is going
+ * away, stop the listener so the event thread does not call into it
+ */
+static void listenerFree(void *module) {
+    stopListener(PyInterpreterState_Get());
+}
+
+/*
+ * Module slots (multi-phase init). All state is process-wide and
+ * guarded by mutexes, so the module is safe without the GIL and in
+ * subinterpreters with their own GIL
+ */
+static PyModuleDef_Slot listenerSlots[] = {
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
 /*
  * Module definition
  */
 static struct PyModuleDef listenerModule = {
     PyModuleDef_HEAD_INIT,
     "_pglEventListener",
-    "macOS event tap listener (C extension)",
-    -1,
-    listenerMethods
+    "Keyboard and mouse event listener (C extension)",
+    0,
+    listenerMethods,
+    listenerSlots,
+    NULL,
+    NULL,
+    listenerFree
 };
 
 /*
@@ -382,5 +603,5 @@ PyMODINIT_FUNC PyInit__pglEventListener(void) {
     PyEval_InitThreads();
     #endif
     
-    return PyModule_Create(&listenerModule);
-}
\ No newline at end of file
+    return PyModuleDef_Init(&listenerModule);
+}
@@ -2,15 +2,10 @@
 //   include section   //
 /////////////////////////
 #include <Python.h>
-#import <Cocoa/Cocoa.h>
-#import <CoreGraphics/CoreGraphics.h>
+#include <stdlib.h>
 #define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
 #include <numpy/arrayobject.h>
-
-////////////////////////
-//   define section   //
-////////////////////////
-#define kMaxDisplays 16
+#include "_pglDisplay.h"
 
 ///////////////////////////////
 //   function declarations   //
@@ -23,12 +18,20 @@ static PyObject* getGammaTableSize(PyObject* self, PyObject* args);
 //////////////////////////
 //   helper functions   //
 //////////////////////////
-CGDirectDisplayID getDisplayID(int whichScreen);
+static int checkDisplay(int displayNumber, const char* caller);
 
 //////////////////////
-// global variables //
+//   module state   //
 //////////////////////
-int verbose = 1;
+// per-interpreter state (replaces the old process-wide verbose global)
+typedef struct {
+  int verbose;
+} gammaTableState;
+
+static inline gammaTableState* getState(PyObject* module)
+{
+  return (gammaTableState*)PyModule_GetState(module);
+}
 
 ///////////////////////////////
 //   Python Object Defs      //
@@ -42,17 +45,42 @@ static PyMethodDef GammaTableMethods[] = {
     {NULL, NULL, 0, NULL}
 };
 
+// Module exec function, run once for each interpreter that imports the module
+static int gammaTableExec(PyObject* module)
+{
+  // set default verbose level
+  getState(module)->verbose = 1;
+
+  // Initialize NumPy C API
+  import_array1(-1);
+  return 0;
+}
+
+// Module slots (multi-phase init). numpy does not support running under
+// a per-interpreter GIL, so only shared-GIL subinterpreters are allowed
+static PyModuleDef_Slot GammaTableSlots[] = {
+    {Py_mod_exec, gammaTableExec},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_MULTIPLE_INTERPRETERS_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
 // Module definition
 static struct PyModuleDef GammaTableModule = {
     PyModuleDef_HEAD_INIT,
     "_pglGammaTable",
     "Gamma Table Module",
-    -1,
-    GammaTableMethods
+    sizeof(gammaTableState),
+    GammaTableMethods,
+    GammaTableSlots
 };
 
 PyMODINIT_FUNC PyInit__pglGammaTable(void) {
-    return PyModule_Create(&GammaTableModule);
+    return PyModuleDef_Init(&GammaTableModule);
 }
 
 ////////////////////////////
@@ -64,12 +92,13 @@ static PyObject* setVerbose(PyObject* self, PyObject* args)
   int newVerbose;
   if (!PyArg_ParseTuple(args, "i", &newVerbose)) return NULL;
 
-  // set the global verbose variable
-  verbose = newVerbose;
+  // set the verbose level in the module state
+  gammaTableState *state = getState(self);
+  state->verbose = newVerbose;
 
   // print a message if verbose is set to a high level
-  if (verbose > 1)
-    printf("(pgl:resolution:setVerbose) Verbose level set to %d\n", verbose);
+  if (state->verbose > 1)
+    printf("(pgl:_pglGammaTable:setVerbose) Verbose level set to %d\n", state->verbose);
 
   // return success
   Py_INCREF(Py_True); return Py_True;
@@ -88,18 +117,10 @@ static PyObject* setGammaTable(PyObject* self, PyObject* args)
         return NULL;
     }
 
-    // Get display ID
-    CGDirectDisplayID whichDisplay = getDisplayID(displayNumber);
-    if (whichDisplay == kCGNullDirectDisplay) {
-        PyErr_SetString(PyExc_ValueError, "(_pglGammaTable:setGammaTable)Invalid display index");
-        return NULL;
-    }
-
-
-    // Initialize NumPy C API
-    import_array(); 
+    // Check display
+    if (!checkDisplay(displayNumber, "setGammaTable")) return NULL;
 
-    // Convert to contiguous float32 arrays (CGGammaValue)
+    // Convert to contiguous float32 arrays
     PyArrayObject *redArray = (PyArrayObject*)PyArray_FROM_OTF(pyRed, NPY_FLOAT32, NPY_ARRAY_IN_ARRAY);
     PyArrayObject *greenArray = (PyArrayObject*)PyArray_FROM_OTF(pyGreen, NPY_FLOAT32, NPY_ARRAY_IN_ARRAY);
     PyArrayObject *blueArray = (PyArrayObject*)PyArray_FROM_OTF(pyBlue, NPY_FLOAT32, NPY_ARRAY_IN_ARRAY);
@@ -113,26 +134,26 @@ static PyObject* setGammaTable(PyObject* self, PyObject* args)
     }
 
     // Get gamma table capacity
-    npy_intp numEntries = (npy_intp)CGDisplayGammaTableCapacity(whichDisplay);
+    npy_intp numEntries = (npy_intp)pglDisplayGetGammaTableSize(displayNumber);
 
     // Ensure all arrays have the correct number of entries
-    if (PyArray_SIZE(greenArray) != numEntries || PyArray_SIZE(blueArray) != numEntries) {
+    if (PyArray_SIZE(redArray) != numEntries || PyArray_SIZE(greenArray) != numEntries || PyArray_SIZE(blueArray) != numEntries) {
         Py_DECREF(redArray); Py_DECREF(greenArray); Py_DECREF(blueArray);
         PyErr_SetString(PyExc_ValueError, "(_pglGammaTable:setGammaTable) Red, green, and blue arrays must have the same length");
         return NULL;
     }
 
-    // Get raw pointers to CGGammaValue
-    CGGammaValue *redPtr = (CGGammaValue*)PyArray_DATA(redArray);
-    CGGammaValue *greenPtr = (CGGammaValue*)PyArray_DATA(greenArray);
-    CGGammaValue *bluePtr = (CGGammaValue*)PyArray_DATA(blueArray);
+    // Get raw pointers
+    float *redPtr = (float*)PyArray_DATA(redArray);
+    float *greenPtr = (float*)PyArray_DATA(greenArray);
+    float *bluePtr = (float*)PyArray_DATA(blueArray);
 
     // Apply the gamma table
-    CGError err = CGSetDisplayTransferByTable(whichDisplay, (uint32_t)numEntries, redPtr, greenPtr, bluePtr);
+    int err = pglDisplaySetGammaTable(displayNumber, redPtr, greenPtr, bluePtr, (int)numEntries);
 
     Py_DECREF(redArray); Py_DECREF(greenArray); Py_DECREF(blueArray);
 
-    if (err != kCGErrorSuccess) {
+    if (err != 0) {
         PyErr_Format(PyExc_RuntimeError, "Failed to set gamma table (error=%d)", err);
         return NULL;
     }
@@ -149,40 +170,32 @@ static PyObject* getGammaTable(PyObject* self, PyObject* args)
     int displayNumber = 0;
     if (!PyArg_ParseTuple(args, "i", &displayNumber)) return NULL;
 
-    // Get the display
-    CGDirectDisplayID whichDisplay = getDisplayID(displayNumber);
-    if (whichDisplay == kCGNullDirectDisplay) {
-        PyErr_SetString(PyExc_ValueError, "(_pglGammaTable:getGammaTable) Invalid display index");
-        return NULL;
-    }
+    // Check display
+    if (!checkDisplay(displayNumber, "getGammaTable")) return NULL;
 
     // Get gamma table capacity
-    size_t gammaTableSize = CGDisplayGammaTableCapacity(whichDisplay);
+    int gammaTableSize = pglDisplayGetGammaTableSize(displayNumber);
+    if (gammaTableSize <= 0) {
+        PyErr_SetString(PyExc_RuntimeError, "(_pglGammaTable:getGammaTable) Could not get gamma table size");
+        return NULL;
+    }
 
     // allocate tables
-    CGGammaValue *redTable = (CGGammaValue *)malloc(sizeof(CGGammaValue) * gammaTableSize);
-    CGGammaValue *greenTable = (CGGammaValue *)malloc(sizeof(CGGammaValue) * gammaTableSize);
-    CGGammaValue *blueTable = (CGGammaValue *)malloc(sizeof(CGGammaValue) * gammaTableSize);
+    float *redTable = (float *)malloc(sizeof(float) * gammaTableSize);
+    float *greenTable = (float *)malloc(sizeof(float) * gammaTableSize);
+    float *blueTable = (float *)malloc(sizeof(float) * gammaTableSize);
     if (!redTable || !greenTable || !blueTable) {
         free(redTable); free(greenTable); free(blueTable);
         PyErr_SetString(PyExc_MemoryError, "(_pglGammaTable:getGammaTable)Failed to allocate gamma tables");
         return NULL;
     }
 
-    uint32_t sampleCount = 0;
-    CGError err = CGGetDisplayTransferByTable(
-        whichDisplay,
-        (uint32_t)gammaTableSize,
-        redTable,
-        greenTable,
-        blueTable,
-        &sampleCount
-    );
+    int sampleCount = pglDisplayGetGammaTable(displayNumber, redTable, greenTable, blueTable, gammaTableSize);
 
     // check for error
-    if (err != kCGErrorSuccess) {
+    if (sampleCount < 0) {
         free(redTable); free(greenTable); free(blueTable);
-        PyErr_Format(PyExc_RuntimeError, "(_pglGammaTable:getGammaTable)Error getting gamma table (error=%d)", err);
+        PyErr_SetString(PyExc_RuntimeError, "(_pglGammaTable:getGammaTable)Error getting gamma table");
         return NULL;
     }
 
@@ -190,7 +203,7 @@ static PyObject* getGammaTable(PyObject* self, PyObject* args)
     PyObject *pyRed = PyList_New(sampleCount);
     PyObject *pyGreen = PyList_New(sampleCount);
     PyObject *pyBlue = PyList_New(sampleCount);
-    for (uint32_t i = 0; i < sampleCount; i++) {
+    for (int i = 0; i < sampleCount; i++) {
         PyList_SET_ITEM(pyRed, i, PyFloat_FromDouble(redTable[i]));
         PyList_SET_ITEM(pyGreen, i, PyFloat_FromDouble(greenTable[i]));
         PyList_SET_ITEM(pyBlue, i, PyFloat_FromDouble(blueTable[i]));
@@ -217,42 +230,31 @@ static PyObject* getGammaTableSize(PyObject* self, PyObject* args)
     int displayNumber = 0;
     if (!PyArg_ParseTuple(args, "i", &displayNumber)) return NULL;
 
-    // Get the display
-    CGDirectDisplayID whichDisplay = getDisplayID(displayNumber);
-    if (whichDisplay == kCGNullDirectDisplay) {
-        PyErr_SetString(PyExc_ValueError, "(_pglGammaTable:getGammaTable) Invalid display index");
-        return NULL;
-    }
+    // Check display
+    if (!checkDisplay(displayNumber, "getGammaTableSize")) return NULL;
 
     // Get gamma table capacity
-    size_t gammaTableSize = CGDisplayGammaTableCapacity(whichDisplay);
-
-    return PyLong_FromSize_t(gammaTableSize);}
+    return PyLong_FromLong(pglDisplayGetGammaTableSize(displayNumber));
+}
 
 //////////////////////////////
-//   getDisplayID function  //
+//   checkDisplay function  //
 //////////////////////////////
-CGDirectDisplayID getDisplayID(int displayNumber) 
+static int checkDisplay(int displayNumber, const char* caller)
 {
-    // Get list of active displays
-    CGDirectDisplayID displays[kMaxDisplays];
-    uint32_t numDisplays = 0;
-
-    CGError err = CGGetActiveDisplayList(kMaxDisplays, displays, &numDisplays);
-    if (err != kCGErrorSuccess || numDisplays == 0) {
-        PyErr_SetString(PyExc_RuntimeError, "(_pglGammaTable:getDisplayID) Unable to get active displays");
-        return  kCGNullDirectDisplay;
+    // Get number of active displays
+    int numDisplays = pglDisplayGetCount();
+    if (numDisplays <= 0) {
+        PyErr_Format(PyExc_RuntimeError, "(_pglGammaTable:%s) Unable to get active displays", caller);
+        return 0;
     }
 
-    // Select which display
-    CGDirectDisplayID whichDisplay;
-    if (displayNumber < numDisplays) {
-        whichDisplay = displays[displayNumber];
-    } else {
+    // check display index
+    if ((displayNumber < 0) || (displayNumber >= numDisplays)) {
         PyErr_Format(PyExc_ValueError,
-                     "(_pglGammaTable:getDisplayID) Display index %d out of range (0-%d)",
-                     displayNumber, numDisplays);
-        return kCGNullDirectDisplay;
+                     "(_pglGammaTable:%s) Display index %d out of range (0-%d)",
+                     caller, displayNumber, numDisplays);
+        return 0;
     }
-    return whichDisplay;
+    return 1;
 }
@@ -0,0 +1,166 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglNoise.c
+//
+//  Python layer over the noise frame generator in _pglNoiseCore.c.
+//  generate makes frames of 8 bit levels (on several threads, with
+//  the GIL released) and expand turns levels into the RGBA float
+//  values a texture takes
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <Python.h>
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+#include "_pglNoiseCore.h"
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+static PyObject* generate(PyObject* self, PyObject* args, PyObject* kwargs);
+static PyObject* expand(PyObject* self, PyObject* args);
+static PyObject* processorCount(PyObject* self, PyObject* args);
+
+///////////////////////////////
+//   Python Object Defs      //
+///////////////////////////////
+// Method table
+static PyMethodDef NoiseMethods[] = {
+    {"generate", (PyCFunction)(void(*)(void))generate, METH_VARARGS | METH_KEYWORDS, "Make nFrames x height x width uint8 noise frames (seeded per frame) filtered by an amplitude spectrum (None for white)"},
+    {"expand", expand, METH_VARARGS, "Expand uint8 levels to float32 RGBA through a 256 x 4 table"},
+    {"processorCount", processorCount, METH_NOARGS, "Number of processors"},
+    {NULL, NULL, 0, NULL}
+};
+
+// Module exec function, run once for each interpreter that imports the module
+static int noiseExec(PyObject* module)
+{
+  // Initialize NumPy C API
+  import_array1(-1);
+  return 0;
+}
+
+// Module slots (multi-phase init). numpy does not support running under
+// a per-interpreter GIL, so only shared-GIL subinterpreters are allowed
+static PyModuleDef_Slot NoiseSlots[] = {
+    {Py_mod_exec, noiseExec},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_MULTIPLE_INTERPRETERS_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
+// Module definition
+static struct PyModuleDef NoiseModule = {
+    PyModuleDef_HEAD_INIT,
+    "_pglNoise",
+    "Dynamic noise frame generation",
+    0,
+    NoiseMethods,
+    NoiseSlots
+};
+
+PyMODINIT_FUNC PyInit__pglNoise(void) {
+    return PyModuleDef_Init(&NoiseModule);
+}
+
+///////////////////////////
+//   generate function   //
+///////////////////////////
+static PyObject* generate(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    static char* keywords[] = {"width", "height", "nFrames", "seed", "firstFrame", "contrast", "amplitude", "nThreads", NULL};
+    int width, height, nFrames, nThreads = 0;
+    unsigned long long seed;
+    long firstFrame = 0;
+    double contrast = 0.25;
+    PyObject *pyAmplitude = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "iiiK|ldOi", keywords, &width, &height, &nFrames, &seed, &firstFrame, &contrast, &pyAmplitude, &nThreads)) return NULL;
+    if ((width <= 0) || (height <= 0) || (nFrames < 0) || (firstFrame < 0)) {
+        PyErr_SetString(PyExc_ValueError, "(_pglNoise:generate) width and height must be positive, nFrames and firstFrame not negative");
+        return NULL;
+    }
+
+    pglNoiseParams params = {width, height, NULL, 0, 0, contrast, (uint64_t)seed};
+    PyArrayObject *amplitude = NULL;
+    if (pyAmplitude != Py_None) {
+        amplitude = (PyArrayObject*)PyArray_FROM_OTF(pyAmplitude, NPY_FLOAT32, NPY_ARRAY_IN_ARRAY);
+        if (!amplitude) return NULL;
+        int fh = (PyArray_NDIM(amplitude) == 2) ? (int)PyArray_DIM(amplitude, 0) : 0;
+        int fw = (PyArray_NDIM(amplitude) == 2) ? (int)PyArray_DIM(amplitude, 1) : 0;
+        if ((fw < width) || (fh < height) || (fw & (fw - 1)) || (fh & (fh - 1))) {
+            Py_DECREF(amplitude);
+            PyErr_SetString(PyExc_ValueError, "(_pglNoise:generate) amplitude must be a 2D array with power of 2 sides at least height x width");
+            return NULL;
+        }
+        params.amplitude = (const float*)PyArray_DATA(amplitude);
+        params.fftWidth = fw;
+        params.fftHeight = fh;
+    }
+
+    npy_intp dims[3] = {nFrames, height, width};
+    PyObject *frames = PyArray_SimpleNew(3, dims, NPY_UINT8);
+    if (!frames) {
+        Py_XDECREF(amplitude);
+        return NULL;
+    }
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = pglNoiseGenerate(&params, firstFrame, nFrames, nThreads, (uint8_t*)PyArray_DATA((PyArrayObject*)frames));
+    Py_END_ALLOW_THREADS
+    Py_XDECREF(amplitude);
+    if (status != 0) {
+        Py_DECREF(frames);
+        return PyErr_NoMemory();
+    }
+    return frames;
+}
+
+/////////////////////////
+//   expand function   //
+/////////////////////////
+static PyObject* expand(PyObject* self, PyObject* args)
+{
+    PyObject *pyLevels, *pyTable;
+    if (!PyArg_ParseTuple(args, "OO", &pyLevels, &pyTable)) return NULL;
+    PyArrayObject *levels = (PyArrayObject*)PyArray_FROM_OTF(pyLevels, NPY_UINT8, NPY_ARRAY_IN_ARRAY);
+    if (!levels) return NULL;
+    PyArrayObject *table = (PyArrayObject*)PyArray_FROM_OTF(pyTable, NPY_FLOAT32, NPY_ARRAY_IN_ARRAY);
+    if (!table) {
+        Py_DECREF(levels);
+        return NULL;
+    }
+    if (PyArray_SIZE(table) != 256 * 4) {
+        Py_DECREF(levels); Py_DECREF(table);
+        PyErr_SetString(PyExc_ValueError, "(_pglNoise:expand) table must be 256 x 4");
+        return NULL;
+    }
+
+    // same shape with RGBA added
+    int nDims = PyArray_NDIM(levels);
+    npy_intp dims[NPY_MAXDIMS];
+    for (int i = 0; i < nDims; i++) dims[i] = PyArray_DIM(levels, i);
+    dims[nDims] = 4;
+    PyObject *values = PyArray_SimpleNew(nDims + 1, dims, NPY_FLOAT32);
+    if (!values) {
+        Py_DECREF(levels); Py_DECREF(table);
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    pglNoiseExpand((const uint8_t*)PyArray_DATA(levels), (long)PyArray_SIZE(levels), (const float*)PyArray_DATA(table), (float*)PyArray_DATA((PyArrayObject*)values));
+    Py_END_ALLOW_THREADS
+    Py_DECREF(levels); Py_DECREF(table);
+    return values;
+}
+
+/////////////////////////////////
+//   processorCount function   //
+/////////////////////////////////
+static PyObject* processorCount(PyObject* self, PyObject* args)
+{
+    return PyLong_FromLong(pglNoiseProcessorCount());
+}
@@ -0,0 +1,274 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglNoiseCore.c
+//
+//  Portable noise frame generator (see _pglNoiseCore.h)
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "_pglNoiseCore.h"
+
+////////////////////////
+//   define section   //
+////////////////////////
+#define kMaxThreads 64
+
+// an FFT of one size: twiddle factors and bit reversed order
+typedef struct {
+  int n;
+  double* cosTable;
+  double* sinTable;
+  int* reversed;
+} pglNoiseFFT;
+
+// what each thread does
+typedef struct {
+  const pglNoiseParams* params;
+  long firstFrame;
+  int nFrames, thread, nThreads, status;
+  uint8_t* out;
+} pglNoiseWork;
+
+///////////////////////////
+//   random numbers      //
+///////////////////////////
+// splitmix64 to spread seeds, xoshiro256** for the noise
+static inline uint64_t splitmix64(uint64_t* state)
+{
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+static inline uint64_t xoshiroNext(uint64_t s[4])
+{
+  uint64_t result = rotl(s[1] * 5, 7) * 9, t = s[1] << 17;
+  s[2] ^= s[0]; s[3] ^= s[1]; s[1] ^= s[2]; s[0] ^= s[3];
+  s[2] ^= t; s[3] = rotl(s[3], 45);
+  return result;
+}
+
+// state for one frame (or pair of frames) of a sequence
+static void seedFrame(uint64_t s[4], uint64_t seed, uint64_t frame)
+{
+  uint64_t state = seed;
+  uint64_t mixed = splitmix64(&state) ^ frame;
+  for (int i = 0; i < 4; i++) s[i] = splitmix64(&mixed);
+}
+
+// two independent standard normal numbers (Box-Muller)
+static inline void gaussianPair(uint64_t s[4], double* a, double* b)
+{
+  double u = ((xoshiroNext(s) >> 11) + 1) * (1.0 / 9007199254740992.0);
+  double v = (xoshiroNext(s) >> 11) * (2 * M_PI / 9007199254740992.0);
+  double r = sqrt(-2 * log(u));
+  *a = r * cos(v);
+  *b = r * sin(v);
+}
+
+///////////////////////////
+//   fft                 //
+///////////////////////////
+static int fftInit(pglNoiseFFT* fft, int n)
+{
+  fft->n = n;
+  fft->cosTable = malloc(sizeof(double) * n / 2 + sizeof(double));
+  fft->sinTable = malloc(sizeof(double) * n / 2 + sizeof(double));
+  fft->reversed = malloc(sizeof(int) * n);
+  if (!fft->cosTable || !fft->sinTable || !fft->reversed) return -1;
+  // inverse transform, so the twiddles turn the positive way
+  for (int i = 0; i < n / 2; i++) {
+    fft->cosTable[i] = cos(2 * M_PI * i / n);
+    fft->sinTable[i] = sin(2 * M_PI * i / n);
+  }
+  int bits = 0;
+  while ((1 << bits) < n) bits++;
+  for (int i = 0; i < n; i++) {
+    int r = 0;
+    for (int b = 0; b < bits; b++) if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+    fft->reversed[i] = r;
+  }
+  return 0;
+}
+
+static void fftFree(pglNoiseFFT* fft)
+{
+  free(fft->cosTable); free(fft->sinTable); free(fft->reversed);
+}
+
+// unnormalized inverse FFT in place
+static void fftInverse(const pglNoiseFFT* fft, double* re, double* im)
+{
+  int n = fft->n;
+  for (int i = 0; i < n; i++) {
+    int j = fft->reversed[i];
+    if (j > i) {
+      double t = re[i]; re[i] = re[j]; re[j] = t;
+      t = im[i]; im[i] = im[j]; im[j] = t;
+    }
+  }
+  for (int size = 2; size <= n; size *= 2) {
+    int half = size / 2, step = n / size;
+    for (int start = 0; start < n; start += size) {
+      for (int k = 0; k < half; k++) {
+        double c = fft->cosTable[k * step], s = fft->sinTable[k * step];
+        int a = start + k, b = a + half;
+        double tr = re[b] * c - im[b] * s, ti = re[b] * s + im[b] * c;
+        re[b] = re[a] - tr; im[b] = im[a] - ti;
+        re[a] += tr; im[a] += ti;
+      }
+    }
+  }
+}
+
+///////////////////////////
+//   toLevel             //
+///////////////////////////
+static inline uint8_t toLevel(double value)
+{
+  double level = 128 + 127 * value;
+  if (level < 1) level = 1;
+  if (level > 255) level = 255;
+  return (uint8_t)lrint(level);
+}
+
+///////////////////////////
+//   generateWork        //
+///////////////////////////
+// make the frames that fall to one thread
+static void* generateWork(void* arg)
+{
+  pglNoiseWork* work = (pglNoiseWork*)arg;
+  const pglNoiseParams* p = work->params;
+  long frameSize = (long)p->width * p->height;
+  uint64_t s[4];
+  work->status = 0;
+
+  // white noise: every level is drawn on its own
+  if (p->amplitude == NULL) {
+    for (int i = work->thread; i < work->nFrames; i += work->nThreads) {
+      uint8_t* frame = work->out + i * frameSize;
+      seedFrame(s, p->seed, (uint64_t)(work->firstFrame + i));
+      for (long j = 0; j < frameSize; j += 2) {
+        double a, b;
+        gaussianPair(s, &a, &b);
+        frame[j] = toLevel(p->contrast * a);
+        if (j + 1 < frameSize) frame[j + 1] = toLevel(p->contrast * b);
+      }
+    }
+    return NULL;
+  }
+
+  // filtered noise: each inverse FFT makes a pair of frames (its real
+  // and imaginary parts are independent), seeded by the pair number
+  int fw = p->fftWidth, fh = p->fftHeight;
+  long n = (long)fw * fh;
+  pglNoiseFFT rowFFT, columnFFT;
+  double *re = malloc(sizeof(double) * n), *im = malloc(sizeof(double) * n);
+  double *columnRe = malloc(sizeof(double) * fh), *columnIm = malloc(sizeof(double) * fh);
+  int ok = re && im && columnRe && columnIm && (fftInit(&rowFFT, fw) == 0) && (fftInit(&columnFFT, fh) == 0);
+  if (ok) {
+    // sd of either part of the inverse transform
+    double power = 0;
+    for (long k = 0; k < n; k++) power += (double)p->amplitude[k] * p->amplitude[k];
+    double scale = (power > 0) ? p->contrast / sqrt(power) : 0;
+
+    long firstPair = work->firstFrame / 2, lastPair = (work->firstFrame + work->nFrames - 1) / 2;
+    for (long pair = firstPair + work->thread; pair <= lastPair; pair += work->nThreads) {
+      seedFrame(s, p->seed, (uint64_t)pair);
+      for (long k = 0; k < n; k++) {
+        double a, b;
+        gaussianPair(s, &a, &b);
+        re[k] = a * p->amplitude[k];
+        im[k] = b * p->amplitude[k];
+      }
+      // rows, then only the columns that are kept
+      for (int row = 0; row < fh; row++) fftInverse(&rowFFT, re + (long)row * fw, im + (long)row * fw);
+      for (int column = 0; column < p->width; column++) {
+        for (int row = 0; row < fh; row++) {
+          columnRe[row] = re[(long)row * fw + column];
+          columnIm[row] = im[(long)row * fw + column];
+        }
+        fftInverse(&columnFFT, columnRe, columnIm);
+        for (int row = 0; row < p->height; row++) {
+          re[(long)row * fw + column] = columnRe[row];
+          im[(long)row * fw + column] = columnIm[row];
+        }
+      }
+      // the frames of this pair that were asked for
+      for (int part = 0; part < 2; part++) {
+        long frame = 2 * pair + part - work->firstFrame;
+        if ((frame < 0) || (frame >= work->nFrames)) continue;
+        const double* values = part ? im : re;
+        uint8_t* out = work->out + frame * frameSize;
+        for (int row = 0; row < p->height; row++)
+          for (int column = 0; column < p->width; column++)
+            out[(long)row * p->width + column] = toLevel(scale * values[(long)row * fw + column]);
+      }
+    }
+  }
+  else work->status = -1;
+  if (ok) {
+    fftFree(&rowFFT);
+    fftFree(&columnFFT);
+  }
+  free(re); free(im); free(columnRe); free(columnIm);
+  return NULL;
+}
+
+///////////////////////////
+//   pglNoiseGenerate    //
+///////////////////////////
+int pglNoiseGenerate(const pglNoiseParams* params, long firstFrame, int nFrames, int nThreads, uint8_t* out)
+{
+  if (nFrames <= 0) return 0;
+  if (nThreads <= 0) nThreads = pglNoiseProcessorCount();
+  if (nThreads > kMaxThreads) nThreads = kMaxThreads;
+  // no more threads than there is work for
+  int nJobs = (params->amplitude == NULL) ? nFrames : (int)((firstFrame + nFrames - 1) / 2 - firstFrame / 2 + 1);
+  if (nThreads > nJobs) nThreads = nJobs;
+
+  pglNoiseWork work[kMaxThreads];
+  pthread_t threads[kMaxThreads];
+  int started[kMaxThreads];
+  for (int t = 0; t < nThreads; t++) {
+    work[t] = (pglNoiseWork){params, firstFrame, nFrames, t, nThreads, 0, out};
+    // the calling thread does the first share itself
+    started[t] = (t > 0) && (pthread_create(&threads[t], NULL, generateWork, &work[t]) == 0);
+    if ((t > 0) && !started[t]) work[t].status = -1;
+  }
+  generateWork(&work[0]);
+
+  int status = work[0].status;
+  for (int t = 1; t < nThreads; t++) {
+    if (started[t]) pthread_join(threads[t], NULL);
+    if (work[t].status != 0) status = -1;
+  }
+  return status;
+}
+
+///////////////////////////
+//   pglNoiseExpand      //
+///////////////////////////
+void pglNoiseExpand(const uint8_t* levels, long n, const float* table, float* out)
+{
+  for (long i = 0; i < n; i++) memcpy(out + 4 * i, table + 4 * levels[i], 4 * sizeof(float));
+}
+
+/////////////////////////////////////
+//   pglNoiseProcessorCount        //
+/////////////////////////////////////
+int pglNoiseProcessorCount(void)
+{
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return (n > 0) ? (int)n : 1;
+}
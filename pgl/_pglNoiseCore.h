@@ -0,0 +1,54 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglNoiseCore.h
+//
+//  Portable generator for dynamic noise stimuli. Each frame is
+//  Gaussian noise filtered in the frequency domain: complex Gaussian
+//  coefficients are weighted by an amplitude spectrum (white, pink,
+//  band-pass, orientation, built by pglStimuli) and inverse FFTed.
+//  Frames are made from their own seed (the stimulus seed and the
+//  frame number), so any frame of a sequence can be made again on
+//  its own, on any thread, and come out the same. Frames are stored
+//  as 8 bit levels (128 is the background) and expanded to RGBA
+//  texture values through a 256 entry table when they are sent.
+/////////////////////////////////////////////////////////////////////
+#ifndef _PGLNOISECORE_H
+#define _PGLNOISECORE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  // size of the frames
+  int width, height;
+  // amplitude spectrum, fftHeight x fftWidth (both powers of 2 at
+  // least the frame size) in FFT order (zero frequency first), or
+  // NULL for white noise that is not filtered
+  const float* amplitude;
+  int fftWidth, fftHeight;
+  // RMS contrast: a level is 128 + 127 * contrast * noise / sd
+  double contrast;
+  uint64_t seed;
+} pglNoiseParams;
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+// Make nFrames frames, starting at frame firstFrame, into out (nFrames
+// x height x width levels) with nThreads threads (0 for one per
+// processor). Returns 0, or -1 if memory or a thread could not be had
+int pglNoiseGenerate(const pglNoiseParams* params, long firstFrame, int nFrames, int nThreads, uint8_t* out);
+
+// Expand n levels to n RGBA float values through table (256 x 4)
+void pglNoiseExpand(const uint8_t* levels, long n, const float* table, float* out);
+
+// Number of processors, for choosing threads
+int pglNoiseProcessorCount(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,201 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglPalette.c
+//
+//  Palette expansion of indexed images (e.g. the Eyelink camera
+//  image, which arrives one line of palette indexes at a time) into
+//  an RGBA float32 buffer in the layout mglMetal textures take, so
+//  that the buffer can be sent as is to update a texture. Works on
+//  any object with the buffer protocol (bytes, array.array, numpy)
+//  and does not need numpy itself
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <Python.h>
+#include <string.h>
+
+////////////////////////
+//   define section   //
+////////////////////////
+// indexes are bytes, so a palette never has more than this many entries
+#define kPaletteSize 256
+#define kChannels 4
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+static PyObject* expandLine(PyObject* self, PyObject* args);
+static PyObject* expandImage(PyObject* self, PyObject* args);
+
+//////////////////////////
+//   helper functions   //
+//////////////////////////
+static int getIndexes(PyObject* obj, Py_buffer* view, const char* caller);
+static int getPalette(PyObject* obj, Py_buffer* view, const char* caller);
+static int getImage(PyObject* obj, Py_buffer* view, Py_ssize_t minFloats, const char* caller);
+static void expand(const unsigned char* indexes, Py_ssize_t n, const float* palette, Py_ssize_t nPalette, float* out);
+
+///////////////////////////////
+//   Python Object Defs      //
+///////////////////////////////
+// Method table
+static PyMethodDef PaletteMethods[] = {
+    {"expandLine", expandLine, METH_VARARGS, "expandLine(indexes, palette, image, line, width): expand one line of palette indexes into row line of an RGBA float32 image"},
+    {"expandImage", expandImage, METH_VARARGS, "expandImage(indexes, palette, image): expand a whole image of palette indexes into an RGBA float32 image"},
+    {NULL, NULL, 0, NULL}
+};
+
+// Module slots (multi-phase init). The module has no mutable state,
+// so it can be loaded in any subinterpreter and does not need the GIL
+static PyModuleDef_Slot PaletteSlots[] = {
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
+// Module definition
+static struct PyModuleDef PaletteModule = {
+    PyModuleDef_HEAD_INIT,
+    "_pglPalette",
+    "Palette expansion of indexed images",
+    0,
+    PaletteMethods,
+    PaletteSlots
+};
+
+PyMODINIT_FUNC PyInit__pglPalette(void) {
+    return PyModuleDef_Init(&PaletteModule);
+}
+
+////////////////////////////
+//   expandLine function  //
+////////////////////////////
+static PyObject* expandLine(PyObject* self, PyObject* args)
+{
+    PyObject *pyIndexes, *pyPalette, *pyImage;
+    int line, width;
+    if (!PyArg_ParseTuple(args, "OOOii", &pyIndexes, &pyPalette, &pyImage, &line, &width)) return NULL;
+
+    // get the buffers
+    Py_buffer indexes, palette, image;
+    if (!getIndexes(pyIndexes, &indexes, "expandLine")) return NULL;
+    if (!getPalette(pyPalette, &palette, "expandLine")) {
+        PyBuffer_Release(&indexes);
+        return NULL;
+    }
+    if (!getImage(pyImage, &image, (Py_ssize_t)(line + 1) * width * kChannels, "expandLine")) {
+        PyBuffer_Release(&indexes); PyBuffer_Release(&palette);
+        return NULL;
+    }
+    if ((line < 0) || (width < 0) || (indexes.len < width)) {
+        PyBuffer_Release(&indexes); PyBuffer_Release(&palette); PyBuffer_Release(&image);
+        PyErr_Format(PyExc_ValueError, "(_pglPalette:expandLine) Need %d indexes for line %d, got %zd", width, line, indexes.len);
+        return NULL;
+    }
+
+    // expand into the row
+    expand((const unsigned char*)indexes.buf, width, (const float*)palette.buf, palette.len / (sizeof(float) * kChannels),
+           (float*)image.buf + (Py_ssize_t)line * width * kChannels);
+
+    PyBuffer_Release(&indexes); PyBuffer_Release(&palette); PyBuffer_Release(&image);
+    Py_RETURN_NONE;
+}
+
+/////////////////////////////
+//   expandImage function  //
+/////////////////////////////
+static PyObject* expandImage(PyObject* self, PyObject* args)
+{
+    PyObject *pyIndexes, *pyPalette, *pyImage;
+    if (!PyArg_ParseTuple(args, "OOO", &pyIndexes, &pyPalette, &pyImage)) return NULL;
+
+    // get the buffers
+    Py_buffer indexes, palette, image;
+    if (!getIndexes(pyIndexes, &indexes, "expandImage")) return NULL;
+    if (!getPalette(pyPalette, &palette, "expandImage")) {
+        PyBuffer_Release(&indexes);
+        return NULL;
+    }
+    if (!getImage(pyImage, &image, indexes.len * kChannels, "expandImage")) {
+        PyBuffer_Release(&indexes); PyBuffer_Release(&palette);
+        return NULL;
+    }
+
+    // one call for the whole image, without the GIL
+    Py_BEGIN_ALLOW_THREADS
+    expand((const unsigned char*)indexes.buf, indexes.len, (const float*)palette.buf, palette.len / (sizeof(float) * kChannels),
+           (float*)image.buf);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&indexes); PyBuffer_Release(&palette); PyBuffer_Release(&image);
+    Py_RETURN_NONE;
+}
+
+////////////////////////
+//   expand function  //
+////////////////////////
+// indexes past the end of the palette come out transparent black
+static void expand(const unsigned char* indexes, Py_ssize_t n, const float* palette, Py_ssize_t nPalette, float* out)
+{
+    static const float missing[kChannels] = {0, 0, 0, 0};
+    for (Py_ssize_t i = 0; i < n; i++, out += kChannels) {
+        const float* color = (indexes[i] < nPalette) ? palette + indexes[i] * kChannels : missing;
+        memcpy(out, color, sizeof(float) * kChannels);
+    }
+}
+
+//////////////////////////
+//   getIndexes function //
+//////////////////////////
+// indexes are one byte each (bytes, bytearray, array('B'), uint8 numpy)
+static int getIndexes(PyObject* obj, Py_buffer* view, const char* caller)
+{
+    if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0) return 0;
+    if (view->itemsize != 1) {
+        PyBuffer_Release(view);
+        PyErr_Format(PyExc_TypeError, "(_pglPalette:%s) indexes must be bytes (one byte per pixel)", caller);
+        return 0;
+    }
+    return 1;
+}
+
+//////////////////////////
+//   getPalette function //
+//////////////////////////
+// palette is a contiguous float32 array of nColors x 4 (RGBA)
+static int getPalette(PyObject* obj, Py_buffer* view, const char* caller)
+{
+    if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0) return 0;
+    if ((view->itemsize != sizeof(float)) || (view->format == NULL) || (strcmp(view->format, "f") != 0) ||
+        (view->len % (sizeof(float) * kChannels) != 0)) {
+        PyBuffer_Release(view);
+        PyErr_Format(PyExc_TypeError, "(_pglPalette:%s) palette must be a contiguous float32 array of nColors x %d", caller, kChannels);
+        return 0;
+    }
+    return 1;
+}
+
+////////////////////////
+//   getImage function //
+////////////////////////
+// image is a writeable contiguous float32 RGBA array with room for minFloats values
+static int getImage(PyObject* obj, Py_buffer* view, Py_ssize_t minFloats, const char* caller)
+{
+    if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE) < 0) return 0;
+    if ((view->itemsize != sizeof(float)) || (view->format == NULL) || (strcmp(view->format, "f") != 0)) {
+        PyBuffer_Release(view);
+        PyErr_Format(PyExc_TypeError, "(_pglPalette:%s) image must be a writeable contiguous float32 array", caller);
+        return 0;
+    }
+    if ((Py_ssize_t)(view->len / sizeof(float)) < minFloats) {
+        PyBuffer_Release(view);
+        PyErr_Format(PyExc_ValueError, "(_pglPalette:%s) image has %zd values, need at least %zd", caller, view->len / (Py_ssize_t)sizeof(float), minFloats);
+        return 0;
+    }
+    return 1;
+}
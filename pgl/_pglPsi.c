@@ -0,0 +1,288 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglPsi.c
+//
+//  Python layer over the Psi / QUEST+ engine in _pglPsiCore.c. The
+//  posterior and likelihood tables are numpy arrays owned by Python
+//  (pglStaircasePsi) and are updated in place here with the GIL
+//  released, so nothing is copied between trials
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <Python.h>
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+#include "_pglPsiCore.h"
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+static PyObject* weibullTable(PyObject* self, PyObject* args);
+static PyObject* logTables(PyObject* self, PyObject* args);
+static PyObject* update(PyObject* self, PyObject* args);
+static PyObject* selectStimulus(PyObject* self, PyObject* args);
+static PyObject* entropy(PyObject* self, PyObject* args);
+
+//////////////////////////
+//   helper functions   //
+//////////////////////////
+static PyArrayObject* checkArray(PyObject* obj, const char* name, const char* caller, npy_intp size, int writeable);
+static PyArrayObject* toDoubleArray(PyObject* obj, const char* name, const char* caller);
+
+///////////////////////////////
+//   Python Object Defs      //
+///////////////////////////////
+// Method table
+static PyMethodDef PsiMethods[] = {
+    {"weibullTable", weibullTable, METH_VARARGS, "Compute likelihood tables (pCorrect, logCorrect, logIncorrect) for a Weibull over a parameter grid"},
+    {"logTables", logTables, METH_VARARGS, "Compute log likelihood tables from a pCorrect table"},
+    {"update", update, METH_VARARGS, "Update a posterior in place with a response, returns the probability of the response"},
+    {"selectStimulus", selectStimulus, METH_VARARGS, "Return the stimulus index that minimizes the expected posterior entropy"},
+    {"entropy", entropy, METH_VARARGS, "Entropy of a posterior"},
+    {NULL, NULL, 0, NULL}
+};
+
+// Module exec function, run once for each interpreter that imports the module
+static int psiExec(PyObject* module)
+{
+  // Initialize NumPy C API
+  import_array1(-1);
+  return 0;
+}
+
+// Module slots (multi-phase init). numpy does not support running under
+// a per-interpreter GIL, so only shared-GIL subinterpreters are allowed
+static PyModuleDef_Slot PsiSlots[] = {
+    {Py_mod_exec, psiExec},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_MULTIPLE_INTERPRETERS_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
+// Module definition
+static struct PyModuleDef PsiModule = {
+    PyModuleDef_HEAD_INIT,
+    "_pglPsi",
+    "Psi / QUEST+ adaptive staircase engine",
+    0,
+    PsiMethods,
+    PsiSlots
+};
+
+PyMODINIT_FUNC PyInit__pglPsi(void) {
+    return PyModuleDef_Init(&PsiModule);
+}
+
+//////////////////////////////
+//   weibullTable function  //
+//////////////////////////////
+static PyObject* weibullTable(PyObject* self, PyObject* args)
+{
+    PyObject *pyStimuli, *pyThresholds, *pySlopes, *pyLapses;
+    double guess;
+    if (!PyArg_ParseTuple(args, "OOOOd", &pyStimuli, &pyThresholds, &pySlopes, &pyLapses, &guess)) return NULL;
+
+    // convert the grids
+    PyArrayObject *stimuli = toDoubleArray(pyStimuli, "stimuli", "weibullTable");
+    PyArrayObject *thresholds = toDoubleArray(pyThresholds, "thresholds", "weibullTable");
+    PyArrayObject *slopes = toDoubleArray(pySlopes, "slopes", "weibullTable");
+    PyArrayObject *lapses = toDoubleArray(pyLapses, "lapses", "weibullTable");
+    if (!stimuli || !thresholds || !slopes || !lapses) {
+        Py_XDECREF(stimuli); Py_XDECREF(thresholds); Py_XDECREF(slopes); Py_XDECREF(lapses);
+        return NULL;
+    }
+
+    // allocate the tables
+    npy_intp nParams = PyArray_SIZE(thresholds) * PyArray_SIZE(slopes) * PyArray_SIZE(lapses);
+    npy_intp dims[2] = {PyArray_SIZE(stimuli), nParams};
+    PyObject *pCorrect = PyArray_SimpleNew(2, dims, NPY_FLOAT64);
+    PyObject *logCorrect = PyArray_SimpleNew(2, dims, NPY_FLOAT64);
+    PyObject *logIncorrect = PyArray_SimpleNew(2, dims, NPY_FLOAT64);
+    if (!pCorrect || !logCorrect || !logIncorrect) {
+        Py_XDECREF(pCorrect); Py_XDECREF(logCorrect); Py_XDECREF(logIncorrect);
+        Py_DECREF(stimuli); Py_DECREF(thresholds); Py_DECREF(slopes); Py_DECREF(lapses);
+        return NULL;
+    }
+
+    // fill them
+    Py_BEGIN_ALLOW_THREADS
+    pglPsiWeibullTable((double*)PyArray_DATA(stimuli), (int)PyArray_SIZE(stimuli),
+                       (double*)PyArray_DATA(thresholds), (int)PyArray_SIZE(thresholds),
+                       (double*)PyArray_DATA(slopes), (int)PyArray_SIZE(slopes),
+                       (double*)PyArray_DATA(lapses), (int)PyArray_SIZE(lapses),
+                       guess,
+                       (double*)PyArray_DATA((PyArrayObject*)pCorrect),
+                       (double*)PyArray_DATA((PyArrayObject*)logCorrect),
+                       (double*)PyArray_DATA((PyArrayObject*)logIncorrect));
+    Py_END_ALLOW_THREADS
+
+    Py_DECREF(stimuli); Py_DECREF(thresholds); Py_DECREF(slopes); Py_DECREF(lapses);
+
+    // return as tuple (pCorrect, logCorrect, logIncorrect)
+    PyObject *result = PyTuple_Pack(3, pCorrect, logCorrect, logIncorrect);
+    Py_DECREF(pCorrect); Py_DECREF(logCorrect); Py_DECREF(logIncorrect);
+    return result;
+}
+
+///////////////////////////
+//   logTables function  //
+///////////////////////////
+static PyObject* logTables(PyObject* self, PyObject* args)
+{
+    PyObject *pyCorrect;
+    if (!PyArg_ParseTuple(args, "O", &pyCorrect)) return NULL;
+
+    // the table is clamped in place, so it has to be ours to write
+    PyArrayObject *pCorrect = checkArray(pyCorrect, "pCorrect", "logTables", -1, 1);
+    if (!pCorrect) return NULL;
+    PyObject *logCorrect = PyArray_SimpleNew(PyArray_NDIM(pCorrect), PyArray_DIMS(pCorrect), NPY_FLOAT64);
+    PyObject *logIncorrect = PyArray_SimpleNew(PyArray_NDIM(pCorrect), PyArray_DIMS(pCorrect), NPY_FLOAT64);
+    if (!logCorrect || !logIncorrect) {
+        Py_XDECREF(logCorrect); Py_XDECREF(logIncorrect);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    pglPsiLogTables((double*)PyArray_DATA(pCorrect), (long)PyArray_SIZE(pCorrect),
+                    (double*)PyArray_DATA((PyArrayObject*)logCorrect),
+                    (double*)PyArray_DATA((PyArrayObject*)logIncorrect));
+    Py_END_ALLOW_THREADS
+
+    PyObject *result = PyTuple_Pack(2, logCorrect, logIncorrect);
+    Py_DECREF(logCorrect); Py_DECREF(logIncorrect);
+    return result;
+}
+
+////////////////////////
+//   update function  //
+////////////////////////
+static PyObject* update(PyObject* self, PyObject* args)
+{
+    PyObject *pyPosterior, *pyCorrect;
+    int stimulusIndex, response;
+    if (!PyArg_ParseTuple(args, "OOip", &pyPosterior, &pyCorrect, &stimulusIndex, &response)) return NULL;
+
+    // check arrays
+    PyArrayObject *posterior = checkArray(pyPosterior, "posterior", "update", -1, 1);
+    if (!posterior) return NULL;
+    npy_intp nParams = PyArray_SIZE(posterior);
+    PyArrayObject *pCorrect = checkArray(pyCorrect, "pCorrect", "update", -1, 0);
+    if (!pCorrect) return NULL;
+    if ((PyArray_NDIM(pCorrect) != 2) || (PyArray_DIM(pCorrect, 1) != nParams)) {
+        PyErr_Format(PyExc_ValueError, "(_pglPsi:update) pCorrect must be nStimuli x %ld", (long)nParams);
+        return NULL;
+    }
+    if ((stimulusIndex < 0) || (stimulusIndex >= PyArray_DIM(pCorrect, 0))) {
+        PyErr_Format(PyExc_IndexError, "(_pglPsi:update) stimulusIndex %d out of range (0-%ld)", stimulusIndex, (long)PyArray_DIM(pCorrect, 0) - 1);
+        return NULL;
+    }
+
+    // update in place
+    double probability;
+    Py_BEGIN_ALLOW_THREADS
+    probability = pglPsiUpdate((double*)PyArray_DATA(posterior),
+                               (double*)PyArray_DATA(pCorrect) + (long)stimulusIndex * nParams,
+                               (int)nParams, response);
+    Py_END_ALLOW_THREADS
+
+    return PyFloat_FromDouble(probability);
+}
+
+////////////////////////////////
+//   selectStimulus function  //
+////////////////////////////////
+static PyObject* selectStimulus(PyObject* self, PyObject* args)
+{
+    PyObject *pyPosterior, *pyCorrect, *pyLogCorrect, *pyLogIncorrect, *pyExpectedEntropy;
+    int nThreads = 1;
+    if (!PyArg_ParseTuple(args, "OOOOO|i", &pyPosterior, &pyCorrect, &pyLogCorrect, &pyLogIncorrect, &pyExpectedEntropy, &nThreads)) return NULL;
+
+    // check arrays
+    PyArrayObject *posterior = checkArray(pyPosterior, "posterior", "selectStimulus", -1, 0);
+    if (!posterior) return NULL;
+    npy_intp nParams = PyArray_SIZE(posterior);
+    PyArrayObject *expectedEntropy = checkArray(pyExpectedEntropy, "expectedEntropy", "selectStimulus", -1, 1);
+    if (!expectedEntropy) return NULL;
+    npy_intp nStimuli = PyArray_SIZE(expectedEntropy);
+    PyArrayObject *pCorrect = checkArray(pyCorrect, "pCorrect", "selectStimulus", nStimuli * nParams, 0);
+    PyArrayObject *logCorrect = pCorrect ? checkArray(pyLogCorrect, "logCorrect", "selectStimulus", nStimuli * nParams, 0) : NULL;
+    PyArrayObject *logIncorrect = logCorrect ? checkArray(pyLogIncorrect, "logIncorrect", "selectStimulus", nStimuli * nParams, 0) : NULL;
+    if (!logIncorrect) return NULL;
+
+    int best;
+    Py_BEGIN_ALLOW_THREADS
+    best = pglPsiSelectStimulus((double*)PyArray_DATA(posterior), (double*)PyArray_DATA(pCorrect),
+                                (double*)PyArray_DATA(logCorrect), (double*)PyArray_DATA(logIncorrect),
+                                (int)nStimuli, (int)nParams, (double*)PyArray_DATA(expectedEntropy), nThreads);
+    Py_END_ALLOW_THREADS
+
+    if (best < 0) {
+        PyErr_SetString(PyExc_MemoryError, "(_pglPsi:selectStimulus) Failed to allocate working memory");
+        return NULL;
+    }
+    return PyLong_FromLong(best);
+}
+
+/////////////////////////
+//   entropy function  //
+/////////////////////////
+static PyObject* entropy(PyObject* self, PyObject* args)
+{
+    PyObject *pyPosterior;
+    if (!PyArg_ParseTuple(args, "O", &pyPosterior)) return NULL;
+    PyArrayObject *posterior = checkArray(pyPosterior, "posterior", "entropy", -1, 0);
+    if (!posterior) return NULL;
+    return PyFloat_FromDouble(pglPsiEntropy((double*)PyArray_DATA(posterior), (int)PyArray_SIZE(posterior)));
+}
+
+////////////////////////////
+//   checkArray function  //
+////////////////////////////
+// Arrays that are read or written in place must already be contiguous
+// float64 (a silent conversion would update a copy). Returns a borrowed
+// reference, or NULL with an exception set
+static PyArrayObject* checkArray(PyObject* obj, const char* name, const char* caller, npy_intp size, int writeable)
+{
+    if (!PyArray_Check(obj)) {
+        PyErr_Format(PyExc_TypeError, "(_pglPsi:%s) %s must be a numpy array", caller, name);
+        return NULL;
+    }
+    PyArrayObject *array = (PyArrayObject*)obj;
+    if ((PyArray_TYPE(array) != NPY_FLOAT64) || !PyArray_IS_C_CONTIGUOUS(array)) {
+        PyErr_Format(PyExc_TypeError, "(_pglPsi:%s) %s must be a C-contiguous float64 array", caller, name);
+        return NULL;
+    }
+    if (writeable && !PyArray_ISWRITEABLE(array)) {
+        PyErr_Format(PyExc_ValueError, "(_pglPsi:%s) %s must be writeable", caller, name);
+        return NULL;
+    }
+    if ((size >= 0) && (PyArray_SIZE(array) != size)) {
+        PyErr_Format(PyExc_ValueError, "(_pglPsi:%s) %s has %ld elements, expected %ld", caller, name, (long)PyArray_SIZE(array), (long)size);
+        return NULL;
+    }
+    return array;
+}
+
+///////////////////////////////
+//   toDoubleArray function  //
+///////////////////////////////
+// Convert any sequence to a new contiguous float64 array (new reference)
+static PyArrayObject* toDoubleArray(PyObject* obj, const char* name, const char* caller)
+{
+    PyArrayObject *array = (PyArrayObject*)PyArray_FROM_OTF(obj, NPY_FLOAT64, NPY_ARRAY_IN_ARRAY);
+    if (!array) {
+        PyErr_Format(PyExc_ValueError, "(_pglPsi:%s) Failed to convert %s to float64", caller, name);
+        return NULL;
+    }
+    if (PyArray_SIZE(array) == 0) {
+        Py_DECREF(array);
+        PyErr_Format(PyExc_ValueError, "(_pglPsi:%s) %s is empty", caller, name);
+        return NULL;
+    }
+    return array;
+}
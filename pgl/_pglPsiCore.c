@@ -0,0 +1,208 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglPsiCore.c
+//
+//  Portable Psi / QUEST+ engine (see _pglPsiCore.h)
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include "_pglPsiCore.h"
+
+////////////////////////////
+//   selection job        //
+////////////////////////////
+// one thread's share of the stimuli for pglPsiSelectStimulus
+typedef struct {
+  const double* posterior;
+  const double* logPosterior;
+  const double* pCorrect;
+  const double* logCorrect;
+  const double* logIncorrect;
+  double sumPosteriorLogPosterior;
+  int nParams;
+  int firstStimulus;
+  int lastStimulus;
+  double* expectedEntropy;
+} psiSelectJob;
+
+///////////////////////////
+//   clampProbability    //
+///////////////////////////
+static inline double clampProbability(double p)
+{
+  if (p < kPsiMinProbability) return kPsiMinProbability;
+  if (p > 1.0 - kPsiMinProbability) return 1.0 - kPsiMinProbability;
+  return p;
+}
+
+///////////////////////////
+//   pglPsiWeibullTable  //
+///////////////////////////
+void pglPsiWeibullTable(const double* stimuli, int nStimuli,
+                        const double* thresholds, int nThresholds,
+                        const double* slopes, int nSlopes,
+                        const double* lapses, int nLapses,
+                        double guess,
+                        double* pCorrect, double* logCorrect, double* logIncorrect)
+{
+  long nParams = (long)nThresholds * nSlopes * nLapses;
+  for (int iStimulus = 0; iStimulus < nStimuli; iStimulus++) {
+    double x = fabs(stimuli[iStimulus]);
+    long cell = (long)iStimulus * nParams;
+    for (int iThreshold = 0; iThreshold < nThresholds; iThreshold++) {
+      for (int iSlope = 0; iSlope < nSlopes; iSlope++) {
+        // detection probability does not depend on lapse, so compute it once
+        double detect = 1.0 - exp(-pow(x / thresholds[iThreshold], slopes[iSlope]));
+        for (int iLapse = 0; iLapse < nLapses; iLapse++, cell++) {
+          double p = clampProbability(guess + (1.0 - guess - lapses[iLapse]) * detect);
+          pCorrect[cell] = p;
+          if (logCorrect) logCorrect[cell] = log(p);
+          if (logIncorrect) logIncorrect[cell] = log(1.0 - p);
+        }
+      }
+    }
+  }
+}
+
+///////////////////////////
+//   pglPsiLogTables     //
+///////////////////////////
+void pglPsiLogTables(double* pCorrect, long nCells, double* logCorrect, double* logIncorrect)
+{
+  for (long i = 0; i < nCells; i++) {
+    pCorrect[i] = clampProbability(pCorrect[i]);
+    logCorrect[i] = log(pCorrect[i]);
+    logIncorrect[i] = log(1.0 - pCorrect[i]);
+  }
+}
+
+///////////////////////////
+//   pglPsiUpdate        //
+///////////////////////////
+double pglPsiUpdate(double* posterior, const double* pCorrectRow, int nParams, int response)
+{
+  // probability of this response under the current posterior
+  double total = 0;
+  if (response) {
+    for (int i = 0; i < nParams; i++) total += posterior[i] * pCorrectRow[i];
+  }
+  else {
+    for (int i = 0; i < nParams; i++) total += posterior[i] * (1.0 - pCorrectRow[i]);
+  }
+  if (total <= 0) return 0;
+
+  // multiply and normalize in one pass
+  double scale = 1.0 / total;
+  if (response) {
+    for (int i = 0; i < nParams; i++) posterior[i] *= pCorrectRow[i] * scale;
+  }
+  else {
+    for (int i = 0; i < nParams; i++) posterior[i] *= (1.0 - pCorrectRow[i]) * scale;
+  }
+  return total;
+}
+
+///////////////////////////
+//   pglPsiEntropy       //
+///////////////////////////
+double pglPsiEntropy(const double* posterior, int nParams)
+{
+  double entropy = 0;
+  for (int i = 0; i < nParams; i++)
+    if (posterior[i] > 0) entropy -= posterior[i] * log(posterior[i]);
+  return entropy;
+}
+
+///////////////////////////
+//   runSelectJob        //
+///////////////////////////
+// For a stimulus with likelihood L, the posterior after a correct
+// response is q = p*L/pc with pc = sum(p*L), so its entropy is
+//   Hc = log(pc) - sum(p*L*(log p + log L))/pc
+// (and likewise for incorrect with 1-L), which makes the expected
+// entropy pc*Hc + pi*Hi a handful of running sums over the grid
+static void* runSelectJob(void* arg)
+{
+  psiSelectJob* job = (psiSelectJob*)arg;
+  int nParams = job->nParams;
+  for (int iStimulus = job->firstStimulus; iStimulus < job->lastStimulus; iStimulus++) {
+    const double* pCorrect = job->pCorrect + (long)iStimulus * nParams;
+    const double* logCorrect = job->logCorrect + (long)iStimulus * nParams;
+    const double* logIncorrect = job->logIncorrect + (long)iStimulus * nParams;
+    double sumCorrect = 0, sumCorrectLogPosterior = 0, sumCorrectLogLikelihood = 0, sumIncorrectLogLikelihood = 0;
+    for (int i = 0; i < nParams; i++) {
+      double p = job->posterior[i];
+      double pc = p * pCorrect[i];
+      sumCorrect += pc;
+      sumCorrectLogPosterior += pc * job->logPosterior[i];
+      sumCorrectLogLikelihood += pc * logCorrect[i];
+      sumIncorrectLogLikelihood += (p - pc) * logIncorrect[i];
+    }
+    double sumIncorrect = 1.0 - sumCorrect;
+    double sumIncorrectLogPosterior = job->sumPosteriorLogPosterior - sumCorrectLogPosterior;
+    double expected = -(sumCorrectLogPosterior + sumCorrectLogLikelihood) - (sumIncorrectLogPosterior + sumIncorrectLogLikelihood);
+    if (sumCorrect > 0) expected += sumCorrect * log(sumCorrect);
+    if (sumIncorrect > 0) expected += sumIncorrect * log(sumIncorrect);
+    job->expectedEntropy[iStimulus] = expected;
+  }
+  return NULL;
+}
+
+////////////////////////////
+//   pglPsiSelectStimulus //
+////////////////////////////
+int pglPsiSelectStimulus(const double* posterior, const double* pCorrect,
+                         const double* logCorrect, const double* logIncorrect,
+                         int nStimuli, int nParams, double* expectedEntropy, int nThreads)
+{
+  if ((nStimuli <= 0) || (nParams <= 0)) return -1;
+
+  // log of the posterior is shared by every stimulus
+  double* logPosterior = (double*)malloc(sizeof(double) * nParams);
+  if (logPosterior == NULL) return -1;
+  double sumPosteriorLogPosterior = 0;
+  for (int i = 0; i < nParams; i++) {
+    logPosterior[i] = (posterior[i] > 0) ? log(posterior[i]) : 0;
+    sumPosteriorLogPosterior += posterior[i] * logPosterior[i];
+  }
+
+  // split the stimuli across threads
+  if (nThreads > nStimuli) nThreads = nStimuli;
+  if (nThreads > kPsiMaxThreads) nThreads = kPsiMaxThreads;
+  if (nThreads < 1) nThreads = 1;
+  psiSelectJob jobs[kPsiMaxThreads];
+  pthread_t threads[kPsiMaxThreads];
+  int started[kPsiMaxThreads];
+  for (int iThread = 0; iThread < nThreads; iThread++) {
+    psiSelectJob* job = &jobs[iThread];
+    job->posterior = posterior;
+    job->logPosterior = logPosterior;
+    job->pCorrect = pCorrect;
+    job->logCorrect = logCorrect;
+    job->logIncorrect = logIncorrect;
+    job->sumPosteriorLogPosterior = sumPosteriorLogPosterior;
+    job->nParams = nParams;
+    job->firstStimulus = (int)((long)nStimuli * iThread / nThreads);
+    job->lastStimulus = (int)((long)nStimuli * (iThread + 1) / nThreads);
+    job->expectedEntropy = expectedEntropy;
+    // the calling thread does the first share itself
+    started[iThread] = (iThread > 0) && (pthread_create(&threads[iThread], NULL, runSelectJob, job) == 0);
+  }
+  runSelectJob(&jobs[0]);
+  for (int iThread = 1; iThread < nThreads; iThread++) {
+    // if a thread could not be started, do its share here
+    if (started[iThread]) pthread_join(threads[iThread], NULL);
+    else runSelectJob(&jobs[iThread]);
+  }
+  free(logPosterior);
+
+  // find the minimum
+  int best = 0;
+  for (int iStimulus = 1; iStimulus < nStimuli; iStimulus++)
+    if (expectedEntropy[iStimulus] < expectedEntropy[best]) best = iStimulus;
+  return best;
+}
@@ -0,0 +1,68 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglPsiCore.h
+//
+//  Portable engine for Bayesian adaptive staircases (Psi / QUEST+).
+//  The posterior is kept over a flat grid of psychometric function
+//  parameters (threshold x slope x lapse) and the likelihood of a
+//  correct response is precomputed for every stimulus and grid cell,
+//  so that a trial is one in-place multiply of the posterior and a
+//  pass over the tables to find the stimulus that minimizes the
+//  expected entropy of the posterior. None of this depends on Python
+//  so it can be built and benchmarked anywhere.
+/////////////////////////////////////////////////////////////////////
+#ifndef _PGLPSICORE_H
+#define _PGLPSICORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+////////////////////////
+//   define section   //
+////////////////////////
+// likelihoods are clamped to [kPsiMinProbability, 1-kPsiMinProbability]
+// so that the log tables are finite
+#define kPsiMinProbability 1e-10
+#define kPsiMaxThreads 64
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+// Fill the likelihood tables for a Weibull psychometric function
+//   p = guess + (1-guess-lapse) * (1-exp(-(x/threshold)^slope))
+// Tables are nStimuli x (nThresholds*nSlopes*nLapses) with the grid
+// index (iThreshold*nSlopes + iSlope)*nLapses + iLapse (i.e. the order
+// of a C-ordered numpy array of shape (nThresholds, nSlopes, nLapses)).
+// logCorrect and logIncorrect can be NULL
+void pglPsiWeibullTable(const double* stimuli, int nStimuli,
+                        const double* thresholds, int nThresholds,
+                        const double* slopes, int nSlopes,
+                        const double* lapses, int nLapses,
+                        double guess,
+                        double* pCorrect, double* logCorrect, double* logIncorrect);
+
+// Fill the log tables from a likelihood table (clamps pCorrect in place)
+void pglPsiLogTables(double* pCorrect, long nCells, double* logCorrect, double* logIncorrect);
+
+// Multiply the posterior by the likelihood of the response (1 correct,
+// 0 incorrect) to the stimulus with the given row of pCorrect and
+// renormalize. Returns the probability the posterior gave to that
+// response (the posterior is left alone if that is 0)
+double pglPsiUpdate(double* posterior, const double* pCorrectRow, int nParams, int response);
+
+// Expected entropy of the posterior after a trial at each stimulus,
+// written into expectedEntropy (nStimuli). Returns the index of the
+// stimulus with the smallest expected entropy. nThreads <= 1 runs in
+// the calling thread, otherwise stimuli are split across threads
+int pglPsiSelectStimulus(const double* posterior, const double* pCorrect,
+                         const double* logCorrect, const double* logIncorrect,
+                         int nStimuli, int nParams, double* expectedEntropy, int nThreads);
+
+// Entropy (nats) of a normalized distribution
+double pglPsiEntropy(const double* posterior, int nParams);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,221 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglRealtime.c
+//
+//  Python layer over _pglSched.h: real-time policy, core pinning and
+//  memory locking for the calling thread, and a wake-up latency
+//  measurement that runs with the GIL released
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <Python.h>
+#include <stdlib.h>
+#include "_pglSched.h"
+
+////////////////////////
+//   define section   //
+////////////////////////
+// time constraint used when none is given: one 60Hz frame, of which a
+// quarter is computation that must be done in the first half
+#define kDefaultPeriod (1.0 / 60.0)
+#define kDefaultComputationFraction 0.25
+#define kDefaultConstraintFraction 0.5
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+static PyObject* setPolicy(PyObject* self, PyObject* args, PyObject* kwargs);
+static PyObject* getPolicy(PyObject* self, PyObject* args);
+static PyObject* pinToCore(PyObject* self, PyObject* args);
+static PyObject* getCore(PyObject* self, PyObject* args);
+static PyObject* lockMemory(PyObject* self, PyObject* args);
+static PyObject* lockBuffer(PyObject* self, PyObject* args);
+static PyObject* measureWakeups(PyObject* self, PyObject* args);
+static PyObject* getBackendName(PyObject* self, PyObject* args);
+
+///////////////////////////////
+//   Python Object Defs      //
+///////////////////////////////
+// Method table
+static PyMethodDef RealtimeMethods[] = {
+    {"setPolicy", (PyCFunction)(void(*)(void))setPolicy, METH_VARARGS | METH_KEYWORDS, "Set the scheduling policy of the calling thread (default, realtime, fifo or deadline)"},
+    {"getPolicy", getPolicy, METH_NOARGS, "Get the scheduling policy of the calling thread as a dict"},
+    {"pinToCore", pinToCore, METH_VARARGS, "Pin the calling thread to a core (-1 for any core)"},
+    {"getCore", getCore, METH_NOARGS, "Get the core the calling thread is pinned to, or -1"},
+    {"lockMemory", lockMemory, METH_VARARGS, "Lock (True) or unlock (False) all memory of the process"},
+    {"lockBuffer", lockBuffer, METH_VARARGS, "Lock (or with lock=False unlock) the memory of an object with the buffer protocol"},
+    {"measureWakeups", measureWakeups, METH_VARARGS, "Wake every interval n times (doing busyTime of work after each) and return how late each wake was"},
+    {"getBackendName", getBackendName, METH_NOARGS, "Get the name of the platform scheduling backend"},
+    {NULL, NULL, 0, NULL}
+};
+
+// Module slots (multi-phase init). Everything acts on the calling
+// thread, so there is no shared state
+static PyModuleDef_Slot RealtimeSlots[] = {
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
+// Module definition
+static struct PyModuleDef RealtimeModule = {
+    PyModuleDef_HEAD_INIT,
+    "_pglRealtime",
+    "Real-time scheduling of pgl threads (C extension)",
+    0,
+    RealtimeMethods,
+    RealtimeSlots
+};
+
+PyMODINIT_FUNC PyInit__pglRealtime(void) {
+    return PyModuleDef_Init(&RealtimeModule);
+}
+
+////////////////////////////
+//   setPolicy function   //
+////////////////////////////
+static PyObject* setPolicy(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    static char* keywords[] = {"policy", "period", "computation", "constraint", "priority", NULL};
+    const char* name;
+    pglSchedPolicy policy = {0};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|dddi", keywords, &name, &policy.period, &policy.computation, &policy.constraint, &policy.priority))
+        return NULL;
+    policy.policy = pglSchedPolicyFromName(name);
+    if (policy.policy < 0) {
+        PyErr_Format(PyExc_ValueError, "Unknown policy '%s' (default, realtime, fifo or deadline)", name);
+        return NULL;
+    }
+
+    // fill in the time constraint from the period
+    if (policy.period <= 0) policy.period = kDefaultPeriod;
+    if (policy.computation <= 0) policy.computation = policy.period * kDefaultComputationFraction;
+    if (policy.constraint <= 0) policy.constraint = policy.period * kDefaultConstraintFraction;
+    if (policy.constraint < policy.computation) policy.constraint = policy.computation;
+
+    const char* message = NULL;
+    if (pglSchedSetPolicy(&policy, &message) != 0) {
+        PyErr_SetString(PyExc_OSError, message ? message : "Could not set scheduling policy");
+        return NULL;
+    }
+    Py_RETURN_TRUE;
+}
+
+////////////////////////////
+//   getPolicy function   //
+////////////////////////////
+static PyObject* getPolicy(PyObject* self, PyObject* args)
+{
+    pglSchedPolicy policy;
+    if (pglSchedGetPolicy(&policy) != 0) {
+        PyErr_SetString(PyExc_OSError, "Could not get scheduling policy");
+        return NULL;
+    }
+    return Py_BuildValue("{s:s,s:d,s:d,s:d,s:i,s:i}",
+                         "policy", pglSchedPolicyNames[policy.policy],
+                         "period", policy.period,
+                         "computation", policy.computation,
+                         "constraint", policy.constraint,
+                         "priority", policy.priority,
+                         "core", pglSchedGetCore());
+}
+
+////////////////////////////
+//   pinToCore function   //
+////////////////////////////
+static PyObject* pinToCore(PyObject* self, PyObject* args)
+{
+    int core;
+    if (!PyArg_ParseTuple(args, "i", &core)) return NULL;
+    const char* message = NULL;
+    if (pglSchedPinToCore(core, &message) != 0) {
+        PyErr_SetString(PyExc_OSError, message ? message : "Could not pin thread");
+        return NULL;
+    }
+    Py_RETURN_TRUE;
+}
+
+//////////////////////////
+//   getCore function   //
+//////////////////////////
+static PyObject* getCore(PyObject* self, PyObject* args)
+{
+    return PyLong_FromLong(pglSchedGetCore());
+}
+
+/////////////////////////////
+//   lockMemory function   //
+/////////////////////////////
+static PyObject* lockMemory(PyObject* self, PyObject* args)
+{
+    int lock = 1;
+    if (!PyArg_ParseTuple(args, "|p", &lock)) return NULL;
+    const char* message = NULL;
+    if (pglSchedLockMemory(lock, &message) != 0) {
+        PyErr_SetString(PyExc_OSError, message ? message : "Could not lock memory");
+        return NULL;
+    }
+    Py_RETURN_TRUE;
+}
+
+/////////////////////////////
+//   lockBuffer function   //
+/////////////////////////////
+static PyObject* lockBuffer(PyObject* self, PyObject* args)
+{
+    PyObject* obj;
+    int lock = 1;
+    if (!PyArg_ParseTuple(args, "O|p", &obj, &lock)) return NULL;
+    Py_buffer view;
+    if (PyObject_GetBuffer(obj, &view, PyBUF_SIMPLE) != 0) return NULL;
+    const char* message = NULL;
+    int result = pglSchedLockBuffer(view.buf, (size_t)view.len, lock, &message);
+    PyBuffer_Release(&view);
+    if (result != 0) {
+        PyErr_SetString(PyExc_OSError, message ? message : "Could not lock buffer");
+        return NULL;
+    }
+    Py_RETURN_TRUE;
+}
+
+/////////////////////////////////
+//   measureWakeups function   //
+/////////////////////////////////
+static PyObject* measureWakeups(PyObject* self, PyObject* args)
+{
+    double interval, busyTime = 0;
+    int n;
+    if (!PyArg_ParseTuple(args, "di|d", &interval, &n, &busyTime)) return NULL;
+    if ((interval <= 0) || (n <= 0)) {
+        PyErr_SetString(PyExc_ValueError, "interval and n must be positive");
+        return NULL;
+    }
+    double* lateness = (double*)malloc(sizeof(double) * n);
+    if (!lateness) return PyErr_NoMemory();
+
+    // the measurement is of this thread's wakes, so nothing else should
+    // be holding it up
+    Py_BEGIN_ALLOW_THREADS
+    pglSchedMeasureWakeups(interval, n, busyTime, lateness);
+    Py_END_ALLOW_THREADS
+
+    PyObject* list = PyList_New(n);
+    if (list) {
+        for (int i = 0; i < n; i++) PyList_SET_ITEM(list, i, PyFloat_FromDouble(lateness[i]));
+    }
+    free(lateness);
+    return list;
+}
+
+/////////////////////////////////
+//   getBackendName function   //
+/////////////////////////////////
+static PyObject* getBackendName(PyObject* self, PyObject* args)
+{
+    return PyUnicode_FromString(pglSchedGetBackendName());
+}
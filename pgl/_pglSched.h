@@ -0,0 +1,94 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglSched.h
+//
+//  Real-time scheduling for the threads that have deadlines: the
+//  render loop, the event listener thread and device acquisition
+//  threads. The portable part (_pglSchedCore.c) measures wake-up
+//  latency and locks buffers. The platform backend is chosen at build
+//  time: _pglSchedMac.c (mach time constraint policy, affinity tags)
+//  or _pglSchedLinux.c (SCHED_FIFO / SCHED_DEADLINE, cpu affinity).
+//  Everything acts on the calling thread, so a thread sets its own
+//  policy when it starts.
+/////////////////////////////////////////////////////////////////////
+#ifndef _PGLSCHED_H
+#define _PGLSCHED_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// scheduling policies (names in pglSchedPolicyNames are what Python sees)
+typedef enum {
+    // what the thread was created with (timesharing)
+    pglSchedDefault = 0,
+    // the platform's periodic real-time policy: time constraint on
+    // macOS, SCHED_FIFO on Linux
+    pglSchedRealtime,
+    // fixed priority, runs until it blocks (SCHED_FIFO)
+    pglSchedFifo,
+    // guaranteed computation time in every period (SCHED_DEADLINE on
+    // Linux, time constraint on macOS)
+    pglSchedDeadline,
+    pglSchedNumPolicies
+} pglSchedPolicyType;
+
+typedef struct {
+    int policy;
+    // seconds, used by the periodic policies (realtime on macOS, deadline)
+    double period;
+    double computation;
+    double constraint;
+    // SCHED_FIFO priority (1-99 on Linux), used by fifo (and realtime on Linux)
+    int priority;
+} pglSchedPolicy;
+
+extern const char* pglSchedPolicyNames[pglSchedNumPolicies];
+
+// returns the policy for a name, or -1 if unknown
+int pglSchedPolicyFromName(const char* name);
+
+// name of the backend (for diagnostics)
+const char* pglSchedGetBackendName(void);
+
+// set the policy of the calling thread. Returns 0 on success, or -1 and
+// message is set to a human readable explanation (e.g. missing privileges)
+int pglSchedSetPolicy(const pglSchedPolicy* policy, const char** message);
+
+// current policy of the calling thread. Returns 0 on success
+int pglSchedGetPolicy(pglSchedPolicy* policy);
+
+// pin the calling thread to a core (-1 for any core). Returns 0 on
+// success, or -1 with message set
+int pglSchedPinToCore(int core, const char** message);
+
+// core the calling thread is pinned to, or -1 if it may run on any
+int pglSchedGetCore(void);
+
+// lock (1) or unlock (0) all current and future memory of the process,
+// so that deadline threads do not take page faults. Returns 0 on
+// success, or -1 with message set
+int pglSchedLockMemory(int lock, const char** message);
+
+// sleep until t (pglClockGetSecs timebase) with the platform's
+// absolute timer
+void pglSchedSleepUntil(double t);
+
+////////////////////////
+//   portable core    //
+////////////////////////
+// lock (1) or unlock (0) one buffer (works where locking all memory
+// is not supported). Returns 0 on success, or -1 with message set
+int pglSchedLockBuffer(void* buffer, size_t length, int lock, const char** message);
+
+// wake every interval seconds n times, doing busyTime seconds of work
+// after each wake, and record in lateness how late each wake was
+// (seconds after it was due). Returns the number recorded
+int pglSchedMeasureWakeups(double interval, int n, double busyTime, double* lateness);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
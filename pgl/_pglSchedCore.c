@@ -0,0 +1,66 @@
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include "_pglSched.h"
+#include "_pglClock.h"
+
+//////////////////////
+// global variables //
+//////////////////////
+const char* pglSchedPolicyNames[pglSchedNumPolicies] = {
+    "default",
+    "realtime",
+    "fifo",
+    "deadline"
+};
+
+////////////////////////////////////////
+//   pglSchedPolicyFromName function  //
+////////////////////////////////////////
+int pglSchedPolicyFromName(const char* name)
+{
+    for (int i = 0; i < pglSchedNumPolicies; i++) {
+        if (strcmp(name, pglSchedPolicyNames[i]) == 0) return i;
+    }
+    return -1;
+}
+
+////////////////////////////////////
+//   pglSchedLockBuffer function  //
+////////////////////////////////////
+int pglSchedLockBuffer(void* buffer, size_t length, int lock, const char** message)
+{
+    if (length == 0) return 0;
+    if ((lock ? mlock(buffer, length) : munlock(buffer, length)) == 0) return 0;
+    if (message) {
+        if (errno == ENOMEM || errno == EAGAIN || errno == EPERM)
+            *message = "Not allowed to lock that much memory (raise the memlock limit, ulimit -l)";
+        else
+            *message = "Could not lock buffer";
+    }
+    return -1;
+}
+
+////////////////////////////////////////
+//   pglSchedMeasureWakeups function  //
+////////////////////////////////////////
+int pglSchedMeasureWakeups(double interval, int n, double busyTime, double* lateness)
+{
+    // deadlines are absolute so that lateness does not accumulate
+    double due = pglClockGetSecs() + interval;
+    for (int i = 0; i < n; i++) {
+        pglSchedSleepUntil(due);
+        double woke = pglClockGetSecs();
+        lateness[i] = woke - due;
+        // stand in for the work done each frame
+        while (pglClockGetSecs() - woke < busyTime);
+        due += interval;
+        // if a wake was so late that the next is already past, skip ahead
+        double now = pglClockGetSecs();
+        while (due < now) due += interval;
+    }
+    return n;
+}
@@ -0,0 +1,197 @@
+/////////////////////////
+//   include section   //
+/////////////////////////
+#define _GNU_SOURCE
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "_pglSched.h"
+
+////////////////////////
+//   define section   //
+////////////////////////
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+#define kDefaultFifoPriority 80
+
+// glibc has no wrapper for sched_setattr / sched_getattr
+typedef struct {
+    uint32_t size;
+    uint32_t schedPolicy;
+    uint64_t schedFlags;
+    int32_t schedNice;
+    uint32_t schedPriority;
+    uint64_t schedRuntime;
+    uint64_t schedDeadline;
+    uint64_t schedPeriod;
+} pglSchedAttr;
+
+//////////////////////////////////
+//   permissionMessage function  //
+//////////////////////////////////
+static const char* permissionMessage(int err)
+{
+    if (err == EPERM)
+        return "Not permitted to use real-time scheduling (needs CAP_SYS_NICE or an rtprio limit, e.g. ulimit -r 99 or /etc/security/limits.conf)";
+    if (err == EINVAL)
+        return "Invalid scheduling parameters";
+    return "Could not set scheduling policy";
+}
+
+////////////////////////////////////////
+//   deadlineMessage function         //
+////////////////////////////////////////
+static const char* deadlineMessage(int err)
+{
+    if (err == EPERM) {
+        // the kernel also refuses a thread whose affinity does not span its root domain
+        cpu_set_t cpus;
+        if ((pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0) && (CPU_COUNT(&cpus) < sysconf(_SC_NPROCESSORS_ONLN)))
+            return "SCHED_DEADLINE threads cannot be pinned: this thread is limited to some cores (pin it to core -1 first)";
+        return "Not permitted to use SCHED_DEADLINE (needs CAP_SYS_NICE, an rtprio limit is not enough)";
+    }
+    if (err == EBUSY)
+        return "Not enough real-time bandwidth left for this deadline";
+    if (err == EINVAL)
+        return "Invalid scheduling parameters (deadline needs computation <= constraint <= period)";
+    return "Could not set SCHED_DEADLINE";
+}
+
+///////////////////////////////////////
+//   pglSchedGetBackendName function //
+///////////////////////////////////////
+const char* pglSchedGetBackendName(void)
+{
+    return "linux (SCHED_FIFO / SCHED_DEADLINE)";
+}
+
+///////////////////////////////////
+//   pglSchedSetPolicy function  //
+///////////////////////////////////
+int pglSchedSetPolicy(const pglSchedPolicy* policy, const char** message)
+{
+    if (policy->policy == pglSchedDeadline) {
+        pglSchedAttr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.schedPolicy = SCHED_DEADLINE;
+        attr.schedRuntime = (uint64_t)(policy->computation * 1e9);
+        attr.schedDeadline = (uint64_t)(policy->constraint * 1e9);
+        attr.schedPeriod = (uint64_t)(policy->period * 1e9);
+        if (syscall(SYS_sched_setattr, 0, &attr, 0) == 0) return 0;
+        if (message) *message = deadlineMessage(errno);
+        return -1;
+    }
+
+    // default, realtime and fifo
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    int schedPolicy = SCHED_OTHER;
+    if (policy->policy != pglSchedDefault) {
+        schedPolicy = SCHED_FIFO;
+        param.sched_priority = (policy->priority > 0) ? policy->priority : kDefaultFifoPriority;
+    }
+    int err = pthread_setschedparam(pthread_self(), schedPolicy, &param);
+    if (err == 0) return 0;
+    if (message) *message = permissionMessage(err);
+    return -1;
+}
+
+///////////////////////////////////
+//   pglSchedGetPolicy function  //
+///////////////////////////////////
+int pglSchedGetPolicy(pglSchedPolicy* policy)
+{
+    memset(policy, 0, sizeof(*policy));
+    pglSchedAttr attr;
+    memset(&attr, 0, sizeof(attr));
+    if (syscall(SYS_sched_getattr, 0, &attr, sizeof(attr), 0) != 0) return -1;
+    if (attr.schedPolicy == SCHED_DEADLINE) {
+        policy->policy = pglSchedDeadline;
+        policy->computation = attr.schedRuntime / 1e9;
+        policy->constraint = attr.schedDeadline / 1e9;
+        policy->period = attr.schedPeriod / 1e9;
+    }
+    else if ((attr.schedPolicy == SCHED_FIFO) || (attr.schedPolicy == SCHED_RR)) {
+        policy->policy = pglSchedFifo;
+        policy->priority = attr.schedPriority;
+    }
+    else {
+        policy->policy = pglSchedDefault;
+    }
+    return 0;
+}
+
+///////////////////////////////////
+//   pglSchedPinToCore function  //
+///////////////////////////////////
+int pglSchedPinToCore(int core, const char** message)
+{
+    long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (core >= numCores) {
+        if (message) *message = "No such core";
+        return -1;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (core < 0) {
+        for (int i = 0; i < numCores; i++) CPU_SET(i, &cpus);
+    }
+    else {
+        CPU_SET(core, &cpus);
+    }
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (err == 0) return 0;
+    if (message) *message = (err == EBUSY) ? "SCHED_DEADLINE threads cannot be pinned to a core" : "Could not set thread affinity (core not available to this process?)";
+    return -1;
+}
+
+/////////////////////////////////
+//   pglSchedGetCore function  //
+/////////////////////////////////
+int pglSchedGetCore(void)
+{
+    cpu_set_t cpus;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) return -1;
+    if (CPU_COUNT(&cpus) != 1) return -1;
+    for (int i = 0; i < CPU_SETSIZE; i++) {
+        if (CPU_ISSET(i, &cpus)) return i;
+    }
+    return -1;
+}
+
+////////////////////////////////////
+//   pglSchedLockMemory function  //
+////////////////////////////////////
+int pglSchedLockMemory(int lock, const char** message)
+{
+    if ((lock ? mlockall(MCL_CURRENT | MCL_FUTURE) : munlockall()) == 0) return 0;
+    if (message) {
+        if (errno == ENOMEM || errno == EPERM)
+            *message = "Not allowed to lock all memory (raise the memlock limit, ulimit -l unlimited, or run with CAP_IPC_LOCK)";
+        else
+            *message = "Could not lock memory";
+    }
+    return -1;
+}
+
+////////////////////////////////////
+//   pglSchedSleepUntil function  //
+////////////////////////////////////
+void pglSchedSleepUntil(double t)
+{
+    // same clock as _pglClockLinux.c
+    struct timespec deadline;
+    double secs = floor(t);
+    deadline.tv_sec = (time_t)secs;
+    deadline.tv_nsec = (long)((t - secs) * 1e9);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR);
+}
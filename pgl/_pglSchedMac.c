@@ -0,0 +1,190 @@
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <mach/mach.h>
+#include <mach/mach_time.h>
+#include <mach/thread_policy.h>
+#include "_pglSched.h"
+
+////////////////////////
+//   define section   //
+////////////////////////
+#define kDefaultFifoPriority 47
+
+//////////////////////
+// global variables //
+//////////////////////
+// same timebase as _pglClockMac.c, kept for converting seconds to
+// mach absolute time units
+static mach_timebase_info_data_t timebaseInfo = {0,0};
+static pthread_once_t timebaseOnce = PTHREAD_ONCE_INIT;
+// core last given to pglSchedPinToCore (-1 is none), per thread since
+// the kernel does not report it back
+static __thread int pinnedCore = -1;
+
+/////////////////////////////
+//   initTimebase function  //
+/////////////////////////////
+static void initTimebase(void)
+{
+    mach_timebase_info(&timebaseInfo);
+}
+
+/////////////////////////////////
+//   secsToAbsolute function   //
+/////////////////////////////////
+static uint64_t secsToAbsolute(double secs)
+{
+    pthread_once(&timebaseOnce, initTimebase);
+    return (uint64_t)(secs * 1e9 * timebaseInfo.denom / timebaseInfo.numer);
+}
+
+/////////////////////////////////
+//   absoluteToSecs function   //
+/////////////////////////////////
+static double absoluteToSecs(uint64_t absTime)
+{
+    pthread_once(&timebaseOnce, initTimebase);
+    return (double)absTime * timebaseInfo.numer / timebaseInfo.denom / 1e9;
+}
+
+///////////////////////////////////////
+//   pglSchedGetBackendName function //
+///////////////////////////////////////
+const char* pglSchedGetBackendName(void)
+{
+    return "mach (time constraint policy)";
+}
+
+///////////////////////////////////
+//   pglSchedSetPolicy function  //
+///////////////////////////////////
+int pglSchedSetPolicy(const pglSchedPolicy* policy, const char** message)
+{
+    mach_port_t thread = pthread_mach_thread_np(pthread_self());
+
+    if (policy->policy == pglSchedFifo) {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = (policy->priority > 0) ? policy->priority : kDefaultFifoPriority;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0) return 0;
+        if (message) *message = "Could not set SCHED_FIFO";
+        return -1;
+    }
+
+    if (policy->policy == pglSchedDefault) {
+        // back to timesharing, and to the default pthread priority
+        thread_standard_policy_data_t standard = {0};
+        kern_return_t result = thread_policy_set(thread, THREAD_STANDARD_POLICY, (thread_policy_t)&standard, THREAD_STANDARD_POLICY_COUNT);
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = 31;
+        pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+        if (result == KERN_SUCCESS) return 0;
+        if (message) *message = "Could not restore the standard policy";
+        return -1;
+    }
+
+    // realtime and deadline are both the time constraint policy: the
+    // thread needs computation of cpu within constraint of the start of
+    // every period
+    thread_time_constraint_policy_data_t timeConstraint;
+    timeConstraint.period = (uint32_t)secsToAbsolute(policy->period);
+    timeConstraint.computation = (uint32_t)secsToAbsolute(policy->computation);
+    timeConstraint.constraint = (uint32_t)secsToAbsolute(policy->constraint);
+    timeConstraint.preemptible = 1;
+    kern_return_t result = thread_policy_set(thread, THREAD_TIME_CONSTRAINT_POLICY, (thread_policy_t)&timeConstraint, THREAD_TIME_CONSTRAINT_POLICY_COUNT);
+    if (result == KERN_SUCCESS) return 0;
+    if (message) *message = (result == KERN_INVALID_ARGUMENT) ?
+        "Invalid time constraint (needs computation <= constraint <= period, and computation of at least ~50 us)" :
+        "Could not set time constraint policy";
+    return -1;
+}
+
+///////////////////////////////////
+//   pglSchedGetPolicy function  //
+///////////////////////////////////
+int pglSchedGetPolicy(pglSchedPolicy* policy)
+{
+    memset(policy, 0, sizeof(*policy));
+    mach_port_t thread = pthread_mach_thread_np(pthread_self());
+
+    // the kernel hands back the defaults if the policy is not set
+    thread_time_constraint_policy_data_t timeConstraint;
+    mach_msg_type_number_t count = THREAD_TIME_CONSTRAINT_POLICY_COUNT;
+    boolean_t getDefault = 0;
+    if (thread_policy_get(thread, THREAD_TIME_CONSTRAINT_POLICY, (thread_policy_t)&timeConstraint, &count, &getDefault) != KERN_SUCCESS) return -1;
+    if (!getDefault) {
+        policy->policy = pglSchedRealtime;
+        policy->period = absoluteToSecs(timeConstraint.period);
+        policy->computation = absoluteToSecs(timeConstraint.computation);
+        policy->constraint = absoluteToSecs(timeConstraint.constraint);
+        return 0;
+    }
+
+    int schedPolicy;
+    struct sched_param param;
+    if ((pthread_getschedparam(pthread_self(), &schedPolicy, &param) == 0) && (schedPolicy == SCHED_FIFO)) {
+        policy->policy = pglSchedFifo;
+        policy->priority = param.sched_priority;
+    }
+    return 0;
+}
+
+///////////////////////////////////
+//   pglSchedPinToCore function  //
+///////////////////////////////////
+int pglSchedPinToCore(int core, const char** message)
+{
+    // macOS has no hard pinning. Affinity tags ask that threads with the
+    // same tag share an L2 and threads with different tags do not, and
+    // are only honoured on Intel Macs
+    thread_affinity_policy_data_t affinity;
+    affinity.affinity_tag = (core < 0) ? THREAD_AFFINITY_TAG_NULL : (integer_t)(core + 1);
+    kern_return_t result = thread_policy_set(pthread_mach_thread_np(pthread_self()), THREAD_AFFINITY_POLICY, (thread_policy_t)&affinity, THREAD_AFFINITY_POLICY_COUNT);
+    if (result == KERN_SUCCESS) {
+        pinnedCore = core;
+        return 0;
+    }
+    if (message) *message = (result == KERN_NOT_SUPPORTED) ?
+        "This Mac does not support thread affinity (Apple silicon), use the realtime policy instead" :
+        "Could not set thread affinity";
+    return -1;
+}
+
+/////////////////////////////////
+//   pglSchedGetCore function  //
+/////////////////////////////////
+int pglSchedGetCore(void)
+{
+    return pinnedCore;
+}
+
+////////////////////////////////////
+//   pglSchedLockMemory function  //
+////////////////////////////////////
+int pglSchedLockMemory(int lock, const char** message)
+{
+    if ((lock ? mlockall(MCL_CURRENT | MCL_FUTURE) : munlockall()) == 0) return 0;
+    if (message) {
+        if (errno == ENOSYS)
+            *message = "macOS cannot lock all memory, lock the buffers that deadline threads use with lockBuffer instead";
+        else
+            *message = "Could not lock memory";
+    }
+    return -1;
+}
+
+////////////////////////////////////
+//   pglSchedSleepUntil function  //
+////////////////////////////////////
+void pglSchedSleepUntil(double t)
+{
+    // same clock as _pglClockMac.c
+    mach_wait_until(secsToAbsolute(t));
+}
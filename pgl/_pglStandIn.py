@@ -0,0 +1,385 @@
+################################################################
+#   filename: _pglStandIn.py
+#    purpose: Stand-in for the mglMetal application, so that
+#             socket level code (e.g. pglMultiDisplay) can be run
+#             and timed without a Mac. pglStandInServer speaks the
+#             mglMetal socket protocol for the commands listed in
+#             pglStandInServer.payloads against a simulated display
+#             with its own refresh rate and vsync phase, and
+#             pglStandInDisplay is a minimal client with the parts of
+#             the pglBase interface that pglMultiDisplay uses.
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import os
+import struct
+import random
+import tempfile
+import threading
+import time
+import numpy as np
+from socket import socket, AF_UNIX, SOCK_STREAM
+from . import _pglComm as pglComm
+from . import _pglTimestamp
+from .pglImage import pglImage
+from .pglRefreshTracker import pglRefreshTracker
+
+# location of the command code definitions shared with mglMetal
+commandTypesFilename = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), "metal", "mglCommandTypes.h")
+
+#################################################################
+# pglStandInServer
+#################################################################
+class pglStandInServer:
+    '''
+    Listens on a unix socket and answers like mglMetal does: an ack (double)
+    as soon as a command code is read, then any command specific response
+    and the command results block. Frames are presented on a simulated vsync
+    (vsyncPhase + k/frameRate on the _pglTimestamp clock), and mglFlush blocks
+    until the frame it presents, like mglMetal waiting on the drawable.
+
+    e.g.
+    server = pglStandInServer(frameRate=60, vsyncPhase=0.004)
+    server.start()
+    display = pglStandInDisplay(server.socketName)
+    '''
+    # number of bytes of payload that follow each command code. Commands
+    # whose payload starts with a count are (bytes per element, header bytes)
+    payloads = {
+        "mglPing": 0,
+        "mglFullscreen": 0,
+        "mglWindowed": 0,
+        "mglFlush": 0,
+        "mglGetTargetPresentationTimestamp": 0,
+        "mglSampleTimestamps": 0,
+        "mglGetWindowFrameInDisplay": 0,
+        "mglSetClearColor": 3 * 4,
+        "mglSetDesiredFrameRate": 4,
+        "mglSetWindowFrameInDisplay": 5 * 4,
+        "mglSetXform": 16 * 4,
+        "mglDots": (11 * 4, 4),
+        "mglLine": (6 * 4, 4),
+        "mglQuad": (6 * 4, 4),
+        "mglArcs": (14 * 4, 4),
+        "mglDeleteTexture": 4,
+        # texture commands have their own layout (see _readTexturePayload)
+        "mglCreateTexture": None,
+        "mglUpdateTexture": None,
+        "mglBltTexture": None,
+        # renderer driven frames: repeatCount, then objects per frame and random seed
+        "mglRepeatFlicker": 2 * 4,
+        "mglRepeatBlts": 4,
+        "mglRepeatQuads": 3 * 4,
+        "mglRepeatDots": 3 * 4,
+        "mglRepeatFlush": 4,
+    }
+
+    def __init__(self, frameRate=60.0, vsyncPhase=0.0, renderTime=0.002, renderJitter=0.0005, objectTime=0.0, socketName=None, verbose=0, clock=None):
+        '''
+        Args:
+            frameRate (float): Refresh rate of the simulated display.
+            vsyncPhase (float): Offset of the vsync times in seconds (displays that are not genlocked
+              have different phases).
+            renderTime (float): Time for the simulated GPU to finish a frame after mglFlush.
+            renderJitter (float): Standard deviation of the render time.
+            objectTime (float): Additional render time for each dot or quad in the frame.
+            socketName (str, optional): Path of the socket, defaults to a new temporary file name.
+            verbose (int): Print each command when > 1.
+            clock (optional): Clock with getSecs and advanceTo (e.g. pglSimulation.pglVirtualClock) to
+              present frames on, instead of the _pglTimestamp clock. Waiting for a vsync then moves
+              the clock on rather than sleeping.
+        '''
+        self.frameRate = frameRate
+        self.framePeriod = 1.0 / frameRate
+        self.vsyncPhase = vsyncPhase
+        self.renderTime = renderTime
+        self.renderJitter = renderJitter
+        self.objectTime = objectTime
+        # dots and quads drawn since the last flush
+        self.nFrameObjects = 0
+        self.verbose = verbose
+        self.clock = clock if clock is not None else _pglTimestamp
+        if socketName is None:
+            socketName = os.path.join(tempfile.gettempdir(), f"pglStandIn.socket.{os.getpid()}.{random.getrandbits(40):010x}")
+        self.socketName = socketName
+        self.windowFrame = [1, 0, 0, 800, 600]
+        self.nFrames = 0
+        # size of each texture by number, and bytes of texture data received
+        self.textures = {}
+        self.nextTextureNum = 1
+        self.textureBytes = 0
+        self._listener = None
+        self._thread = None
+        self._running = False
+        self._rng = random.Random()
+
+        # command codes, from the same header that the client parses
+        comm = pglComm._pglComm.__new__(pglComm._pglComm)
+        comm.parseCommandValues(commandTypesFilename)
+        self.commandNames = {int(value): name for name, value in comm.commandValues.items()}
+        self.commandValues = {name: int(value) for name, value in comm.commandValues.items()}
+
+    def start(self):
+        '''
+        Start listening (returns once the socket exists so a client can connect).
+        '''
+        if os.path.exists(self.socketName): os.remove(self.socketName)
+        self._listener = socket(AF_UNIX, SOCK_STREAM)
+        self._listener.bind(self.socketName)
+        self._listener.listen(1)
+        self._running = True
+        self._thread = threading.Thread(target=self._serve, name=f"pglStandInServer:{self.frameRate}Hz", daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self):
+        '''
+        Stop the server and remove the socket.
+        '''
+        self._running = False
+        if self._listener is not None:
+            try:
+                self._listener.close()
+            except OSError:
+                pass
+            self._listener = None
+        if os.path.exists(self.socketName): os.remove(self.socketName)
+        if self._thread is not None:
+            self._thread.join(timeout=2)
+            self._thread = None
+
+    def nextVsync(self, t):
+        '''
+        Time of the first vsync at or after t.
+        '''
+        k = np.ceil((t - self.vsyncPhase) / self.framePeriod)
+        return self.vsyncPhase + k * self.framePeriod
+
+    def _serve(self):
+        # one client at a time, as with mglMetal
+        while self._running:
+            try:
+                connection, _ = self._listener.accept()
+            except OSError:
+                return
+            with connection:
+                try:
+                    self._handleConnection(connection)
+                except (ConnectionError, OSError):
+                    pass
+
+    def _handleConnection(self, connection):
+        while self._running:
+            # read command code
+            data = self._recv(connection, 2)
+            if data is None: return
+            commandValue = struct.unpack('@H', data)[0]
+            commandName = self.commandNames.get(commandValue)
+            receivedTime = self.clock.getSecs()
+
+            # ack as soon as the command is read
+            connection.sendall(struct.pack('@d', receivedTime))
+            if self.verbose > 1: print(f"(pglStandInServer) {commandName} ({commandValue})")
+
+            # unknown commands can not be skipped since we do not know their length
+            if commandName not in self.payloads:
+                print(f"(pglStandInServer) ❌ Command {commandName} ({commandValue}) is not supported by the stand-in, closing connection")
+                return
+
+            # read the payload
+            payload = self.payloads[commandName]
+            if payload is None:
+                body = self._readTexturePayload(connection, commandName)
+            elif isinstance(payload, tuple):
+                header = self._recv(connection, payload[1])
+                if header is None: return
+                count = struct.unpack('@I', header)[0]
+                body = self._recv(connection, count * payload[0])
+            else:
+                body = self._recv(connection, payload)
+            if body is None: return
+
+            # frames drawn by the renderer answer with results for every frame
+            if commandName.startswith("mglRepeat"):
+                self._repeatFrames(connection, commandName, commandValue, receivedTime, body)
+                continue
+
+            # command specific responses
+            drawableAcquired = drawablePresented = 0.0
+            if commandName == "mglFlush":
+                # GPU finishes, then the frame goes up on the next vsync
+                done = receivedTime + self._frameRenderTime(self.nFrameObjects)
+                drawablePresented = self.nextVsync(done)
+                drawableAcquired = drawablePresented - self.framePeriod
+                self._sleepUntil(drawablePresented)
+                self.nFrames += 1
+                self.nFrameObjects = 0
+            elif commandName == "mglDots":
+                self.nFrameObjects += len(body) // (11 * 4)
+            elif commandName == "mglQuad":
+                self.nFrameObjects += len(body) // (6 * 6 * 4)
+            elif commandName == "mglGetTargetPresentationTimestamp":
+                connection.sendall(struct.pack('@d', self.nextVsync(self.clock.getSecs() + self.renderTime)))
+            elif commandName == "mglSampleTimestamps":
+                now = self.clock.getSecs()
+                connection.sendall(struct.pack('@dd', now, now))
+            elif commandName == "mglGetWindowFrameInDisplay":
+                connection.sendall(struct.pack('@d5I', 1.0, *self.windowFrame))
+            elif commandName == "mglSetWindowFrameInDisplay":
+                self.windowFrame = list(struct.unpack('@5I', body))
+            elif commandName == "mglCreateTexture":
+                textureNum = self.nextTextureNum
+                self.nextTextureNum += 1
+                self.textures[textureNum] = struct.unpack('@II', body[:8])
+                connection.sendall(struct.pack('@d', 1.0) + struct.pack('@I', textureNum) + struct.pack('@I', len(self.textures)))
+            elif commandName == "mglUpdateTexture":
+                textureNum, width, height = struct.unpack('@III', body[:12])
+                if textureNum in self.textures: self.textures[textureNum] = (width, height)
+            elif commandName == "mglDeleteTexture":
+                self.textures.pop(struct.unpack('@I', body)[0], None)
+            elif commandName == "mglSetDesiredFrameRate":
+                self.frameRate = float(struct.unpack('@I', body)[0])
+                self.framePeriod = 1.0 / self.frameRate
+
+            # command results
+            processedTime = self.clock.getSecs()
+            # (fields are packed one at a time, as the client reads them one at a time)
+            connection.sendall(struct.pack('@H', commandValue) + struct.pack('@I', 1) +
+                               struct.pack('@7d', processedTime, 0.0, 0.0, 0.0, 0.0, drawableAcquired, drawablePresented))
+
+    def _frameRenderTime(self, nObjects):
+        return max(0.0, self._rng.gauss(self.renderTime + nObjects * self.objectTime, self.renderJitter))
+
+    def _repeatFrames(self, connection, commandName, commandValue, receivedTime, body):
+        # the renderer makes and presents repeatCount frames on its own, each
+        # started as soon as the last is presented, then sends the results of
+        # every frame (each field repeatCount long, as for a batch)
+        values = struct.unpack(f'@{len(body) // 4}I', body)
+        repeatCount = values[0]
+        if commandName in ("mglRepeatQuads", "mglRepeatDots"):
+            nObjects = values[1]
+        elif commandName == "mglRepeatBlts":
+            nObjects = len(self.textures)
+        else:
+            nObjects = 0
+        # blts need a texture to draw
+        success = 0 if (commandName == "mglRepeatBlts" and not self.textures) else 1
+        times = np.zeros((7, repeatCount))
+        frameStart = receivedTime
+        for iFrame in range(repeatCount if success else 0):
+            done = frameStart + self._frameRenderTime(nObjects)
+            drawablePresented = self.nextVsync(done)
+            times[:, iFrame] = [frameStart, frameStart, done, frameStart, done, drawablePresented - self.framePeriod, drawablePresented]
+            self._sleepUntil(drawablePresented)
+            self.nFrames += 1
+            frameStart = self.clock.getSecs()
+        if not success: times[0, :] = self.clock.getSecs()
+        connection.sendall(np.full(repeatCount, commandValue, dtype=np.uint16).tobytes() +
+                           np.full(repeatCount, success, dtype=np.uint32).tobytes() + times.tobytes())
+
+    def _readTexturePayload(self, connection, commandName):
+        # create: width, height, RGBA float32 data
+        # update: textureNum, width, height, RGBA float32 data
+        # blt: minMag, mip, address, nVertices, nVertices x 5 float32, phase, textureNum
+        headerLength = {"mglCreateTexture": 8, "mglUpdateTexture": 12, "mglBltTexture": 16}[commandName]
+        header = self._recv(connection, headerLength)
+        if header is None: return None
+        if commandName == "mglBltTexture":
+            nVertices = struct.unpack('@I', header[12:16])[0]
+            rest = self._recv(connection, nVertices * 5 * 4 + 8)
+        else:
+            width, height = struct.unpack('@II', header[-8:])
+            rest = self._recv(connection, width * height * 4 * 4)
+            if rest is not None: self.textureBytes += len(rest)
+        if rest is None: return None
+        # the texture data itself is not kept
+        return header
+
+    def _sleepUntil(self, t):
+        # a simulated clock just moves on
+        if hasattr(self.clock, "advanceTo"):
+            self.clock.advanceTo(t)
+            return
+        # sleep most of the way, then spin for the last bit
+        while True:
+            remaining = t - self.clock.getSecs()
+            if remaining <= 0: return
+            time.sleep(remaining - 0.001 if remaining > 0.002 else 0)
+
+    def _recv(self, connection, numBytes):
+        data = bytearray()
+        while len(data) < numBytes:
+            chunk = connection.recv(numBytes - len(data))
+            if not chunk: return None
+            data.extend(chunk)
+        return bytes(data)
+
+#################################################################
+# pglStandInDisplay
+#################################################################
+class pglStandInDisplay(pglImage):
+    '''
+    Minimal client for a pglStandInServer (or an mglMetal that has
+    already been started) with the methods of pglBase that
+    pglMultiDisplay needs: flush, getTargetPresentationTimestamp,
+    clearScreen, isOpen and close, and the texture methods of
+    pglImage (imageCreate, imageUpdate, imageDelete).
+    '''
+    commandRecording = False
+    commandResults = None
+    verbose = 0
+
+    def __init__(self, socketName, frameRate=60.0, timeout=10):
+        self.frameRate = frameRate
+        self.refreshTracker = pglRefreshTracker(nominalFrameRate=frameRate)
+        self.s = pglComm._pglComm(socketName, self, timeout=timeout)
+        if not self.s.isOpen():
+            self.s = None
+            return
+        self.s.parseCommandValues(commandTypesFilename)
+
+    def isOpen(self):
+        return self.s is not None
+
+    def close(self):
+        if self.s is None: return True
+        try:
+            self.s.s.close()
+        except OSError:
+            pass
+        self.s = None
+        return True
+
+    def flush(self):
+        if self.isOpen() is False:
+            print(f"(pglStandInDisplay:flush) ❌ No screen is open")
+            return None
+        self.s.writeCommand("mglFlush")
+        self.commandResults = self.s.readCommandResults()
+        self.refreshTracker.update(self.commandResults.get('drawablePresented', 0))
+        if self._resources is not None: self._resources.frameEnd()
+        return self.commandResults.get('drawablePresented', None)
+
+    def getFramePeriod(self):
+        return self.refreshTracker.framePeriod
+
+    def getTargetPresentationTimestamp(self):
+        if self.isOpen() is False:
+            print(f"(pglStandInDisplay:getTargetPresentationTimestamp) ❌ No screen is open")
+            return 0
+        self.s.writeCommand("mglGetTargetPresentationTimestamp")
+        ack = self.s.readAck()
+        targetPresentationTimestamp = self.s.toLocalTime(self.s.read(np.double))
+        self.commandResults = self.s.readCommandResults(ack)
+        return targetPresentationTimestamp
+
+    def clearScreen(self, color):
+        if self.isOpen() is False: return False
+        self.s.writeCommand("mglSetClearColor")
+        self.s.write(np.array(color, dtype=np.float32).ravel()[:3])
+        self.commandResults = self.s.readCommandResults()
+        return True
@@ -0,0 +1,191 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglTess.c
+//
+//  Python layer over the polygon tessellator in _pglTessCore.c.
+//  Takes the vertices as an n x 2 numpy array and returns the
+//  triangles as an m x 3 array of indices into it, tessellating with
+//  the GIL released
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <Python.h>
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+#include <stdlib.h>
+#include "_pglTessCore.h"
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+static PyObject* tessellate(PyObject* self, PyObject* args);
+static PyObject* triangleArea(PyObject* self, PyObject* args);
+
+//////////////////////////
+//   helper functions   //
+//////////////////////////
+static PyArrayObject* toVertexArray(PyObject* obj, const char* caller);
+
+///////////////////////////////
+//   Python Object Defs      //
+///////////////////////////////
+// Method table
+static PyMethodDef TessMethods[] = {
+    {"tessellate", tessellate, METH_VARARGS, "Triangulate an n x 2 outline (with holes starting at the given vertex indices), returns an m x 3 uint32 array of vertex indices"},
+    {"triangleArea", triangleArea, METH_VARARGS, "Total area of the triangles of an n x 2 array of vertices"},
+    {NULL, NULL, 0, NULL}
+};
+
+// Module exec function, run once for each interpreter that imports the module
+static int tessExec(PyObject* module)
+{
+  // Initialize NumPy C API
+  import_array1(-1);
+  return 0;
+}
+
+// Module slots (multi-phase init). numpy does not support running under
+// a per-interpreter GIL, so only shared-GIL subinterpreters are allowed
+static PyModuleDef_Slot TessSlots[] = {
+    {Py_mod_exec, tessExec},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_MULTIPLE_INTERPRETERS_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
+// Module definition
+static struct PyModuleDef TessModule = {
+    PyModuleDef_HEAD_INIT,
+    "_pglTess",
+    "Polygon tessellation (ear clipping with holes)",
+    0,
+    TessMethods,
+    TessSlots
+};
+
+PyMODINIT_FUNC PyInit__pglTess(void) {
+    return PyModuleDef_Init(&TessModule);
+}
+
+////////////////////////////
+//   tessellate function  //
+////////////////////////////
+static PyObject* tessellate(PyObject* self, PyObject* args)
+{
+    PyObject *pyVertices, *pyHoleStarts = Py_None;
+    if (!PyArg_ParseTuple(args, "O|O", &pyVertices, &pyHoleStarts)) return NULL;
+
+    PyArrayObject *vertices = toVertexArray(pyVertices, "tessellate");
+    if (!vertices) return NULL;
+    int nVertices = (int)PyArray_DIM(vertices, 0);
+
+    // where each hole starts, which must go up and stay within the vertices
+    int nHoles = 0;
+    int *holeStarts = NULL;
+    if (pyHoleStarts != Py_None) {
+        PyArrayObject *starts = (PyArrayObject*)PyArray_FROM_OTF(pyHoleStarts, NPY_INT64, NPY_ARRAY_IN_ARRAY);
+        if (!starts) {
+            Py_DECREF(vertices);
+            return NULL;
+        }
+        nHoles = (int)PyArray_SIZE(starts);
+        holeStarts = (int*)malloc(sizeof(int) * (nHoles > 0 ? nHoles : 1));
+        if (!holeStarts) {
+            Py_DECREF(starts); Py_DECREF(vertices);
+            return PyErr_NoMemory();
+        }
+        const npy_int64 *data = (const npy_int64*)PyArray_DATA(starts);
+        for (int i = 0; i < nHoles; i++) {
+            if ((data[i] < 3) || (data[i] > nVertices) || ((i > 0) && (data[i] < data[i-1]))) {
+                PyErr_Format(PyExc_ValueError, "(_pglTess:tessellate) hole starts must go up, after an outline of at least 3 vertices and within the %d vertices", nVertices);
+                free(holeStarts); Py_DECREF(starts); Py_DECREF(vertices);
+                return NULL;
+            }
+            holeStarts[i] = (int)data[i];
+        }
+        Py_DECREF(starts);
+    }
+
+    // room for the most triangles there could be
+    npy_intp dims[2] = {pglTessMaxTriangles(nVertices, nHoles), 3};
+    PyObject *triangles = PyArray_SimpleNew(2, dims, NPY_UINT32);
+    if (!triangles) {
+        free(holeStarts); Py_DECREF(vertices);
+        return NULL;
+    }
+
+    int nTriangles;
+    Py_BEGIN_ALLOW_THREADS
+    nTriangles = pglTessTriangulate((const double*)PyArray_DATA(vertices), nVertices, holeStarts, nHoles,
+                                    (uint32_t*)PyArray_DATA((PyArrayObject*)triangles));
+    Py_END_ALLOW_THREADS
+    free(holeStarts);
+    Py_DECREF(vertices);
+    if (nTriangles < 0) {
+        Py_DECREF(triangles);
+        return PyErr_NoMemory();
+    }
+
+    // trim to the triangles that were made
+    if (nTriangles < dims[0]) {
+        PyObject *trimmed = PySequence_GetSlice(triangles, 0, nTriangles);
+        Py_DECREF(triangles);
+        if (!trimmed) return NULL;
+        triangles = PyArray_NewCopy((PyArrayObject*)trimmed, NPY_CORDER);
+        Py_DECREF(trimmed);
+    }
+    return triangles;
+}
+
+//////////////////////////////
+//   triangleArea function  //
+//////////////////////////////
+static PyObject* triangleArea(PyObject* self, PyObject* args)
+{
+    PyObject *pyVertices, *pyTriangles;
+    if (!PyArg_ParseTuple(args, "OO", &pyVertices, &pyTriangles)) return NULL;
+    PyArrayObject *vertices = toVertexArray(pyVertices, "triangleArea");
+    if (!vertices) return NULL;
+    PyArrayObject *triangles = (PyArrayObject*)PyArray_FROM_OTF(pyTriangles, NPY_UINT32, NPY_ARRAY_IN_ARRAY);
+    if (!triangles) {
+        Py_DECREF(vertices);
+        return NULL;
+    }
+    npy_intp nVertices = PyArray_DIM(vertices, 0);
+    const uint32_t *indices = (const uint32_t*)PyArray_DATA(triangles);
+    for (npy_intp i = 0; i < PyArray_SIZE(triangles); i++) {
+        if (indices[i] >= nVertices) {
+            PyErr_SetString(PyExc_IndexError, "(_pglTess:triangleArea) triangle index out of range");
+            Py_DECREF(triangles); Py_DECREF(vertices);
+            return NULL;
+        }
+    }
+    double area = pglTessTriangleArea((const double*)PyArray_DATA(vertices), indices, (int)(PyArray_SIZE(triangles) / 3));
+    Py_DECREF(triangles);
+    Py_DECREF(vertices);
+    return PyFloat_FromDouble(area);
+}
+
+///////////////////////////////
+//   toVertexArray function  //
+///////////////////////////////
+// Convert to a new contiguous n x 2 float64 array (new reference)
+static PyArrayObject* toVertexArray(PyObject* obj, const char* caller)
+{
+    PyArrayObject *array = (PyArrayObject*)PyArray_FROM_OTF(obj, NPY_FLOAT64, NPY_ARRAY_IN_ARRAY);
+    if (!array) {
+        PyErr_Format(PyExc_ValueError, "(_pglTess:%s) Failed to convert vertices to float64", caller);
+        return NULL;
+    }
+    if ((PyArray_NDIM(array) != 2) || (PyArray_DIM(array, 1) != 2)) {
+        Py_DECREF(array);
+        PyErr_Format(PyExc_ValueError, "(_pglTess:%s) vertices must be an n x 2 array", caller);
+        return NULL;
+    }
+    return array;
+}
@@ -0,0 +1,700 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglTessCore.c
+//
+//  Portable polygon tessellator (see _pglTessCore.h)
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <stdlib.h>
+#include <math.h>
+#include "_pglTessCore.h"
+
+////////////////////////
+//   define section   //
+////////////////////////
+// nodes are handed out from blocks of this many, so they never move
+#define kTessBlockSize 1024
+
+////////////////////////////
+//   tessNode             //
+////////////////////////////
+// a vertex of a ring, linked to its neighbours on the ring and (when
+// the z-order index is used) to its neighbours along the curve
+typedef struct tessNode {
+  int i;
+  double x, y;
+  struct tessNode *prev, *next;
+  int32_t z;
+  struct tessNode *prevZ, *nextZ;
+  int steiner;
+} tessNode;
+
+////////////////////////////
+//   tessBlock            //
+////////////////////////////
+typedef struct tessBlock {
+  struct tessBlock* nextBlock;
+  int nUsed;
+  tessNode nodes[kTessBlockSize];
+} tessBlock;
+
+////////////////////////////
+//   tessState            //
+////////////////////////////
+typedef struct {
+  tessBlock* blocks;
+  int outOfMemory;
+  uint32_t* triangles;
+  int nTriangles;
+  int maxTriangles;
+  double minX, minY, invSize;
+} tessState;
+
+//////////////////////////////
+//   function declarations  //
+//////////////////////////////
+static void earcutLinked(tessState* state, tessNode* ear, int pass);
+
+///////////////////////////
+//   createNode          //
+///////////////////////////
+static tessNode* createNode(tessState* state, int i, double x, double y)
+{
+  if ((state->blocks == NULL) || (state->blocks->nUsed == kTessBlockSize)) {
+    tessBlock* block = (tessBlock*)malloc(sizeof(tessBlock));
+    if (block == NULL) {
+      state->outOfMemory = 1;
+      return NULL;
+    }
+    block->nextBlock = state->blocks;
+    block->nUsed = 0;
+    state->blocks = block;
+  }
+  tessNode* p = &state->blocks->nodes[state->blocks->nUsed++];
+  p->i = i;
+  p->x = x;
+  p->y = y;
+  p->prev = p->next = NULL;
+  p->z = 0;
+  p->prevZ = p->nextZ = NULL;
+  p->steiner = 0;
+  return p;
+}
+
+///////////////////////////
+//   insertNode          //
+///////////////////////////
+// add a node after last on its ring (or start a ring)
+static tessNode* insertNode(tessState* state, int i, double x, double y, tessNode* last)
+{
+  tessNode* p = createNode(state, i, x, y);
+  if (p == NULL) return NULL;
+  if (last == NULL) {
+    p->prev = p;
+    p->next = p;
+  }
+  else {
+    p->next = last->next;
+    p->prev = last;
+    last->next->prev = p;
+    last->next = p;
+  }
+  return p;
+}
+
+///////////////////////////
+//   removeNode          //
+///////////////////////////
+static void removeNode(tessNode* p)
+{
+  p->next->prev = p->prev;
+  p->prev->next = p->next;
+  if (p->prevZ) p->prevZ->nextZ = p->nextZ;
+  if (p->nextZ) p->nextZ->prevZ = p->prevZ;
+}
+
+///////////////////////////
+//   geometry            //
+///////////////////////////
+// twice the signed area of the triangle (negative for a convex corner
+// of a ring wound the way the tessellator winds the outline)
+static inline double area(const tessNode* p, const tessNode* q, const tessNode* r)
+{
+  return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+}
+
+static inline int equals(const tessNode* p1, const tessNode* p2)
+{
+  return (p1->x == p2->x) && (p1->y == p2->y);
+}
+
+static inline int pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+{
+  return ((cx - px) * (ay - py) >= (ax - px) * (cy - py)) &&
+         ((ax - px) * (by - py) >= (bx - px) * (ay - py)) &&
+         ((bx - px) * (cy - py) >= (cx - px) * (by - py));
+}
+
+static inline int sign(double value)
+{
+  return (value > 0) - (value < 0);
+}
+
+// q lies on segment pr, given that the three are collinear
+static inline int onSegment(const tessNode* p, const tessNode* q, const tessNode* r)
+{
+  return (q->x <= fmax(p->x, r->x)) && (q->x >= fmin(p->x, r->x)) &&
+         (q->y <= fmax(p->y, r->y)) && (q->y >= fmin(p->y, r->y));
+}
+
+// segments p1q1 and p2q2 cross or touch
+static int intersects(const tessNode* p1, const tessNode* q1, const tessNode* p2, const tessNode* q2)
+{
+  int o1 = sign(area(p1, q1, p2));
+  int o2 = sign(area(p1, q1, q2));
+  int o3 = sign(area(p2, q2, p1));
+  int o4 = sign(area(p2, q2, q1));
+  if ((o1 != o2) && (o3 != o4)) return 1;
+  if ((o1 == 0) && onSegment(p1, p2, q1)) return 1;
+  if ((o2 == 0) && onSegment(p1, q2, q1)) return 1;
+  if ((o3 == 0) && onSegment(p2, p1, q2)) return 1;
+  if ((o4 == 0) && onSegment(p2, q1, q2)) return 1;
+  return 0;
+}
+
+// diagonal ab crosses an edge of the ring
+static int intersectsPolygon(const tessNode* a, const tessNode* b)
+{
+  const tessNode* p = a;
+  do {
+    if ((p->i != a->i) && (p->next->i != a->i) && (p->i != b->i) && (p->next->i != b->i) && intersects(p, p->next, a, b)) return 1;
+    p = p->next;
+  } while (p != a);
+  return 0;
+}
+
+// diagonal ab leaves a into the inside of the ring
+static int locallyInside(const tessNode* a, const tessNode* b)
+{
+  if (area(a->prev, a, a->next) < 0)
+    return (area(a, b, a->next) >= 0) && (area(a, a->prev, b) >= 0);
+  return (area(a, b, a->prev) < 0) || (area(a, a->next, b) < 0);
+}
+
+// the middle of diagonal ab is inside the ring
+static int middleInside(const tessNode* a, const tessNode* b)
+{
+  const tessNode* p = a;
+  int inside = 0;
+  double px = (a->x + b->x) / 2, py = (a->y + b->y) / 2;
+  do {
+    if (((p->y > py) != (p->next->y > py)) && (p->next->y != p->y) &&
+        (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
+      inside = !inside;
+    p = p->next;
+  } while (p != a);
+  return inside;
+}
+
+// ab can split the ring into two without crossing it
+static int isValidDiagonal(const tessNode* a, const tessNode* b)
+{
+  if ((a->next->i == b->i) || (a->prev->i == b->i) || intersectsPolygon(a, b)) return 0;
+  if (locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&
+      ((area(a->prev, a, b->prev) != 0) || (area(a, b->prev, b) != 0)))
+    return 1;
+  // zero length diagonal between two convex corners
+  return equals(a, b) && (area(a->prev, a, a->next) > 0) && (area(b->prev, b, b->next) > 0);
+}
+
+///////////////////////////
+//   zOrder              //
+///////////////////////////
+// interleave the bits of the coordinates scaled to 0..32767
+static int32_t zOrder(double x, double y, double minX, double minY, double invSize)
+{
+  uint32_t ix = (uint32_t)((x - minX) * invSize);
+  uint32_t iy = (uint32_t)((y - minY) * invSize);
+  ix = (ix | (ix << 8)) & 0x00FF00FF;
+  ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+  ix = (ix | (ix << 2)) & 0x33333333;
+  ix = (ix | (ix << 1)) & 0x55555555;
+  iy = (iy | (iy << 8)) & 0x00FF00FF;
+  iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+  iy = (iy | (iy << 2)) & 0x33333333;
+  iy = (iy | (iy << 1)) & 0x55555555;
+  return (int32_t)(ix | (iy << 1));
+}
+
+///////////////////////////
+//   sortLinked          //
+///////////////////////////
+// merge sort of the z links by z
+static tessNode* sortLinked(tessNode* list)
+{
+  int inSize = 1, numMerges;
+  do {
+    tessNode *p = list, *q, *e, *tail = NULL;
+    list = NULL;
+    numMerges = 0;
+    while (p) {
+      numMerges++;
+      q = p;
+      int pSize = 0;
+      for (int i = 0; i < inSize; i++) {
+        pSize++;
+        q = q->nextZ;
+        if (!q) break;
+      }
+      int qSize = inSize;
+      while ((pSize > 0) || ((qSize > 0) && q)) {
+        if ((pSize != 0) && ((qSize == 0) || !q || (p->z <= q->z))) {
+          e = p;
+          p = p->nextZ;
+          pSize--;
+        }
+        else {
+          e = q;
+          q = q->nextZ;
+          qSize--;
+        }
+        if (tail) tail->nextZ = e;
+        else list = e;
+        e->prevZ = tail;
+        tail = e;
+      }
+      p = q;
+    }
+    tail->nextZ = NULL;
+    inSize *= 2;
+  } while (numMerges > 1);
+  return list;
+}
+
+///////////////////////////
+//   indexCurve          //
+///////////////////////////
+static void indexCurve(tessState* state, tessNode* start)
+{
+  tessNode* p = start;
+  do {
+    if (p->z == 0) p->z = zOrder(p->x, p->y, state->minX, state->minY, state->invSize);
+    p->prevZ = p->prev;
+    p->nextZ = p->next;
+    p = p->next;
+  } while (p != start);
+  p->prevZ->nextZ = NULL;
+  p->prevZ = NULL;
+  sortLinked(p);
+}
+
+///////////////////////////
+//   isEar               //
+///////////////////////////
+// the corner at ear is convex and no other vertex is inside it
+static int isEar(const tessNode* ear)
+{
+  const tessNode *a = ear->prev, *b = ear, *c = ear->next;
+  if (area(a, b, c) >= 0) return 0;
+  double x0 = fmin(a->x, fmin(b->x, c->x)), y0 = fmin(a->y, fmin(b->y, c->y));
+  double x1 = fmax(a->x, fmax(b->x, c->x)), y1 = fmax(a->y, fmax(b->y, c->y));
+  const tessNode* p = c->next;
+  while (p != a) {
+    if ((p->x >= x0) && (p->x <= x1) && (p->y >= y0) && (p->y <= y1) &&
+        pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) && (area(p->prev, p, p->next) >= 0))
+      return 0;
+    p = p->next;
+  }
+  return 1;
+}
+
+///////////////////////////
+//   isEarHashed         //
+///////////////////////////
+// as isEar, looking only at vertices whose z order is within that of
+// the bounding box of the corner
+static int isEarHashed(const tessState* state, const tessNode* ear)
+{
+  const tessNode *a = ear->prev, *b = ear, *c = ear->next;
+  if (area(a, b, c) >= 0) return 0;
+  double x0 = fmin(a->x, fmin(b->x, c->x)), y0 = fmin(a->y, fmin(b->y, c->y));
+  double x1 = fmax(a->x, fmax(b->x, c->x)), y1 = fmax(a->y, fmax(b->y, c->y));
+  int32_t minZ = zOrder(x0, y0, state->minX, state->minY, state->invSize);
+  int32_t maxZ = zOrder(x1, y1, state->minX, state->minY, state->invSize);
+
+#define blocksEar(p) (((p)->x >= x0) && ((p)->x <= x1) && ((p)->y >= y0) && ((p)->y <= y1) && ((p) != a) && ((p) != c) && \
+                      pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, (p)->x, (p)->y) && (area((p)->prev, (p), (p)->next) >= 0))
+  const tessNode *p = ear->prevZ, *n = ear->nextZ;
+  // both directions at once, then whichever is left
+  while (p && (p->z >= minZ) && n && (n->z <= maxZ)) {
+    if (blocksEar(p)) return 0;
+    p = p->prevZ;
+    if (blocksEar(n)) return 0;
+    n = n->nextZ;
+  }
+  while (p && (p->z >= minZ)) {
+    if (blocksEar(p)) return 0;
+    p = p->prevZ;
+  }
+  while (n && (n->z <= maxZ)) {
+    if (blocksEar(n)) return 0;
+    n = n->nextZ;
+  }
+#undef blocksEar
+  return 1;
+}
+
+///////////////////////////
+//   addTriangle         //
+///////////////////////////
+static void addTriangle(tessState* state, const tessNode* a, const tessNode* b, const tessNode* c)
+{
+  // cannot happen for a polygon without crossing edges, but those that
+  // have them are only cut up as well as can be
+  if (state->nTriangles >= state->maxTriangles) return;
+  uint32_t* triangle = state->triangles + 3 * state->nTriangles++;
+  triangle[0] = (uint32_t)a->i;
+  triangle[1] = (uint32_t)b->i;
+  triangle[2] = (uint32_t)c->i;
+}
+
+///////////////////////////
+//   filterPoints        //
+///////////////////////////
+// remove duplicate and collinear vertices between start and end
+static tessNode* filterPoints(tessNode* start, tessNode* end)
+{
+  if (!start) return start;
+  if (!end) end = start;
+  tessNode* p = start;
+  int again;
+  do {
+    again = 0;
+    if (!p->steiner && (equals(p, p->next) || (area(p->prev, p, p->next) == 0))) {
+      removeNode(p);
+      p = end = p->prev;
+      if (p == p->next) break;
+      again = 1;
+    }
+    else {
+      p = p->next;
+    }
+  } while (again || (p != end));
+  return end;
+}
+
+///////////////////////////
+//   signedArea          //
+///////////////////////////
+static double signedArea(const double* xy, int start, int end)
+{
+  double sum = 0;
+  for (int i = start, j = end - 1; i < end; j = i++)
+    sum += (xy[2 * j] - xy[2 * i]) * (xy[2 * i + 1] + xy[2 * j + 1]);
+  return sum;
+}
+
+///////////////////////////
+//   linkedList          //
+///////////////////////////
+// make a ring from vertices start to end-1, wound clockwise for the
+// outline and counterclockwise for holes
+static tessNode* linkedList(tessState* state, const double* xy, int start, int end, int clockwise)
+{
+  tessNode* last = NULL;
+  if (clockwise == (signedArea(xy, start, end) > 0)) {
+    for (int i = start; i < end; i++)
+      if (!(last = insertNode(state, i, xy[2 * i], xy[2 * i + 1], last))) return NULL;
+  }
+  else {
+    for (int i = end - 1; i >= start; i--)
+      if (!(last = insertNode(state, i, xy[2 * i], xy[2 * i + 1], last))) return NULL;
+  }
+  if (last && equals(last, last->next)) {
+    removeNode(last);
+    last = last->next;
+  }
+  return last;
+}
+
+///////////////////////////
+//   splitPolygon        //
+///////////////////////////
+// join a and b with two edges (one each way), splitting the ring in
+// two, or joining a hole to the outline. Returns the copy of b
+static tessNode* splitPolygon(tessState* state, tessNode* a, tessNode* b)
+{
+  tessNode* a2 = createNode(state, a->i, a->x, a->y);
+  tessNode* b2 = createNode(state, b->i, b->x, b->y);
+  if (!a2 || !b2) return NULL;
+  tessNode *an = a->next, *bp = b->prev;
+  a->next = b;
+  b->prev = a;
+  a2->next = an;
+  an->prev = a2;
+  b2->next = a2;
+  a2->prev = b2;
+  bp->next = b2;
+  b2->prev = bp;
+  return b2;
+}
+
+///////////////////////////
+//   cureLocalIntersections
+///////////////////////////
+// cut off the corners where two edges next but one to each other cross
+static tessNode* cureLocalIntersections(tessState* state, tessNode* start)
+{
+  tessNode* p = start;
+  do {
+    tessNode *a = p->prev, *b = p->next->next;
+    if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a)) {
+      addTriangle(state, a, p, b);
+      removeNode(p);
+      removeNode(p->next);
+      p = start = b;
+    }
+    p = p->next;
+  } while (p != start);
+  return filterPoints(p, NULL);
+}
+
+///////////////////////////
+//   splitEarcut         //
+///////////////////////////
+// split the ring along a valid diagonal and clip each half
+static void splitEarcut(tessState* state, tessNode* start)
+{
+  tessNode* a = start;
+  do {
+    tessNode* b = a->next->next;
+    while (b != a->prev) {
+      if ((a->i != b->i) && isValidDiagonal(a, b)) {
+        tessNode* c = splitPolygon(state, a, b);
+        if (!c) return;
+        a = filterPoints(a, a->next);
+        c = filterPoints(c, c->next);
+        earcutLinked(state, a, 0);
+        earcutLinked(state, c, 0);
+        return;
+      }
+      b = b->next;
+    }
+    a = a->next;
+  } while (a != start);
+}
+
+///////////////////////////
+//   earcutLinked        //
+///////////////////////////
+// clip ears off the ring. When a full turn finds none, try again after
+// removing degenerate vertices (pass 1), after curing local
+// intersections (pass 2), and then by splitting the ring
+static void earcutLinked(tessState* state, tessNode* ear, int pass)
+{
+  if (!ear) return;
+  if (!pass && state->invSize) indexCurve(state, ear);
+
+  tessNode* stop = ear;
+  while (ear->prev != ear->next) {
+    tessNode *prev = ear->prev, *next = ear->next;
+    if (state->invSize ? isEarHashed(state, ear) : isEar(ear)) {
+      addTriangle(state, prev, ear, next);
+      removeNode(ear);
+      // skip the next vertex, it leads to fewer sliver triangles
+      ear = next->next;
+      stop = next->next;
+      continue;
+    }
+    ear = next;
+    if (ear == stop) {
+      if (pass == 0) {
+        earcutLinked(state, filterPoints(ear, NULL), 1);
+      }
+      else if (pass == 1) {
+        ear = cureLocalIntersections(state, filterPoints(ear, NULL));
+        earcutLinked(state, ear, 2);
+      }
+      else {
+        splitEarcut(state, ear);
+      }
+      break;
+    }
+  }
+}
+
+///////////////////////////
+//   getLeftmost         //
+///////////////////////////
+static tessNode* getLeftmost(tessNode* start)
+{
+  tessNode *p = start, *leftmost = start;
+  do {
+    if ((p->x < leftmost->x) || ((p->x == leftmost->x) && (p->y < leftmost->y))) leftmost = p;
+    p = p->next;
+  } while (p != start);
+  return leftmost;
+}
+
+///////////////////////////
+//   findHoleBridge      //
+///////////////////////////
+// find a vertex of the outline that the leftmost vertex of the hole can
+// be joined to without crossing anything: cast a ray left from the hole
+// to the nearest edge, then take the end of that edge, or the vertex
+// inside the triangle it makes with the ray that is at the smallest
+// angle to the ray
+static int sectorContainsSector(const tessNode* m, const tessNode* p)
+{
+  return (area(m->prev, m, p->prev) < 0) && (area(p->next, m, m->next) < 0);
+}
+
+static tessNode* findHoleBridge(tessNode* hole, tessNode* outerNode)
+{
+  tessNode *p = outerNode, *m = NULL;
+  double hx = hole->x, hy = hole->y, qx = -INFINITY;
+  do {
+    if ((hy <= p->y) && (hy >= p->next->y) && (p->next->y != p->y)) {
+      double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+      if ((x <= hx) && (x > qx)) {
+        qx = x;
+        m = (p->x < p->next->x) ? p : p->next;
+        if (x == hx) return m;
+      }
+    }
+    p = p->next;
+  } while (p != outerNode);
+  if (!m) return NULL;
+
+  tessNode* stop = m;
+  double mx = m->x, my = m->y, tanMin = INFINITY;
+  p = m;
+  do {
+    if ((hx >= p->x) && (p->x >= mx) && (hx != p->x) &&
+        pointInTriangle((hy < my) ? hx : qx, hy, mx, my, (hy < my) ? qx : hx, hy, p->x, p->y)) {
+      double tangent = fabs(hy - p->y) / (hx - p->x);
+      if (locallyInside(p, hole) &&
+          ((tangent < tanMin) || ((tangent == tanMin) && ((p->x > m->x) || ((p->x == m->x) && sectorContainsSector(m, p)))))) {
+        m = p;
+        tanMin = tangent;
+      }
+    }
+    p = p->next;
+  } while (p != stop);
+  return m;
+}
+
+///////////////////////////
+//   eliminateHoles      //
+///////////////////////////
+static int compareLeftmost(const void* a, const void* b)
+{
+  const tessNode *p = *(const tessNode* const*)a, *q = *(const tessNode* const*)b;
+  if (p->x != q->x) return (p->x > q->x) - (p->x < q->x);
+  return (p->y > q->y) - (p->y < q->y);
+}
+
+// join each hole to the outline, left to right, making one ring
+static tessNode* eliminateHoles(tessState* state, const double* xy, int nVertices, const int* holeStarts, int nHoles, tessNode* outerNode)
+{
+  tessNode** queue = (tessNode**)malloc(sizeof(tessNode*) * nHoles);
+  if (!queue) {
+    state->outOfMemory = 1;
+    return NULL;
+  }
+  int nQueue = 0;
+  for (int iHole = 0; iHole < nHoles; iHole++) {
+    int start = holeStarts[iHole];
+    int end = (iHole < nHoles - 1) ? holeStarts[iHole + 1] : nVertices;
+    if (end <= start) continue;
+    tessNode* list = linkedList(state, xy, start, end, 0);
+    if (!list) {
+      if (state->outOfMemory) break;
+      continue;
+    }
+    if (list == list->next) list->steiner = 1;
+    queue[nQueue++] = getLeftmost(list);
+  }
+  qsort(queue, nQueue, sizeof(tessNode*), compareLeftmost);
+
+  for (int iHole = 0; (iHole < nQueue) && !state->outOfMemory; iHole++) {
+    tessNode* bridge = findHoleBridge(queue[iHole], outerNode);
+    if (!bridge) continue;
+    tessNode* bridgeReverse = splitPolygon(state, bridge, queue[iHole]);
+    if (!bridgeReverse) break;
+    filterPoints(bridgeReverse, bridgeReverse->next);
+    outerNode = filterPoints(bridge, bridge->next);
+  }
+  free(queue);
+  return outerNode;
+}
+
+/////////////////////////////////
+//   pglTessMaxTriangles       //
+/////////////////////////////////
+int pglTessMaxTriangles(int nVertices, int nHoles)
+{
+  // n vertices in one ring make n-2 triangles, and each bridge adds two
+  int maxTriangles = nVertices + 2 * nHoles - 2;
+  return (maxTriangles > 0) ? maxTriangles : 0;
+}
+
+/////////////////////////////////
+//   pglTessTriangulate        //
+/////////////////////////////////
+int pglTessTriangulate(const double* xy, int nVertices, const int* holeStarts, int nHoles, uint32_t* triangles)
+{
+  if (nVertices < 3) return 0;
+  if (!holeStarts) nHoles = 0;
+  tessState state = {NULL, 0, triangles, 0, pglTessMaxTriangles(nVertices, nHoles), 0, 0, 0};
+  int outerLength = (nHoles > 0) ? holeStarts[0] : nVertices;
+
+  tessNode* outerNode = linkedList(&state, xy, 0, outerLength, 1);
+  if (outerNode && (outerNode->next != outerNode->prev)) {
+    if (nHoles > 0) outerNode = eliminateHoles(&state, xy, nVertices, holeStarts, nHoles, outerNode);
+
+    // z-order index for large polygons, over the bounding box of all
+    // the vertices (so a stray hole still has a place on the curve)
+    if (!state.outOfMemory && (nVertices > kTessHashThreshold)) {
+      double minX = xy[0], minY = xy[1], maxX = xy[0], maxY = xy[1];
+      for (int i = 1; i < nVertices; i++) {
+        double x = xy[2 * i], y = xy[2 * i + 1];
+        if (x < minX) minX = x;
+        if (y < minY) minY = y;
+        if (x > maxX) maxX = x;
+        if (y > maxY) maxY = y;
+      }
+      double size = fmax(maxX - minX, maxY - minY);
+      state.minX = minX;
+      state.minY = minY;
+      state.invSize = (size != 0) ? 32767.0 / size : 0;
+    }
+    if (!state.outOfMemory) earcutLinked(&state, outerNode, 0);
+  }
+
+  // free the nodes
+  while (state.blocks) {
+    tessBlock* nextBlock = state.blocks->nextBlock;
+    free(state.blocks);
+    state.blocks = nextBlock;
+  }
+  return state.outOfMemory ? -1 : state.nTriangles;
+}
+
+/////////////////////////////////
+//   pglTessTriangleArea       //
+/////////////////////////////////
+double pglTessTriangleArea(const double* xy, const uint32_t* triangles, int nTriangles)
+{
+  double sum = 0;
+  for (int i = 0; i < nTriangles; i++) {
+    const uint32_t* t = triangles + 3 * i;
+    double ax = xy[2 * t[0]], ay = xy[2 * t[0] + 1];
+    double bx = xy[2 * t[1]], by = xy[2 * t[1] + 1];
+    double cx = xy[2 * t[2]], cy = xy[2 * t[2] + 1];
+    sum += fabs((bx - ax) * (cy - ay) - (cx - ax) * (by - ay)) / 2;
+  }
+  return sum;
+}
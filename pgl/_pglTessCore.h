@@ -0,0 +1,54 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglTessCore.h
+//
+//  Portable polygon tessellator. Concave outlines and outlines with
+//  holes are cut into triangles by ear clipping: holes are first
+//  joined to the outline through bridge edges, making one outline,
+//  and ears are then clipped off it. Outlines with more than
+//  kTessHashThreshold vertices keep their vertices sorted along a
+//  z-order curve so that the test of whether an ear contains another
+//  vertex only looks at vertices near it. Outlines that are not
+//  simple (edges that cross) still get triangles, by curing local
+//  self intersections and splitting the outline along diagonals.
+//  None of this depends on Python so it can be built and benchmarked
+//  anywhere.
+/////////////////////////////////////////////////////////////////////
+#ifndef _PGLTESSCORE_H
+#define _PGLTESSCORE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+////////////////////////
+//   define section   //
+////////////////////////
+// outlines with more vertices than this use the z-order index
+#define kTessHashThreshold 80
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+// Most triangles pglTessTriangulate can write for nVertices vertices in
+// 1 + nHoles rings
+int pglTessMaxTriangles(int nVertices, int nHoles);
+
+// Triangulate nVertices points (x, y pairs in xy). The outline is
+// vertices 0 to holeStarts[0]-1 and hole i runs from holeStarts[i] up
+// to the next hole (holeStarts can be NULL when nHoles is 0). Either
+// winding is fine for both. Writes three vertex indices per triangle
+// into triangles, which must have room for pglTessMaxTriangles.
+// Returns the number of triangles, or -1 if memory ran out
+int pglTessTriangulate(const double* xy, int nVertices, const int* holeStarts, int nHoles, uint32_t* triangles);
+
+// Sum of the areas of the triangles (for checking against the area of
+// the polygon)
+double pglTessTriangleArea(const double* xy, const uint32_t* triangles, int nTriangles);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -2,13 +2,13 @@
 //   include section   //
 ///////////////////////
 #include <Python.h>
-#include <stdint.h>
-#include <mach/mach_time.h>
+#include "_pglClock.h"
 
 ///////////////////////////////
 //   function declarations   //
 ///////////////////////////////
 static PyObject* getSecs(PyObject* self, PyObject* args);
+static PyObject* getClockName(PyObject* self, PyObject* args);
 
 ///////////////////////////////
 //   Python Object Defs      //
@@ -16,20 +16,34 @@ static PyObject* getSecs(PyObject* self, PyObject* args);
 // Method table
 static PyMethodDef MetalTimeMethods[] = {
     {"getSecs", getSecs, METH_VARARGS, "Get current time in seconds (Metal timebase)."},
+    {"getClockName", getClockName, METH_NOARGS, "Get the name of the underlying platform clock."},
     {NULL, NULL, 0, NULL}
 };
 
+// Module slots (multi-phase init). The module has no mutable state,
+// so it can be loaded in any subinterpreter and does not need the GIL
+static PyModuleDef_Slot MetalTimeSlots[] = {
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
 // Module definition
 static struct PyModuleDef MetalTimeModule = {
     PyModuleDef_HEAD_INIT,
     "_pglTimestamp",           // module name
     "Metal Time Module",       // docstring
-    -1,
-    MetalTimeMethods
+    0,                         // no per-module state
+    MetalTimeMethods,
+    MetalTimeSlots
 };
 
 PyMODINIT_FUNC PyInit__pglTimestamp(void) {
-    return PyModule_Create(&MetalTimeModule);
+    return PyModuleDef_Init(&MetalTimeModule);
 }
 
 ////////////////////////////
@@ -37,16 +51,13 @@ PyMODINIT_FUNC PyInit__pglTimestamp(void) {
 ////////////////////////////
 static PyObject* getSecs(PyObject* self, PyObject* args) 
 {
-    static mach_timebase_info_data_t timebaseInfo = {0,0};
-
-    // initialize timebase info once
-    if (timebaseInfo.denom == 0) {
-        mach_timebase_info(&timebaseInfo);
-    }
-
-    uint64_t absTime = mach_absolute_time();
-    double nanoseconds = (double)absTime * timebaseInfo.numer / timebaseInfo.denom;
-    double seconds = nanoseconds / 1e9;
+    return PyFloat_FromDouble(pglClockGetSecs());
+}
 
-    return Py_BuildValue("d", seconds);
+////////////////////////////////
+//   getClockName function    //
+////////////////////////////////
+static PyObject* getClockName(PyObject* self, PyObject* args) 
+{
+    return PyUnicode_FromString(pglClockGetName());
 }
@@ -0,0 +1,154 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglTrace.c
+//
+//  Python layer over the trace log in _pglTraceCore.c. record is
+//  called from the hot paths, so it takes its arguments without
+//  building a tuple (METH_FASTCALL). drain copies the waiting records
+//  out as bytes (with the GIL released) for pglTrace to save and
+//  decode
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <Python.h>
+#include "_pglTraceCore.h"
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+static PyObject* record(PyObject* self, PyObject* const* args, Py_ssize_t nArgs);
+static PyObject* enable(PyObject* self, PyObject* args);
+static PyObject* disable(PyObject* self, PyObject* args);
+static PyObject* isEnabled(PyObject* self, PyObject* args);
+static PyObject* threadIndex(PyObject* self, PyObject* args);
+static PyObject* count(PyObject* self, PyObject* args);
+static PyObject* drain(PyObject* self, PyObject* args);
+static PyObject* dropped(PyObject* self, PyObject* args);
+
+///////////////////////////////
+//   Python Object Defs      //
+///////////////////////////////
+// Method table
+static PyMethodDef TraceMethods[] = {
+    {"record", (PyCFunction)(void(*)(void))record, METH_FASTCALL, "Record event (an int) with up to 4 numbers from the calling thread"},
+    {"enable", enable, METH_VARARGS, "Start recording, with rings of capacity records for threads that start recording after this"},
+    {"disable", disable, METH_NOARGS, "Stop recording"},
+    {"isEnabled", isEnabled, METH_NOARGS, "Whether recording"},
+    {"threadIndex", threadIndex, METH_NOARGS, "Index of the calling thread in records"},
+    {"count", count, METH_NOARGS, "Number of records waiting to be drained"},
+    {"drain", drain, METH_NOARGS, "Take the waiting records, as bytes of recordSize byte records"},
+    {"dropped", dropped, METH_NOARGS, "Number of records dropped because a ring was full"},
+    {NULL, NULL, 0, NULL}
+};
+
+// Module exec function, run once for each interpreter that imports the module
+static int traceExec(PyObject* module)
+{
+  return PyModule_AddIntConstant(module, "recordSize", sizeof(pglTraceRecord));
+}
+
+// Module slots (multi-phase init). The rings are shared by the whole
+// process, and are safe to use from any thread
+static PyModuleDef_Slot TraceSlots[] = {
+    {Py_mod_exec, traceExec},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
+// Module definition
+static struct PyModuleDef TraceModule = {
+    PyModuleDef_HEAD_INIT,
+    "_pglTrace",
+    "Binary trace log with a ring per thread (C extension)",
+    0,
+    TraceMethods,
+    TraceSlots
+};
+
+PyMODINIT_FUNC PyInit__pglTrace(void) {
+    return PyModuleDef_Init(&TraceModule);
+}
+
+/////////////////////////
+//   record function   //
+/////////////////////////
+static PyObject* record(PyObject* self, PyObject* const* args, Py_ssize_t nArgs)
+{
+    if ((nArgs < 1) || (nArgs > 5)) {
+        PyErr_SetString(PyExc_TypeError, "(_pglTrace:record) takes an event and up to 4 numbers");
+        return NULL;
+    }
+    // nothing to do (and nothing to convert) when not recording
+    if (!pglTraceIsEnabled()) Py_RETURN_NONE;
+    unsigned long event = PyLong_AsUnsignedLong(args[0]);
+    if ((event == (unsigned long)-1) && PyErr_Occurred()) return NULL;
+    double values[4] = {0, 0, 0, 0};
+    for (Py_ssize_t i = 1; i < nArgs; i++) {
+        values[i - 1] = PyFloat_AsDouble(args[i]);
+        if ((values[i - 1] == -1.0) && PyErr_Occurred()) return NULL;
+    }
+    pglTraceLog((uint32_t)event, values[0], values[1], values[2], values[3]);
+    Py_RETURN_NONE;
+}
+
+/////////////////////////
+//   enable function   //
+/////////////////////////
+static PyObject* enable(PyObject* self, PyObject* args)
+{
+    long capacity = 0;
+    if (!PyArg_ParseTuple(args, "|l", &capacity)) return NULL;
+    pglTraceEnable(capacity);
+    Py_RETURN_NONE;
+}
+
+static PyObject* disable(PyObject* self, PyObject* args)
+{
+    pglTraceDisable();
+    Py_RETURN_NONE;
+}
+
+static PyObject* isEnabled(PyObject* self, PyObject* args)
+{
+    return PyBool_FromLong(pglTraceIsEnabled());
+}
+
+static PyObject* threadIndex(PyObject* self, PyObject* args)
+{
+    int index = pglTraceThreadIndex();
+    if (index < 0) return PyErr_NoMemory();
+    return PyLong_FromLong(index);
+}
+
+static PyObject* count(PyObject* self, PyObject* args)
+{
+    return PyLong_FromLong(pglTraceCount());
+}
+
+////////////////////////
+//   drain function   //
+////////////////////////
+static PyObject* drain(PyObject* self, PyObject* args)
+{
+    // records written after counting stay for the next drain
+    long n = pglTraceCount();
+    PyObject* records = PyBytes_FromStringAndSize(NULL, n * (Py_ssize_t)sizeof(pglTraceRecord));
+    if (!records) return NULL;
+    long nDrained;
+    Py_BEGIN_ALLOW_THREADS
+    nDrained = pglTraceDrain((pglTraceRecord*)PyBytes_AS_STRING(records), n);
+    Py_END_ALLOW_THREADS
+    if ((nDrained < n) && (_PyBytes_Resize(&records, nDrained * (Py_ssize_t)sizeof(pglTraceRecord)) != 0)) return NULL;
+    return records;
+}
+
+static PyObject* dropped(PyObject* self, PyObject* args)
+{
+    return PyLong_FromUnsignedLongLong(pglTraceDropped());
+}
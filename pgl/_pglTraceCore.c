@@ -0,0 +1,240 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglTraceCore.c
+//
+//  Portable trace log (see _pglTraceCore.h)
+/////////////////////////////////////////////////////////////////////
+
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "_pglTraceCore.h"
+#include "_pglClock.h"
+
+////////////////////////
+//   define section   //
+////////////////////////
+#define kDefaultCapacity 65536
+#define kMaxCapacity (1L << 24)
+
+// the ring of one thread. Only the thread writes records and head,
+// only the reader moves tail, each on its own cache line
+typedef struct pglTraceRing {
+  _Alignas(64) _Atomic uint64_t head;
+  // the writer's copy of tail, so it only reads the reader's when it
+  // looks full, and the records it dropped
+  uint64_t cachedTail;
+  _Atomic uint64_t dropped;
+  // set when the thread exits, so the ring can be given to a new
+  // thread once what it recorded has been drained
+  _Atomic int exited;
+  _Alignas(64) _Atomic uint64_t tail;
+  _Alignas(64) uint64_t capacity, mask;
+  uint32_t thread;
+  pglTraceRecord* records;
+  struct pglTraceRing* next;
+} pglTraceRing;
+
+//////////////////////
+// global variables //
+//////////////////////
+static atomic_int enabled = 0;
+static atomic_long ringCapacity = kDefaultCapacity;
+// records dropped by threads whose ring could not be made
+static atomic_uint_fast64_t nDropped = 0;
+// every ring that was made (threads come and go, their rings stay so
+// what they recorded can still be drained, and are reused after that)
+static _Atomic(pglTraceRing*) rings = NULL;
+static atomic_uint nRings = 0;
+static _Thread_local pglTraceRing* threadRing = NULL;
+// its destructor marks the ring of a thread that exits
+static pthread_key_t ringKey;
+static pthread_once_t ringKeyOnce = PTHREAD_ONCE_INIT;
+// one reader at a time
+static pthread_mutex_t drainMutex = PTHREAD_MUTEX_INITIALIZER;
+
+///////////////////////////
+//   threadExited        //
+///////////////////////////
+static void threadExited(void* ring)
+{
+  atomic_store_explicit(&((pglTraceRing*)ring)->exited, 1, memory_order_release);
+}
+
+static void makeRingKey(void)
+{
+  pthread_key_create(&ringKey, threadExited);
+}
+
+///////////////////////////
+//   reuseRing           //
+///////////////////////////
+// claim the ring of a thread that has exited, once it is drained
+// (nothing writes it any more, so it stays drained)
+static pglTraceRing* reuseRing(long capacity)
+{
+  for (pglTraceRing* ring = atomic_load(&rings); ring; ring = ring->next) {
+    if (ring->capacity != (uint64_t)capacity) continue;
+    if (!atomic_load_explicit(&ring->exited, memory_order_acquire)) continue;
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (atomic_load_explicit(&ring->head, memory_order_relaxed) != tail) continue;
+    int exited = 1;
+    if (!atomic_compare_exchange_strong(&ring->exited, &exited, 0)) continue;
+    ring->cachedTail = tail;
+    return ring;
+  }
+  return NULL;
+}
+
+///////////////////////////
+//   ringForThread       //
+///////////////////////////
+// give the calling thread a ring: a drained one left by a thread that
+// has exited, or a new one added to the list
+static pglTraceRing* ringForThread(void)
+{
+  long capacity = atomic_load_explicit(&ringCapacity, memory_order_relaxed);
+  pthread_once(&ringKeyOnce, makeRingKey);
+  pglTraceRing* ring = reuseRing(capacity);
+  if (ring) {
+    // a new index, so records of the two threads are told apart
+    ring->thread = atomic_fetch_add(&nRings, 1);
+    pthread_setspecific(ringKey, ring);
+    threadRing = ring;
+    return ring;
+  }
+  if (posix_memalign((void**)&ring, 64, sizeof(pglTraceRing)) != 0) return NULL;
+  memset(ring, 0, sizeof(pglTraceRing));
+  ring->records = malloc(sizeof(pglTraceRecord) * capacity);
+  if (!ring->records) {
+    free(ring);
+    return NULL;
+  }
+  ring->capacity = capacity;
+  ring->mask = capacity - 1;
+  ring->thread = atomic_fetch_add(&nRings, 1);
+  atomic_init(&ring->head, 0);
+  atomic_init(&ring->tail, 0);
+  atomic_init(&ring->dropped, 0);
+  atomic_init(&ring->exited, 0);
+  // push on the front of the list
+  pglTraceRing* first = atomic_load(&rings);
+  do ring->next = first;
+  while (!atomic_compare_exchange_weak(&rings, &first, ring));
+  pthread_setspecific(ringKey, ring);
+  threadRing = ring;
+  return ring;
+}
+
+///////////////////////////
+//   pglTraceEnable      //
+///////////////////////////
+int pglTraceEnable(long capacity)
+{
+  if (capacity <= 0) capacity = kDefaultCapacity;
+  if (capacity > kMaxCapacity) capacity = kMaxCapacity;
+  long rounded = 1;
+  while (rounded < capacity) rounded *= 2;
+  atomic_store(&ringCapacity, rounded);
+  atomic_store(&enabled, 1);
+  return 0;
+}
+
+void pglTraceDisable(void)
+{
+  atomic_store(&enabled, 0);
+}
+
+int pglTraceIsEnabled(void)
+{
+  return atomic_load_explicit(&enabled, memory_order_relaxed);
+}
+
+///////////////////////////
+//   pglTraceLog         //
+///////////////////////////
+void pglTraceLog(uint32_t event, double a, double b, double c, double d)
+{
+  if (!atomic_load_explicit(&enabled, memory_order_relaxed)) return;
+  pglTraceRing* ring = threadRing;
+  if (!ring && !(ring = ringForThread())) {
+    atomic_fetch_add_explicit(&nDropped, 1, memory_order_relaxed);
+    return;
+  }
+  uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  if (head - ring->cachedTail >= ring->capacity) {
+    ring->cachedTail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - ring->cachedTail >= ring->capacity) {
+      // only this thread writes it, so no read-modify-write is needed
+      atomic_store_explicit(&ring->dropped, atomic_load_explicit(&ring->dropped, memory_order_relaxed) + 1, memory_order_relaxed);
+      return;
+    }
+  }
+  pglTraceRecord* record = &ring->records[head & ring->mask];
+  record->time = pglClockGetSecs();
+  record->event = event;
+  record->thread = ring->thread;
+  record->args[0] = a;
+  record->args[1] = b;
+  record->args[2] = c;
+  record->args[3] = d;
+  // the record is written before the reader can see it
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+int pglTraceThreadIndex(void)
+{
+  pglTraceRing* ring = threadRing ? threadRing : ringForThread();
+  return ring ? (int)ring->thread : -1;
+}
+
+///////////////////////////
+//   pglTraceCount       //
+///////////////////////////
+long pglTraceCount(void)
+{
+  long n = 0;
+  for (pglTraceRing* ring = atomic_load(&rings); ring; ring = ring->next)
+    n += (long)(atomic_load_explicit(&ring->head, memory_order_acquire) - atomic_load_explicit(&ring->tail, memory_order_relaxed));
+  return n;
+}
+
+///////////////////////////
+//   pglTraceDrain       //
+///////////////////////////
+long pglTraceDrain(pglTraceRecord* out, long maxRecords)
+{
+  long n = 0;
+  pthread_mutex_lock(&drainMutex);
+  for (pglTraceRing* ring = atomic_load(&rings); ring && (n < maxRecords); ring = ring->next) {
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint64_t nCopy = head - tail;
+    if (nCopy > (uint64_t)(maxRecords - n)) nCopy = maxRecords - n;
+    // in at most two pieces, around the end of the ring
+    while (nCopy > 0) {
+      uint64_t start = tail & ring->mask;
+      uint64_t piece = ring->capacity - start;
+      if (piece > nCopy) piece = nCopy;
+      memcpy(out + n, ring->records + start, sizeof(pglTraceRecord) * piece);
+      n += piece;
+      tail += piece;
+      nCopy -= piece;
+    }
+    // the writer can use the places once they are copied
+    atomic_store_explicit(&ring->tail, tail, memory_order_release);
+  }
+  pthread_mutex_unlock(&drainMutex);
+  return n;
+}
+
+uint64_t pglTraceDropped(void)
+{
+  uint64_t n = atomic_load(&nDropped);
+  for (pglTraceRing* ring = atomic_load(&rings); ring; ring = ring->next)
+    n += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+  return n;
+}
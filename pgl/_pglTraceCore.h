@@ -0,0 +1,68 @@
+/////////////////////////////////////////////////////////////////////
+//  _pglTraceCore.h
+//
+//  Portable trace log for diagnostics in the hot paths. Each record
+//  is a fixed size: a timestamp (pglClockGetSecs), an event id and
+//  up to four numbers. Every thread writes to its own ring, so a
+//  record is a few stores with no lock and no system call; a single
+//  reader drains the rings (from another thread, while they are
+//  being written) into a buffer that is saved and decoded later.
+//  A thread whose ring is full drops the record and counts it, it
+//  never waits for the reader.
+/////////////////////////////////////////////////////////////////////
+#ifndef _PGLTRACECORE_H
+#define _PGLTRACECORE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// one record (48 bytes). thread is the index of the thread that
+// wrote it (in the order threads first recorded; a ring reused after
+// its thread exited gets a new index)
+typedef struct {
+  double time;
+  uint32_t event;
+  uint32_t thread;
+  double args[4];
+} pglTraceRecord;
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+// Start recording. capacity is the number of records in the ring
+// of each thread that starts recording after this (rounded up to a
+// power of 2). Returns 0
+int pglTraceEnable(long capacity);
+
+// Stop recording (records already in the rings stay to be drained)
+void pglTraceDisable(void);
+
+int pglTraceIsEnabled(void);
+
+// Record an event from the calling thread. Safe from any thread;
+// the first record of a thread makes its ring, or takes the drained
+// ring of a thread that has exited
+void pglTraceLog(uint32_t event, double a, double b, double c, double d);
+
+// Index of the calling thread's ring (making it), or -1 if it could
+// not be made
+int pglTraceThreadIndex(void);
+
+// Number of records waiting to be drained
+long pglTraceCount(void);
+
+// Copy up to maxRecords waiting records (oldest first in each ring)
+// into out and free their place. Returns the number copied
+long pglTraceDrain(pglTraceRecord* out, long maxRecords);
+
+// Number of records dropped because a ring was full
+uint64_t pglTraceDropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
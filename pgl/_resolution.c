@@ -0,0 +1,229 @@
+/////////////////////////
+//   include section   //
+/////////////////////////
+#include <Python.h>
+#include <stdlib.h>
+#include "_pglDisplay.h"
+
+///////////////////////////////
+//   function declarations   //
+///////////////////////////////
+static PyObject* setVerbose(PyObject* self, PyObject* args);
+static PyObject* setResolution(PyObject* self, PyObject* args);
+static PyObject* getResolution(PyObject* self, PyObject* args);
+static PyObject* getNumDisplaysAndDefault(PyObject* self, PyObject* args);
+static PyObject* getBackendName(PyObject* self, PyObject* args);
+
+//////////////////////////
+//   helper functions   //
+//////////////////////////
+static int setBestMode(int displayNumber,int screenWidth,int screenHeight,int frameRate,int bitDepth,int verbose);
+
+//////////////////////
+//   module state   //
+//////////////////////
+// per-interpreter state (replaces the old process-wide verbose global)
+typedef struct {
+  int verbose;
+} resolutionState;
+
+static inline resolutionState* getState(PyObject* module)
+{
+  return (resolutionState*)PyModule_GetState(module);
+}
+
+///////////////////////////////
+//   Python Object Defs      //
+///////////////////////////////
+// Method table
+static PyMethodDef ResolutionMethods[] = {
+    {"setResolution", setResolution, METH_VARARGS, "Get resolution info for a display"},
+    {"getResolution", getResolution, METH_VARARGS, "Set resolution for a display"},
+    {"getNumDisplaysAndDefault", getNumDisplaysAndDefault, METH_NOARGS, "Get number of displays and default"},
+    {"setVerbose", setVerbose, METH_VARARGS, "Set verbose level"},
+    {"getBackendName", getBackendName, METH_NOARGS, "Get the name of the platform display backend"},
+    {NULL, NULL, 0, NULL}
+};
+
+// Module exec function, run once for each interpreter that imports the module
+static int resolutionExec(PyObject* module)
+{
+  // set default verbose level
+  getState(module)->verbose = 1;
+  return 0;
+}
+
+// Module slots (multi-phase init)
+static PyModuleDef_Slot resolutionSlots[] = {
+    {Py_mod_exec, resolutionExec},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
+// Module definition
+static struct PyModuleDef resolutionModule = {
+    PyModuleDef_HEAD_INIT,
+    "_resolution",
+    "Display Info Extension Module",
+    sizeof(resolutionState),
+    ResolutionMethods,
+    resolutionSlots
+};
+
+PyMODINIT_FUNC PyInit__resolution(void) {
+    return PyModuleDef_Init(&resolutionModule);
+}
+
+////////////////////////////
+//   setVerbose function  //
+////////////////////////////
+static PyObject* setVerbose(PyObject* self, PyObject* args) 
+{
+  // get the verbose level from the arguments
+  int newVerbose;
+  if (!PyArg_ParseTuple(args, "i", &newVerbose)) return NULL;
+
+  // set the verbose level in the module state
+  resolutionState *state = getState(self);
+  state->verbose = newVerbose;
+
+  // print a message if verbose is set to a high level
+  if (state->verbose > 1)
+    printf("(pgl:resolution:setVerbose) Verbose level set to %d\n", state->verbose);
+
+  // return success
+  Py_INCREF(Py_True); return Py_True;
+}
+
+///////////////////////////////
+//   setResolution function  //
+///////////////////////////////
+static PyObject* setResolution(PyObject* self, PyObject* args) 
+{
+  // get arguments
+  // displayNumber is the index of the display to set resolution for
+  // screenWidth, screenHeight, frameRate, and bitDepth are the desired
+  // parameters to set the display to
+  // note that the displayNumber is zero indexed, so 0 is the first display
+  int displayNumber = 0;
+  int screenWidth, screenHeight, frameRate, bitDepth;
+  if (!PyArg_ParseTuple(args, "iiiii", &displayNumber, &screenWidth, &screenHeight, &frameRate, &bitDepth)) return NULL;
+  int verbose = getState(self)->verbose;
+
+  // check number of displays
+  int numDisplays = pglDisplayGetCount();
+  if (numDisplays < 0) {
+    printf("(pgl:_resolution:_setResolution) Cannot get displays\n");
+    Py_RETURN_FALSE;
+  }
+ 
+  // checkfor valid displayNumber
+  if (displayNumber < 0 || displayNumber >= numDisplays) {
+    if (verbose) printf("(pgl:_resolution:_setResolution) Invalid display number %d\n", displayNumber);
+    Py_RETURN_FALSE;
+  }
+
+  // Switch the display mode
+  int success;
+  Py_BEGIN_ALLOW_THREADS
+  success = setBestMode(displayNumber,screenWidth,screenHeight,frameRate,bitDepth,verbose);
+  Py_END_ALLOW_THREADS
+
+  // check to see if it found the right setting
+  if (!success) {
+    printf("(pgl:_resolution:_setResolution) Warning: failed to set requested display parameters.\n");
+    Py_RETURN_FALSE;
+  }
+
+  // return success
+  Py_RETURN_TRUE;
+}
+
+///////////////////////////////
+//   getResolution function  //
+///////////////////////////////
+static PyObject* getResolution(PyObject* self, PyObject* args) 
+{
+  // get displayNumber for which display to return resolution info
+  int displayNumber = 0;
+  if (!PyArg_ParseTuple(args, "i", &displayNumber)) return NULL;
+  int verbose = getState(self)->verbose;
+
+  // checkfor valid displayNumber
+  int numDisplays = pglDisplayGetCount();
+  if (displayNumber < 0 || displayNumber >= numDisplays) {
+    if (verbose) printf("(pgl:_resolution:getResolution) Invalid display number %d\n", displayNumber);
+    return Py_BuildValue("(iiii)", -1,-1,-1,-1);
+  }
+
+  // get the display settings
+  pglDisplayMode mode;
+  if (pglDisplayGetCurrentMode(displayNumber, &mode) != 0) {
+    printf("(pgl:_resolution:getResolution) Cannot get displays\n");
+    return Py_BuildValue("(iiii)", -1,-1,-1,-1);
+  }
+
+  // display information depending on verbose level
+  if (verbose>0) printf("(pgl:_resolution:getResolution) Display %i/%i: %ix%i %iHz %ibits\n",displayNumber,numDisplays,mode.width,mode.height,mode.frameRate,mode.bitDepth);
+  if (verbose>1) pglDisplayPrintModes(displayNumber);
+
+  // return the screen resolution, frame rate, and bit depth
+  return Py_BuildValue("(iiii)", mode.width, mode.height, mode.frameRate, mode.bitDepth);
+}
+
+//////////////////////////////////////////
+//   getNumDisplaysAndDefault function  //
+//////////////////////////////////////////
+static PyObject* getNumDisplaysAndDefault(PyObject* self, PyObject* args)
+{
+  // return num displays and default display number
+  int numDisplays = pglDisplayGetCount();
+  int defaultDisplayNum = numDisplays-1;
+
+  return Py_BuildValue("(ii)", numDisplays, defaultDisplayNum);
+}
+
+////////////////////////////////
+//   getBackendName function  //
+////////////////////////////////
+static PyObject* getBackendName(PyObject* self, PyObject* args)
+{
+  return PyUnicode_FromString(pglDisplayGetBackendName());
+}
+
+/////////////////////
+//   setBestMode   //
+/////////////////////
+static int setBestMode(int displayNumber,int screenWidth,int screenHeight,int frameRate,int bitDepth,int verbose)
+{
+  // get all available display modes
+  pglDisplayMode *modes = (pglDisplayMode*)malloc(sizeof(pglDisplayMode) * PGL_MAX_DISPLAY_MODES);
+  if (modes == NULL) return 0;
+  int count = pglDisplayGetModes(displayNumber, modes, PGL_MAX_DISPLAY_MODES);
+
+  // find the closest match
+  pglDisplayMode best;
+  int bestIndex = pglDisplayFindBestMode(modes, count, screenWidth, screenHeight, frameRate, bitDepth, &best);
+  free(modes);
+  if (bestIndex < 0) return 0;
+
+  // print the mode that is being set
+  if (verbose > 0)
+    printf("(pgl:_resolution:setBestMode) Setting display %i to %ix%i %iHz %i bits\n",
+           displayNumber, best.width, best.height, best.frameRate, best.bitDepth);
+
+  // now go set the best matching mode
+  int retval = (pglDisplaySetModeByIndex(displayNumber, bestIndex) == 0);
+
+  if ((best.width != screenWidth) || (best.height != screenHeight) || (best.bitDepth != bitDepth) || (best.frameRate != frameRate)) {
+    pglDisplayPrintModes(displayNumber);
+    printf("(mglResolution:setBestMode) No exact mode match found (see avaliable modes printed above). Using closest match: %ix%i %i bits %iHz\n",best.width,best.height,best.bitDepth,best.frameRate);
+  }
+
+  return(retval);
+}
@@ -0,0 +1,190 @@
+################################################################
+#   filename: pglAssetPrefetch.py
+#    purpose: Loads the assets (e.g. images from disk) that upcoming
+#             trials need on a background thread, and turns them
+#             into textures a little at a time between frames, so
+#             that a trial starts with its textures ready to blit
+#             instead of loading and uploading them at trial start.
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import time
+import numpy as np
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass, field
+from .pglSerialize import pglSerialize
+
+#################################################################
+# pglAssetPrefetcher
+#################################################################
+class pglAssetPrefetcher:
+    '''
+    Cache of assets by key. request(key) starts loading an asset on a worker
+    thread with loadFunction(key) (disk I/O, decoding, conversion - anything
+    that does not talk to mglMetal). Loaded assets are turned into textures with
+    uploadFunction(key, loaded) by service(), which is called from the display
+    loop since only that thread may use the socket, and uploads at most
+    maxUploads assets each call so that no one frame takes the whole cost.
+
+    get(key) returns the ready asset. If it was not requested ahead of time, or
+    has not finished loading, get loads or waits for it and counts it as a miss
+    or late, so the lookahead can be tuned from getStats.
+
+    e.g.
+    prefetcher = pglAssetPrefetcher(loadFunction=lambda key: np.load(key), uploadFunction=lambda key, im: pgl.imageCreate(im))
+    prefetcher.request("next.npy")
+    ... each frame: prefetcher.service()
+    image = prefetcher.get("next.npy")
+    '''
+    def __init__(self, loadFunction, uploadFunction=None, maxWorkers=1, maxUploads=1, verbose=1):
+        '''
+        Args:
+            loadFunction (callable): loadFunction(key) returns the loaded asset. Runs on a worker thread.
+            uploadFunction (callable, optional): uploadFunction(key, loaded) returns what get will
+              return (e.g. pglImageInstances). Runs on the calling thread. Defaults to returning loaded.
+            maxWorkers (int, optional): Number of loading threads.
+            maxUploads (int, optional): Most assets to upload per call to service.
+            verbose (int, optional): Verbosity level.
+        '''
+        self.loadFunction = loadFunction
+        self.uploadFunction = uploadFunction
+        self.maxUploads = maxUploads
+        self.verbose = verbose
+        self.data = pglAssetPrefetchData()
+        # key -> future while loading, and key -> asset once uploaded
+        self.pending = {}
+        self.ready = {}
+        self._executor = ThreadPoolExecutor(max_workers=maxWorkers, thread_name_prefix="pglAssetPrefetcher")
+
+    def __repr__(self):
+        return f"pglAssetPrefetcher({len(self.ready)} ready, {len(self.pending)} loading, {self.data.nHits} hits, {self.data.nLate} late, {self.data.nMisses} misses)"
+
+    def __contains__(self, key):
+        return key in self.ready or key in self.pending
+
+    ################################################################
+    # request
+    ################################################################
+    def request(self, key):
+        '''
+        Start loading key if it is not already loaded or loading.
+        '''
+        if key in self: return
+        self.pending[key] = self._executor.submit(self._load, key)
+
+    def _load(self, key):
+        startTime = time.perf_counter()
+        loaded = self.loadFunction(key)
+        return (loaded, time.perf_counter() - startTime)
+
+    ################################################################
+    # service
+    ################################################################
+    def service(self, maxUploads=None):
+        '''
+        Upload assets that have finished loading (at most maxUploads). Call once per frame.
+
+        Returns:
+            int: Number of assets uploaded.
+        '''
+        if maxUploads is None: maxUploads = self.maxUploads
+        nUploaded = 0
+        for key in [key for key, future in self.pending.items() if future.done()]:
+            if nUploaded >= maxUploads: break
+            self._upload(key, self.pending.pop(key))
+            nUploaded += 1
+        return nUploaded
+
+    def _upload(self, key, future):
+        try:
+            loaded, loadTime = future.result()
+        except Exception as e:
+            print(f"(pglAssetPrefetcher:_upload) ❌ Could not load {key}: {e}")
+            self.ready[key] = None
+            return
+        self.data.loadTimes.append(loadTime)
+        startTime = time.perf_counter()
+        self.ready[key] = loaded if self.uploadFunction is None else self.uploadFunction(key, loaded)
+        self.data.uploadTimes.append(time.perf_counter() - startTime)
+
+    ################################################################
+    # get
+    ################################################################
+    def get(self, key):
+        '''
+        The asset for key, loading and uploading it now if it is not ready.
+        '''
+        if key in self.ready:
+            self.data.nHits += 1
+        elif key in self.pending:
+            # still loading (or loaded but not uploaded yet), wait for it
+            startTime = time.perf_counter()
+            self._upload(key, self.pending.pop(key))
+            self.data.waitTimes.append(time.perf_counter() - startTime)
+            self.data.nLate += 1
+            if self.verbose > 1: print(f"(pglAssetPrefetcher:get) Waited {1000*self.data.waitTimes[-1]:.1f} ms for {key}")
+        else:
+            # never requested, load here
+            startTime = time.perf_counter()
+            self.request(key)
+            self._upload(key, self.pending.pop(key))
+            self.data.waitTimes.append(time.perf_counter() - startTime)
+            self.data.nMisses += 1
+            if self.verbose > 1: print(f"(pglAssetPrefetcher:get) {key} was not prefetched, loaded in {1000*self.data.waitTimes[-1]:.1f} ms")
+        return self.ready[key]
+
+    ################################################################
+    # keep
+    ################################################################
+    def keep(self, keys):
+        '''
+        Drop every ready asset that is not in keys (dropping the last reference
+        to a pglImageInstance deletes its texture).
+        '''
+        keys = set(keys)
+        for key in [key for key in self.ready if key not in keys]:
+            del self.ready[key]
+
+    def close(self):
+        '''
+        Stop loading and drop all assets.
+        '''
+        for future in self.pending.values(): future.cancel()
+        self._executor.shutdown(wait=True)
+        self.pending = {}
+        self.ready = {}
+
+    ################################################################
+    # getStats
+    ################################################################
+    def getStats(self, printSummary=True):
+        '''
+        Summary of how often assets were ready when asked for, and of load, upload and wait times.
+        '''
+        def median(values): return float(np.median(values)) if values else np.nan
+        stats = {'nHits': self.data.nHits, 'nLate': self.data.nLate, 'nMisses': self.data.nMisses,
+                 'medianLoadTime': median(self.data.loadTimes), 'medianUploadTime': median(self.data.uploadTimes),
+                 'maxWaitTime': float(max(self.data.waitTimes)) if self.data.waitTimes else 0.0}
+        if printSummary:
+            print(f"(pglAssetPrefetcher:getStats) {stats['nHits']} ready, {stats['nLate']} late, {stats['nMisses']} not prefetched; "
+                  f"median load {1000*stats['medianLoadTime']:.1f} ms, upload {1000*stats['medianUploadTime']:.1f} ms, max wait {1000*stats['maxWaitTime']:.1f} ms")
+        return stats
+
+##############################################
+# Data for pglAssetPrefetcher
+##############################################
+@dataclass
+class pglAssetPrefetchData(pglSerialize):
+    # asked for and already uploaded
+    nHits: int = 0
+    # asked for while still loading
+    nLate: int = 0
+    # asked for without having been requested
+    nMisses: int = 0
+    loadTimes: list = field(default_factory=list)
+    uploadTimes: list = field(default_factory=list)
+    waitTimes: list = field(default_factory=list)
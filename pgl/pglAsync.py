@@ -0,0 +1,311 @@
+################################################################
+#   filename: pglAsync.py
+#    purpose: asyncio client for the mglMetal socket protocol, so
+#             that one event loop can drive rendering and device
+#             I/O (serial devices, trackers, photometers) without
+#             threads: commands are awaitable, flush resolves when
+#             the frame is presented, and devices are read as async
+#             event streams.
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import os
+import asyncio
+import struct
+import time
+import numpy as np
+from collections import deque
+from . import _pglComm as pglComm
+from . import _pglTimestamp
+
+# location of the command code definitions shared with mglMetal
+commandTypesFilename = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), "metal", "mglCommandTypes.h")
+
+# command results block that follows every command (after the ack)
+resultsFormat = [('commandCode', '@H'), ('success', '@I'), ('processedTime', '@d'), ('vertexStart', '@d'), ('vertexEnd', '@d'),
+                 ('fragmentStart', '@d'), ('fragmentEnd', '@d'), ('drawableAcquired', '@d'), ('drawablePresented', '@d')]
+resultsLength = sum(struct.calcsize(f) for _, f in resultsFormat)
+
+#################################################################
+# pglAsync
+#################################################################
+class pglAsync:
+    '''
+    asyncio client for mglMetal. Commands are written as soon as they are
+    called and answered in order by mglMetal, so a reader task matches each
+    answer to the command that is waiting for it; commands can be issued
+    without waiting for earlier ones (e.g. all of a frame's drawing) and the
+    caller only awaits what it needs, typically flush.
+
+    e.g.
+    async def main():
+        renderer = pglAsync()
+        await renderer.connect(socketName)
+        renderer.clearScreen([0.5, 0.5, 0.5])
+        presentedTime = await renderer.flush()
+        await renderer.close()
+    asyncio.run(main())
+    '''
+    def __init__(self, verbose=1):
+        self.verbose = verbose
+        self.commandResults = None
+        self._reader = None
+        self._writer = None
+        self._readerTask = None
+        # commands waiting for their answer, oldest first: (future, responseFormat)
+        self._waiting = deque()
+
+        # command codes, from the same header pglBase uses
+        comm = pglComm._pglComm.__new__(pglComm._pglComm)
+        comm.parseCommandValues(commandTypesFilename)
+        self.commandValues = {name: int(value) for name, value in comm.commandValues.items()}
+
+    ################################################################
+    # connect / close
+    ################################################################
+    async def connect(self, socketName, timeout=10):
+        '''
+        Connect to the mglMetal socket, retrying until it exists or timeout.
+        '''
+        startTime = time.time()
+        while True:
+            try:
+                self._reader, self._writer = await asyncio.open_unix_connection(socketName)
+                break
+            except (FileNotFoundError, ConnectionRefusedError):
+                if time.time() - startTime > timeout:
+                    print(f"(pglAsync:connect) ❌ Could not connect to {socketName}")
+                    return False
+                await asyncio.sleep(0.1)
+        self._readerTask = asyncio.get_running_loop().create_task(self._readAnswers())
+        if self.verbose > 0: print(f"(pglAsync:connect) Connected to: {socketName}")
+        return True
+
+    def isOpen(self):
+        return self._writer is not None
+
+    async def close(self):
+        '''
+        Close the connection (commands still waiting get a ConnectionError).
+        '''
+        if self._writer is None: return True
+        self._writer.close()
+        try:
+            await self._writer.wait_closed()
+        except OSError:
+            pass
+        self._writer = None
+        if self._readerTask is not None:
+            self._readerTask.cancel()
+            try:
+                await self._readerTask
+            except asyncio.CancelledError:
+                pass
+            self._readerTask = None
+        self._failWaiting(ConnectionError("(pglAsync) Connection closed"))
+        return True
+
+    ################################################################
+    # command
+    ################################################################
+    def command(self, commandName, payload=b'', responseFormat=None):
+        '''
+        Send a command without waiting for it.
+
+        Args:
+            commandName (str): e.g. "mglFlush".
+            payload (bytes): Data that follows the command code.
+            responseFormat (str, optional): struct format of the command specific
+              response that mglMetal sends between the ack and the command results.
+
+        Returns:
+            asyncio.Future: Resolves to (response, commandResults) when mglMetal answers,
+              where response is the unpacked responseFormat (or None).
+        '''
+        future = asyncio.get_running_loop().create_future()
+        if self._writer is None:
+            future.set_exception(ConnectionError("(pglAsync:command) Not connected"))
+            return future
+        commandValue = self.commandValues.get(commandName)
+        if commandValue is None:
+            future.set_exception(ValueError(f"(pglAsync:command) Command '{commandName}' not found"))
+            return future
+        self._waiting.append((future, responseFormat))
+        self._writer.write(struct.pack('@H', commandValue) + bytes(payload))
+        return future
+
+    async def _readAnswers(self):
+        # answers come back in the order the commands were written
+        try:
+            while True:
+                ack = struct.unpack('@d', await self._reader.readexactly(8))[0]
+                future, responseFormat = self._waiting.popleft()
+                response = None
+                if responseFormat is not None:
+                    response = struct.unpack(responseFormat, await self._reader.readexactly(struct.calcsize(responseFormat)))
+                    if len(response) == 1: response = response[0]
+                data = await self._reader.readexactly(resultsLength)
+                commandResults = {'ack': ack}
+                offset = 0
+                for name, fieldFormat in resultsFormat:
+                    commandResults[name] = struct.unpack_from(fieldFormat, data, offset)[0]
+                    offset += struct.calcsize(fieldFormat)
+                self.commandResults = commandResults
+                if not future.done(): future.set_result((response, commandResults))
+        except (asyncio.IncompleteReadError, ConnectionError, OSError) as e:
+            if self.verbose > 0 and self._writer is not None: print(f"(pglAsync:_readAnswers) ❌ Connection lost: {e}")
+            self._failWaiting(ConnectionError(f"(pglAsync) Connection lost: {e}"))
+
+    def _failWaiting(self, exception):
+        while self._waiting:
+            future, _ = self._waiting.popleft()
+            if not future.done(): future.set_exception(exception)
+
+    async def drain(self):
+        '''
+        Wait until everything written has been handed to the socket.
+        '''
+        if self._writer is not None: await self._writer.drain()
+
+    ################################################################
+    # commands
+    ################################################################
+    async def ping(self):
+        '''
+        Round trip time (seconds) of a ping.
+        '''
+        startTime = _pglTimestamp.getSecs()
+        await self.command("mglPing")
+        return _pglTimestamp.getSecs() - startTime
+
+    async def flush(self):
+        '''
+        Flush the frame. Resolves when the frame is presented.
+
+        Returns:
+            float: Time the frame was presented.
+        '''
+        _, commandResults = await self.command("mglFlush")
+        return commandResults['drawablePresented']
+
+    async def getTargetPresentationTimestamp(self):
+        '''
+        Time the next frame is scheduled to be presented.
+        '''
+        targetPresentationTimestamp, _ = await self.command("mglGetTargetPresentationTimestamp", responseFormat='@d')
+        return targetPresentationTimestamp
+
+    def clearScreen(self, color):
+        '''
+        Set the clear color (not awaited by default; await the result to wait for it).
+        '''
+        color = np.array(color, dtype=np.float32).ravel()
+        if color.size == 1: color = np.repeat(color, 3)
+        return self.command("mglSetClearColor", color[:3].tobytes())
+
+    def dots(self, xyz, color, dotSize=(1.0, 1.0), dotShape=1, dotAntialiasingBorder=0):
+        '''
+        Draw dots given in device coordinates (n x 2 or n x 3).
+        Each dot is x, y, z, r, g, b, a, width, height, shape, border (float32).
+        '''
+        xyz = np.atleast_2d(np.asarray(xyz, dtype=np.float32))
+        n = xyz.shape[0]
+        data = np.zeros((n, 11), dtype=np.float32)
+        data[:, 0:xyz.shape[1]] = xyz
+        data[:, 3:3 + len(color)] = color
+        if len(color) == 3: data[:, 6] = 1
+        data[:, 7:9] = dotSize
+        data[:, 9] = dotShape
+        data[:, 10] = dotAntialiasingBorder
+        return self.command("mglDots", struct.pack('@I', n) + data.tobytes())
+
+#################################################################
+# pglAsyncStream
+#################################################################
+class pglAsyncStream:
+    '''
+    Async event stream from a device, for use with async for. Events are
+    timestamped (_pglTimestamp clock) as soon as the event loop sees them.
+
+    fromFd: the event loop watches a file descriptor (a serial port, pipe or
+      socket) and calls readFunction() when it is readable - no thread and
+      no polling.
+    fromPoll: for devices with only a polling API, pollFunction() is called
+      every interval seconds on the event loop and each event it returns is
+      passed on.
+
+    e.g.
+    stream = pglAsyncStream.fromSerial(serialDevice)
+    async for timestamp, data in stream:
+        ...
+    '''
+    def __init__(self, maxsize=0):
+        self.queue = asyncio.Queue(maxsize)
+        self._close = None
+
+    @classmethod
+    def fromFd(cls, fd, readFunction):
+        '''
+        Stream of (timestamp, readFunction()) each time fd is readable. readFunction
+        should read what is available without blocking and return None if there is nothing.
+        '''
+        stream = cls()
+        loop = asyncio.get_running_loop()
+        def onReadable():
+            timestamp = _pglTimestamp.getSecs()
+            data = readFunction()
+            if data is not None: stream.queue.put_nowait((timestamp, data))
+        loop.add_reader(fd, onReadable)
+        stream._close = lambda: loop.remove_reader(fd)
+        return stream
+
+    @classmethod
+    def fromSerial(cls, serialDevice):
+        '''
+        Stream of (timestamp, bytes) from a pglSerial (or pyserial) port.
+        '''
+        port = getattr(serialDevice, 'serial', serialDevice)
+        def readAvailable():
+            nBytes = port.in_waiting
+            return port.read(nBytes) if nBytes else None
+        return cls.fromFd(port.fileno(), readAvailable)
+
+    @classmethod
+    def fromPoll(cls, pollFunction, interval=0.001):
+        '''
+        Stream of (timestamp, event) for each event returned by pollFunction().
+        '''
+        stream = cls()
+        async def pollLoop():
+            while True:
+                events = pollFunction()
+                if events:
+                    timestamp = _pglTimestamp.getSecs()
+                    for event in events: stream.queue.put_nowait((timestamp, event))
+                await asyncio.sleep(interval)
+        task = asyncio.get_running_loop().create_task(pollLoop())
+        stream._close = task.cancel
+        return stream
+
+    def close(self):
+        if self._close is not None:
+            self._close()
+            self._close = None
+
+    def __aiter__(self):
+        return self
+
+    async def __anext__(self):
+        return await self.queue.get()
+
+    def getAll(self):
+        '''
+        Everything that has arrived so far, without waiting.
+        '''
+        events = []
+        while not self.queue.empty(): events.append(self.queue.get_nowait())
+        return events
@@ -18,6 +18,8 @@ import sys
 import numpy as np
 from . import _pglComm as pglComm
 from . import _resolution
+from . import _pglEventListener
+from .pglTrace import traceLog
 from types import SimpleNamespace
 import signal
 import glob
@@ -28,8 +30,13 @@ import threading
 from pathlib import Path
 from dataclasses import dataclass, field
 from .pglSerialize import pglSerialize
+from .pglRefreshTracker import pglRefreshTracker
+from .pglMarkers import pglMarkers
 import re
 
+# trace log events (see pglTrace)
+traceFlush = traceLog.define("pglBase:flush", "presented {presented:.6f}", ("presented",))
+
 #############
 # Main class
 #############
@@ -38,6 +45,7 @@ class pglBase:
     # Variables
     ################################################################
     _verbose = 1 # verbosity level, 0 = silent, 1 = normal, 2 = verbose
+    _resultDetail = "full" # results read for drawing commands: "full", "flushOnly" or "summary"
     macOSversion = None
     cpuInfo = None
     gpuInfo = None
@@ -49,6 +57,18 @@ class pglBase:
     screenHeight = SimpleNamespace(pix = 0, cm = 0.0, deg = 0.0)
     distanceToScreen = SimpleNamespace(cm = 0.0)
     clearScreenColor = [0.0, 0.0, 0.0]
+    # stimulus onsets (see markOnset): count, onsetId -> label and presented time
+    # (of the last maxOnsetHistory onsets)
+    onsetCount = 0
+    onsetLabels = None
+    onsetTimes = None
+    maxOnsetHistory = 1024
+    # onsets marked on the frame being drawn
+    _pendingOnsetIds = ()
+    # measured refresh period and vsync phase (see getFramePeriod)
+    refreshTracker = None
+    # frame locked markers (see markers)
+    _markers = None
 
     ################################################################
     # Init Function
@@ -74,6 +94,10 @@ class pglBase:
         # get socket path
         self.metalSocketPath = os.path.join(self.homeDir, "Library/Containers/gru.mglMetal/Data")
 
+        # stimulus onsets published to the event listener
+        self.onsetLabels = {}
+        self.onsetTimes = {}
+
         # print what we are doing
         if self.verbose > 0: 
             print("(pglBase) Main library instance created")
@@ -112,10 +136,30 @@ class pglBase:
         # Print the new verbosity level
         if self._verbose > 0: print(f"(pglBase) Verbosity level set to {self._verbose}")
 
+    ################################################################
+    # resultDetail property
+    ################################################################
+    @property
+    def resultDetail(self):
+        # How much of the results of drawing commands is read (see _pglComm)
+        return self._resultDetail
+    @resultDetail.setter
+    def resultDetail(self, mode):
+        # Set to "full", "flushOnly" or "summary"
+        if mode not in pglComm._pglComm.resultDetailModes:
+            print(f"(pglBase) resultDetail must be one of {', '.join(pglComm._pglComm.resultDetailModes)}")
+            return
+        self._resultDetail = mode
+        # if we have a socket, set it there too (reading any results left unread first)
+        if hasattr(self, 's') and self.s:
+            self.s.readDeferredResults()
+            self.s.resultDetail = mode
+        if self._verbose > 0: print(f"(pglBase) resultDetail set to {self._resultDetail}")
+
     ################################################################
     # Open a screen
     ################################################################
-    def open(self, whichScreen=None, screenWidth=None, screenHeight=None, screenX=None, screenY=None, backgroundColor=None, stable=False, mglMetalPath=None):
+    def open(self, whichScreen=None, screenWidth=None, screenHeight=None, screenX=None, screenY=None, backgroundColor=None, stable=False, mglMetalPath=None, remoteAddress=None):
         """
         Open a screen on the specified display.
 
@@ -133,18 +177,25 @@ class pglBase:
                                      rather than looking for a later compiled version.
             mglMetalPath (str, optional): The file path to the mglMetal application, if omitted will search in the pgl directory
             backgroundColor (list, optional): The background color as a list of RGB values, each between 0 and 1.
+            remoteAddress (str, optional): "tcp://host:port" of a pglRelay on another machine, to draw with
+                                     the mglMetal running there instead of starting one here. whichScreen is
+                                     then a screen of that machine (default 0).
         Returns:
             bool: True if the screen was opened successfully, False otherwise.
         """
         self.printHeader("pglBase:open")
-        # get how many displays we have
-        (numDisplays, defaultDisplay) = self.getNumDisplaysAndDefault()
-        if whichScreen is None: whichScreen = defaultDisplay
-
-        # Check if the screen number is valid
-        if whichScreen < 0 or whichScreen >= numDisplays:
-            print(f"(pglBase:open) ❌ Error: Invalid screen number {whichScreen}. Must be between 0 and {numDisplays-1}.")
-            return False
+        if remoteAddress is None:
+            # get how many displays we have
+            (numDisplays, defaultDisplay) = self.getNumDisplaysAndDefault()
+            if whichScreen is None: whichScreen = defaultDisplay
+
+            # Check if the screen number is valid
+            if whichScreen < 0 or whichScreen >= numDisplays:
+                print(f"(pglBase:open) ❌ Error: Invalid screen number {whichScreen}. Must be between 0 and {numDisplays-1}.")
+                return False
+        elif whichScreen is None:
+            # the displays are on the other machine
+            whichScreen = 0
 
         # Check whether any screen positioning was provided, in which
         # case we will not open full screen
@@ -170,8 +221,11 @@ class pglBase:
         # create the socket path
         socketName = os.path.join(self.metalSocketPath, self.metalSocketName)
 
-        # start up mglMetal application
-        if not os.path.exists(self.metalAppName):
+        # start up mglMetal application (unless it is running on another machine behind a pglRelay)
+        if remoteAddress is not None:
+            if self.verbose > 0: print(f"(pglBase:open) Using mglMetal through relay: {remoteAddress}")
+            socketName = remoteAddress
+        elif not os.path.exists(self.metalAppName):
             print(f"(pglBase:open) ❌ Error: mglMetal application not found at {self.metalAppName}")
             return False
         else:
@@ -203,6 +257,7 @@ class pglBase:
             print("(pglBase:open) ❌ Error: Could not parse command types.")
             self.s = None
             return False
+        self.s.resultDetail = self._resultDetail
 
         # set the window location and size
         self.setWindowFrameInDisplay(whichScreen, screenX, screenY, screenWidth, screenHeight)
@@ -216,7 +271,13 @@ class pglBase:
         self.getWindowFrameInDisplay()
 
         # get frame rate
-        self.frameRate = self.getFrameRate(whichScreen)
+        if remoteAddress is None:
+            self.frameRate = self.getFrameRate(whichScreen)
+        else:
+            # the display is on the other machine, so time a few frames
+            presentedTimes = [self.flush() for iFrame in range(10)]
+            self.frameRate = round(1 / np.median(np.diff(presentedTimes)))
+        self.refreshTracker = pglRefreshTracker(nominalFrameRate=self.frameRate, verbose=self.verbose)
 
         # clear screen
         if backgroundColor is None:
@@ -244,6 +305,9 @@ class pglBase:
          # make sure that a screen is open
         if self.isOpen() is False: return True
         
+        # send markers that are still waiting
+        if self._markers is not None: self._markers.close()
+
         # Print what we are doing
         if self.verbose > 0: 
             self.printHeader("pglBase:close")
@@ -254,6 +318,13 @@ class pglBase:
             print("(pglBase:close) ❌ Not connected to socket")
             return False
         
+        # through a pglRelay, the relay looks after mglMetal on its machine
+        if self.s.isRemote:
+            self.s.close()
+            self.s = None
+            if getattr(self, '_resources', None) is not None: self._resources.closed()
+            return True
+
         # get the PID of the mglMetal application
         pid = self.s.getPID()
         if pid is None:
@@ -271,6 +342,8 @@ class pglBase:
         # Close the socket
         self.s.close()
         self.s = None
+        # what the renderer held went with it
+        if getattr(self, '_resources', None) is not None: self._resources.closed()
         if self.verbose>0: self.printHeader()
         return True
     
@@ -294,8 +367,10 @@ class pglBase:
         if self.isOpen() is False: 
             print(f"(pglBase:flush) ❌ No screen is open")
             return None
+        if self._markers is not None: self._markers.beforeFlush()
         self.s.writeCommand("mglFlush")
         self.commandResults = self.s.readCommandResults()
+        if traceLog.on and self.commandResults is not None: traceLog.record(traceFlush, self.commandResults.get('drawablePresented', 0))
         
         # keep profile information if profileMode is set
         if self.profileMode > 0:
@@ -314,12 +389,109 @@ class pglBase:
                 self.profileModeCommandResults[self.profileModeBufferIndex] = self.commandResults 
             self.profileModeBufferIndex += 1
         
+        # publish the stimulus onsets marked for this frame
+        if self._pendingOnsetIds:
+            presentedTime = self.commandResults.get('drawablePresented', 0)
+            if presentedTime > 0:
+                for onsetId in self._pendingOnsetIds:
+                    _pglEventListener.publishOnset(float(presentedTime), onsetId)
+                    self.onsetTimes[onsetId] = float(presentedTime)
+            self._pendingOnsetIds = ()
+
+        # measure the refresh period from when frames are presented
+        if self.refreshTracker is not None:
+            self.refreshTracker.update(self.commandResults.get('drawablePresented', 0))
+
+        # send the frame's markers stamped with its presented time
+        if self._markers is not None: self._markers.frameFlushed(self.commandResults.get('drawablePresented', 0))
+
+        # close the frame's upload count
+        resources = getattr(self, '_resources', None)
+        if resources is not None: resources.frameEnd()
+
         # reset line counter for pglDraw:text
         self.currentLine = 1
         
         # success
         return self.commandResults.get('drawablePresented', None)
     
+    ################################################################
+    # markOnset
+    ################################################################
+    def markOnset(self, label=None):
+        """
+        Mark the frame being drawn as a stimulus onset. When it is flushed, its
+        presentation time is published to the event listener, which stamps
+        key and mouse button events with their latency from the most recent
+        onset at the event's own timestamp (onsetLatency and onsetId), so
+        reaction times do not depend on how often the loop runs.
+
+        Args:
+            label (optional): What the onset is (e.g. (taskID, trial, segment)), kept in onsetLabels.
+
+        Returns:
+            int: The onsetId.
+        """
+        self.onsetCount += 1
+        # several tasks can mark onsets on the same frame, they all get its presented time
+        self._pendingOnsetIds = (*self._pendingOnsetIds, self.onsetCount)
+        self.onsetLabels[self.onsetCount] = label
+        # forget the oldest onsets (dicts keep the order onsets were marked in)
+        while len(self.onsetLabels) > self.maxOnsetHistory: self.onsetLabels.pop(next(iter(self.onsetLabels)))
+        while len(self.onsetTimes) > self.maxOnsetHistory: self.onsetTimes.pop(next(iter(self.onsetTimes)))
+        return self.onsetCount
+
+    ################################################################
+    # markers
+    ################################################################
+    @property
+    def markers(self):
+        """
+        Frame locked marker service (see pglMarkers): markers for external
+        systems (digital lines, VPixx pixel mode, eye tracker messages, the
+        data log) marked on the frame being drawn and sent once it is
+        presented, stamped with its presented time.
+        """
+        if self._markers is None: self._markers = pglMarkers(self)
+        return self._markers
+
+    ################################################################
+    # getFramePeriod
+    ################################################################
+    def getFramePeriod(self):
+        """
+        Frame period measured from when frames were presented (see
+        pglRefreshTracker), which is more precise than 1/getFrameRate
+        (e.g. 59.94 Hz displays report 59 Hz) and follows variable refresh
+        displays. Until enough frames have been flushed, this is the
+        nominal period.
+
+        Returns:
+            float: Frame period in seconds.
+        """
+        if self.refreshTracker is not None and self.refreshTracker.framePeriod:
+            return self.refreshTracker.framePeriod
+        frameRate = getattr(self, 'frameRate', 0)
+        return 1.0 / frameRate if frameRate else 1.0 / 60.0
+
+    ################################################################
+    # getNextVsync
+    ################################################################
+    def getNextVsync(self, t=None):
+        """
+        Predicted time of the next vsync, from the measured period and phase.
+        Unlike getTargetPresentationTimestamp, this needs no round trip to mglMetal.
+
+        Args:
+            t (float, optional): Predict the first vsync at or after this time (default now).
+
+        Returns:
+            float: Time of the vsync (same clock as getSecs).
+        """
+        if t is None: t = self.getSecs()
+        if self.refreshTracker is None: return t + self.getFramePeriod()
+        return self.refreshTracker.nextVsync(t)
+
     ################################################################
     # setDesiredFrameRate
     ################################################################
@@ -529,7 +701,7 @@ class pglBase:
 
         self.s.writeCommand("mglSampleTimestamps")
         ack = self.s.readAck()
-        cpuTime = self.s.read(np.double)
+        cpuTime = self.s.toLocalTime(self.s.read(np.double))
         gpuTime = self.s.read(np.double)
         self.commandResults = self.s.readCommandResults(ack)
 
@@ -552,7 +724,7 @@ class pglBase:
 
         self.s.writeCommand("mglGetTargetPresentationTimestamp")
         ack = self.s.readAck()
-        targetPresentationTimestamp = self.s.read(np.double)
+        targetPresentationTimestamp = self.s.toLocalTime(self.s.read(np.double))
         self.commandResults = self.s.readCommandResults(ack)
 
         return targetPresentationTimestamp
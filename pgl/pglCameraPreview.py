@@ -0,0 +1,375 @@
+################################################################
+#   filename: pglCameraPreview.py
+#    purpose: Live preview of an eye tracker camera. A background
+#             thread grabs frames at the camera rate into a small
+#             ring of luminance buffers, and the display side shows
+#             the newest frame by updating one persistent texture,
+#             without ever waiting on the camera. Frames that were
+#             never shown and frames shown late are counted.
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import threading
+import time
+import numpy as np
+from dataclasses import dataclass, field
+from .pglSerialize import pglSerialize
+from . import _pglTimestamp
+try:
+    from . import _pglPalette
+except ImportError:
+    _pglPalette = None
+    print("(pglCameraPreview) ❌ Could not import _pglPalette, camera frames will be converted in python. Try running 'make force'")
+
+#################################################################
+# pglCameraSource
+#################################################################
+class pglCameraSource:
+    '''
+    Where pglCameraPreview gets its frames from. Subclasses implement grab,
+    which returns the current camera frame as a 2D luminance array (uint8,
+    or float in 0-1) or None if there is none.
+    '''
+    def __init__(self, frameRate=60.0):
+        self.frameRate = frameRate
+
+    def grab(self):
+        return None
+
+    def close(self):
+        pass
+
+#################################################################
+# pglCameraSourceTrackPixx
+#################################################################
+class pglCameraSourceTrackPixx(pglCameraSource):
+    '''
+    Frames from a TrackPixx3 (via pypixxlib._libdpx). The library is not
+    thread safe, so every call goes through lock, which the pglTrackPixx3
+    instance also holds for its own calls.
+    '''
+    def __init__(self, dp, lock, frameRate=60.0):
+        super().__init__(frameRate)
+        self.dp = dp
+        self.lock = lock
+
+    def grab(self):
+        with self.lock:
+            self.dp.DPxUpdateRegCache()
+            image = self.dp.TPxGetEyeImage()
+        return image
+
+#################################################################
+# pglCameraSourceFake
+#################################################################
+class pglCameraSourceFake(pglCameraSource):
+    '''
+    Synthetic eye camera for testing without a tracker: two dark pupils
+    with bright corneal reflections drifting over a noisy background.
+    grabTime simulates the time the transfer from the camera takes, and
+    with probability stallProbability a grab takes stallTime longer
+    (e.g. a busy USB bus), so that dropped and late frames can be tested.
+    '''
+    def __init__(self, width=640, height=240, frameRate=60.0, grabTime=0.002, stallProbability=0.0, stallTime=0.05, seed=None):
+        super().__init__(frameRate)
+        self.width = width
+        self.height = height
+        self.grabTime = grabTime
+        self.stallProbability = stallProbability
+        self.stallTime = stallTime
+        self.nGrabs = 0
+        self.rng = np.random.default_rng(seed)
+
+        # a few background frames to cycle through, and the pixel grid
+        self.backgrounds = [np.clip(self.rng.normal(150, 12, (height, width)), 0, 255).astype(np.uint8) for i in range(4)]
+        self.y, self.x = np.mgrid[0:height, 0:width]
+
+    def grab(self):
+        startTime = time.perf_counter()
+        image = self.backgrounds[self.nGrabs % len(self.backgrounds)].copy()
+
+        # pupils drift slowly around the center of each half of the image
+        t = self.nGrabs / self.frameRate
+        radius = self.height / 8
+        for eye, centerX in enumerate([self.width / 4, 3 * self.width / 4]):
+            pupilX = centerX + radius * np.cos(2 * np.pi * 0.25 * t + eye)
+            pupilY = self.height / 2 + radius * np.sin(2 * np.pi * 0.25 * t + eye) / 2
+            # only the box around the pupil needs to be drawn
+            top, left = max(0, int(pupilY - radius)), max(0, int(pupilX - radius))
+            bottom, right = min(self.height, int(pupilY + radius) + 1), min(self.width, int(pupilX + radius) + 1)
+            x, y = self.x[top:bottom, left:right], self.y[top:bottom, left:right]
+            box = image[top:bottom, left:right]
+            box[(x - pupilX)**2 + (y - pupilY)**2 < radius**2] = 20
+            box[(x - pupilX - radius / 3)**2 + (y - pupilY - radius / 3)**2 < (radius / 6)**2] = 250
+        self.nGrabs += 1
+
+        # take as long as a transfer from the camera would
+        duration = self.grabTime
+        if self.stallProbability > 0 and self.rng.random() < self.stallProbability: duration += self.stallTime
+        remaining = duration - (time.perf_counter() - startTime)
+        if remaining > 0: time.sleep(remaining)
+        return image
+
+#################################################################
+# pglCameraPreview
+#################################################################
+class pglCameraPreview:
+    '''
+    Live camera preview. The grabber thread keeps the newest frames in a ring
+    of nRing luminance (uint8) buffers; update, called from the display loop,
+    takes whatever frame is newest (never waiting for one), expands it to the
+    RGBA float32 that mglMetal textures take and sends it to one texture that
+    is created once and then updated in place.
+
+    With three buffers the grabber always has a buffer to write into that is
+    neither the newest frame nor the one being shown, so neither side waits
+    on the other except for swapping indexes.
+
+    e.g.
+    preview = pglCameraPreview(pgl, pglCameraSourceFake())
+    preview.start()
+    while running:
+        image = preview.update()
+        if image is not None: image.display()
+        pgl.flush()
+    preview.stop()
+    preview.getStats()
+    '''
+    # latencies and grab durations kept for getStats: the last maxHistory frames, trimmed
+    # back to that once there are twice as many (lists, so that the data saves as JSON)
+    maxHistory = 4096
+
+    def __init__(self, pgl, source, nRing=3, latenessFrames=2.0, verbose=1):
+        '''
+        Args:
+            pgl: pgl instance (or anything with imageCreate / imageUpdate) to make the texture on.
+            source (pglCameraSource): Where frames come from.
+            nRing (int, optional): Number of frame buffers in the ring (at least 3).
+            latenessFrames (float, optional): A frame is counted late if it is shown more
+              than this many frame periods (of the camera or the display, whichever is
+              slower) after it was grabbed.
+            verbose (int, optional): Verbosity level.
+        '''
+        self.pgl = pgl
+        self.source = source
+        self.nRing = max(3, int(nRing))
+        self.latenessFrames = latenessFrames
+        self.verbose = verbose
+        self.data = pglCameraPreviewData()
+
+        # ring of luminance frames, with the frame number and grab time of each
+        self.ring = [None] * self.nRing
+        self.ringFrameNumbers = [0] * self.nRing
+        self.ringGrabTimes = [0.0] * self.nRing
+        self._ringLock = threading.Lock()
+        self._newest = -1
+        self._reading = -1
+
+        # texture, the RGBA buffer it is sent from, and a gray palette to expand luminance with
+        self.texture = None
+        self.textureBuffer = None
+        self.grayPalette = np.repeat(np.arange(256, dtype=np.float32)[:, np.newaxis] / 255, 4, axis=1)
+        self.grayPalette[:, 3] = 1
+        self.lastShownFrameNumber = 0
+
+        self._thread = None
+        self._running = False
+
+    def __repr__(self):
+        return f"pglCameraPreview({self.data.nGrabbed} grabbed, {self.data.nShown} shown, {self.data.nDropped} dropped, {self.data.nLate} late)"
+
+    ################################################################
+    # start / stop
+    ################################################################
+    def start(self):
+        '''
+        Start grabbing frames.
+        '''
+        if self._running: return True
+        self._running = True
+        self._thread = threading.Thread(target=self._grabLoop, name="pglCameraPreview", daemon=True)
+        self._thread.start()
+        return True
+
+    def stop(self, deleteTexture=True):
+        '''
+        Stop grabbing frames (and release the texture).
+        '''
+        self._running = False
+        if self._thread is not None:
+            self._thread.join(timeout=2)
+            self._thread = None
+        if deleteTexture: self.texture = None
+        return True
+
+    def isRunning(self):
+        return self._running
+
+    ################################################################
+    # _grabLoop
+    ################################################################
+    def _grabLoop(self):
+        framePeriod = 1.0 / self.source.frameRate
+        nextGrab = _pglTimestamp.getSecs()
+        frameNumber = 0
+        while self._running:
+            # wait for the next camera frame
+            self._sleepUntil(nextGrab)
+            grabStart = _pglTimestamp.getSecs()
+            try:
+                image = self.source.grab()
+            except Exception as e:
+                print(f"(pglCameraPreview:_grabLoop) ❌ Could not grab camera frame: {e}")
+                self._running = False
+                return
+            grabEnd = _pglTimestamp.getSecs()
+            self.data.grabDurations.append(grabEnd - grabStart)
+            if len(self.data.grabDurations) > 2 * self.maxHistory: del self.data.grabDurations[:-self.maxHistory]
+
+            # grab ran past one or more camera frames, pick up again at the next one
+            nextGrab += framePeriod
+            if grabEnd > nextGrab:
+                nMissed = int((grabEnd - nextGrab) // framePeriod) + 1
+                self.data.nMissed += nMissed
+                nextGrab += nMissed * framePeriod
+            if image is None: continue
+
+            # write into a buffer that is neither the newest nor the one being shown
+            with self._ringLock:
+                slot = next(i for i in range(self.nRing) if i != self._newest and i != self._reading)
+            self._storeFrame(slot, image)
+            frameNumber += 1
+            with self._ringLock:
+                self.ringFrameNumbers[slot] = frameNumber
+                self.ringGrabTimes[slot] = grabStart
+                self._newest = slot
+            self.data.nGrabbed = frameNumber
+
+    def _storeFrame(self, slot, image):
+        # keep frames as uint8 luminance
+        image = np.asarray(image)
+        if image.ndim == 3: image = image[..., 0]
+        if image.dtype != np.uint8:
+            scale = 255.0 if image.size and np.max(image) <= 1 else 1.0
+            image = np.clip(image * scale, 0, 255).astype(np.uint8)
+        if self.ring[slot] is None or self.ring[slot].shape != image.shape:
+            self.ring[slot] = np.empty(image.shape, dtype=np.uint8)
+        np.copyto(self.ring[slot], image)
+
+    def _sleepUntil(self, t):
+        remaining = t - _pglTimestamp.getSecs()
+        if remaining > 0: time.sleep(remaining)
+
+    ################################################################
+    # getLatest
+    ################################################################
+    def getLatest(self):
+        '''
+        Newest frame without waiting for one.
+
+        Returns:
+            tuple: (frameNumber, grabTime, copy of the luminance image), or None if
+              no frame has been grabbed yet.
+        '''
+        with self._ringLock:
+            if self._newest < 0: return None
+            slot = self._newest
+            return (self.ringFrameNumbers[slot], self.ringGrabTimes[slot], self.ring[slot].copy())
+
+    ################################################################
+    # update
+    ################################################################
+    def update(self):
+        '''
+        Send the newest frame to the texture if there is a new one. Call once per
+        display frame.
+
+        Returns:
+            pglImageInstance: The preview texture (None until the first frame arrives).
+        '''
+        # take the newest frame, marking it so the grabber does not write over it
+        with self._ringLock:
+            slot = self._newest
+            if slot < 0 or self.ringFrameNumbers[slot] == self.lastShownFrameNumber:
+                return self.texture
+            self._reading = slot
+            frameNumber = self.ringFrameNumbers[slot]
+            grabTime = self.ringGrabTimes[slot]
+        try:
+            frame = self.ring[slot]
+            height, width = frame.shape
+
+            # expand luminance into the RGBA buffer
+            if self.textureBuffer is None or self.textureBuffer.shape[:2] != (height, width):
+                self.textureBuffer = np.empty((height, width, 4), dtype=np.float32)
+                self.texture = None
+            if _pglPalette is not None:
+                _pglPalette.expandImage(frame, self.grayPalette, self.textureBuffer)
+            else:
+                self.textureBuffer[...] = self.grayPalette[frame]
+        finally:
+            with self._ringLock:
+                self._reading = -1
+
+        # send to the texture, creating it the first time
+        if self.texture is None:
+            self.texture = self.pgl.imageCreate(self.textureBuffer)
+            if self.texture is None: return None
+        else:
+            self.pgl.imageUpdate(self.texture, self.textureBuffer)
+
+        # count frames that were never shown and frames shown late
+        shownTime = _pglTimestamp.getSecs()
+        latency = shownTime - grabTime
+        self.data.latencies.append(latency)
+        if len(self.data.latencies) > 2 * self.maxHistory: del self.data.latencies[:-self.maxHistory]
+        self.data.nDropped += max(0, frameNumber - self.lastShownFrameNumber - 1)
+        displayRate = getattr(self.pgl, 'frameRate', None) or self.source.frameRate
+        if latency > self.latenessFrames / min(self.source.frameRate, displayRate):
+            self.data.nLate += 1
+            if self.verbose > 1: print(f"(pglCameraPreview:update) Frame {frameNumber} shown {1000*latency:.1f} ms after it was grabbed")
+        self.data.nShown += 1
+        self.lastShownFrameNumber = frameNumber
+        return self.texture
+
+    ################################################################
+    # getStats
+    ################################################################
+    def getStats(self, printSummary=True):
+        '''
+        Summary of grabbed, shown, dropped and late frames and of latency from grab to texture
+        (over the recent frames that are kept, see maxHistory).
+        '''
+        latencies = np.array(self.data.latencies)
+        grabDurations = np.array(self.data.grabDurations)
+        stats = {'nGrabbed': self.data.nGrabbed, 'nShown': self.data.nShown, 'nDropped': self.data.nDropped,
+                 'nLate': self.data.nLate, 'nMissed': self.data.nMissed,
+                 'medianLatency': float(np.median(latencies)) if latencies.size else np.nan,
+                 'maxLatency': float(np.max(latencies)) if latencies.size else np.nan,
+                 'medianGrabDuration': float(np.median(grabDurations)) if grabDurations.size else np.nan}
+        if printSummary:
+            print(f"(pglCameraPreview:getStats) {stats['nGrabbed']} grabbed, {stats['nShown']} shown, {stats['nDropped']} dropped, "
+                  f"{stats['nLate']} late, {stats['nMissed']} camera frames missed by the grabber")
+            print(f"  latency grab to texture: median {1000*stats['medianLatency']:.2f} ms, max {1000*stats['maxLatency']:.2f} ms")
+        return stats
+
+##############################################
+# Data for pglCameraPreview
+##############################################
+@dataclass
+class pglCameraPreviewData(pglSerialize):
+    nGrabbed: int = 0
+    nShown: int = 0
+    # grabbed but overwritten by a newer frame before they could be shown
+    nDropped: int = 0
+    # shown more than latenessFrames after being grabbed
+    nLate: int = 0
+    # camera frames that passed while the grabber was busy
+    nMissed: int = 0
+    # of recent frames (see pglCameraPreview.maxHistory)
+    grabDurations: list = field(default_factory=list)
+    latencies: list = field(default_factory=list)
@@ -0,0 +1,381 @@
+################################################################
+#   filename: pglColor.py
+#    purpose: Colour spaces (luminance, contrast, XYZ, xyY, LMS,
+#             DKL) converted to display values through the
+#             display calibration, for the pgl psychophysics
+#             and experiment library
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import numpy as np
+from collections import OrderedDict
+
+#############
+# Display color
+#############
+class pglDisplayColor(np.ndarray):
+    '''
+    Colors that have already been converted to display values, so
+    that validateColor passes them through rather than converting
+    them again (e.g. stimuli that validate their colors once and then
+    redraw them every frame)
+    '''
+    pass
+
+#################################################################
+# pglColorEngine
+#################################################################
+class pglColorEngine:
+    '''
+    Converts colors from a color space to display values. Every space
+    is an affine transform away from linear RGB (the light each gun
+    puts out, 0-1), which the calibration's inverse gamma table then
+    turns into the value to send to the display. The transform for a
+    space is worked out once, and colors are converted by _pglColor
+    in one pass, so a single color, the vertices of a primitive or
+    the pixels of a texture cost the same per color.
+
+    The luminance calibration measures luminance only, so the
+    chromaticities of the primaries default to sRGB / Rec. 709 with
+    a D65 white and can be set from a spectroradiometer measurement.
+    Cone excitations use the Smith & Pokorny fundamentals scaled so
+    that L+M is luminance. DKL is cartesian (luminance, L-M, S) around
+    the background: the luminance axis is a luminance contrast, the
+    L-M axis has a pooled L,M cone contrast of 1 and the S axis an S
+    cone contrast of 1.
+    '''
+    # spaces, and what is in the color channels
+    colorSpaces = {
+        "rgb": "display values (passed through as is)",
+        "linear": "linear RGB, 0-1 of each gun's light",
+        "luminance": "cd/m2",
+        "contrast": "luminance contrast relative to the background",
+        "xyz": "CIE 1931 XYZ (Y in cd/m2)",
+        "xyY": "CIE 1931 chromaticity x, y and luminance Y (cd/m2)",
+        "lms": "Smith & Pokorny cone excitations (L+M in cd/m2)",
+        "dkl": "DKL luminance, L-M and S cone contrast around the background",
+    }
+    # sRGB / Rec. 709 primaries and D65 white (CIE xy)
+    defaultPrimaries = np.array([[0.640, 0.330], [0.300, 0.600], [0.150, 0.060]])
+    defaultWhitePoint = np.array([0.3127, 0.3290])
+    # Smith & Pokorny cone fundamentals from XYZ
+    xyzToLms = np.array([[ 0.15514, 0.54312, -0.03286],
+                         [-0.15514, 0.45684,  0.03286],
+                         [ 0.0,     0.0,      0.00801]])
+    # number of conversions of a few colors kept
+    cacheSize = 256
+    # colors with more rows than this are not cached
+    cacheMaxRows = 16
+    _pglColor = None
+
+    def __init__(self, calibrationData=None, primaries=None, whitePoint=None, linearized=False, lutSize=1024):
+        '''
+        Args:
+            calibrationData (pglDisplayLuminanceCalibrationData): luminance calibration of the
+                display. If None, luminance is relative (0-1) and the display is taken as linear.
+            primaries (array-like): CIE xy chromaticities of the red, green and blue guns (3 x 2).
+            whitePoint (array-like): CIE xy chromaticity of the display white.
+            linearized (bool): True if the inverse gamma table of the calibration is already
+                loaded into the display's gamma table, so linear RGB is sent as is.
+            lutSize (int): entries in the inverse gamma table used for conversion.
+        '''
+        self.minLuminance, self.maxLuminance = 0.0, 1.0
+        self.lut = None
+        self.primaries, self.whitePoint = self.defaultPrimaries, self.defaultWhitePoint
+        self._transforms = {}
+        self._cache = OrderedDict()
+        if calibrationData is not None:
+            self.setCalibration(calibrationData, linearized, lutSize)
+        self.setPrimaries(primaries, whitePoint)
+
+    ################################################################
+    # setCalibration
+    ################################################################
+    def setCalibration(self, calibrationData, linearized=False, lutSize=1024):
+        '''
+        Set the luminance range and the inverse gamma table from a luminance calibration
+        '''
+        medians = calibrationData.getMedianMeasurements()
+        if medians is None:
+            print("(pglColorEngine:setCalibration) ❌ Calibration has no measurements")
+            return False
+        values, measurements = medians[0], medians[1]
+        order = np.argsort(values)
+        values, measurements = values[order], measurements[order]
+        self.minLuminance, self.maxLuminance = float(np.min(measurements)), float(np.max(measurements))
+        if self.maxLuminance <= self.minLuminance:
+            print("(pglColorEngine:setCalibration) ❌ Calibration measurements do not increase")
+            return False
+        if linearized:
+            self.lut = None
+        else:
+            # display value for evenly spaced linear values, measurement noise
+            # is kept from making the table go down
+            normalized = np.maximum.accumulate((measurements - self.minLuminance) / (self.maxLuminance - self.minLuminance))
+            self.lut = np.interp(np.linspace(0, 1, lutSize), normalized, values).astype(np.float32)
+        # the matrices are in cd/m2, so follow the new luminance range
+        self._setMatrices()
+        return True
+
+    ################################################################
+    # setPrimaries
+    ################################################################
+    def setPrimaries(self, primaries=None, whitePoint=None):
+        '''
+        Set the chromaticities of the guns and white (CIE xy), default sRGB with a D65 white
+        '''
+        self.primaries = self.defaultPrimaries if primaries is None else np.asarray(primaries, dtype=np.float64).reshape(3, 2)
+        self.whitePoint = self.defaultWhitePoint if whitePoint is None else np.asarray(whitePoint, dtype=np.float64).reshape(2)
+        self._setMatrices()
+
+    def _setMatrices(self):
+        # XYZ of each primary (columns) with Y of 1, scaled so they add to the white
+        primaries, whitePoint = self.primaries, self.whitePoint
+        x, y = primaries[:, 0], primaries[:, 1]
+        primaryXYZ = np.array([x / y, np.ones(3), (1 - x - y) / y])
+        whiteXYZ = np.array([whitePoint[0] / whitePoint[1], 1.0, (1 - whitePoint[0] - whitePoint[1]) / whitePoint[1]])
+        scale = np.linalg.solve(primaryXYZ, whiteXYZ)
+        # linear RGB to XYZ in cd/m2, with black taken as a dim white
+        self.rgbToXyz = primaryXYZ * scale * (self.maxLuminance - self.minLuminance)
+        self.blackXyz = whiteXYZ * self.minLuminance
+        self.xyzToRgb = np.linalg.inv(self.rgbToXyz)
+        self.clearCache()
+
+    ################################################################
+    # clearCache
+    ################################################################
+    def clearCache(self):
+        '''
+        Forget the transforms and conversions worked out so far
+        '''
+        self._transforms = {}
+        self._cache = OrderedDict()
+
+    ################################################################
+    # getTransform
+    ################################################################
+    def getTransform(self, space, background=None):
+        '''
+        Get the affine transform from a color space to linear RGB
+
+        Args:
+            space (str): one of colorSpaces
+            background (float or array-like): background in linear RGB for contrast and dkl (default 0.5 gray)
+
+        Returns:
+            tuple: (matrix, offset) so that linear RGB = matrix @ color + offset
+        '''
+        background = np.broadcast_to(np.asarray(0.5 if background is None else background, dtype=np.float64), (3,))
+        key = (space, background.tobytes())
+        transform = self._transforms.get(key)
+        if transform is not None: return transform
+
+        identity = np.eye(3)
+        luminanceRange = self.maxLuminance - self.minLuminance
+        xyzOffset = -self.xyzToRgb @ self.blackXyz
+        lmsToRgb = self.xyzToRgb @ np.linalg.inv(self.xyzToLms)
+        if space == "linear":
+            transform = (identity, np.zeros(3))
+        elif space == "luminance":
+            transform = (identity / luminanceRange, np.full(3, -self.minLuminance / luminanceRange))
+        elif space == "contrast":
+            # luminance of the background times 1 + contrast
+            backgroundLuminance = (self.rgbToXyz @ background + self.blackXyz)[1]
+            transform = (identity * backgroundLuminance / luminanceRange, background)
+        elif space in ("xyz", "xyY"):
+            transform = (self.xyzToRgb, xyzOffset)
+        elif space == "lms":
+            transform = (lmsToRgb, xyzOffset)
+        elif space == "dkl":
+            backgroundLms = self.xyzToLms @ (self.rgbToXyz @ background + self.blackXyz)
+            l, m, s = backgroundLms
+            axes = np.column_stack((backgroundLms, np.array([1.0, -1.0, 0.0]) / np.sqrt(1 / l**2 + 1 / m**2), np.array([0.0, 0.0, s])))
+            transform = (lmsToRgb @ axes, background)
+        else:
+            print(f"(pglColorEngine:getTransform) ❌ Unknown color space {space}, must be one of {list(self.colorSpaces)}")
+            return None
+        self._transforms[key] = transform
+        return transform
+
+    ################################################################
+    # convert
+    ################################################################
+    def convert(self, color, space, background=None):
+        '''
+        Convert colors to display values
+
+        Args:
+            color (array-like): colors with 3 channels (or 4 with alpha) in their last dimension,
+                e.g. n x 3 vertex colors or h x w x 4 texture pixels. luminance and contrast
+                also take 1 channel, which for dkl is the luminance axis.
+            space (str): one of colorSpaces
+            background (float or array-like): background in linear RGB for contrast and dkl
+
+        Returns:
+            pglDisplayColor: float32 display values of the same shape (3 or 4 channels)
+        '''
+        color = np.asarray(color)
+        if color.dtype != np.float32: color = color.astype(np.float64)
+        if space == "rgb": return color.astype(np.float32).view(pglDisplayColor)
+        if color.ndim == 0: color = color.reshape(1, 1)
+        if color.shape[-1] == 1:
+            # one channel, the same in each gun or the luminance axis of dkl
+            if space == "dkl":
+                color = np.concatenate((color, np.zeros(color.shape[:-1] + (2,), dtype=color.dtype)), axis=-1)
+            else:
+                color = np.repeat(color, 3, axis=-1)
+        if color.shape[-1] not in (3, 4):
+            print(f"(pglColorEngine:convert) ❌ Colors must have 1, 3 or 4 channels, not {color.shape[-1]}")
+            return None
+
+        # small conversions (a color set every trial) are remembered
+        key = None
+        if color.size <= 4 * self.cacheMaxRows:
+            key = (space, None if background is None else np.asarray(background, dtype=np.float64).tobytes(), color.dtype.char, color.shape, color.tobytes())
+            values = self._cache.get(key)
+            if values is not None:
+                self._cache.move_to_end(key)
+                return values.copy().view(pglDisplayColor)
+
+        transform = self.getTransform(space, background)
+        if transform is None: return None
+        values = self._transform(color, transform[0], transform[1], space == "xyY")
+
+        if key is not None:
+            self._cache[key] = values.copy()
+            if len(self._cache) > self.cacheSize: self._cache.popitem(last=False)
+        return values.view(pglDisplayColor)
+
+    ################################################################
+    # _transform
+    ################################################################
+    def _transform(self, color, matrix, offset, xyY):
+        '''
+        Apply the transform and the inverse gamma table in _pglColor (numpy if it is not compiled)
+        '''
+        if pglColorEngine._pglColor is None:
+            try:
+                from . import _pglColor
+                pglColorEngine._pglColor = _pglColor
+            except ImportError:
+                pglColorEngine._pglColor = False
+                print("(pglColorEngine:convert) ❌ Could not import _pglColor, converting with numpy instead: You may need to compile by going to pgl in terminal and running 'make force'")
+        if pglColorEngine._pglColor:
+            return pglColorEngine._pglColor.transform(color, matrix, offset, self.lut, xyY)[0]
+
+        channels = color[..., 0:3].astype(np.float64)
+        if xyY:
+            x, y, Y = channels[..., 0], channels[..., 1], channels[..., 2]
+            with np.errstate(divide="ignore", invalid="ignore"):
+                channels = np.stack((np.where(y != 0, x * Y / y, 0), Y, np.where(y != 0, (1 - x - y) * Y / y, 0)), axis=-1)
+        linear = np.clip(channels @ matrix.T + offset, 0, 1)
+        if self.lut is not None: linear = np.interp(linear, np.linspace(0, 1, len(self.lut)), self.lut)
+        values = np.empty(color.shape, dtype=np.float32)
+        values[..., 0:3] = linear
+        if color.shape[-1] == 4: values[..., 3] = color[..., 3]
+        return values
+
+    ################################################################
+    # invert
+    ################################################################
+    def invert(self, values, space, background=None):
+        '''
+        Convert display values back to a color space (e.g. to check what a color came out as
+        after clamping). xyY is returned as XYZ converted to xyY.
+        '''
+        values = np.asarray(values, dtype=np.float64)
+        linear = values[..., 0:3]
+        if self.lut is not None: linear = np.interp(linear, self.lut, np.linspace(0, 1, len(self.lut)))
+        if space == "rgb":
+            return values.copy()
+        transform = self.getTransform(space, background)
+        if transform is None: return None
+        color = np.linalg.solve(transform[0], (linear - transform[1]).reshape(-1, 3).T).T.reshape(linear.shape)
+        if space == "xyY":
+            total = np.sum(color, axis=-1)
+            with np.errstate(divide="ignore", invalid="ignore"):
+                color = np.stack((np.where(total != 0, color[..., 0] / total, 0), np.where(total != 0, color[..., 1] / total, 0), color[..., 1]), axis=-1)
+        if values.shape[-1] == 4: color = np.concatenate((color, values[..., 3:4]), axis=-1)
+        return color
+
+#################################################################
+# pglColor
+#################################################################
+class pglColor:
+    '''
+    Colors given to drawing functions in a color space other than the
+    display's own values, converted through the display calibration
+    '''
+    # space the drawing functions take colors in ("rgb" is display values)
+    colorSpace = "rgb"
+    colorBackground = None
+    colorEngine = None
+
+    ################################################################
+    # setColorSpace
+    ################################################################
+    def setColorSpace(self, space="rgb", background=None):
+        '''
+        Set the color space drawing functions take their colors in
+
+        Args:
+            space (str): one of pglColorEngine.colorSpaces, "rgb" for display values
+            background (float or array-like): background in linear RGB that contrast
+                and dkl colors are relative to (default 0.5 gray)
+        '''
+        if space not in pglColorEngine.colorSpaces:
+            print(f"(pglColor:setColorSpace) ❌ Unknown color space {space}, must be one of {list(pglColorEngine.colorSpaces)}")
+            return False
+        if self.colorEngine is None and space != "rgb":
+            print("(pglColor:setColorSpace) No color calibration set, using relative luminance and a linear display")
+            self.colorEngine = pglColorEngine()
+        self.colorSpace = space
+        self.colorBackground = background
+        return True
+
+    ################################################################
+    # setColorCalibration
+    ################################################################
+    def setColorCalibration(self, calibrationData=None, primaries=None, whitePoint=None, linearized=False, lutSize=1024):
+        '''
+        Set the calibration colors are converted through (see pglColorEngine)
+        '''
+        self.colorEngine = pglColorEngine(calibrationData, primaries, whitePoint, linearized, lutSize)
+        return self.colorEngine
+
+    ################################################################
+    # convertColor
+    ################################################################
+    def convertColor(self, color, space=None, background=None):
+        '''
+        Convert colors to display values
+
+        Args:
+            color (array-like): colors with 1, 3 or 4 channels in their last dimension
+                (a color, n x 3 vertex colors or h x w x 4 texture pixels)
+            space (str): color space, default the one set by setColorSpace
+            background (float or array-like): background in linear RGB, default the one set by setColorSpace
+
+        Returns:
+            pglDisplayColor: float32 display values
+        '''
+        if space is None: space = self.colorSpace
+        if background is None: background = self.colorBackground
+        if self.colorEngine is None: self.colorEngine = pglColorEngine()
+        return self.colorEngine.convert(color, space, background)
+
+    ################################################################
+    # convertColorFromDisplay
+    ################################################################
+    def convertColorFromDisplay(self, values, space=None, background=None):
+        '''
+        Convert display values back to a color space
+        '''
+        if space is None: space = self.colorSpace
+        if background is None: background = self.colorBackground
+        if self.colorEngine is None: self.colorEngine = pglColorEngine()
+        return self.colorEngine.invert(values, space, background)
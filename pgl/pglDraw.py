@@ -14,7 +14,13 @@ from PIL import Image, ImageDraw, ImageFont
 import os
 from pathlib import Path
 from pgl.pglImage import pglImageInstance
+from pgl.pglColor import pglDisplayColor
 import math
+from collections import OrderedDict
+from pgl.pglTrace import traceLog
+
+# trace log events (see pglTrace)
+traceClearScreen = traceLog.define("pglDraw:clearScreen", "{r:.3f} {g:.3f} {b:.3f}", ("r", "g", "b"))
 
 #############
 # Drawing class
@@ -23,6 +29,10 @@ class pglDraw:
     """
     pglDraw class for drawing operations.
     """
+    # number of polygon tessellations kept (see tessellate)
+    tessellationCacheSize = 256
+    _tessellationCache = None
+    _pglTess = None
     def __init__(self):   
         # set current line starting at top of screen
         self.currentLine = 1
@@ -47,6 +57,7 @@ class pglDraw:
 
         # Validate the color
         color = self.validateColor(color,withAlpha = False)
+        if traceLog.on: traceLog.record(traceClearScreen, *color[:3])
 
         # Check if the socket is connected
         if not self.s:
@@ -167,13 +178,17 @@ class pglDraw:
         Returns:
             None
         """
-        # set defaults
-        if color is None: color = np.ones(3)
+        # make into arrays, one entry per line
+        x1, y1, x2, y2 = (np.atleast_1d(np.asarray(value, dtype=np.float64)).ravel() for value in (x1, y1, x2, y2))
+        # validate that x1, y1, x2, y2 are all the same length
+        if not (len(x1) == len(y1) == len(x2) == len(y2)):
+            print("(pglDraw:line) x1, y1, x2, y2 must all be the same length.")
+            return
+        nLines = len(x1)
+
+        # validate color (one for all lines or one per line)
+        color = self.validateColor(color, withAlpha=False, n=nLines, forceN=True)
 
-        # validate color
-        color = self.validateColor(color, withAlpha=False, n = 1)
-        color = color.flatten()
-        
         # Convert units if necessary
         if units is None:
             pass
@@ -183,32 +198,134 @@ class pglDraw:
         elif units != "device":
             print(f"(pglDraw:line) Invalid units '{units}'. Using deg units.")
 
-        # make into vertex data
-        if isinstance(x1, (list, tuple, np.ndarray)):
-            # validate that x1, y1, x2, y2 are all the same length
-            if not (len(x1) == len(y1) == len(x2) == len(y2)):
-                print("(pglDraw:line) x1, y1, x2, y2 must all be the same length.")
-                return
-            nLines = len(x1)
-            # create vertex data for multiple lines
-            vertexData = np.array([], dtype=np.float32)
-            for iLine in range(nLines):
-                # if x1 is a list or array, use the corresponding y1, x2, y2
-                vertexData = np.append(vertexData,np.array([x1[iLine], y1[iLine], 0, *color, x2[iLine], y2[iLine], 0, *color], dtype=np.float32))
+        # start and end vertex of each line, both in the color of the line
+        positions = np.stack([np.column_stack((x1, y1)), np.column_stack((x2, y2))], axis=1).reshape(-1, 2)
+        self._writeVertices("mglLine", positions, np.repeat(color, 2, axis=0))
+
+    ################################################################
+    # polyline
+    ################################################################
+    def polyline(self, vertices, color=None, width=None, closed=False, miterLimit=4, units=None):
+        """
+        Draw many line segments with a single command, e.g. a gaze trace,
+        a trajectory, a grid or a wireframe.
+
+        Args:
+            vertices (np.array): n x 2 array of points joined one to the next (a polyline), or
+                n x 4 array of separate segments (x1, y1, x2, y2). Segments with a non-finite
+                end (e.g. nan during a blink) are left out, breaking the polyline there.
+            color (optional): One RGB color for everything, or n x 3 colors: one per point
+                of a polyline (blended along each segment) or one per separate segment.
+            width (float or array-like, optional): Line width in the units of the vertices, one
+                for all or one per point / segment. None draws one pixel wide lines.
+            closed (bool): Join the last point of a polyline back to the first.
+            miterLimit (float): Longest miter at a join of a wide polyline, as a multiple of half
+                the width (sharper corners are clipped to this).
+            units (str, optional): "pix" for pixels, otherwise degrees.
+
+        Returns:
+            None
+        """
+        vertices = np.atleast_2d(np.array(vertices, dtype=np.float64))
+        if vertices.ndim != 2 or vertices.shape[1] not in (2, 4):
+            print("(pglDraw:polyline) Vertices must be an n x 2 (polyline) or n x 4 (segments) matrix, but got shape", vertices.shape)
+            return
+        isSegments = vertices.shape[1] == 4
+        n = vertices.shape[0]
+        if n < (1 if isSegments else 2): return
+
+        # one color and width for each point (or segment)
+        color = self.validateColor(color, withAlpha=False, n=n, forceN=True).astype(np.float64)
+        if width is not None:
+            width = np.atleast_1d(np.asarray(width, dtype=np.float64)).ravel()
+            if width.shape[0] not in (1, n):
+                print(f"(pglDraw:polyline) {width.shape[0]} widths provided, but expected 1 or {n}. Using only the first width.")
+                width = width[:1]
+            width = np.broadcast_to(width, (n,))
+
+        # Convert units if necessary
+        if units is None:
+            pass
+        elif units.lower() in ("pixels","pix","pixel","px"):
+            for column in range(0, vertices.shape[1], 2):
+                vertices[:,column], vertices[:,column+1] = self.pix2deg(vertices[:,column], vertices[:,column+1])
+            if width is not None: width = width * self.xPix2Deg
+        elif units != "device":
+            print(f"(pglDraw:polyline) Invalid units '{units}'. Using deg units.")
 
+        if isSegments:
+            # n x 2 x 2 start and end of each segment, which take the segment's color and width
+            segmentEnds = vertices.reshape(n, 2, 2)
+            endColors = np.repeat(color[:, np.newaxis, :], 2, axis=1)
+            endWidths = None if width is None else np.repeat(width[:, np.newaxis], 2, axis=1)
         else:
-            # if x1 is a single value, then draw a single line
-            vertexData = np.array([x1, y1, 0, *color, x2, y2, 0, *color], dtype=np.float32)
-            nLines = 1
+            if closed:
+                vertices, color = np.vstack((vertices, vertices[:1])), np.vstack((color, color[:1]))
+                if width is not None: width = np.concatenate((width, width[:1]))
+            segmentEnds = np.stack((vertices[:-1], vertices[1:]), axis=1)
+            endColors = np.stack((color[:-1], color[1:]), axis=1)
+            endWidths = None if width is None else np.stack((width[:-1], width[1:]), axis=1)
+
+        # leave out segments that have a non-finite end
+        keep = np.all(np.isfinite(segmentEnds), axis=(1, 2))
+
+        if endWidths is None:
+            # one pixel wide: a line list, two vertices per segment
+            self._writeVertices("mglLine", segmentEnds[keep].reshape(-1, 2), endColors[keep].reshape(-1, 3))
+            return
 
-        # send line command
-        self.s.writeCommand("mglLine")
-        #ack = self.s.readAck()
-        # send the number of vertices
-        self.s.write(np.uint32(nLines * 2))
-        # send the data
+        # wide: each segment is a quad, offset to either side along its normal
+        direction = segmentEnds[:,1,:] - segmentEnds[:,0,:]
+        length = np.hypot(direction[:,0], direction[:,1])
+        keep &= length > 0
+        normal = np.zeros_like(direction)
+        normal[keep] = np.column_stack((-direction[keep,1], direction[keep,0])) / length[keep, np.newaxis]
+        # butt ends, unless the segments join
+        offset = np.repeat(normal[:, np.newaxis, :], 2, axis=1)
+        if not isSegments:
+            offset = self._polylineMiters(normal, keep, closed, miterLimit)
+        offset = offset * (endWidths / 2)[:, :, np.newaxis]
+
+        # corners go start+, end+, end-, start- as for quad, made into the two triangles 0,1,2 and 2,3,0
+        triangleEnds = np.array([0, 1, 1, 1, 0, 0])
+        triangleSides = np.array([1, 1, -1, -1, -1, 1])[:, np.newaxis]
+        positions = segmentEnds[keep][:, triangleEnds, :] + triangleSides * offset[keep][:, triangleEnds, :]
+        self._writeVertices("mglQuad", positions.reshape(-1, 2), endColors[keep][:, triangleEnds, :].reshape(-1, 3))
+
+    def _polylineMiters(self, normal, keep, closed, miterLimit):
+        # offset (unit half width) at the start and end of each segment, so that
+        # neighbouring segments meet along the bisector of the corner between them
+        nSegments = normal.shape[0]
+        previousNormal = np.zeros_like(normal)
+        nextNormal = np.zeros_like(normal)
+        previousNormal[1:] = normal[:-1] * keep[:-1, np.newaxis]
+        nextNormal[:-1] = normal[1:] * keep[1:, np.newaxis]
+        if closed and nSegments > 1:
+            previousNormal[0] = normal[-1] * keep[-1]
+            nextNormal[-1] = normal[0] * keep[0]
+        offset = np.zeros((nSegments, 2, 2))
+        for end, otherNormal in ((0, previousNormal), (1, nextNormal)):
+            bisector = normal + otherNormal
+            bisectorLength = np.hypot(bisector[:,0], bisector[:,1])
+            # an end without a neighbour (or that doubles straight back) stays square
+            square = bisectorLength < 1e-9
+            bisector[square] = normal[square]
+            bisectorLength[square] = 1
+            bisector /= bisectorLength[:, np.newaxis]
+            # the miter is longer by 1/cos of half the angle of the corner
+            cosine = np.sum(bisector * normal, axis=1)
+            scale = np.minimum(1 / np.maximum(cosine, 1e-9), miterLimit)
+            offset[:, end, :] = bisector * scale[:, np.newaxis]
+        return offset
+
+    def _writeVertices(self, commandName, positions, colors):
+        # send vertices as x, y, z, r, g, b (float32) with their count, as mglLine and mglQuad take them
+        vertexData = np.zeros((positions.shape[0], 6), dtype=np.float32)
+        vertexData[:, 0:2] = positions
+        vertexData[:, 3:6] = colors
+        self.s.writeCommand(commandName)
+        self.s.write(np.uint32(vertexData.shape[0]))
         self.s.write(vertexData)
-        # read the command results
         self.s.readCommandResults()
 
     ################################################################
@@ -230,11 +347,8 @@ class pglDraw:
         # validate color
         color = self.validateColor(color, withAlpha=False)
 
-        # draw the horizontal line
-        self.line(x - size/2, y, x + size/2, y, color, units=units)
-
-        # draw the vertical line
-        self.line(x, y - size/2, x, y + size/2, color, units=units)
+        # draw the horizontal and vertical lines
+        self.line([x - size/2, x], [y, y - size/2], [x + size/2, x], [y, y + size/2], color, units=units)
 
     ################################################################
     # circle
@@ -287,17 +401,9 @@ class pglDraw:
                 quad[i,:,:] = np.array([[x, y], [x1, y1], [x2, y2], [x, y]])
             self.quad(quad, color=color)
         else:
-            # draw the circle using a series of line segments
-            for i in range(numSegments):
-                # calculate start and stop angle for segment
-                angle1 = 2 * np.pi * i / numSegments
-                angle2 = 2 * np.pi * (i + 1) / numSegments
-                # draw that segment
-                x1 = x + radius[0] * np.cos(angle1)
-                y1 = y + radius[1] * np.sin(angle1)
-                x2 = x + radius[0] * np.cos(angle2)
-                y2 = y + radius[1] * np.sin(angle2)
-                self.line(x1, y1, x2, y2, color)
+            # draw the circle as one closed polyline
+            angles = 2 * np.pi * np.arange(numSegments) / numSegments
+            self.polyline(np.column_stack((x + radius[0] * np.cos(angles), y + radius[1] * np.sin(angles))), color=color, closed=True)
 
     ################################################################
     # quad
@@ -373,6 +479,92 @@ class pglDraw:
         # read the command results
         self.s.readCommandResults()
 
+    ################################################################
+    # polygon
+    ################################################################
+    def polygon(self, vertices, holes=None, color=None, x=0, y=0, units=None):
+        '''
+        Draw a polygon of any shape: concave, and with holes (e.g. letter
+        outlines, apertures, annular sectors). The outline is cut into triangles
+        by the native tessellator (see tessellate), which remembers the result,
+        so a shape that is drawn again is not tessellated again. To move a shape
+        around, keep its vertices the same and give x and y.
+
+        Args:
+            vertices (np.array): n x 2 array of the outline, in either winding.
+            holes (list of np.array, optional): m x 2 arrays of holes inside the outline.
+            color: One RGB color, or one per vertex (outline then holes) blended across the triangles.
+            x, y (float): Offset added to the vertices (in the same units).
+            units (str, optional): "pix" for pixels, otherwise degrees.
+
+        e.g.:
+            # annular sector from 20 to 70 degrees of angle, 3 to 5 degrees out
+            angles = np.radians(np.linspace(20, 70, 50))
+            outer = np.column_stack((5*np.cos(angles), 5*np.sin(angles)))
+            inner = np.column_stack((3*np.cos(angles), 3*np.sin(angles)))
+            self.polygon(np.vstack((outer, inner[::-1])), color=[0.8, 0.8, 0.2])
+        '''
+        vertices, triangles = self.tessellate(vertices, holes)
+        if triangles is None or len(triangles) == 0: return
+        vertices = vertices + [x, y]
+
+        # Convert units if necessary
+        if units is None:
+            pass
+        elif units.lower() in ("pixels","pix","pixel","px"):
+            vertices[:,0], vertices[:,1] = self.pix2deg(vertices[:,0], vertices[:,1])
+        elif units != "device":
+            print(f"(pglDraw:polygon) Invalid units '{units}'. Using deg units.")
+
+        # mglPolygon is a triangle strip (convex shapes only), so the triangles go as a list with mglQuad
+        color = self.validateColor(color, withAlpha=False, n=vertices.shape[0], forceN=True)
+        self._writeVertices("mglQuad", vertices[triangles.ravel()], color[triangles.ravel()])
+
+    ################################################################
+    # tessellate
+    ################################################################
+    def tessellate(self, vertices, holes=None):
+        '''
+        Cut a polygon (outline and optional holes, each an n x 2 array) into triangles.
+        Results are kept for the last tessellationCacheSize shapes, looked up by a hash
+        of the vertices.
+
+        Returns:
+            (np.ndarray, np.ndarray): All the vertices (outline then holes, n x 2) and
+            an m x 3 array of indices of the vertices of each triangle (None if the
+            tessellator is not available).
+        '''
+        rings = [np.atleast_2d(np.asarray(vertices, dtype=np.float64))]
+        if holes is not None: rings += [np.atleast_2d(np.asarray(hole, dtype=np.float64)) for hole in holes]
+        if any(ring.ndim != 2 or ring.shape[1] != 2 for ring in rings):
+            print("(pglDraw:tessellate) Outline and holes must be n x 2 arrays")
+            return None, None
+        vertices = np.ascontiguousarray(np.vstack(rings))
+        holeStarts = tuple(np.cumsum([len(ring) for ring in rings])[:-1])
+
+        # look in the cache
+        if self._tessellationCache is None: self._tessellationCache = OrderedDict()
+        key = (len(vertices), holeStarts, hash(vertices.tobytes()))
+        triangles = self._tessellationCache.get(key)
+        if triangles is not None:
+            self._tessellationCache.move_to_end(key)
+            return vertices, triangles
+
+        # check for the native tessellator
+        if pglDraw._pglTess is None:
+            try:
+                from . import _pglTess
+                pglDraw._pglTess = _pglTess
+            except ImportError:
+                print("(pglDraw:tessellate) ❌ Could not import _pglTess: You may need to compile by going to pgl in terminal and running 'make force'")
+                return vertices, None
+        triangles = pglDraw._pglTess.tessellate(vertices, holeStarts if holeStarts else None)
+
+        # remember it, forgetting the least recently used
+        self._tessellationCache[key] = triangles
+        if len(self._tessellationCache) > self.tessellationCacheSize: self._tessellationCache.popitem(last=False)
+        return vertices, triangles
+
     ################################################################
     # rect
     ################################################################
@@ -438,6 +630,11 @@ class pglDraw:
         Returns:
             np.ndarray: A numpy array of the validated color.
         """
+        # colors in a color space other than display values (see pglColor) are
+        # converted below, unless they already have been
+        colorSpace = getattr(self, "colorSpace", "rgb")
+        convert = (color is not None) and (colorSpace != "rgb") and not isinstance(color, pglDisplayColor)
+
         if color is None:
             color = np.array([[1.0, 1.0, 1.0]]).astype(np.float32)  # Default to white if no color is provided
 
@@ -457,6 +654,10 @@ class pglDraw:
             if forceN and color.shape[0] != n:
                 color = np.repeat(color, n, axis=0)
 
+        if convert:
+            converted = self.convertColor(color)
+            if converted is not None: color = np.asarray(converted)
+
         # If a scalar is provided, convert it to grayscale
         if color.shape[1] == 1:
             color = np.repeat(color, 3, axis=1)
@@ -477,6 +678,8 @@ class pglDraw:
             # If withAlpha is False, ignore the alpha channel
             color = color[:,0:3]   
 
+        # mark as display values so that redrawing does not convert again
+        if colorSpace != "rgb": color = color.view(pglDisplayColor)
         return(color)
     
     ####################################################
@@ -635,6 +838,7 @@ class pglDraw:
         
         # create the text image
         img = self.imageCreate(np.array(img))
+        if img is not None: self.resources.retag("texture", img.imageNum, "text", label=textString)
         return img
         
     ######################################################
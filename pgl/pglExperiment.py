@@ -25,6 +25,7 @@ import ipywidgets as widgets
 from .pglBase import pglDisplayMessage
 from traitlets import Float, TraitError, TraitError, observe, Instance, Int, Unicode, Dict, validate, Bool
 from .pglParameter import pglParameter, pglParameterBlock
+from .pglAssetPrefetch import pglAssetPrefetcher
 from .pglEvent import pglEvent
 from .pglSerialize import pglSerialize
 from typing import List as ListType, Optional
@@ -552,11 +553,12 @@ class pglExperiment(pglExperimentBase):
             self.eyeTracker.start()
 
         # calculate the phases that we will need to cover
-        self.state.phaseNums = sorted(task.settings.phaseNum for task in self.tasks if task.settings.phaseNum is not None) or None
+        self.state.phaseNums = sorted({task.settings.phaseNum for task in self.tasks if task.settings.phaseNum is not None}) or None
         
         # intialize variables
         self.state.experimentDone = False
         self.state.volumeNumber = 0
+        self.state.currentPhaseIndex = 0
 
         # set manual pre-start (this will put up a screen and wait for start key
         # before waiting for volume trigger
@@ -616,6 +618,9 @@ class pglExperiment(pglExperimentBase):
                     self.state.experimentStarted = True
                     self.state.experimentDone = True
         
+        # what is on the renderer before the tasks make their stimuli
+        resourcesBefore = self.pgl.resources.snapshot(withRecords=False) if hasattr(self.pgl, 'resources') else None
+
         # start the experiment
         self.startPhase(phaseNum=0)
         print(f"(pglExperiment:run) Experiment started.")
@@ -646,7 +651,8 @@ class pglExperiment(pglExperimentBase):
                     break
 
             # grab any events that match the keyList and return their index within that list
-            subjectResponses = [keyIndex for e in events if e.type == "keyboard" and e.eventType == "keydown" and e.keyCode in self.state.responseKeyCodesList for keyIndex in [self.state.responseKeyCodesList.index(e.keyCode)]]
+            # (each carries the keyboard event it came from, for its timestamp and onset latency)
+            subjectResponses = [pglSubjectResponse(self.state.responseKeyCodesList.index(e.keyCode), e) for e in events if e.type == "keyboard" and e.eventType == "keydown" and e.keyCode in self.state.responseKeyCodesList]
                 
             # update tasks in current phase
             phaseDone = False
@@ -665,7 +671,7 @@ class pglExperiment(pglExperimentBase):
                 # end all tasks in current phase
                 for task in self.currentTasks: task.end()
                 # check if we have ended all phases
-                if self.state.phaseNum >= len(self.state.phaseNums)-1:
+                if self.state.currentPhaseIndex >= len(self.state.phaseNums)-1:
                     self.state.experimentDone = True
                 else:
                     # update phase
@@ -679,6 +685,9 @@ class pglExperiment(pglExperimentBase):
         # mark end time
         self.data.endTime = self.pgl.getSecs()
         print("(pglExperiment:run) Experiment done.")
+
+        # report what the run left on the renderer
+        if resourcesBefore is not None: self.pgl.resources.check(since=resourcesBefore)
         
         # save data
         self.save()
@@ -935,6 +944,10 @@ class pglTask:
     
     # reference to pgl, set by pglExperiment when added
     pgl = None
+
+    # how many trials ahead to prefetch the assets named by getTrialAssets
+    assetLookahead = 2
+    _prefetcher = None
     
     '''
     Class representing a task in the experiment. For example, a fixation task. Or
@@ -958,6 +971,9 @@ class pglTask:
         self.e = None
         self.waitUntilVolumeTrigger = False
 
+        # assets of the current trial (see getTrialAssets)
+        self.trialAssets = {}
+
 
     def start(self, startTime):
         '''
@@ -1003,7 +1019,9 @@ class pglTask:
             # update to next segment
             self.state.currentSegment += 1
             self.state.segmentStartTime = updateTime
-            self.data.events.append(pglEventSegment(self.state.currentSegment, updateTime))
+            # the frame drawn next is the segment's onset, responses are timed from when it is presented
+            onsetId = self.pgl.markOnset((self.settings.taskID, self.state.currentTrial, self.state.currentSegment)) if self.pgl is not None else None
+            self.data.events.append(pglEventSegment(self.state.currentSegment, updateTime, onsetId=onsetId))
             
             # default to false, this will get reset
             # at end of segment clock if set for this segment
@@ -1028,6 +1046,9 @@ class pglTask:
         for parameter in self.parameters: 
             self.data.params[-1].update(parameter.get())
 
+        # get this trial's assets and start loading the ones for the next trials
+        self.trialAssets = self.prefetchTrialAssets()
+
         # start segment (startSegment will update currentSegment to 0)
         self.state.currentSegment = -1
         self.startSegment(startTime)
@@ -1060,6 +1081,66 @@ class pglTask:
         '''
         self.parameters.append(param)
 
+    def peekParams(self, nAhead=1):
+        '''
+        Parameters of the trial nAhead trials after the current one, without advancing.
+        '''
+        params = {}
+        for parameter in self.parameters:
+            params.update(parameter.peek(nAhead))
+        return params
+
+    def getTrialAssets(self, params):
+        '''
+        Override to list the assets (any hashable keys, e.g. file names) that a trial
+        with these params needs. They are loaded with loadAsset and uploaded with
+        uploadAsset up to assetLookahead trials ahead, and at the start of the trial
+        are in self.trialAssets, keyed the same way.
+        '''
+        return []
+
+    def loadAsset(self, key):
+        '''
+        Override to load an asset named by getTrialAssets. Runs on a background thread,
+        so it should not draw or otherwise use pgl.
+        '''
+        return None
+
+    def uploadAsset(self, key, loaded):
+        '''
+        Turn a loaded asset into what the trial uses. By default numpy images (on their
+        own or in a list, tuple or dict) become textures with imageCreate.
+        '''
+        if isinstance(loaded, np.ndarray) and loaded.ndim in (2, 3):
+            return self.pgl.imageCreate(loaded)
+        if isinstance(loaded, (list, tuple)):
+            return type(loaded)(self.uploadAsset(key, item) for item in loaded)
+        if isinstance(loaded, dict):
+            return {name: self.uploadAsset(key, item) for name, item in loaded.items()}
+        return loaded
+
+    def prefetchTrialAssets(self):
+        '''
+        Get the current trial's assets and request the assets of the next assetLookahead trials.
+        '''
+        # nothing to do for tasks that do not declare assets
+        if type(self).getTrialAssets is pglTask.getTrialAssets: return {}
+        if self._prefetcher is None:
+            self._prefetcher = pglAssetPrefetcher(self.loadAsset, self.uploadAsset)
+
+        # request upcoming trials first so they load while this trial's assets are got
+        currentKeys = list(self.getTrialAssets(self.currentParams))
+        upcomingKeys = []
+        for nAhead in range(1, self.assetLookahead + 1):
+            if self.state.currentTrial + nAhead >= self.settings.nTrials: break
+            upcomingKeys.extend(self.getTrialAssets(self.peekParams(nAhead)))
+        for key in upcomingKeys: self._prefetcher.request(key)
+        trialAssets = {key: self._prefetcher.get(key) for key in currentKeys}
+
+        # let go of assets from earlier trials
+        self._prefetcher.keep(currentKeys + upcomingKeys)
+        return trialAssets
+
     def update(self, updateTime, subjectResponses, phaseNum, tasks, events):
         '''
         Update the task.
@@ -1090,17 +1171,24 @@ class pglTask:
         if subjectResponses != []:
             # Pass each subjectResponse in sequence to handleSubjectResponse
             for subjectResponse in subjectResponses:
+                # the keyboard event the response came from
+                responseEvent = getattr(subjectResponse, 'event', None)
                 # call the subject response handler
                 responseType = self.handleSubjectResponse(subjectResponse, updateTime)
                 # save as an event if responseType is not None
                 # responseType can be used to specify different types of responsees
                 # and is defined by the subclass
                 if responseType is not None:
-                    self.data.events.append(pglEventSubjectResponse(response=subjectResponse, timestamp=updateTime, responseType=responseType))
+                    self.data.events.append(pglEventSubjectResponse(response=int(subjectResponse), timestamp=updateTime, responseType=responseType,
+                                                                    responseTime=getattr(responseEvent, 'timestamp', None), reactionTime=getattr(responseEvent, 'onsetLatency', None),
+                                                                    onsetId=getattr(responseEvent, 'onsetId', None)))
                 
         # update the screen
         self.updateScreen()
 
+        # upload a prefetched asset if one has loaded
+        if self._prefetcher is not None: self._prefetcher.service()
+
 
     def handleSubjectResponse(self, response, updateTime) -> None:
         '''
@@ -1150,6 +1238,12 @@ class pglTask:
         self.data.events.append(pglEventSegment(self.state.currentSegment, endTime, eventType=pglEventSegment.boundaryType.END))
         self.data.events.append(pglEventTrial(self.state.currentTrial, endTime, eventType=pglEventTrial.boundaryType.END))
 
+        # stop prefetching and release the textures
+        if self._prefetcher is not None:
+            self._prefetcher.getStats(printSummary=self.pgl.verbose > 0)
+            self._prefetcher.close()
+            self._prefetcher = None
+
     def jumpSegment(self):
         '''
         Jump to the next segment.
@@ -1854,7 +1948,7 @@ class pglEventSegment(pglEvent):
         START = 'start'
         END = 'end'
 
-    def __init__(self, segmentNum = None, timestamp=None, eventType=None):
+    def __init__(self, segmentNum = None, timestamp=None, eventType=None, onsetId=None):
         super().__init__(type="segment")
 
         # handle default
@@ -1865,23 +1959,45 @@ class pglEventSegment(pglEvent):
         self.segmentNum = segmentNum
         self.eventType = eventType.value
         self.timestamp = timestamp
+        # stimulus onset (pgl.markOnset) of the segment's first frame
+        self.onsetId = onsetId
 
     def print(self):
         print(f"(pglEventSegment) Segment {self.eventType} at: {self.timestamp}")
         
 
+#################################################################
+# Subject response
+#################################################################
+class pglSubjectResponse(int):
+    '''
+    A subject response as tasks get it: the index of the key in
+    responseKeyCodesList (so it can be used as that int), carrying the
+    keyboard event it came from (with its timestamp, onsetLatency and onsetId).
+    '''
+    def __new__(cls, keyIndex, event=None):
+        response = super().__new__(cls, keyIndex)
+        response.event = event
+        return response
+
 #################################################################
 # Events that specify subject response
 #################################################################
 class pglEventSubjectResponse(pglEvent):
     
-    def __init__(self, response=None, timestamp=None, responseType=None):
+    def __init__(self, response=None, timestamp=None, responseType=None, responseTime=None, reactionTime=None, onsetId=None):
         super().__init__(type="subjectResponse")
         
         # set attributes
         self.response = response
+        # time of the frame loop update that handled the response
         self.timestamp = timestamp
         self.responseType = responseType
+        # hardware time of the key press, and its latency from the most
+        # recent stimulus onset (the presented time of onsetId)
+        self.responseTime = responseTime
+        self.reactionTime = reactionTime
+        self.onsetId = onsetId
 
 #################################################################
 # Events that specifys mri volume trigger
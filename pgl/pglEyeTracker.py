@@ -12,6 +12,7 @@ from pgl import pglDevice
 from .pglData import pglTimeSeries, pglEventsData
 from .pglEvent import pglEvent
 from dataclasses import dataclass, field
+import threading
 import numpy as np
 
 #################################################################
@@ -36,6 +37,9 @@ class pglEyeTracker(pglDevice):
         self.calibrationTime = None
         self.isTracking = False 
         self.pgl = pgl
+        # the tracker connection is not thread safe and markers (pglMarkerSinkEyeTracker)
+        # send messages from their own thread, so subclasses talk to the tracker holding this
+        self.lock = threading.RLock()
 
     def __del__(self):
         """Destructor to clean up resources."""
@@ -25,6 +25,11 @@ try:
 except ImportError:
     pylink = None
     _HAVE_PYLINK = False
+try:
+    from . import _pglPalette
+except ImportError:
+    _pglPalette = None
+    print("(pglEyelink) ❌ Could not import _pglPalette, camera image will be assembled in python. Try running 'make force'")
     
 #############
 # Eyelink class
@@ -135,12 +140,14 @@ class pglEyelink(pglEyeTracker):
             print(f("pglEyelink:start) ❌ data not being saved because openEDF has not been called"))
 
         # start recording
-        error = self.eyelink.startRecording(1,1,1,1)
-        pylink.pumpDelay(100)
+        with self.lock:
+            error = self.eyelink.startRecording(1,1,1,1)
+            pylink.pumpDelay(100)
+            isRecording = self.eyelink.isRecording() if error == 0 else None
 
         # check for errors
         if error == 0:
-            if self.eyelink.isRecording() == 0:
+            if isRecording == 0:
                 # write a message so we can recover info about this session
                 self.sendMessage(f"pgl: start date={datetime.now().strftime("%Y/%m/%d")}")
                 self.sendMessage(f"pgl: start time={datetime.now().strftime("%H:%M:%S")}")
@@ -161,7 +168,8 @@ class pglEyelink(pglEyeTracker):
             return
         else:
             print(f"(pglEyelink:sendMessage) Sending message {message}")
-        self.eyelink.sendMessage(message)
+        with self.lock:
+            self.eyelink.sendMessage(message)
 
     def stop(self):
         """Stop eye tracking."""
@@ -178,14 +186,14 @@ class pglEyelink(pglEyeTracker):
         self.sendMessage(f"pgl: stop isoformat={datetime.now().isoformat()}")
         self.sendMessage(f"pgl: stop getSecs={self.pgl.getSecs()}")
 
-        # Stop recording
-        self.eyelink.stopRecording()
-    
-        # Wait for stop to complete
-        pylink.msecDelay(500)
+        # Stop recording, wait for stop to complete and check
+        with self.lock:
+            self.eyelink.stopRecording()
+            pylink.msecDelay(500)
+            isRecording = self.eyelink.isRecording()
     
         # Verify stopped
-        if self.eyelink.isRecording() != 0:
+        if isRecording != 0:
             print("(pglEyeTracker) Eye tracking stopped.")
             return True
         else:
@@ -210,7 +218,8 @@ class pglEyelink(pglEyeTracker):
     
         # Open file on Host PC
         try:
-            error = self.eyelink.openDataFile(filename)
+            with self.lock:
+                error = self.eyelink.openDataFile(filename)
         
             if error == 0:
                 print(f"(pglEyeTracker) Data file opened: {filename}")
@@ -238,14 +247,17 @@ class pglEyelink(pglEyeTracker):
         import os
         
         # Stop recording first
-        if self.eyelink.isRecording():
+        with self.lock:
+            isRecording = self.eyelink.isRecording()
+        if isRecording:
             if not self.stop():
                 print("(pglEyeTracker) Warning: Issue stopping recording")
         
         # Close file on Host PC
         print("(pglEyeTracker) Closing data file...")
-        self.eyelink.closeDataFile()
-        pylink.msecDelay(100)
+        with self.lock:
+            self.eyelink.closeDataFile()
+            pylink.msecDelay(100)
         
         # Ensure local directory exists
         localDir = os.path.dirname(filename)
@@ -258,7 +270,8 @@ class pglEyelink(pglEyeTracker):
         
         # Transfer file
         print(f"(pglEyeTracker) Transferring data file...")
-        result = self.eyelink.receiveDataFile(self.edfFilename, filename)
+        with self.lock:
+            result = self.eyelink.receiveDataFile(self.edfFilename, filename)
         
         if result > 0:
             if os.path.exists(filename):
@@ -302,14 +315,15 @@ class pglEyelink(pglEyeTracker):
             (int(screenWidth * (1 - margin)), int(screenHeight * (1 - margin))),  # bottom-right
         ]
 
+        commands = []
         match numPoints:
             case 5:
                 # Just use first 5 points
                 points = points[:5]  
-                self.eyelink.sendCommand("calibration_type = HV5")
+                commands.append("calibration_type = HV5")
             case 9:
                 # Already set as default
-                self.eyelink.sendCommand("calibration_type = HV9")
+                commands.append("calibration_type = HV9")
                 pass
             case 13:
                 # Add 4 mid-edge points to the 9-point layout
@@ -319,15 +333,16 @@ class pglEyelink(pglEyeTracker):
                     (int(screenWidth * 0.5 * margin + screenWidth * 0.5 * 0.5), screenHeight//2),  # left-mid
                     (int(screenWidth * 0.5 * (1 - margin) + screenWidth * 0.5 * 0.5), screenHeight//2),  # right-mid
                 ])
-                self.eyelink.sendCommand("calibration_type = HV13")
+                commands.append("calibration_type = HV13")
             case _:
                 print(f"(pglEyelink) Warning: {numPoints} points not supported, defaulting to 9")
-                self.eyelink.sendCommand("calibration_type = HV9")
+                commands.append("calibration_type = HV9")
             
         # send the calibration targets
         calTargets = " ".join([f"{x},{y}" for x, y in points])
-        self.eyelink.sendCommand(f"calibration_targets = {calTargets}")
-        self.eyelink.sendCommand(f"validation_targets = {calTargets}")
+        commands += [f"calibration_targets = {calTargets}", f"validation_targets = {calTargets}"]
+        with self.lock:
+            for command in commands: self.eyelink.sendCommand(command)
 
     def calibrate(self):
         """Calibrate the eye tracker."""
@@ -337,12 +352,6 @@ class pglEyelink(pglEyeTracker):
             print("             C: (C)alibrate V: (V)alidate")
             print("             0 or Q: (Q)uit calibration")
             try:
-                # Put tracker in offline mode before calibration
-                self.eyelink.setOfflineMode()
-            
-                # Wait briefly for mode switch
-                pylink.msecDelay(50)
-
                 # get current eat codes
                 k = self.pgl.devicesGetKeyboard()            
                 eatKeys = k.eatKeyCodes
@@ -350,8 +359,12 @@ class pglEyelink(pglEyeTracker):
                 # eat relevant keys
                 self.pgl.setEatKeys(keyChars=['return', 'c', 'v', 'q', '0'])
                 
-                # Now do the setup
-                self.eyelink.doTrackerSetup()
+                # Put tracker in offline mode, wait briefly for the mode switch and
+                # do the setup (markers wait until it is done)
+                with self.lock:
+                    self.eyelink.setOfflineMode()
+                    pylink.msecDelay(50)
+                    self.eyelink.doTrackerSetup()
 
             except Exception as e:
                 print(f"(pglEyelink) Error during calibration: {e}")
@@ -389,11 +402,13 @@ if _HAVE_PYLINK:
             # setup_image_display()
             self.cameraImageSize = (384, 320)
                 
-            # buffer to store camera image
-            self.cameraImageBuffer = array.array('I')  
+            # buffer to store camera image (RGBA float32, as the texture takes it)
+            # and the texture it is sent to, which is reused from image to image
+            self.cameraImageBuffer = np.zeros((self.cameraImageSize[1], self.cameraImageSize[0], 4), dtype=np.float32)
+            self.cameraImage = None
             
             # image palette; its indices are used to reconstruct the camera image
-            self.imagePalette = []
+            self.imagePalette = np.zeros((256, 4), dtype=np.float32)
             
             # title to be displayed below the camera image
             self.cameraImageTitle = ""
@@ -451,9 +466,11 @@ if _HAVE_PYLINK:
             should return 1 if success and 0 otherwise. If 1 is returned, the tracker will send high-resolution images (if available) to the host. If 0 is returned, the tracker will send low-resolution images (if available) to the host."""
             
             # allocate buffer for camera image
-            self.cameraImageSize = (width, height)
-            # Fix, fix, fix: allocate4 cameaImageBuffer
-            self.cameraImageBuffer = np.zeros((height, width, 3), dtype=np.float32)
+            if (width, height) != self.cameraImageSize or self.cameraImageBuffer.shape[:2] != (height, width):
+                self.cameraImageSize = (width, height)
+                self.cameraImageBuffer = np.zeros((height, width, 4), dtype=np.float32)
+                # texture is a different size, so make a new one for the next image
+                self.cameraImage = None
             # clear display
             self.clear_cal_display()
             print("(pglEyelink) setup_image_display")
@@ -472,27 +489,53 @@ if _HAVE_PYLINK:
                 is given line by line from top to bottom. It may be efficient to collect one full image and do a full blit of the entire
                 image."""
                 
-            # add line to camera image buffer
-            for iPixel in range(width):
-                self.cameraImageBuffer[line,iPixel,:] = self.imagePalette[buff[iPixel]]
+            # lines are packed width pixels apart, so the buffer has to be exactly width
+            # wide (it will not be if setup_image_display was not called with this size)
+            if self.cameraImageBuffer.shape[0] < totlines or self.cameraImageBuffer.shape[1] != width:
+                self.setup_image_display(width, totlines)
+
+            # expand the palette indexes of this line into the camera image buffer
+            if _pglPalette is not None:
+                try:
+                    _pglPalette.expandLine(buff, self.imagePalette, self.cameraImageBuffer, line, width)
+                except TypeError:
+                    # buff is not a byte buffer (e.g. a list of ints)
+                    _pglPalette.expandLine(bytes(bytearray(buff[:width])), self.imagePalette, self.cameraImageBuffer, line, width)
+            else:
+                self.cameraImageBuffer[line, :width] = self.imagePalette[np.asarray(buff[:width], dtype=np.intp)]
         
             # if last line, draw the full image
             if line == totlines-1:
-                # clear display
-                self.pgl.clearScreen(self.backgroundColor)
-                # draw the camera image
-                im = self.pgl.imageCreate(self.cameraImageBuffer[0:totlines,0:width])
-                im.display()
-                # draw the title below the image
-                if self.cameraImageTitle:
-                    # Draw title
-                    self.pgl.text(self.cameraImageTitle,fontSize=10,color=(0,0,0),x=im.displayLeft+(im.displayRight-im.displayLeft)/2,y=im.displayTop+0.5)
-                # flush to screen
-                self.pgl.flush()
+                self.drawCameraImage(self.cameraImageBuffer[:totlines, :width])
+
+        def drawCameraImage(self, imageData):
+            """ send the camera image to its texture and draw it with its title. The
+                texture is created once and then updated in place for each new image."""
+            # clear display
+            self.pgl.clearScreen(self.backgroundColor)
+            # send the camera image, reusing the texture
+            if self.cameraImage is None:
+                self.cameraImage = self.pgl.imageCreate(imageData)
+                if self.cameraImage is None: return
+            else:
+                self.pgl.imageUpdate(self.cameraImage, np.ascontiguousarray(imageData))
+            # draw the camera image
+            im = self.cameraImage
+            im.display()
+            # draw the title below the image
+            if self.cameraImageTitle:
+                # Draw title
+                self.pgl.text(self.cameraImageTitle,fontSize=10,color=(0,0,0),x=im.displayLeft+(im.displayRight-im.displayLeft)/2,y=im.displayTop+0.5)
+            # flush to screen
+            self.pgl.flush()
                 
         def set_image_palette(self, r, g, b):
             """ get the color palette for the camera image"""
-            self.imagePalette = np.stack([r, g, b], axis=1)
+            # RGBA float32, padded out to all 256 possible indexes
+            self.imagePalette = np.zeros((256, 4), dtype=np.float32)
+            nColors = min(len(r), 256)
+            self.imagePalette[:nColors, 0:3] = np.stack([r[:nColors], g[:nColors], b[:nColors]], axis=1) / 255.0
+            self.imagePalette[:nColors, 3] = 1
         
         def erase_cal_target(self):
             """ erase the calibration target"""
@@ -605,6 +648,8 @@ if _HAVE_PYLINK:
 
         def exit_image_display(self):
             """ exit the camera image display"""
+            # release the camera image texture
+            self.cameraImage = None
             self.clear_cal_display()
 
         def alert_printf(self, msg):
@@ -58,6 +58,7 @@ class pglFrameGrab:
             if self.verbose>0: print(f"(pglImage:setRenderTarget) Setting render target to image {imageInstance.imageNum} ({imageInstance.width.pix}x{imageInstance.height.pix})")
             # send the image number
             self.s.write(np.uint32(imageInstance.imageNum))
+            self.resources.retag("texture", imageInstance.imageNum, "renderTarget")
         # read the command results
         self.commandResults = self.s.readCommandResults()
     
@@ -112,6 +113,7 @@ class pglFrameGrab:
 
         # then read that many bytes
         frame = self.s.read(np.float32, imageHeight, imageWidth, 4)
+        self.resources.download(int(dataLength))
         #print(frame)
         #frame = np.transpose(frame, (2, 1, 0))
 
@@ -8,8 +8,19 @@
 #############
 # Import modules
 #############
+import time
+import weakref
+import zlib
 import numpy as np
+from collections import OrderedDict
 from types import SimpleNamespace
+from .pglTrace import traceLog
+from .pglResources import pglResourceRegistry
+
+# trace log events (see pglTrace)
+traceImageCreate = traceLog.define("pglImage:imageCreate", "image {imageNum} {width}x{height} ({nImages} images)", ("imageNum", "width", "height", "nImages"))
+traceImageUpdate = traceLog.define("pglImage:imageUpdate", "image {imageNum} {width}x{height}", ("imageNum", "width", "height"))
+traceImageDelete = traceLog.define("pglImage:imageDelete", "image {imageNum}", ("imageNum",))
 
 #############
 # Image class
@@ -19,6 +30,24 @@ class pglImage:
     Class for displaying images.
 
     '''
+    # imageDisplay keeps the textures it makes for arrays (and PIL images) and
+    # reuses them when it is given the same image again (see imageFromSource)
+    imageDisplayCache = True
+    # most textures to keep for imageDisplay
+    imageDisplayCacheSize = 16
+    # warn once a source has been uploaded this many times by imageDisplay
+    imageDisplayUploadWarning = 10
+    # what this display holds on the renderer (see resources)
+    _resources = None
+
+    @property
+    def resources(self):
+        '''
+        Registry of the textures, render targets, stencils and movies this display
+        has made on the renderer, with upload counts per frame (see pglResources)
+        '''
+        if self._resources is None: self._resources = pglResourceRegistry(self)
+        return self._resources
 
     def imageCreate(self, imageData):
         '''
@@ -75,7 +104,9 @@ class pglImage:
         imageNum = self.s.read(np.uint32)
         nImages = self.s.read(np.uint32)
         if self.verbose>1: print(f"(pglImage:imageCreate) Created image {imageNum} ({nImages} total images)")
+        if traceLog.on: traceLog.record(traceImageCreate, imageNum, imageWidth, imageHeight, nImages)
         self.s.readCommandResults(ackTime)
+        self.resources.created("texture", imageNum, imageWidth, imageHeight, uploadBytes=imageData.nbytes)
 
         # create an instance of pglImageInstance
         imageInstance = pglImageInstance(imageNum, imageWidth, imageHeight, self)
@@ -114,7 +145,10 @@ class pglImage:
         
         # check for image passed in
         if not isinstance(imageInstance, pglImageInstance):
-            imageInstance = self.imageCreate(imageInstance)
+            if self.imageDisplayCache:
+                imageInstance = self.imageFromSource(imageInstance)
+            else:
+                imageInstance = self.imageCreate(imageInstance)
             if imageInstance is None: return None
 
         if width is None:
@@ -185,6 +219,7 @@ class pglImage:
         self.s.write(np.float32(imageInstance.phase))
         self.s.write(np.uint32(imageInstance.imageNum))
         self.commandResults = self.s.readCommandResults(ackTime)
+        self.resources.used("texture", imageInstance.imageNum)
  
     def imageDelete(self, imageInstance):
         '''
@@ -199,10 +234,184 @@ class pglImage:
         
         # Delete texture
         if self.verbose>1: print(f"(pglImage:imageDelete) Deleting image {imageInstance.imageNum} ({imageInstance.width.pix}x{imageInstance.height.pix})")
+        if traceLog.on: traceLog.record(traceImageDelete, imageInstance.imageNum)
         # send the deleteTexture command
         self.s.writeCommand("mglDeleteTexture")
         self.s.write(np.uint32(imageInstance.imageNum))
         self.commandResults = self.s.readCommandResults()
+        self.resources.released("texture", imageInstance.imageNum)
+
+    def imageUpdate(self, imageInstance, imageData):
+        '''
+            Replace the contents of an existing image with new image data, reusing
+            the texture already in the mglMetal app rather than deleting it and
+            creating a new one. Useful for images that change every frame (e.g. a
+            camera image).
+
+            Args:
+                imageInstance: What is returned by imageCreate
+                imageData: New image data. If this is already a HxWx4 float32 array
+                  it is sent as is, otherwise it is validated as in imageCreate.
+
+            Returns:
+                True if the image was updated, False otherwise.
+        '''
+        if self.isOpen() == False:
+            return False
+        if not isinstance(imageInstance, pglImageInstance):
+            print("(pglImage:imageUpdate) imageInstance should be an instance of pglImageInstance.")
+            return False
+
+        # skip validation of data that is already in the texture format
+        if not (isinstance(imageData, np.ndarray) and imageData.dtype == np.float32 and imageData.ndim == 3 and imageData.shape[2] == 4):
+            (tf, imageData) = self.imageValidate(imageData)
+            if not tf: return False
+        imageHeight, imageWidth = imageData.shape[0], imageData.shape[1]
+
+        # send the updateTexture command
+        if self.verbose>1: print(f"(pglImage:imageUpdate) Updating image {imageInstance.imageNum} ({imageWidth}x{imageHeight})")
+        if traceLog.on: traceLog.record(traceImageUpdate, imageInstance.imageNum, imageWidth, imageHeight)
+        self.s.writeCommand("mglUpdateTexture")
+        ackTime = self.s.readAck()
+        self.s.write(np.uint32(imageInstance.imageNum))
+        self.s.write(np.uint32(imageWidth))
+        self.s.write(np.uint32(imageHeight))
+        imageData = np.ascontiguousarray(imageData)
+        self.s.write(imageData.ravel())
+        self.commandResults = self.s.readCommandResults(ackTime)
+        self.resources.updated("texture", imageInstance.imageNum, imageData.nbytes, imageWidth, imageHeight)
+
+        # keep the size in case it changed
+        imageInstance.width.pix = imageWidth
+        imageInstance.height.pix = imageHeight
+        return True
+
+    def imageFromSource(self, source):
+        '''
+            Texture for an image given as an array (or PIL image) rather than a
+            pglImageInstance. Textures are kept by the identity of the source object
+            and a fingerprint of its contents: shape, type and a crc32 of all of
+            its data (much cheaper than the upload it saves). Passing the same
+            unchanged image again reuses its texture; an equal copy shares the
+            texture of the first. An array that has changed since it was last
+            displayed is sent to its own texture in place, unless that texture was
+            drawn earlier in this frame or is shared with another source, in which
+            case it gets a new texture so that what was already drawn keeps its pixels.
+
+            Args:
+                source: The image data, as for imageCreate.
+
+            Returns:
+                pglImageInstance or None if the image could not be created.
+        '''
+        if getattr(self, '_imageCache', None) is None: self.imageCacheClear()
+        stats = self._imageCacheStats
+        stats['nCalls'] += 1
+
+        # fingerprint the contents
+        startTime = time.perf_counter()
+        imageData = source if isinstance(source, np.ndarray) else np.asarray(source)
+        fingerprint = (imageData.shape, imageData.dtype.str, zlib.crc32(np.ascontiguousarray(imageData)))
+        stats['fingerprintTime'] += time.perf_counter() - startTime
+        key = fingerprint
+        frameNum = self.resources.nFrames
+
+        # entry for this object (if the id has not been reused by a new object)
+        entry = self._imageCacheById.get(id(source))
+        if entry is not None and entry.refs[id(source)]() is not source:
+            self._imageCacheDropSource(entry, id(source))
+            entry = None
+
+        if entry is not None and entry.fingerprint == fingerprint:
+            # same object, unchanged
+            stats['nReused'] += 1
+        elif key in self._imageCache:
+            # same contents as another image already on the card
+            if entry is not None: self._imageCacheDropSource(entry, id(source))
+            entry = self._imageCache[key]
+            self._imageCacheAddSource(entry, source)
+            stats['nReused'] += 1
+        elif entry is not None and entry.fingerprint[:2] == fingerprint[:2] and len(entry.refs) == 1 and entry.displayedFrame != frameNum:
+            # same object, changed since it was last displayed, and its texture is its
+            # own and not drawn yet this frame: update the texture in place
+            if not self.imageUpdate(entry.imageInstance, imageData): return None
+            self._imageCache.pop(entry.key, None)
+            entry.fingerprint, entry.key = fingerprint, key
+            self._imageCache[key] = entry
+            entry.nUploads += 1
+            stats['nUpdated'] += 1
+        else:
+            # new image
+            imageInstance = self.imageCreate(imageData)
+            if imageInstance is None: return None
+            if entry is not None:
+                # same object, but a different size, or its texture is shared or already
+                # drawn this frame, so it gets a new texture (the old one stays for others)
+                self._imageCacheDropSource(entry, id(source))
+                nUploads = entry.nUploads
+            else:
+                nUploads = 0
+            entry = SimpleNamespace(imageInstance=imageInstance, fingerprint=fingerprint, key=key, refs={}, nUploads=nUploads + 1, displayedFrame=None)
+            self._imageCache[key] = entry
+            self._imageCacheAddSource(entry, source)
+            stats['nCreated'] += 1
+
+            # drop the least recently displayed textures
+            while len(self._imageCache) > self.imageDisplayCacheSize:
+                _, evicted = self._imageCache.popitem(last=False)
+                for sourceId in evicted.refs:
+                    if self._imageCacheById.get(sourceId) is evicted: self._imageCacheById.pop(sourceId)
+                stats['nEvicted'] += 1
+
+        self._imageCache.move_to_end(entry.key)
+        # about to be drawn in this frame
+        entry.displayedFrame = frameNum
+
+        # point out sources that are uploaded over and over
+        if entry.nUploads == self.imageDisplayUploadWarning:
+            warning = getattr(self, 'oneTimeWarning', print)
+            warning(f"(pglImage:imageDisplay) An image {imageData.shape} has been uploaded {entry.nUploads} times because it keeps changing. "
+                    f"Consider imageCreate once and imageUpdate when it changes. {self._imageCacheSummary()}")
+        elif stats['nCreated'] == self.imageDisplayUploadWarning * self.imageDisplayCacheSize:
+            warning = getattr(self, 'oneTimeWarning', print)
+            warning(f"(pglImage:imageDisplay) imageDisplay has made {stats['nCreated']} textures from arrays. "
+                    f"Consider imageCreate for images that are displayed more than once. {self._imageCacheSummary()}")
+        return entry.imageInstance
+
+    def _imageCacheDropSource(self, entry, sourceId):
+        # the object no longer goes with this entry
+        if self._imageCacheById.get(sourceId) is entry: self._imageCacheById.pop(sourceId)
+        entry.refs.pop(sourceId, None)
+
+    def _imageCacheAddSource(self, entry, source):
+        # remember the object (weakly, so the cache does not keep it alive)
+        try:
+            entry.refs[id(source)] = weakref.ref(source)
+        except TypeError:
+            # e.g. lists, which can not be weakly referenced, are only matched by contents
+            return
+        self._imageCacheById[id(source)] = entry
+
+    def imageCacheClear(self):
+        '''
+            Drop the textures imageDisplay has kept for arrays.
+        '''
+        self._imageCache = OrderedDict()
+        self._imageCacheById = {}
+        self._imageCacheStats = {'nCalls': 0, 'nReused': 0, 'nUpdated': 0, 'nCreated': 0, 'nEvicted': 0, 'fingerprintTime': 0.0}
+
+    def imageCacheStats(self, printSummary=True):
+        '''
+            How often imageDisplay reused, updated or created a texture for an array.
+        '''
+        if getattr(self, '_imageCache', None) is None: self.imageCacheClear()
+        if printSummary: print(f"(pglImage:imageCacheStats) {self._imageCacheSummary()}")
+        return dict(self._imageCacheStats, nCached=len(self._imageCache))
+
+    def _imageCacheSummary(self):
+        stats = self._imageCacheStats
+        return (f"{stats['nCalls']} images displayed from arrays: {stats['nReused']} reused, {stats['nUpdated']} updated, "
+                f"{stats['nCreated']} created, {stats['nEvicted']} evicted, {1000*stats['fingerprintTime']:.1f} ms fingerprinting")
 
     def imageValidate(self, imageData):
         '''
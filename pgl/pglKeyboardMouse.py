@@ -14,6 +14,7 @@ from time import sleep
 from typing import Optional
 from .pglEvent import pglEvent
 from .pglEventListener import pglEventListener, keyCodeToChar, charToKeyCode
+from . import _pglEventListener
 from .pglDevice import pglDevice
 
 #############################
@@ -149,6 +150,11 @@ class pglKeyboardMouse(pglDevice):
             
             # Convert keycode to character (if possible)
             keyChar = keyCodeToChar(keyCode, shift)
+
+            # latency from the most recent stimulus onset. Look it up again since the
+            # onset may have been published (after its flush) after the event arrived
+            onset = _pglEventListener.onsetLatency(timestamp)
+            onsetLatency, onsetId = onset if onset is not None else (None, None)
             
             # Create event object
             eventList.append(pglEventKeyboard(
@@ -160,7 +166,9 @@ class pglKeyboardMouse(pglDevice):
                 shift=shift,
                 ctrl=ctrl,
                 alt=alt,
-                cmd=cmd
+                cmd=cmd,
+                onsetLatency=onsetLatency,
+                onsetId=onsetId
             ))
 
         return eventList
@@ -383,7 +391,7 @@ class pglEventKeyboard(pglEvent):
 
     """
 
-    def __init__(self, keyChar, keyCode, key, timestamp, shift, ctrl, alt, cmd, eventType = None):
+    def __init__(self, keyChar, keyCode, key, timestamp, shift, ctrl, alt, cmd, eventType = None, onsetLatency = None, onsetId = None):
         '''
         Initialize the pglEventKeyboard instance.
         Args:
@@ -396,6 +404,8 @@ class pglEventKeyboard(pglEvent):
             alt (bool): Whether the alt key was held down.
             cmd (bool): Whether the cmd key was held down.
             eventType (str): The type of event ('keydown' or 'keyup').
+            onsetLatency (double): Time from the most recent stimulus onset (see pgl.markOnset) to timestamp.
+            onsetId (int): Which onset that was.
         Returns:
             None
         '''
@@ -409,6 +419,8 @@ class pglEventKeyboard(pglEvent):
         self.alt = alt
         self.cmd = cmd
         self.eventType = eventType
+        self.onsetLatency = onsetLatency
+        self.onsetId = onsetId
     def __repr__(self):
         '''
         Return a string representation of the pglEventKeyboard instance.
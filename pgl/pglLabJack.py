@@ -15,6 +15,7 @@ import time
 import numpy as np
 from pgl import pglTimestamp
 from .pglDevice import pglDigitalIODevice, pglAnalogTraceData
+from .pglRealtime import pglRealtimeThread
 import matplotlib.pyplot as plt
 
 class pglLabJack(pglDigitalIODevice):
@@ -203,7 +204,7 @@ class pglLabJack(pglDigitalIODevice):
 
         return True
             
-    def startAnalogRead(self, duration=2, channels=[0], scanRate=1000, scansPerRead=1000, range=10.0):
+    def startAnalogRead(self, duration=2, channels=[0], scanRate=1000, scansPerRead=1000, range=10.0, realtime=False):
         '''
         Start analog input reading from specified channels.
         
@@ -213,6 +214,8 @@ class pglLabJack(pglDigitalIODevice):
             scanRate (int): Sampling rate in Hz
             scansPerRead (int): Number of scans per read operation
             range (float): Voltage range for analog inputs. Options: 10.0V, 1.0V, 0.1V, 0.01V
+            realtime (bool): Run the acquisition thread with real-time scheduling (see pglRealtime),
+                so reads are not held up by background work
 
         '''
         if self.h is None:
@@ -264,10 +267,20 @@ class pglLabJack(pglDigitalIODevice):
         self.isReading = True
 
         # start acquisition thread
-        self.acquisitionThread = threading.Thread(
-            target=self.analogReadThread,
-            daemon=True
-        )
+        if realtime:
+            # one read per period, most of which is waiting on the device
+            readPeriod = scansPerRead / scanRate
+            self.acquisitionThread = pglRealtimeThread(
+                target=self.analogReadThread,
+                policy="fifo",
+                period=readPeriod,
+                daemon=True
+            )
+        else:
+            self.acquisitionThread = threading.Thread(
+                target=self.analogReadThread,
+                daemon=True
+            )
         self.acquisitionThread.start()
            
     def analogReadThread(self):
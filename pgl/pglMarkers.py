@@ -0,0 +1,395 @@
+################################################################
+#   filename: pglMarkers.py
+#    purpose: Frame locked markers for external systems. Code
+#             marks the frame it is drawing (pgl.markers.mark)
+#             and, once the frame is flushed, the markers are
+#             sent to the sinks (a digital line, VPixx pixel mode,
+#             the eye tracker, the experiment's data log) stamped
+#             with the time the frame was presented, from a
+#             background thread so the render loop does not wait
+#             on the devices. How late each sink sent its markers
+#             relative to the presentation is kept (latency).
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import queue
+import threading
+import numpy as np
+from dataclasses import dataclass, field
+from .pglEvent import pglEvent
+from .pglColor import pglDisplayColor
+from .pglTrace import traceLog
+
+traceMark = traceLog.define("pglMarkers:mark", "{name} code={code}", ("name:s", "code"))
+traceMarkerSent = traceLog.define("pglMarkers:sent", "{sink} {name} latency={latency:.6f}", ("sink:s", "name:s", "latency"))
+
+#################################################################
+# pglMarker
+#################################################################
+@dataclass
+class pglMarker:
+    '''
+    One marker: what it is (name, code and any fields), the frame it was
+    marked on and the time that frame was presented.
+    '''
+    name: str
+    code: int = 1
+    fields: dict = field(default_factory=dict)
+    frameNum: int = 0
+    markTime: float = 0.0
+    presentedTime: float = None
+    # presentedTime is the time of the flush, the display did not give one
+    presentedTimeEstimated: bool = False
+    # sink name -> time it was sent
+    sentTimes: dict = field(default_factory=dict)
+    # sink name -> time a sink scheduled it for (when the device does not say when it went out)
+    scheduledTimes: dict = field(default_factory=dict)
+
+#################################################################
+# pglMarkers
+#################################################################
+class pglMarkers:
+    '''
+    Frame locked marker service of a display (pgl.markers). Add the sinks
+    the setup has, then mark frames as they are drawn:
+
+    pgl.markers.addSink(pglMarkerSinkDigital(labJack, pulseLen=10))
+    pgl.markers.addSink(pglMarkerSinkEyeTracker(eyeTracker))
+    pgl.markers.addSink(pglMarkerSinkLog(experiment))
+    ...
+    pgl.markers.mark("stimulusOn", code=3, trialNum=trialNum)
+    pgl.flush()
+    ...
+    pgl.markers.printLatency()
+
+    Markers go to the sinks after the flush (from the marker thread), with
+    the presented time of the frame they were marked on.
+    '''
+    # latencies kept for each sink
+    nLatencies = 4096
+
+    def __init__(self, pgl=None):
+        self.pgl = pgl
+        self.sinks = []
+        self.pending = []
+        self.nFrames = 0
+        self.nMarkers = 0
+        self._queue = queue.Queue()
+        self._thread = None
+        self._lock = threading.Lock()
+        self._latencies = {}
+        self._nSent = {}
+        self._nScheduled = {}
+        self._nErrors = {}
+
+    ################################################################
+    # sinks
+    ################################################################
+    def addSink(self, sink):
+        '''
+        Add a sink (a pglMarkerSink) that markers are sent to.
+        '''
+        with self._lock:
+            self.sinks.append(sink)
+            self._latencies[sink.name] = np.full(self.nLatencies, np.nan)
+            self._nSent[sink.name] = 0
+            self._nScheduled[sink.name] = 0
+            self._nErrors[sink.name] = 0
+        return sink
+
+    def removeSink(self, sink):
+        with self._lock:
+            if sink in self.sinks: self.sinks.remove(sink)
+
+    ################################################################
+    # mark
+    ################################################################
+    def mark(self, name, code=1, **fields):
+        '''
+        Mark the frame being drawn: the marker is sent to the sinks once it
+        is flushed, stamped with the time it was presented.
+
+        Args:
+            name (str): What the marker is, e.g. "stimulusOn".
+            code (int): Code for sinks that send a number (digital lines, pixel mode).
+            **fields: Anything else to log with it (e.g. trialNum).
+
+        Returns:
+            pglMarker
+        '''
+        marker = pglMarker(name=name, code=int(code), fields=fields, frameNum=self.nFrames, markTime=self._getSecs())
+        self.pending.append(marker)
+        if traceLog.on: traceLog.record(traceMark, traceLog.string(name), code)
+        return marker
+
+    ################################################################
+    # flush hooks (called by flush on the render thread)
+    ################################################################
+    def beforeFlush(self):
+        '''
+        Called by flush before the frame is sent, so that sinks that are part
+        of the frame (pixel mode) can draw the frame's markers.
+        '''
+        for sink in self.sinks:
+            if sink.drawsFrame: sink.drawFrame(self.pgl, self.pending)
+
+    def frameFlushed(self, presentedTime):
+        '''
+        Called by flush with the time the frame was presented: hands the
+        frame's markers to the marker thread.
+        '''
+        self.nFrames += 1
+        if not self.pending: return
+        estimated = bool(not presentedTime or presentedTime <= 0)
+        if estimated: presentedTime = self._getSecs()
+        for marker in self.pending:
+            marker.presentedTime, marker.presentedTimeEstimated = float(presentedTime), estimated
+        self._queue.put(self.pending)
+        self.nMarkers += len(self.pending)
+        self.pending = []
+        if self._thread is None or not self._thread.is_alive():
+            self._thread = threading.Thread(target=self._dispatchLoop, name="pglMarkers", daemon=True)
+            self._thread.start()
+
+    ################################################################
+    # dispatch (marker thread)
+    ################################################################
+    def _dispatchLoop(self):
+        while True:
+            markers = self._queue.get()
+            if markers is None:
+                self._queue.task_done()
+                return
+            with self._lock: sinks = list(self.sinks)
+            for marker in markers:
+                for sink in sinks:
+                    try:
+                        sentTime = sink.send(marker)
+                    except Exception as e:
+                        with self._lock: self._nErrors[sink.name] += 1
+                        print(f"(pglMarkers) ❌ Could not send {marker.name} to {sink.name}: {e}")
+                        continue
+                    if sentTime is pglMarkerSink.scheduled:
+                        # handed to the device for the presented time, which is not a measured latency
+                        marker.scheduledTimes[sink.name] = marker.presentedTime
+                        with self._lock: self._nScheduled[sink.name] += 1
+                        continue
+                    if sentTime is None: sentTime = self._getSecs()
+                    marker.sentTimes[sink.name] = sentTime
+                    latency = sentTime - marker.presentedTime
+                    # stats and addSink (which resets them) run on different threads
+                    with self._lock:
+                        self._latencies[sink.name][self._nSent[sink.name] % self.nLatencies] = latency
+                        self._nSent[sink.name] += 1
+                    if traceLog.on: traceLog.record(traceMarkerSent, traceLog.string(sink.name), traceLog.string(marker.name), latency)
+            self._queue.task_done()
+
+    def wait(self):
+        '''
+        Wait until the markers of the frames flushed so far have been sent.
+        '''
+        if self._thread is not None and self._thread.is_alive(): self._queue.join()
+
+    def close(self):
+        '''
+        Send what is waiting and stop the marker thread.
+        '''
+        if self._thread is not None and self._thread.is_alive():
+            self._queue.put(None)
+            self._thread.join()
+        self._thread = None
+
+    ################################################################
+    # latency
+    ################################################################
+    def latency(self):
+        '''
+        How late each sink sent markers after the frame was presented, over
+        its last nLatencies markers. Markers a sink scheduled on its device
+        (nScheduled) have no measured time and are not in the latencies.
+
+        Returns:
+            dict: sink name -> n, nScheduled, nErrors, median, p95, min and max latency (seconds).
+        '''
+        stats = {}
+        with self._lock:
+            for sink in self.sinks:
+                latencies = self._latencies[sink.name]
+                latencies = latencies[~np.isnan(latencies)]
+                stats[sink.name] = {"n": self._nSent[sink.name], "nScheduled": self._nScheduled[sink.name], "nErrors": self._nErrors[sink.name]}
+                if len(latencies):
+                    stats[sink.name].update(median=float(np.median(latencies)), p95=float(np.percentile(latencies, 95)),
+                                            min=float(latencies.min()), max=float(latencies.max()))
+        return stats
+
+    def printLatency(self):
+        print(f"(pglMarkers) {self.nMarkers} markers over {self.nFrames} frames")
+        for name, stats in self.latency().items():
+            scheduled = f" {stats['nScheduled']:6d} scheduled" if stats['nScheduled'] else ""
+            if "median" not in stats:
+                print(f"  {name:<20} {stats['n']:6d} sent{scheduled} {stats['nErrors']:4d} errors")
+                continue
+            print(f"  {name:<20} {stats['n']:6d} sent{scheduled} {stats['nErrors']:4d} errors, latency median {stats['median']*1000:.3f} ms "
+                  f"p95 {stats['p95']*1000:.3f} ms range [{stats['min']*1000:.3f} {stats['max']*1000:.3f}] ms")
+
+    def _getSecs(self):
+        return self.pgl.getSecs() if self.pgl is not None else 0.0
+
+#################################################################
+# sinks
+#################################################################
+class pglMarkerSink:
+    '''
+    Where markers go. send is called from the marker thread with each
+    marker after its frame was presented and returns the time it went
+    out (or None for now), or scheduled if the device was given the marker
+    to send at the presented time and does not report when it did. Sinks
+    that are part of the frame itself set
+    drawsFrame and draw in drawFrame, which is called on the render
+    thread before each flush.
+    '''
+    name = "sink"
+    drawsFrame = False
+    # returned by send for markers left to the device to send on time
+    scheduled = object()
+
+    def send(self, marker):
+        return None
+
+    def drawFrame(self, pgl, markers):
+        pass
+
+class pglMarkerSinkDigital(pglMarkerSink):
+    '''
+    Pulse on a digital output (e.g. pglLabJack after setupDigitalOutput).
+    If the presented time is still ahead (the display reports the time the
+    frame will be shown), the pulse is scheduled for it with
+    digitalOutputAtTime when the device has it; those are counted as
+    scheduled, since the device does not say when the pulse went out.
+    '''
+    def __init__(self, device, pulseLen=10, scheduleMargin=0.002, name=None):
+        '''
+        Args:
+            device: Digital output device with digitalOutput(state, pulseLen).
+            pulseLen (float): Pulse length in milliseconds.
+            scheduleMargin (float): Schedule the pulse if the presented time is at least this (seconds) ahead.
+        '''
+        self.device = device
+        self.pulseLen = pulseLen
+        self.scheduleMargin = scheduleMargin
+        self.name = name or f"digital:{getattr(device, 'deviceType', 'device')}"
+
+    def send(self, marker):
+        if hasattr(self.device, 'digitalOutputAtTime') and hasattr(self.device, 'pglTimestamp'):
+            if marker.presentedTime - self.device.pglTimestamp.getSecs() >= self.scheduleMargin:
+                if self.device.digitalOutputAtTime(marker.presentedTime, True, self.pulseLen): return self.scheduled
+        return self.device.digitalOutput(True, self.pulseLen)
+
+class pglMarkerSinkPixelMode(pglMarkerSink):
+    '''
+    VPixx pixel mode (pglDataPixx.enablePixelMode): the colour of the top
+    left pixel of each frame drives the digital outputs when the frame is
+    shown, so the marker goes out with the frame itself. The pixel is
+    drawn on every frame (0 when there is no marker) so the background does
+    not drive the outputs, and the gamma table must be linear for the code
+    to come through.
+    '''
+    name = "pixelMode"
+    drawsFrame = True
+
+    def __init__(self, doutShift=16):
+        '''
+        Args:
+            doutShift (int): First digital output the code drives; the top left pixel's
+                red, green and blue drive outputs 0-7, 8-15 and 16-23 (pixel mode B uses blue).
+        '''
+        self.doutShift = doutShift
+
+    def drawFrame(self, pgl, markers):
+        # the pixel is placed in pixel units, which need visual angle coordinates
+        if getattr(pgl, 'xPix2Deg', None) is None:
+            getattr(pgl, 'oneTimeWarning', print)("(pglMarkerSinkPixelMode) ❌ Pixel mode markers need visualAngle coordinates to place the pixel, not drawing them")
+            return
+        code = 0
+        for marker in markers: code |= marker.code
+        word = (code << self.doutShift) & 0xFFFFFF
+        # the code is the pixel's display value, which a color space (setColorSpace) must not convert
+        color = np.array([[(word & 0xFF) / 255, ((word >> 8) & 0xFF) / 255, ((word >> 16) & 0xFF) / 255]], dtype=np.float32).view(pglDisplayColor)
+        pgl.quad(np.array([[0, 0], [1, 0], [1, 1], [0, 1]]), color=color, units="pix")
+
+    def send(self, marker):
+        # went out with the frame
+        return marker.presentedTime
+
+class pglMarkerSinkEyeTracker(pglMarkerSink):
+    '''
+    Eye tracker message (e.g. pglEyelink). Eyelink takes a number at the
+    start of a message as how many milliseconds before the message the
+    event happened, so the message is timed at the presentation even
+    though it is sent later. Messages are sent from the marker thread, so
+    the tracker has to serialize its calls (pglEyeTracker.lock).
+    '''
+    name = "eyeTracker"
+
+    def __init__(self, eyeTracker, prefix="pgl: marker", offsetMessages=True):
+        '''
+        Args:
+            eyeTracker: Eye tracker with sendMessage(message).
+            prefix (str): Start of the message text.
+            offsetMessages (bool): Start messages with the offset in ms (Eyelink).
+        '''
+        self.eyeTracker = eyeTracker
+        self.prefix = prefix
+        self.offsetMessages = offsetMessages
+
+    def send(self, marker):
+        text = " ".join([f"{self.prefix} {marker.name} code={marker.code}"] + [f"{k}={v}" for k, v in marker.fields.items()] + [f"presentedTime={marker.presentedTime}"])
+        sentTime = self.eyeTracker.pgl.getSecs() if getattr(self.eyeTracker, 'pgl', None) is not None else None
+        if self.offsetMessages and sentTime is not None:
+            text = f"{max(0, round((sentTime - marker.presentedTime) * 1000))} {text}"
+        self.eyeTracker.sendMessage(text)
+        return sentTime
+
+class pglMarkerSinkLog(pglMarkerSink):
+    '''
+    The experiment's data log: a pglEventMarker in experiment.data.events,
+    and, with eyeTrackerEvents, the experiment's eye tracker event
+    (pglExperiment.saveEyeTrackerEvent) timestamped with the presentation.
+    '''
+    name = "log"
+
+    def __init__(self, experiment, eyeTrackerEvents=False):
+        self.experiment = experiment
+        self.eyeTrackerEvents = eyeTrackerEvents
+
+    def send(self, marker):
+        self.experiment.data.events.append(pglEventMarker(name=marker.name, code=marker.code, fields=dict(marker.fields), timestamp=marker.presentedTime,
+                                                          markTime=marker.markTime, presentedTimeEstimated=marker.presentedTimeEstimated))
+        if self.eyeTrackerEvents and getattr(self.experiment, 'eyeTracker', None) is not None:
+            self.experiment.saveEyeTrackerEvent(eventType=marker.name, taskID=marker.fields.get('taskID'), trialNum=marker.fields.get('trialNum'),
+                                                segmentNum=marker.fields.get('segmentNum'), timestamp=marker.presentedTime)
+        return None
+
+#################################################################
+# Event of a marker in the data log
+#################################################################
+class pglEventMarker(pglEvent):
+
+    def __init__(self, name=None, code=None, fields=None, timestamp=None, markTime=None, presentedTimeEstimated=False):
+        super().__init__(type="marker")
+
+        # set attributes
+        self.name = name
+        self.code = code
+        self.fields = fields if fields is not None else {}
+        # time the frame it was marked on was presented, and when it was marked
+        self.timestamp = timestamp
+        self.markTime = markTime
+        self.presentedTimeEstimated = presentedTimeEstimated
+
+    def print(self):
+        print(f"(pglEventMarker) {self.name} code={self.code} at: {self.timestamp}")
@@ -0,0 +1,310 @@
+################################################################
+#   filename: pglMultiDisplay.py
+#    purpose: Runs several screens (each with its own mglMetal
+#             connection) as one session, for dichoptic, haploscope
+#             and multi-monitor rigs: command streams are sent to
+#             all screens in parallel and flushes are aimed at a
+#             shared presentation time, with the presentation time
+#             of every screen kept so that skew can be measured.
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import time
+import numpy as np
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass, field
+from .pglSerialize import pglSerialize
+from . import _pglTimestamp
+
+#################################################################
+# pglMultiDisplay
+#################################################################
+class pglMultiDisplay:
+    '''
+    A session over several displays. Each display is a pgl instance
+    (or anything with the same flush / getTargetPresentationTimestamp
+    interface, e.g. pglStandInDisplay) talking to its own mglMetal.
+
+    Since each display has its own socket, the work for each display
+    runs in its own thread, so a slow display does not hold up the others.
+
+    e.g.
+    multi = pglMultiDisplay()
+    multi.open([1, 2])
+    multi.submit(lambda display, i: display.clearScreen([i, 0, 0]))
+    presented = multi.flush()
+    multi.getSkew()
+    multi.close()
+
+    Flushing: mglMetal presents a frame on the first vsync after its
+    commands are done, so to aim every display at the same vsync
+    (the shared target, by default the latest of each display's next
+    target presentation time) each display's mglFlush is held back until
+    flushLeadFrames of its own frame periods before the shared target.
+    A display that takes longer than that to render will present a frame
+    late, so each display's lead is adjusted by a quarter frame whenever
+    it presents a frame early or late. Displays that are not genlocked can
+    still differ by up to a frame in phase, which is what getSkew reports.
+    '''
+    def __init__(self, displays=None, flushLeadFrames=0.5, verbose=1):
+        '''
+        Args:
+            displays (list, optional): Already opened pgl instances to run together.
+            flushLeadFrames (float, optional): How many frames before the shared target
+              presentation time to send each display's flush.
+            verbose (int, optional): Verbosity level.
+        '''
+        self.displays = []
+        self.flushLeadFrames = flushLeadFrames
+        self.verbose = verbose
+        self.data = pglMultiDisplayData()
+        # per display lead (in frames), adjusted as flushes land early or late
+        self.flushLeads = {}
+        self._executor = None
+        for display in (displays or []): self.addDisplay(display)
+
+    # most frames ahead of the target a flush will be sent
+    maxFlushLeadFrames = 3.0
+
+    def __len__(self):
+        return len(self.displays)
+
+    def __getitem__(self, index):
+        return self.displays[index]
+
+    def __iter__(self):
+        return iter(self.displays)
+
+    def __repr__(self):
+        return f"pglMultiDisplay({len(self.displays)} displays, {self.data.nFlushes} flushes)"
+
+    ################################################################
+    # open
+    ################################################################
+    def open(self, whichScreens, **kwargs):
+        '''
+        Open a pgl instance (and mglMetal) on each screen.
+
+        Args:
+            whichScreens (list): Screen numbers to open.
+            **kwargs: Passed on to pgl.open (e.g. screenWidth, screenHeight).
+
+        Returns:
+            bool: True if all screens opened.
+        '''
+        # import here, since the pgl class is built in the package __init__
+        from . import pgl
+
+        # added once every screen is open, so that a failure closes only what this call opened
+        opened = []
+        for whichScreen in whichScreens:
+            display = pgl()
+            if not display.open(whichScreen, **kwargs):
+                print(f"(pglMultiDisplay:open) ❌ Could not open screen {whichScreen}")
+                for display in opened + [display]: display.close()
+                return False
+            opened.append(display)
+        for display in opened: self.addDisplay(display)
+        return True
+
+    def addDisplay(self, display):
+        '''
+        Add an already opened display to the session.
+        '''
+        if not display.isOpen():
+            print(f"(pglMultiDisplay:addDisplay) ❌ Display is not open")
+            return False
+        self.displays.append(display)
+        # nan for the flushes before it joined, so every display has one entry per flush
+        self.data.presentedTimes.append([np.nan] * self.data.nFlushes)
+        self.flushLeads[id(display)] = self.flushLeadFrames
+
+        # one thread per display
+        if self._executor is not None: self._executor.shutdown()
+        self._executor = ThreadPoolExecutor(max_workers=len(self.displays), thread_name_prefix="pglMultiDisplay")
+        return True
+
+    ################################################################
+    # close
+    ################################################################
+    def close(self):
+        '''
+        Close all the displays.
+        '''
+        if self.displays: self.parallel(lambda display: display.close())
+        self.displays = []
+        if self._executor is not None:
+            self._executor.shutdown()
+            self._executor = None
+        return True
+
+    ################################################################
+    # parallel
+    ################################################################
+    def parallel(self, function, *args):
+        '''
+        Call function(display, *args) for every display at the same time,
+        each in its own thread. Returns the list of results in display order.
+        '''
+        if not self.displays: return []
+        futures = [self._executor.submit(function, display, *args) for display in self.displays]
+        # result() re-raises any exception from the display's thread
+        return [future.result() for future in futures]
+
+    def submit(self, drawFunctions):
+        '''
+        Send each display's drawing commands in parallel.
+
+        Args:
+            drawFunctions (callable or list): Either one function called as
+              drawFunction(display, displayIndex) for each display, or a list
+              with one function per display called as drawFunction(display).
+
+        Returns:
+            list: Whatever the functions returned, in display order.
+        '''
+        if callable(drawFunctions):
+            indices = {id(display): i for i, display in enumerate(self.displays)}
+            return self.parallel(lambda display: drawFunctions(display, indices[id(display)]))
+        if len(drawFunctions) != len(self.displays):
+            print(f"(pglMultiDisplay:submit) ❌ Got {len(drawFunctions)} draw functions for {len(self.displays)} displays")
+            return None
+        functions = {id(display): f for display, f in zip(self.displays, drawFunctions)}
+        return self.parallel(lambda display: functions[id(display)](display))
+
+    ################################################################
+    # getTargetPresentationTimestamps
+    ################################################################
+    def getTargetPresentationTimestamps(self):
+        '''
+        Time that each display's next frame is scheduled to be presented.
+        '''
+        return np.array(self.parallel(lambda display: float(display.getTargetPresentationTimestamp())))
+
+    ################################################################
+    # flush
+    ################################################################
+    def flush(self, targetTime=None, synchronized=True):
+        '''
+        Flush all the displays.
+
+        Args:
+            targetTime (float, optional): Shared time (on the pglTimestamp clock) to aim
+              the frames at. Defaults to the latest next presentation time of the displays.
+            synchronized (bool, optional): If False, just flush every display at once
+              without aiming at a shared target.
+
+        Returns:
+            np.ndarray: The time each display's frame was presented.
+        '''
+        if not self.displays:
+            print(f"(pglMultiDisplay:flush) ❌ No displays are open")
+            return None
+
+        framePeriods = np.array([self.getFramePeriod(display) for display in self.displays])
+        leads = np.array([self.flushLeads[id(display)] for display in self.displays])
+        if synchronized:
+            # shared target is the latest of the displays' next frames
+            targetTimes = self.getTargetPresentationTimestamps()
+            sharedTarget = float(targetTimes.max()) if targetTime is None else float(targetTime)
+
+            # hold each flush until shortly before the shared target (a display
+            # whose lead puts that in the past just flushes straight away)
+            sendTimes = {id(display): sharedTarget - lead * framePeriod for display, lead, framePeriod in zip(self.displays, leads, framePeriods)}
+            def flushAt(display):
+                self.waitUntil(sendTimes[id(display)])
+                return (_pglTimestamp.getSecs(), display.flush())
+        else:
+            targetTimes = np.full(len(self.displays), np.nan)
+            sharedTarget = np.nan
+            def flushAt(display):
+                return (_pglTimestamp.getSecs(), display.flush())
+
+        results = self.parallel(flushAt)
+        sendTimes = np.array([r[0] for r in results])
+        presentedTimes = np.array([np.nan if r[1] is None else float(r[1]) for r in results])
+
+        # move the lead of any display that missed the target
+        if synchronized:
+            for display, presentedTime, framePeriod in zip(self.displays, presentedTimes, framePeriods):
+                error = presentedTime - sharedTarget
+                if error > framePeriod / 2:
+                    self.flushLeads[id(display)] = min(self.flushLeads[id(display)] + 0.25, self.maxFlushLeadFrames)
+                elif error < -framePeriod / 2:
+                    self.flushLeads[id(display)] = max(self.flushLeads[id(display)] - 0.25, 0.0)
+
+        # keep the record
+        self.data.sharedTargets.append(sharedTarget)
+        self.data.targetTimes.append(targetTimes.tolist())
+        self.data.sendTimes.append(sendTimes.tolist())
+        for i, presentedTime in enumerate(presentedTimes): self.data.presentedTimes[i].append(float(presentedTime))
+        self.data.nFlushes += 1
+
+        if self.verbose > 1:
+            print(f"(pglMultiDisplay:flush) target {sharedTarget:.6f} presented {presentedTimes} skew {1000*np.ptp(presentedTimes):.3f} ms")
+        return presentedTimes
+
+    def getFramePeriod(self, display):
+        '''
+        Frame period of a display, measured from its presented frames if it
+        tracks them (pglBase.getFramePeriod), else from its frameRate, or 60Hz if unknown.
+        '''
+        if hasattr(display, 'getFramePeriod'): return display.getFramePeriod()
+        frameRate = getattr(display, 'frameRate', None)
+        return 1.0 / frameRate if frameRate else 1.0 / 60.0
+
+    def waitUntil(self, t):
+        '''
+        Wait until time t on the pglTimestamp clock (sleeps, then spins for the last millisecond).
+        '''
+        while True:
+            remaining = t - _pglTimestamp.getSecs()
+            if remaining <= 0: return
+            time.sleep(remaining - 0.001 if remaining > 0.002 else 0)
+
+    ################################################################
+    # getSkew
+    ################################################################
+    def getSkew(self, printSummary=True):
+        '''
+        Summary of how far apart the displays presented each frame. Only flushes
+        that every display presented (e.g. not those before a display was added) count.
+
+        Returns:
+            dict: skew (max - min presented time per counted flush), median and max skew,
+              the number of flushes counted, and the median offset of each display from the shared target.
+        '''
+        if self.data.nFlushes == 0:
+            print(f"(pglMultiDisplay:getSkew) ❌ No flushes yet")
+            return None
+        presented = np.array(self.data.presentedTimes).T
+        presentedByAll = np.all(np.isfinite(presented), axis=1)
+        if not np.any(presentedByAll):
+            print(f"(pglMultiDisplay:getSkew) ❌ No flush was presented on every display")
+            return None
+        skew = np.ptp(presented[presentedByAll], axis=1)
+        sharedTargets = np.array(self.data.sharedTargets)
+        offsets = np.nanmedian(presented - sharedTargets[:, np.newaxis], axis=0) if not np.all(np.isnan(sharedTargets)) else np.full(len(self.displays), np.nan)
+        summary = {'skew': skew, 'medianSkew': float(np.median(skew)), 'maxSkew': float(np.max(skew)), 'nFlushes': len(skew), 'targetOffsets': offsets}
+        if printSummary:
+            print(f"(pglMultiDisplay:getSkew) {len(skew)} of {self.data.nFlushes} flushes presented on every display: median skew {1000*summary['medianSkew']:.3f} ms, max skew {1000*summary['maxSkew']:.3f} ms")
+            for i, offset in enumerate(offsets):
+                print(f"  display {i}: median offset from target {1000*offset:.3f} ms")
+        return summary
+
+##############################################
+# Data for pglMultiDisplay
+##############################################
+@dataclass
+class pglMultiDisplayData(pglSerialize):
+    # one entry per flush
+    nFlushes: int = 0
+    sharedTargets: list = field(default_factory=list)
+    targetTimes: list = field(default_factory=list)
+    sendTimes: list = field(default_factory=list)
+    # one list per display, with an entry for every flush (nan if it was not presented)
+    presentedTimes: list = field(default_factory=list)
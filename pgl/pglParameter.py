@@ -112,6 +112,22 @@ class pglParameter:
         paramValues = self.data.parameterBlocks[self.state.blockNum][self.state.currentTrialInBlock]
         
         return dict(zip(paramNames, paramValues))    
+
+    def peek(self, nAhead=1):
+        '''
+        Get the parameter values for the trial nAhead trials after the current one
+        without advancing (e.g. peek(1) is what the next get() will return). Blocks
+        that are needed are generated ahead of time, in the same order get() would
+        have generated them, so peeking does not change the sequence.
+        '''
+        blockNum, trialInBlock = self.state.blockNum, self.state.currentTrialInBlock
+        for i in range(nAhead):
+            trialInBlock += 1
+            if blockNum == -1 or trialInBlock >= self.data.blockLengths[blockNum]:
+                blockNum += 1
+                trialInBlock = 0
+                if blockNum >= len(self.data.parameterBlocks): self.generateBlock()
+        return dict(zip(self.data.parameterNames[blockNum], self.data.parameterBlocks[blockNum][trialInBlock]))
     
     def getParameterBlock(self):
         '''
@@ -132,20 +148,24 @@ class pglParameter:
         '''
         Start a block.
         '''
-        # get randomization of parameters
-        (paramNames, parameterBlock) = self.getParameterBlock()
-        
-        # append to the data lists
-        self.data.parameterNames.append(paramNames)
-        self.data.parameterBlocks.append(parameterBlock)
-        self.data.blockLengths.append(len(parameterBlock))
+        # get randomization of parameters (unless peek already made this block)
+        if self.state.blockNum + 1 >= len(self.data.parameterBlocks): self.generateBlock()
         
         # increment block number and reset trial in block
         self.state.blockNum += 1
         self.state.currentTrialInBlock = 0
         
         # display block information        
-        print(f"Block {self.state.blockNum+1}: {len(parameterBlock)} trials randomized over: {paramNames}")
+        print(f"Block {self.state.blockNum+1}: {self.data.blockLengths[self.state.blockNum]} trials randomized over: {self.data.parameterNames[self.state.blockNum]}")
+
+    def generateBlock(self):
+        '''
+        Randomize the next block and append it to the data lists.
+        '''
+        (paramNames, parameterBlock) = self.getParameterBlock()
+        self.data.parameterNames.append(paramNames)
+        self.data.parameterBlocks.append(parameterBlock)
+        self.data.blockLengths.append(len(parameterBlock))
 
     def print(self):
         """
@@ -363,8 +383,9 @@ class pglParameterBlock(pglParameter):
         if not isinstance(parameters, list) or not all(isinstance(p, pglParameter) for p in parameters):
             raise TypeError("(pglParameterBlock) ❌ Error: parameters must be a list of pglParameter instances.")
 
-        # keep the list of pglParameters
-        self.settings = pglParameterSettingsBlock()        
+        # keep the list of pglParameters (subclasses may have already set a specialized settings)
+        if not isinstance(getattr(self, 'settings', None), pglParameterSettingsBlock):
+            self.settings = pglParameterSettingsBlock()        
         self.settings.parameters = parameters
         self.settings.parameterNames = [p.settings.name for p in self.settings.parameters]
 
@@ -387,7 +408,7 @@ class pglParameterBlock(pglParameter):
         to run as a block of trials.
         '''
         # create a copy of allParameterValues
-        block = self.settings.validValues
+        block = list(self.settings.validValues)
         # randomly shuffle
         self._rng.shuffle(block)
         # and return
@@ -507,6 +528,367 @@ class pglParameterNestedBlock(pglParameterBlock):
         block = buildNestedBlock(self.settings.parameters)
         return (self.settings.parameterNames, block)
 
+##########################
+# Parameter sequence class
+##########################
+class pglParameterSequence(pglParameterBlock):
+    '''
+    Like pglParameterBlock, this runs over all combinations of its parameters
+    in randomized blocks, but the whole session's sequence of trials is generated
+    up front as a table (with numpy rather than Python lists), so that get() on
+    each trial is just a row read and there is no work to do at block boundaries.
+
+    The table can also satisfy some constraints:
+
+    noRepeat: list of parameter names whose value should never be the same on
+      two consecutive trials (including across block boundaries), e.g.
+      noRepeat=['direction'] for [1,2,1,3,2,3,...] rather than [1,1,2,...]
+
+    counterbalance: name of a parameter to hold constant within each block, with
+      the order of blocks across the session counterbalanced with a balanced
+      (Williams) Latin square. counterbalanceIndex (e.g. the subject number) picks
+      which row of the square is used, so that across subjects each value is
+      run in each position and follows each other value equally often.
+      e.g. for condition=[A,B,C] and other parameters crossed within the block:
+
+      counterbalanceIndex 0: block 1: A, block 2: B, block 3: C, block 4: A...
+      counterbalanceIndex 1: block 1: B, block 2: C, block 3: A, block 4: B...
+
+    The generated table is in self.trialTable (a numpy structured array with
+    columns trial, block, trialInBlock and one for each parameter), and the
+    sequence is reproducible from randomSeed.
+
+    e.g.
+    direction = pglParameter('direction', [0, 90, 180, 270])
+    coherence = pglParameter('coherence', [0.1, 0.5, 1.0])
+    sequence = pglParameterSequence([direction, coherence], nBlocks=20, noRepeat=['direction'], randomSeed=1)
+    sequence.get() -> {'direction': 180, 'coherence': 0.5}
+    '''
+    def __init__(self, parameters: list, nBlocks: int=1, noRepeat: list=[], counterbalance: str=None, counterbalanceIndex: int=0, name: str="", description: str="", randomSeed=None):
+        '''
+        Initialize the parameter sequence.
+
+        Args:
+            parameters (list): A list of pglParameter instances to include in the sequence.
+            nBlocks (int, optional): Number of blocks to generate up front. If the experiment
+              runs past the end of the table, more blocks are generated.
+            noRepeat (list, optional): Names of parameters that should not repeat on consecutive trials.
+            counterbalance (str, optional): Name of a parameter to hold constant in each block and
+              counterbalance across blocks.
+            counterbalanceIndex (int, optional): Which row of the counterbalancing Latin square to use.
+            name (str, optional): Name to override default of paramname1_paramname2...
+            description (str, optional): Description string describing the parameter sequence.
+            randomSeed (int, optional): Seed for random number generation. If None, a random seed is used.
+        '''
+        # batches are not a single value per trial, so they can not be a column of the table
+        for p in parameters:
+            if isinstance(p, pglParameterBatch):
+                raise TypeError(f"(pglParameterSequence) ❌ Error: pglParameterBatch ({p.settings.name}) can not be used in a pglParameterSequence.")
+            if isinstance(p, pglParameterBlock):
+                raise TypeError(f"(pglParameterSequence) ❌ Error: pass the parameters of {p.settings.name} directly rather than as a block.")
+
+        # specialized settings and data for this
+        self.settings = pglParameterSettingsSequence()
+        self.data = pglParameterDataSequence()
+
+        # call super init
+        super().__init__(parameters=parameters, name=name, description=description, randomSeed=randomSeed)
+
+        # validate the constraints
+        if not isinstance(nBlocks, (int, np.integer)) or nBlocks < 1:
+            raise ValueError(f"(pglParameterSequence) ❌ Error: nBlocks must be a positive integer, got {nBlocks}.")
+        for parameterName in list(noRepeat) + ([] if counterbalance is None else [counterbalance]):
+            if parameterName not in self.settings.parameterNames:
+                raise ValueError(f"(pglParameterSequence) ❌ Error: {parameterName} is not one of the parameters {self.settings.parameterNames}.")
+        if counterbalance is not None and counterbalance in noRepeat:
+            raise ValueError(f"(pglParameterSequence) ❌ Error: {counterbalance} is held constant within blocks, so it can not also be noRepeat.")
+        self.settings.nBlocks = int(nBlocks)
+        self.settings.noRepeat = list(noRepeat)
+        self.settings.counterbalance = "" if counterbalance is None else counterbalance
+        self.settings.counterbalanceIndex = int(counterbalanceIndex)
+
+        # generate the whole session
+        self._trialTable = None
+        self.extendSequence(self.settings.nBlocks)
+
+    def __repr__(self):
+        return f"pglParameterSequence(name={self.settings.name}, parameters={self.settings.parameterNames}, nBlocks={self.data.nBlocks}, nTrials={self.data.nTrials})"
+
+    def get(self):
+        '''
+        Get the parameter values for the next trial.
+        '''
+        # increment trial number, generating more blocks if we have run off the end
+        self.state.currentTrial += 1
+        if self.state.currentTrial >= self.data.nTrials:
+            self.extendSequence(self.settings.nBlocks)
+
+        # read the row for this trial
+        row = self._rows[self.state.currentTrial]
+
+        # keep block state the same as for other parameters
+        blockNum = int(self.data.trialBlocks[self.state.currentTrial])
+        if blockNum != self.state.blockNum:
+            self.state.blockNum = blockNum
+            print(f"Block {blockNum+1}: {self.data.blockLengths[blockNum]} trials randomized over: {self.settings.parameterNames}")
+        self.state.currentTrialInBlock = int(self.data.trialInBlock[self.state.currentTrial])
+
+        return dict(zip(self.settings.parameterNames, row))
+
+    def peek(self, nAhead=1):
+        '''
+        Get the parameter values for the trial nAhead trials after the current one
+        without advancing, generating more blocks if needed.
+        '''
+        trialNum = self.state.currentTrial + nAhead
+        while trialNum >= self.data.nTrials: self.extendSequence(self.settings.nBlocks)
+        return self.getTrial(trialNum)
+
+    def getTrial(self, trialNum):
+        '''
+        Get the parameter values for any trial (0-based) without advancing the sequence.
+        '''
+        if trialNum < 0 or trialNum >= self.data.nTrials:
+            print(f"(pglParameterSequence:getTrial) ❌ trialNum {trialNum} is out of range (0-{self.data.nTrials-1})")
+            return None
+        return dict(zip(self.settings.parameterNames, self._rows[trialNum]))
+
+    def getParameterBlock(self):
+        '''
+        Get one randomized block (in the same form as pglParameterBlock). Note that
+        get() does not use this, it reads from the pre-generated trialTable.
+        '''
+        levelIndices, _ = self._generateBlocks(1, previousRow=None, firstBlock=self.data.nBlocks)
+        values = self._levelValues(levelIndices)
+        return (self.settings.parameterNames, list(zip(*values)))
+
+    @property
+    def trialTable(self):
+        '''
+        The session's trial sequence as a numpy structured array with columns
+        trial, block, trialInBlock and one per parameter.
+        '''
+        if getattr(self, '_trialTable', None) is None: self._buildTrialTable()
+        return self._trialTable
+
+    @property
+    def _rows(self):
+        # rows of the trial table as tuples of python values, for fast dict building
+        if getattr(self, '_trialTable', None) is None: self._buildTrialTable()
+        return self._trialRows
+
+    def extendSequence(self, nBlocks):
+        '''
+        Generate nBlocks more blocks and append them to the sequence.
+        '''
+        # continue on from the last trial so noRepeat holds across the join
+        previousRow = self.data.levelIndices[-1] if self.data.nTrials > 0 else None
+        levelIndices, blockLengths = self._generateBlocks(nBlocks, previousRow=previousRow, firstBlock=self.data.nBlocks)
+
+        # block number and trial within block for every trial
+        firstBlock = self.data.nBlocks
+        trialBlocks = np.repeat(np.arange(firstBlock, firstBlock + nBlocks, dtype=np.int32), blockLengths)
+        blockStarts = np.repeat(np.cumsum(blockLengths) - blockLengths, blockLengths)
+        trialInBlock = (np.arange(len(trialBlocks)) - blockStarts).astype(np.int32)
+
+        # append to data
+        if self.data.nTrials == 0:
+            self.data.levelIndices = levelIndices
+            self.data.trialBlocks = trialBlocks
+            self.data.trialInBlock = trialInBlock
+        else:
+            self.data.levelIndices = np.concatenate((self.data.levelIndices, levelIndices))
+            self.data.trialBlocks = np.concatenate((self.data.trialBlocks, trialBlocks))
+            self.data.trialInBlock = np.concatenate((self.data.trialInBlock, trialInBlock))
+        self.data.blockLengths.extend(int(n) for n in blockLengths)
+        self.data.parameterNames.extend([list(self.settings.parameterNames) for _ in range(nBlocks)])
+        self.data.nBlocks += nBlocks
+        self.data.nTrials = len(self.data.trialBlocks)
+
+        # table gets rebuilt on next access
+        self._trialTable = None
+
+    def _generateBlocks(self, nBlocks, previousRow, firstBlock):
+        '''
+        Generate level indices for nBlocks blocks. Returns an (nTrials, nParameters) array
+        of indices into each parameter's validValues, and the length of each block.
+        '''
+        parameterNames = self.settings.parameterNames
+        nLevels = [len(p.settings.validValues) for p in self.settings.parameters]
+
+        # parameters crossed within each block (all but the counterbalanced one)
+        if self.settings.counterbalance:
+            counterbalanceColumn = parameterNames.index(self.settings.counterbalance)
+        else:
+            counterbalanceColumn = None
+        crossedColumns = [i for i in range(len(nLevels)) if i != counterbalanceColumn]
+        crossedLevels = [nLevels[i] for i in crossedColumns]
+        blockLength = int(np.prod(crossedLevels)) if crossedLevels else 1
+
+        # a random permutation of the cartesian product for each block, all at once
+        order = self._rng.permuted(np.tile(np.arange(blockLength), (nBlocks, 1)), axis=1).ravel()
+        levelIndices = np.zeros((nBlocks * blockLength, len(nLevels)), dtype=np.int32)
+        if crossedLevels:
+            levelIndices[:, crossedColumns] = np.column_stack(np.unravel_index(order, crossedLevels))
+
+        # counterbalanced parameter is constant within block, following a row of the Latin square
+        if counterbalanceColumn is not None:
+            square = self._williamsSquare(nLevels[counterbalanceColumn])
+            squareRow = square[self.settings.counterbalanceIndex % len(square)]
+            blockLevels = squareRow[np.arange(firstBlock, firstBlock + nBlocks) % len(squareRow)]
+            levelIndices[:, counterbalanceColumn] = np.repeat(blockLevels, blockLength)
+
+        # fix any consecutive repeats
+        if self.settings.noRepeat:
+            noRepeatColumns = [parameterNames.index(n) for n in self.settings.noRepeat]
+            self._removeRepeats(levelIndices, noRepeatColumns, blockLength, previousRow)
+
+        return (levelIndices, np.full(nBlocks, blockLength, dtype=np.int64))
+
+    def _removeRepeats(self, levelIndices, columns, blockLength, previousRow):
+        '''
+        Reorder trials within blocks (in place) so that none of the given columns
+        has the same value on consecutive trials.
+        '''
+        keys = levelIndices[:, columns]
+        nBlocks = len(keys) // blockLength
+
+        # check feasibility: a value that fills more than half a block must repeat
+        for i, column in enumerate(columns):
+            counts = np.bincount(keys[:blockLength, i])
+            if counts.max() > (blockLength + 1) // 2:
+                print(f"(pglParameterSequence) ❌ noRepeat can not be satisfied for {self.settings.parameterNames[column]}: one value makes up more than half of each block.")
+                return
+
+        # find blocks with a repeat (vectorised over the whole session)
+        repeats = np.any(keys[1:] == keys[:-1], axis=1)
+        # (repeat k is between trials k and k+1, which is on a block boundary when k+1 starts a block)
+        badBlocks = np.unique((np.flatnonzero(repeats) + 1) // blockLength)
+        if previousRow is not None:
+            if np.any(keys[0] == np.asarray(previousRow)[columns]): badBlocks = np.union1d(badBlocks, [0])
+        badBlocks = badBlocks[badBlocks < nBlocks]
+
+        # repair each of those blocks in order (so each block can see the previous block's last trial)
+        failed = 0
+        badBlocks = set(badBlocks.tolist())
+        while badBlocks:
+            blockNum = min(badBlocks)
+            badBlocks.discard(blockNum)
+            start = blockNum * blockLength
+            previousKey = keys[start-1] if start > 0 else (None if previousRow is None else np.asarray(previousRow)[columns])
+            order = self._repairBlock(keys[start:start+blockLength], previousKey)
+            if order is None:
+                failed += 1
+                continue
+            levelIndices[start:start+blockLength] = levelIndices[start:start+blockLength][order]
+            keys[start:start+blockLength] = keys[start:start+blockLength][order]
+            # reordering may have moved a repeat onto the boundary with the next block
+            end = start + blockLength
+            if end < len(keys) and np.any(keys[end] == keys[end-1]): badBlocks.add(blockNum + 1)
+        if failed:
+            print(f"(pglParameterSequence) ❌ Could not remove all repeats of {self.settings.noRepeat} in {failed} block(s)")
+
+    def _repairBlock(self, blockKeys, previousKey, maxSwaps=None):
+        '''
+        Return an ordering of the rows of blockKeys with no consecutive repeats
+        (and the first row different from previousKey), found by randomly swapping
+        a repeated trial with another trial whenever that does not add repeats.
+        Returns None if no such ordering was found.
+        '''
+        n = len(blockKeys)
+        if maxSwaps is None: maxSwaps = 100 * n + 100
+        order = np.arange(n)
+        prefix = None if previousKey is None else np.asarray(previousKey)[np.newaxis, :]
+
+        def countRepeats(order):
+            keys = blockKeys[order] if prefix is None else np.concatenate((prefix, blockKeys[order]))
+            return np.flatnonzero(np.any(keys[1:] == keys[:-1], axis=1))
+
+        repeats = countRepeats(order)
+        for _ in range(maxSwaps):
+            if len(repeats) == 0: return order
+            # position (in the block) of a trial that repeats its predecessor
+            i = repeats[self._rng.integers(len(repeats))] + (0 if prefix is not None else 1)
+            j = self._rng.integers(n)
+            order[[i, j]] = order[[j, i]]
+            newRepeats = countRepeats(order)
+            # keep the swap if it does not make things worse
+            if len(newRepeats) <= len(repeats):
+                repeats = newRepeats
+            else:
+                order[[i, j]] = order[[j, i]]
+        return order if len(repeats) == 0 else None
+
+    @staticmethod
+    def _williamsSquare(n):
+        '''
+        Balanced Latin square: each value appears once in each position and (across rows)
+        immediately follows every other value equally often. Odd n needs 2n rows.
+        '''
+        # first row is 0, 1, n-1, 2, n-2, ...
+        firstRow = [0]
+        low, high = 1, n - 1
+        for i in range(1, n):
+            if i % 2: firstRow.append(low); low += 1
+            else: firstRow.append(high); high -= 1
+        square = (np.array(firstRow)[np.newaxis, :] + np.arange(n)[:, np.newaxis]) % n
+        if n % 2: square = np.vstack((square, square[:, ::-1]))
+        return square
+
+    def _levelValues(self, levelIndices):
+        '''
+        Convert a table of level indices into one array of values per parameter.
+        '''
+        values = []
+        for column, p in enumerate(self.settings.parameters):
+            validValues = np.asarray(p.settings.validValues) if self._isSimpleValues(p.settings.validValues) else np.array(p.settings.validValues + [None], dtype=object)[:-1]
+            values.append(validValues[levelIndices[:, column]])
+        return values
+
+    @staticmethod
+    def _isSimpleValues(validValues):
+        # values that numpy can hold in a plain 1D numeric or string column
+        try:
+            array = np.asarray(validValues)
+        except ValueError:
+            return False
+        return array.ndim == 1 and array.dtype.kind in 'biufU'
+
+    def _buildTrialTable(self):
+        '''
+        Build the structured array view of the sequence from the level indices.
+        '''
+        values = self._levelValues(self.data.levelIndices) if self.data.nTrials else [np.zeros(0) for _ in self.settings.parameterNames]
+        dtype = [('trial', np.int32), ('block', np.int32), ('trialInBlock', np.int32)]
+        dtype += [(name, v.dtype) for name, v in zip(self.settings.parameterNames, values)]
+        table = np.empty(self.data.nTrials, dtype=dtype)
+        table['trial'] = np.arange(self.data.nTrials)
+        table['block'] = self.data.trialBlocks
+        table['trialInBlock'] = self.data.trialInBlock
+        for name, v in zip(self.settings.parameterNames, values):
+            table[name] = v
+        self._trialTable = table
+        # tuples of python values (not numpy scalars) for each trial
+        self._trialRows = table[self.settings.parameterNames].tolist()
+
+    def print(self):
+        '''
+        Print the details of the sequence.
+        '''
+        print(f"(pglParameterSequence) Name: {self.settings.name}")
+        print(f"Parameters: {self.settings.parameterNames}")
+        print(f"Blocks: {self.data.nBlocks} Trials: {self.data.nTrials}")
+        if self.settings.noRepeat: print(f"No repeats of: {self.settings.noRepeat}")
+        if self.settings.counterbalance: print(f"Counterbalanced across blocks: {self.settings.counterbalance} (index {self.settings.counterbalanceIndex})")
+        print(f"Random Seed: {self.settings.randomSeed}")
+
+    def load(self, parameterDir):
+        '''
+        Load, then rebuild the trial table on next access.
+        '''
+        super().load(parameterDir)
+        self._trialTable = None
+
 ##############################################
 # Settings for pglParameter
 ##############################################
@@ -526,6 +908,13 @@ class pglParameterSettingsBatch(pglParameterSettings):
 class pglParameterSettingsBlock(pglParameterSettings):
     parameters: List[pglParameter] = field(default_factory=list)
     parameterNames: List[str] = field(default_factory=list)
+
+@dataclass
+class pglParameterSettingsSequence(pglParameterSettingsBlock):
+    nBlocks: int = 1
+    noRepeat: List[str] = field(default_factory=list)
+    counterbalance: str = ""
+    counterbalanceIndex: int = 0
     
 ##############################################
 # Data for pglParameter
@@ -539,6 +928,18 @@ class pglParameterData(pglSerialize):
     
     def __repr__(self):
         return f"pglParameterData({len(self.parameterBlocks)} blocks, {sum(self.blockLengths)} total trials)"        
+
+@dataclass
+class pglParameterDataSequence(pglParameterData):
+    # whole session, as indices into each parameter's validValues (nTrials x nParameters)
+    levelIndices: np.ndarray = field(default_factory=lambda: np.zeros((0, 0), dtype=np.int32))
+    trialBlocks: np.ndarray = field(default_factory=lambda: np.zeros(0, dtype=np.int32))
+    trialInBlock: np.ndarray = field(default_factory=lambda: np.zeros(0, dtype=np.int32))
+    nBlocks: int = 0
+    nTrials: int = 0
+
+    def __repr__(self):
+        return f"pglParameterDataSequence({self.nBlocks} blocks, {self.nTrials} total trials)"
     
 ##############################################
 # State for pglParameter
@@ -130,6 +130,9 @@ class pglProfile:
         self.profileInfo['endTime'] = time.time()
         localTime = time.localtime(self.profileInfo['endTime'])
         self.profileInfo['endTimeStr'] = time.strftime("%H:%M:%S", localTime)
+        # refresh period measured from presented frames (see pglRefreshTracker)
+        if getattr(self, 'refreshTracker', None) is not None and self.refreshTracker.isReady:
+            self.profileInfo['refreshStats'] = self.refreshTracker.getStats(printSummary=False)
 
     ################################################################
     # profileModeDisplay
@@ -152,6 +155,8 @@ class pglProfile:
                     continue
                 totalTime = flushTimes[-1] - flushTimes[0]
                 expectedFrameTime = 1 / profileInfo['frameRate']*1000  # in ms
+                refreshStats = profileInfo.get('refreshStats')
+                if refreshStats is not None: expectedFrameTime = refreshStats['framePeriod']*1000
                 # get the difference in times
                 frameTimes = np.diff(flushTimes)
                 if self.verbose>1: print(frameTimes*1000)
@@ -160,6 +165,8 @@ class pglProfile:
                 medianFrameTime = np.median(frameTimes)
                 stdFrameTime = np.std(frameTimes)
                 dropCriteria = meanFrameTime + meanFrameTime/2
+                # with a measured period, drops do not raise the criteria
+                if refreshStats is not None: dropCriteria = 1.5 * refreshStats['framePeriod']
                 droppedFrames = np.sum(frameTimes > dropCriteria)
                 # add one frames worth of time to totalTime (since we calculated the difference from the end of first to last, but didnt include the first frame
                 totalTime += expectedFrameTime / 1000
@@ -167,6 +174,8 @@ class pglProfile:
                 profileText = f"{nFrames} frames, {totalTime:0.3f} secs Screen: {profileInfo['whichScreen']} ({profileInfo['screenWidth'].pix}x{profileInfo['screenHeight'].pix})"
                 timeText = f"Started: {profileInfo['startTimeStr']} Ended: {profileInfo['endTimeStr']}"
                 frameText = f"Frame Rate: {profileInfo['frameRate']} Hz Expected Frame Time: {expectedFrameTime:.2f} ms"
+                if refreshStats is not None:
+                    frameText += f" (measured {refreshStats['frameRate']:.3f} Hz{', variable refresh' if refreshStats['isVariable'] else ''})"
                 frameTimeText = f"Median frame time: {medianFrameTime*1000:.2f} ms, {meanFrameTime*1000:.2f} ± {stdFrameTime*1000:.2f} mean ± std ms"
                 droppedFramesText = f"Dropped frames (longer than {dropCriteria*1000:0.2f} ms): {droppedFrames} ({droppedFrames/nFrames*100:.2f}%)"
                 # print information
@@ -211,3 +220,169 @@ class pglProfile:
         """
         self.profileList = []
         print("(pglProfile) Cleared all profile data.")
+
+    ################################################################
+    # repeat commands
+    ################################################################
+    def repeatFlush(self, repeatCount):
+        '''
+        Have mglMetal present repeatCount frames on its own, with nothing drawn.
+
+        Returns:
+            dict: Command results with one entry per frame (e.g. drawablePresented), or None.
+        '''
+        return self._repeatCommand("mglRepeatFlush", repeatCount)
+
+    def repeatFlicker(self, repeatCount, randomSeed=0):
+        '''
+        Have mglMetal present repeatCount frames on its own, each cleared to a random color.
+
+        Returns:
+            dict: Command results with one entry per frame, or None.
+        '''
+        return self._repeatCommand("mglRepeatFlicker", repeatCount, randomSeed)
+
+    def repeatBlts(self, repeatCount):
+        '''
+        Have mglMetal present repeatCount frames on its own, each blting every texture
+        that has been created (see imageCreate).
+
+        Returns:
+            dict: Command results with one entry per frame, or None.
+        '''
+        return self._repeatCommand("mglRepeatBlts", repeatCount)
+
+    def repeatQuads(self, repeatCount, nQuads, randomSeed=0):
+        '''
+        Have mglMetal present repeatCount frames on its own, each with nQuads random quads.
+
+        Returns:
+            dict: Command results with one entry per frame, or None.
+        '''
+        return self._repeatCommand("mglRepeatQuads", repeatCount, nQuads, randomSeed)
+
+    def repeatDots(self, repeatCount, nDots, randomSeed=0):
+        '''
+        Have mglMetal present repeatCount frames on its own, each with nDots random dots.
+
+        Returns:
+            dict: Command results with one entry per frame, or None.
+        '''
+        return self._repeatCommand("mglRepeatDots", repeatCount, nDots, randomSeed)
+
+    def _repeatCommand(self, commandName, repeatCount, *values):
+        # send the command and its parameters (all uint32), then read the
+        # results of every frame the renderer presented
+        if self.isOpen() is False:
+            print(f"(pglProfile:{commandName}) ❌ No screen is open")
+            return None
+        if repeatCount < 1:
+            print(f"(pglProfile:{commandName}) ❌ repeatCount must be at least 1")
+            return None
+        try:
+            # pause interrupts, since stopping part way through the results would leave them on the socket
+            self.pauseInterrupts()
+            self.s.writeCommand(commandName)
+            ack = self.s.readAck()
+            self.s.write(np.uint32(repeatCount))
+            for value in values: self.s.write(np.uint32(value))
+            self.commandResults = self.s.readCommandResults(ack, nCommands=repeatCount)
+        finally:
+            self.restoreInterrupts()
+        if self.commandResults is None: return None
+        # keep every field one entry per frame, even for one frame
+        commandResults = {key: np.atleast_1d(value) for key, value in self.commandResults.items() if key != 'ack'}
+        commandResults['ack'] = self.commandResults['ack']
+        if not np.all(commandResults['success']):
+            print(f"(pglProfile:{commandName}) ❌ Renderer could not draw the frames (mglRepeatBlts needs a texture, see imageCreate)")
+        return commandResults
+
+    ################################################################
+    # profileRepeat
+    ################################################################
+    def profileRepeat(self, commands=("flush", "flicker", "blts", "quads", "dots"), frameCounts=(60, 300), objectCounts=(100, 1000, 10000), textureSizes=(256, 1024), randomSeed=0, printSummary=True):
+        '''
+        Run each mglRepeat* command, where the renderer makes frames on its own, and the
+        same frames driven from Python (pgl drawing commands and flush), across object
+        counts (dots and quads), texture sizes (blts) and frame counts. Comparing the two
+        separates what the renderer can do from what each frame costs the client.
+
+        Args:
+            commands: Which of "flush", "flicker", "blts", "quads" and "dots" to run.
+            frameCounts: Number of frames in each run.
+            objectCounts: Dots or quads per frame.
+            textureSizes: Width and height of the texture for blts.
+            randomSeed (int): Seed for the random stimuli (renderer and Python).
+            printSummary (bool): Print the side by side table.
+
+        Returns:
+            list of dict: One row per run with the renderer driven and Python driven results.
+        '''
+        if self.isOpen() is False:
+            print(f"(pglProfile:profileRepeat) ❌ No screen is open")
+            return None
+        framePeriod = self.getFramePeriod()
+        rng = np.random.default_rng(randomSeed)
+        rows = []
+        for command in commands:
+            if command in ("quads", "dots"): sizes = objectCounts
+            elif command == "blts": sizes = textureSizes
+            else: sizes = (0,)
+            for size in sizes:
+                # blts draw every texture there is, so make just the one
+                imageInstance = self.imageCreate(rng.random((size, size, 3))) if command == "blts" else None
+                for nFrames in frameCounts:
+                    # renderer driven
+                    if command == "flush": results = self.repeatFlush(nFrames)
+                    elif command == "flicker": results = self.repeatFlicker(nFrames, randomSeed)
+                    elif command == "blts": results = self.repeatBlts(nFrames)
+                    elif command == "quads": results = self.repeatQuads(nFrames, size, randomSeed)
+                    else: results = self.repeatDots(nFrames, size, randomSeed)
+                    if results is None: continue
+                    renderer = self._frameStats(results['drawablePresented'], framePeriod)
+                    renderer['gpuTime'] = float(np.median(results['fragmentEnd'] - results['vertexStart']))
+
+                    # python driven
+                    presentedTimes = np.zeros(nFrames)
+                    clientTimes = np.zeros(nFrames)
+                    for iFrame in range(nFrames):
+                        frameStart = time.perf_counter()
+                        self._repeatFrameFromPython(command, size, rng, imageInstance)
+                        clientTimes[iFrame] = time.perf_counter() - frameStart
+                        presentedTimes[iFrame] = self.flush() or np.nan
+                    python = self._frameStats(presentedTimes, framePeriod)
+                    python['clientTime'] = float(np.median(clientTimes))
+                    python['clientTimeMax'] = float(np.max(clientTimes))
+                    rows.append({'command': command, 'size': size, 'nFrames': nFrames, 'renderer': renderer, 'python': python})
+                if imageInstance is not None: self.imageDelete(imageInstance)
+
+        if printSummary and rows:
+            print(f"(pglProfile:profileRepeat) renderer driven (mglRepeat*) vs Python driven frames, frame period {1000*framePeriod:.2f} ms")
+            print(f"  {'command':>8} {'size':>6} {'frames':>6} | {'renderer interval ms':>20} {'dropped':>7} {'gpu ms':>7} | {'python interval ms':>18} {'dropped':>7} {'client ms':>9} {'% frame':>7}")
+            for row in rows:
+                renderer, python = row['renderer'], row['python']
+                print(f"  {row['command']:>8} {row['size']:>6} {row['nFrames']:>6} | {1000*renderer['medianInterval']:>20.3f} {renderer['nDropped']:>7d} {1000*renderer['gpuTime']:>7.3f} | "
+                      f"{1000*python['medianInterval']:>18.3f} {python['nDropped']:>7d} {1000*python['clientTime']:>9.3f} {100*python['clientTime']/framePeriod:>6.1f}%")
+        return rows
+
+    def _repeatFrameFromPython(self, command, size, rng, imageInstance):
+        # draw what the repeat command draws, with the usual pgl calls
+        if command == "flicker":
+            self.clearScreen(rng.random(3))
+        elif command == "blts":
+            self.imageDisplay(imageInstance)
+        elif command == "quads":
+            centers = rng.uniform(-1, 1, (size, 1, 2))
+            corners = np.array([[-1, -1], [1, -1], [1, 1], [-1, 1]]) * 0.02
+            self.quad((centers + corners).astype(np.float32), color=rng.random((size, 3)))
+        elif command == "dots":
+            self.dots(rng.uniform(-1, 1, size), rng.uniform(-1, 1, size), color=rng.random((size, 4)))
+
+    @staticmethod
+    def _frameStats(presentedTimes, framePeriod):
+        # frame intervals, and frames that took more than one and a half periods
+        intervals = np.diff(np.asarray(presentedTimes, dtype=float))
+        intervals = intervals[np.isfinite(intervals)]
+        if len(intervals) == 0: return {'medianInterval': np.nan, 'maxInterval': np.nan, 'nDropped': 0}
+        return {'medianInterval': float(np.median(intervals)), 'maxInterval': float(np.max(intervals)),
+                'nDropped': int(np.sum(intervals > 1.5 * framePeriod))}
@@ -0,0 +1,214 @@
+################################################################
+#   filename: pglRealtime.py
+#    purpose: Real-time scheduling, core pinning and memory
+#             locking for the threads that have deadlines: the
+#             render loop, the event listener thread and device
+#             acquisition threads (see _pglSched.h). Policies are
+#             per thread, so each thread sets its own.
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+##############
+# import
+##############
+import sys
+import threading
+import numpy as np
+from . import _pglRealtime
+from . import _pglEventListener
+
+##############
+# setThreadRealtime
+##############
+def setThreadRealtime(policy="realtime", period=None, computation=None, constraint=None, priority=0, core=None, caller="pglRealtime", verbose=1):
+    '''
+    Set the scheduling of the calling thread.
+
+    Args:
+        policy (str): "realtime" (time constraint on macOS, SCHED_FIFO on Linux), "fifo",
+            "deadline" (SCHED_DEADLINE on Linux, time constraint on macOS) or "default".
+        period (float, optional): Seconds between the thread's deadlines, e.g. the frame period.
+            Defaults to 1/60 s.
+        computation (float, optional): Seconds of cpu the thread needs each period. Defaults to a quarter period.
+        constraint (float, optional): Seconds from the start of the period by which that must be done.
+            Defaults to half a period.
+        priority (int): SCHED_FIFO priority (0 picks a default).
+        core (int, optional): Core to pin the thread to (-1 for any core). On Linux,
+            deadline threads can not be pinned.
+        caller (str): Name used in messages.
+        verbose (int): Verbosity level.
+
+    Returns:
+        bool: True if everything asked for was set.
+    '''
+    # the kernel only takes SCHED_DEADLINE for threads that may run on every core
+    if policy == "deadline" and core is not None and core >= 0 and sys.platform.startswith('linux'):
+        print(f"({caller}) ❌ SCHED_DEADLINE threads cannot be pinned to a core, set deadline scheduling without core")
+        return False
+    success = True
+    # pin (or unpin, with core -1) before setting the policy, since a SCHED_DEADLINE
+    # thread needs to be free to run on every core and can not be pinned afterwards
+    if core is not None:
+        try:
+            _pglRealtime.pinToCore(int(core))
+        except OSError as e:
+            print(f"({caller}) ❌ Could not pin thread to core {core}: {e}")
+            success = False
+    try:
+        _pglRealtime.setPolicy(policy, period or 0.0, computation or 0.0, constraint or 0.0, int(priority))
+    except (OSError, ValueError) as e:
+        print(f"({caller}) ❌ Could not set {policy} scheduling: {e}")
+        return False
+    if verbose > 1: print(f"({caller}) {threading.current_thread().name}: {_pglRealtime.getPolicy()}")
+    return success
+
+#################################################################
+# pglRealtimeThread
+#################################################################
+class pglRealtimeThread(threading.Thread):
+    '''
+    A thread that sets its own scheduling before running target, for
+    device acquisition threads.
+
+    e.g.
+    thread = pglRealtimeThread(target=readLoop, policy="fifo", core=3, daemon=True)
+    thread.start()
+    '''
+    def __init__(self, *args, policy="realtime", period=None, computation=None, constraint=None, priority=0, core=None, **kwargs):
+        super().__init__(*args, **kwargs)
+        self.schedulingArgs = dict(policy=policy, period=period, computation=computation, constraint=constraint, priority=priority, core=core)
+        self.schedulingSet = None
+
+    def run(self):
+        self.schedulingSet = setThreadRealtime(**self.schedulingArgs, caller=f"pglRealtimeThread:{self.name}")
+        super().run()
+
+#################################################################
+# pglRealtime
+#################################################################
+class pglRealtime:
+    '''
+    Real-time scheduling for pgl. setRealtime is called from the thread that
+    runs the experiment loop (it is the one that draws and flushes);
+    setEventThreadRealtime applies to the keyboard / mouse listener thread;
+    pglRealtimeThread starts acquisition threads with their own policy.
+    '''
+    ################################################################
+    # setRealtime
+    ################################################################
+    def setRealtime(self, policy="realtime", computation=None, constraint=None, priority=0, core=None, lockMemory=False):
+        '''
+        Set real-time scheduling of the calling (render) thread, with a period of one frame.
+
+        Args:
+            policy (str): "realtime", "fifo", "deadline" or "default" (see setThreadRealtime).
+            computation (float, optional): Seconds of cpu needed each frame (default a quarter frame).
+            constraint (float, optional): Seconds into the frame by which that must be done (default half a frame).
+            priority (int): SCHED_FIFO priority (0 picks a default).
+            core (int, optional): Core to pin the thread to (not with deadline on Linux).
+            lockMemory (bool): Also lock all memory of the process so the loop takes no page faults.
+
+        Returns:
+            bool: True if everything asked for was set.
+        '''
+        framePeriod = self.getFramePeriod() if hasattr(self, 'getFramePeriod') else None
+        success = setThreadRealtime(policy, framePeriod, computation, constraint, priority, core, caller="pglRealtime:setRealtime", verbose=self.verbose)
+        if lockMemory: success = self.lockMemory(True) and success
+        return success
+
+    def setRealtimeDefault(self):
+        '''
+        Put the calling thread back to the default policy on any core, and unlock memory.
+        '''
+        success = setThreadRealtime("default", core=-1, caller="pglRealtime:setRealtimeDefault", verbose=self.verbose)
+        try:
+            _pglRealtime.lockMemory(False)
+        except OSError:
+            pass
+        return success
+
+    ################################################################
+    # setEventThreadRealtime
+    ################################################################
+    def setEventThreadRealtime(self, policy="realtime", period=0.001, computation=0.0002, constraint=0.0005, priority=0, core=-1):
+        '''
+        Set the scheduling of the keyboard and mouse listener thread (_pglEventListener).
+        It is applied by that thread when it starts, or at its next event if it is
+        running; getRealtimeStatus reports whether it was.
+
+        The default time constraint asks for 0.2 ms of cpu within 0.5 ms of each millisecond,
+        so events are timestamped and queued promptly.
+        '''
+        try:
+            _pglEventListener.setThreadPolicy(policy, period, computation, constraint, int(priority), int(core))
+        except ValueError as e:
+            print(f"(pglRealtime:setEventThreadRealtime) ❌ {e}")
+            return False
+        return True
+
+    ################################################################
+    # lockMemory
+    ################################################################
+    def lockMemory(self, lock=True):
+        '''
+        Lock (or unlock) all current and future memory of the process, so that
+        deadline threads do not take page faults. Where that is not supported
+        (macOS), lock buffers with lockBuffer.
+        '''
+        try:
+            _pglRealtime.lockMemory(bool(lock))
+        except OSError as e:
+            print(f"(pglRealtime:lockMemory) ❌ {e}")
+            return False
+        return True
+
+    def lockBuffer(self, buffer, lock=True):
+        '''
+        Lock (or unlock) the memory of a buffer (e.g. a numpy array a deadline thread writes to).
+        '''
+        try:
+            _pglRealtime.lockBuffer(buffer, bool(lock))
+        except (OSError, TypeError, BufferError) as e:
+            print(f"(pglRealtime:lockBuffer) ❌ {e}")
+            return False
+        return True
+
+    ################################################################
+    # getRealtimeStatus
+    ################################################################
+    def getRealtimeStatus(self):
+        '''
+        Scheduling of the calling thread, and whether the event thread policy was applied.
+        '''
+        status = _pglRealtime.getPolicy()
+        applied, error = _pglEventListener.getThreadPolicyStatus()
+        status['eventThreadApplied'] = applied
+        status['eventThreadError'] = error
+        status['backend'] = _pglRealtime.getBackendName()
+        return status
+
+    ################################################################
+    # measureWakeupJitter
+    ################################################################
+    def measureWakeupJitter(self, interval=None, n=500, busyTime=0.0, printSummary=True):
+        '''
+        Measure how late the calling thread wakes from timed sleeps (natively,
+        with the GIL released), e.g. before and after setRealtime.
+
+        Args:
+            interval (float, optional): Seconds between wakes (default one frame).
+            n (int): Number of wakes.
+            busyTime (float): Seconds of work after each wake.
+
+        Returns:
+            np.ndarray: How late (seconds) each wake was.
+        '''
+        if interval is None: interval = self.getFramePeriod() if hasattr(self, 'getFramePeriod') else 1 / 60
+        lateness = np.array(_pglRealtime.measureWakeups(interval, int(n), busyTime))
+        if printSummary:
+            policy = _pglRealtime.getPolicy()['policy']
+            print(f"(pglRealtime:measureWakeupJitter) {policy}: lateness median {1e6*np.median(lateness):.1f} us, "
+                  f"99th {1e6*np.percentile(lateness, 99):.1f} us, max {1e6*lateness.max():.1f} us, "
+                  f"{np.sum(lateness > 0.001)} of {len(lateness)} over 1 ms")
+        return lateness
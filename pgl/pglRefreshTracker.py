@@ -0,0 +1,219 @@
+################################################################
+#   filename: pglRefreshTracker.py
+#    purpose: Measures the actual refresh period and vsync phase
+#             of a display from the times frames were presented
+#             (drawablePresented), since the nominal mode refresh
+#             rate is an integer (59.94 Hz reports as 59) and means
+#             little on variable refresh (ProMotion / VRR) displays.
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import numpy as np
+from collections import deque
+from dataclasses import dataclass
+from .pglSerialize import pglSerialize
+
+#################################################################
+# pglRefreshTracker
+#################################################################
+class pglRefreshTracker:
+    '''
+    Fits presented times to vsyncs at phase + n * period. Each interval
+    between presented frames is counted as a whole number of refreshes
+    (so dropped frames do not bias the period), the line is fit by least
+    squares over the most recent frames, and frames that are far off the
+    line (e.g. a late timestamp) are rejected and the fit redone. Fitting
+    over a sliding window follows slow drift of the display clock.
+
+    If the intervals are not whole multiples of one period, the display is
+    taken to be variable refresh (isVariable): framePeriod is then the
+    median interval and nextVsync predicts one period after the last frame.
+
+    e.g.
+    tracker = pglRefreshTracker(nominalFrameRate=60)
+    ... after each flush: tracker.update(presentedTime)
+    tracker.framePeriod, tracker.nextVsync(pgl.getSecs())
+    '''
+    # refits whose drift is kept (a list, rather than a deque, so that the data saves as JSON)
+    maxDriftHistory = 1024
+
+    def __init__(self, nominalFrameRate=None, windowSize=240, minSamples=16, refitInterval=8, outlierThreshold=0.0005, verbose=0):
+        '''
+        Args:
+            nominalFrameRate (float, optional): Reported refresh rate, used until enough frames have been seen.
+            windowSize (int): Number of recent frames to fit.
+            minSamples (int): Frames needed before the fit is used.
+            refitInterval (int): Refit every this many frames.
+            outlierThreshold (float): Frames further than this (seconds) from the fit are rejected.
+            verbose (int): Verbosity level.
+        '''
+        self.nominalFrameRate = nominalFrameRate
+        self.windowSize = windowSize
+        self.minSamples = minSamples
+        self.refitInterval = refitInterval
+        self.outlierThreshold = outlierThreshold
+        self.verbose = verbose
+        self.presentedTimes = deque(maxlen=windowSize)
+        self.reset()
+
+    def reset(self):
+        '''
+        Forget all frames (e.g. after the display mode changes).
+        '''
+        self.presentedTimes.clear()
+        self._nSinceFit = 0
+        self.data = pglRefreshTrackerData()
+        if self.nominalFrameRate: self.data.framePeriod = 1.0 / self.nominalFrameRate
+
+    def __repr__(self):
+        kind = "variable" if self.data.isVariable else "fixed"
+        return f"pglRefreshTracker({self.frameRate:.4f} Hz {kind}, {self.data.nSamples} frames, residual {1e6*self.data.residualStd:.1f} us)"
+
+    ################################################################
+    # properties
+    ################################################################
+    @property
+    def framePeriod(self):
+        # measured frame period in seconds (nominal until measured)
+        return self.data.framePeriod
+
+    @property
+    def frameRate(self):
+        return 1.0 / self.data.framePeriod if self.data.framePeriod else 0.0
+
+    @property
+    def isReady(self):
+        # whether the period and phase are measured rather than nominal
+        return self.data.nSamples >= self.minSamples
+
+    ################################################################
+    # update
+    ################################################################
+    def update(self, presentedTime):
+        '''
+        Add the presented time of a frame (0 or None, i.e. not presented, is ignored).
+        '''
+        if not presentedTime or presentedTime <= 0: return
+        if self.presentedTimes and presentedTime <= self.presentedTimes[-1]: return
+        self.presentedTimes.append(float(presentedTime))
+        self._nSinceFit += 1
+        if len(self.presentedTimes) >= self.minSamples and (self._nSinceFit >= self.refitInterval or not self.isReady):
+            self.fit()
+
+    ################################################################
+    # fit
+    ################################################################
+    def fit(self):
+        '''
+        Fit period and phase to the frames in the window.
+        '''
+        self._nSinceFit = 0
+        t = np.array(self.presentedTimes)
+        intervals = np.diff(t)
+        if len(intervals) == 0: return
+
+        # starting period: the current estimate, or the smallest common interval
+        period = self.data.framePeriod if self.data.framePeriod else np.percentile(intervals, 10)
+        # refine from intervals that are one refresh long, so a wrong nominal rate does not stick
+        single = intervals[np.abs(intervals / period - 1) < 0.25]
+        if len(single) >= self.minSamples // 2: period = np.median(single)
+
+        # number of refreshes between frames, then vsync index of each frame
+        keep = np.ones(len(t), dtype=bool)
+        for iteration in range(3):
+            counts = np.maximum(np.round(intervals / period), 1)
+            n = np.concatenate([[0], np.cumsum(counts)])
+            # least squares t = phase + n * period over the frames we keep
+            A = np.column_stack([np.ones(np.count_nonzero(keep)), n[keep]])
+            (phase, period), *_ = np.linalg.lstsq(A, t[keep], rcond=None)
+            residuals = t - (phase + n * period)
+            newKeep = np.abs(residuals) < max(self.outlierThreshold, 4 * np.std(residuals[keep]) if np.count_nonzero(keep) > 2 else np.inf)
+            if np.count_nonzero(newKeep) < self.minSamples or np.array_equal(newKeep, keep): break
+            keep = newKeep
+
+        residualStd = float(np.std(residuals[keep]))
+        # fractional refresh counts mean there is no fixed period
+        fractional = np.abs(intervals / period - np.round(intervals / period))
+        isVariable = bool(np.median(fractional) > 0.15)
+
+        previousPeriod = self.data.framePeriod
+        self.data.isVariable = isVariable
+        self.data.nSamples = len(t)
+        self.data.nRejected = int(len(t) - np.count_nonzero(keep))
+        self.data.nDropped = int(np.sum(counts - 1))
+        if isVariable:
+            self.data.framePeriod = float(np.median(intervals))
+            self.data.phase = float(t[-1])
+            self.data.residualStd = float(np.std(intervals))
+        else:
+            self.data.framePeriod = float(period)
+            self.data.phase = float(phase)
+            self.data.residualStd = residualStd
+        if previousPeriod:
+            self.data.drift.append(self.data.framePeriod - previousPeriod)
+            if len(self.data.drift) > self.maxDriftHistory: del self.data.drift[:-self.maxDriftHistory]
+        if self.verbose > 1: print(f"(pglRefreshTracker:fit) {self}")
+
+    ################################################################
+    # nextVsync
+    ################################################################
+    def nextVsync(self, t):
+        '''
+        Predicted time of the first vsync at or after t.
+        '''
+        period = self.data.framePeriod
+        if not period: return t
+        if self.data.isVariable or not self.isReady:
+            # nothing to lock to, one period after the last frame
+            last = self.presentedTimes[-1] if self.presentedTimes else t
+            return max(t, last + period)
+        k = np.ceil((t - self.data.phase) / period)
+        return float(self.data.phase + k * period)
+
+    def vsyncIndex(self, t):
+        '''
+        Number of refreshes (fractional) from the fitted phase to t.
+        '''
+        if not self.data.framePeriod: return 0.0
+        return (t - self.data.phase) / self.data.framePeriod
+
+    ################################################################
+    # getStats
+    ################################################################
+    def getStats(self, printSummary=True):
+        '''
+        Measured frame rate, how well frames fit it, and drift of the period between fits.
+        '''
+        drift = np.array(self.data.drift)
+        stats = {'frameRate': self.frameRate, 'framePeriod': self.data.framePeriod, 'phase': self.data.phase,
+                 'isVariable': self.data.isVariable, 'nSamples': self.data.nSamples, 'nRejected': self.data.nRejected,
+                 'nDropped': self.data.nDropped, 'residualStd': self.data.residualStd,
+                 'maxDrift': float(np.max(np.abs(drift))) if len(drift) else 0.0}
+        if printSummary:
+            kind = "variable refresh" if stats['isVariable'] else "fixed refresh"
+            print(f"(pglRefreshTracker:getStats) {stats['frameRate']:.4f} Hz ({1000*stats['framePeriod']:.4f} ms, {kind}) from {stats['nSamples']} frames, "
+                  f"{stats['nRejected']} rejected, {stats['nDropped']} dropped, residual {1e6*stats['residualStd']:.1f} us")
+        return stats
+
+##############################################
+# Data for pglRefreshTracker
+##############################################
+@dataclass
+class pglRefreshTrackerData(pglSerialize):
+    framePeriod: float = 0.0
+    # time of a vsync (vsyncs are at phase + k * framePeriod)
+    phase: float = 0.0
+    isVariable: bool = False
+    nSamples: int = 0
+    nRejected: int = 0
+    nDropped: int = 0
+    residualStd: float = 0.0
+    # change in period at each of the last maxDriftHistory refits
+    drift: list = None
+
+    def __post_init__(self):
+        if self.drift is None: self.drift = []
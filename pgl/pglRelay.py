@@ -0,0 +1,207 @@
+################################################################
+#   filename: pglRelay.py
+#    purpose: Runs on the stimulus machine and passes a tcp
+#             connection through to mglMetal's unix socket, so
+#             that experiment logic, device polling and analysis
+#             can run on a separate control machine
+#             (pgl.open(remoteAddress="tcp://host:port")). Answers
+#             the clock offset handshake that the client does when
+#             it connects. Run on the stimulus machine with e.g.
+#             python -m pgl.pglRelay --host 192.168.1.10 --port 7770 --launch
+#             (it listens on loopback only unless given --host)
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import os
+import sys
+import time
+import struct
+import random
+import string
+import argparse
+import threading
+import subprocess
+from datetime import datetime
+from socket import socket, AF_UNIX, AF_INET, SOCK_STREAM, IPPROTO_TCP, TCP_NODELAY, SOL_SOCKET, SO_REUSEADDR, SHUT_RDWR
+from . import _pglTimestamp
+from ._pglComm import clockSyncMagic
+
+#################################################################
+# pglRelay
+#################################################################
+class pglRelay:
+    '''
+    Passes one tcp client at a time through to an mglMetal unix socket.
+    Each client starts with the clock offset handshake (see
+    _pglComm.syncClock), after which bytes are copied both ways as is.
+    There is no authentication: whoever can reach the port can draw, so
+    it listens on loopback unless another host address is given.
+
+    e.g.
+    relay = pglRelay(socketName, port=7770).start()
+    ...
+    relay.stop()
+    '''
+    def __init__(self, socketName, port=7770, host="127.0.0.1", verbose=1):
+        '''
+        Args:
+            socketName (str): Path of the mglMetal (or pglStandInServer) socket.
+            port (int): tcp port to listen on (0 picks a free one, see self.port).
+            host (str): Address to listen on, loopback by default. Give the address of the
+                interface the control machine connects on (or 0.0.0.0 for all of them) to
+                reach it from another machine.
+            verbose (int): Verbosity level.
+        '''
+        self.socketName = socketName
+        self.host = host
+        self.port = port
+        self.verbose = verbose
+        self.nClients = 0
+        self._listener = None
+        self._thread = None
+        self._running = False
+
+    def start(self):
+        '''
+        Start listening (returns once the port is open).
+        '''
+        self._listener = socket(AF_INET, SOCK_STREAM)
+        self._listener.setsockopt(SOL_SOCKET, SO_REUSEADDR, 1)
+        self._listener.bind((self.host, self.port))
+        self._listener.listen(1)
+        self.port = self._listener.getsockname()[1]
+        self._running = True
+        self._thread = threading.Thread(target=self._serve, name=f"pglRelay:{self.port}", daemon=True)
+        self._thread.start()
+        if self.verbose > 0: print(f"(pglRelay:start) Relaying tcp port {self.port} on {self.host} to {self.socketName}")
+        if self.host not in ("127.0.0.1", "localhost", "::1"):
+            print(f"(pglRelay:start) ⚠️ Listening on {self.host}: anyone who can reach port {self.port} can send commands to mglMetal")
+        return self
+
+    def stop(self):
+        '''
+        Stop listening.
+        '''
+        self._running = False
+        if self._listener is not None:
+            try:
+                self._listener.close()
+            except OSError:
+                pass
+            self._listener = None
+        if self._thread is not None:
+            self._thread.join(timeout=2)
+            self._thread = None
+
+    def _serve(self):
+        # one client at a time, as with mglMetal
+        while self._running:
+            try:
+                client, address = self._listener.accept()
+            except OSError:
+                return
+            client.setsockopt(IPPROTO_TCP, TCP_NODELAY, 1)
+            self.nClients += 1
+            if self.verbose > 0: print(f"(pglRelay) Client connected from {address[0]}")
+            try:
+                self._handleClient(client)
+            except (ConnectionError, OSError) as e:
+                if self.verbose > 0: print(f"(pglRelay) Client disconnected: {e}")
+            finally:
+                client.close()
+
+    def _handleClient(self, client):
+        # clock offset handshake
+        header = self._recv(client, len(clockSyncMagic) + 4)
+        if header is None: return
+        if header[:len(clockSyncMagic)] != clockSyncMagic:
+            print(f"(pglRelay:_handleClient) ❌ Client did not start with the clock handshake, closing connection")
+            return
+        nProbes = struct.unpack('@I', header[len(clockSyncMagic):])[0]
+        for iProbe in range(nProbes):
+            if self._recv(client, 8) is None: return
+            client.sendall(struct.pack('@d', _pglTimestamp.getSecs()))
+
+        # then pass everything through
+        metal = socket(AF_UNIX, SOCK_STREAM)
+        metal.connect(self.socketName)
+        toClient = threading.Thread(target=self._copy, args=(metal, client), daemon=True)
+        toClient.start()
+        self._copy(client, metal)
+        toClient.join(timeout=2)
+        metal.close()
+
+    def _copy(self, source, destination):
+        # copy until either side closes, then close both so the other copy ends too
+        try:
+            while True:
+                data = source.recv(65536)
+                if not data: break
+                destination.sendall(data)
+        except OSError:
+            pass
+        for sock in (source, destination):
+            try:
+                sock.shutdown(SHUT_RDWR)
+            except OSError:
+                pass
+
+    def _recv(self, connection, numBytes):
+        data = bytearray()
+        while len(data) < numBytes:
+            chunk = connection.recv(numBytes - len(data))
+            if not chunk: return None
+            data.extend(chunk)
+        return bytes(data)
+
+#################################################################
+# launchMetal
+#################################################################
+def launchMetal(mglMetalPath, socketPath):
+    '''
+    Start mglMetal listening on a new socket in socketPath (as pglBase.open does).
+
+    Returns:
+        str: The socket name, or None if mglMetal could not be started.
+    '''
+    timestamp = datetime.now().strftime("%Y%m%d_%H%M%S")
+    randomString = ''.join(random.choices(string.ascii_letters + string.digits, k=10))
+    socketName = os.path.join(socketPath, f"pglMetal.socket.{timestamp}.{randomString}")
+    try:
+        subprocess.run(["open", "-g", "-n", mglMetalPath, "--args", "-mglConnectionAddress", socketName], check=True)
+    except Exception as e:
+        print(f"(pglRelay:launchMetal) ❌ Error starting mglMetal application: {e}")
+        return None
+    # wait for the socket
+    startTime = time.time()
+    while not os.path.exists(socketName):
+        if time.time() - startTime > 10:
+            print(f"(pglRelay:launchMetal) ❌ mglMetal did not open {socketName}")
+            return None
+        time.sleep(0.1)
+    return socketName
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Relay a tcp port to mglMetal for pgl running on another machine")
+    parser.add_argument("--port", type=int, default=7770, help="tcp port to listen on")
+    parser.add_argument("--host", default="127.0.0.1", help="address to listen on (loopback by default, the control machine needs e.g. the stimulus machine's LAN address)")
+    parser.add_argument("--socket", default=None, help="socket of an mglMetal that is already running")
+    parser.add_argument("--launch", action="store_true", help="start mglMetal")
+    parser.add_argument("--mglMetalPath", default=os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), "metal", "mglMetal.app"))
+    args = parser.parse_args()
+
+    socketName = args.socket
+    if args.launch:
+        socketName = launchMetal(args.mglMetalPath, os.path.expanduser("~/Library/Containers/gru.mglMetal/Data"))
+    if socketName is None:
+        print("(pglRelay) ❌ Give either --socket or --launch")
+        sys.exit(1)
+    relay = pglRelay(socketName, port=args.port, host=args.host).start()
+    try:
+        while True: time.sleep(1)
+    except KeyboardInterrupt:
+        relay.stop()
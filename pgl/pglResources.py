@@ -0,0 +1,348 @@
+################################################################
+#   filename: pglResources.py
+#    purpose: Registry of what a display holds on the renderer:
+#             textures (and the text images and render targets
+#             made from them), stencils and movies, with their
+#             size, format, where they were made and when they
+#             were last used, and the bytes uploaded each frame.
+#             Each display has one (pgl.resources) that pglImage,
+#             pglDraw, pglFrameGrab and pglStimulusMovie keep up
+#             to date; snapshot and check are for looking at it
+#             during and after long sessions.
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import os
+import sys
+import time
+import numpy as np
+from collections import Counter
+from dataclasses import dataclass, asdict
+
+# textures are sent and kept as RGBA 32 bit floats
+textureFormat = "RGBA32Float"
+textureBytesPerPixel = 16
+# kinds of resource; textures, text and render targets share texture numbers
+resourceKinds = ("texture", "text", "renderTarget", "stencil", "movie")
+resourceSpaces = {"texture": "texture", "text": "texture", "renderTarget": "texture", "stencil": "stencil", "movie": "movie"}
+# files of pgl itself are skipped when finding where a resource was made
+pglDir = os.path.dirname(os.path.abspath(__file__))
+
+#################################################################
+# pglResourceRecord
+#################################################################
+@dataclass
+class pglResourceRecord:
+    '''
+    One resource on the renderer.
+    '''
+    kind: str
+    resourceNum: int
+    width: int = 0
+    height: int = 0
+    format: str = ""
+    nBytes: int = 0
+    label: str = ""
+    # file:line (function) of the code outside pgl that made it
+    site: str = ""
+    createdTime: float = 0.0
+    createdFrame: int = 0
+    lastUsedFrame: int = 0
+    nUses: int = 0
+    nUploads: int = 0
+    uploadBytes: int = 0
+
+#################################################################
+# pglResourceRegistry
+#################################################################
+class pglResourceRegistry:
+    '''
+    What a display holds on the renderer, and what it uploads each frame.
+
+    e.g.
+    before = pgl.resources.snapshot()
+    ... run ...
+    pgl.resources.check(since=before)
+    pgl.resources.print()
+    '''
+    # frames of upload counts kept for rates
+    nFramesWindow = 600
+    # warn when one site has this many resources alive (and at each doubling)
+    siteWarning = 32
+    # check: resources not used for this many seconds are reported
+    idleWarningSecs = 60.0
+
+    def __init__(self, pgl=None):
+        self.pgl = pgl
+        self.records = {}
+        self.siteCounts = Counter()
+        self._siteWarned = {}
+        self.nFrames = 0
+        self.nCreated = 0
+        self.nReleased = 0
+        self.uploadBytes = 0
+        self.downloadBytes = 0
+        self.frameUploadBytes = 0
+        self._frameUploads = np.zeros(self.nFramesWindow, dtype=np.int64)
+        self._frameTimes = np.zeros(self.nFramesWindow)
+        self.startTime = time.perf_counter()
+
+    ################################################################
+    # created
+    ################################################################
+    def created(self, kind, resourceNum, width=0, height=0, format=textureFormat, nBytes=None, label="", uploadBytes=None):
+        '''
+        Register a resource that was made on the renderer.
+
+        Args:
+            kind (str): One of resourceKinds.
+            resourceNum (int): Number the renderer gave it (imageNum, movieNum ...).
+            width, height (int): Size in pixels.
+            format (str): Pixel format.
+            nBytes (int, optional): Bytes it holds (defaults to width x height RGBA floats).
+            label (str): What it is, for reports.
+            uploadBytes (int, optional): Bytes sent to make it (defaults to nBytes).
+
+        Returns:
+            pglResourceRecord
+        '''
+        if nBytes is None: nBytes = int(width) * int(height) * textureBytesPerPixel
+        if uploadBytes is None: uploadBytes = nBytes
+        key = (resourceSpaces.get(kind, kind), int(resourceNum))
+        # a number the renderer gave out again means the old one is gone
+        if key in self.records: self._remove(key)
+        record = pglResourceRecord(kind=kind, resourceNum=int(resourceNum), width=int(width), height=int(height), format=format,
+                                   nBytes=int(nBytes), label=label, site=self._site(), createdTime=time.perf_counter() - self.startTime,
+                                   createdFrame=self.nFrames, lastUsedFrame=self.nFrames, nUploads=1 if uploadBytes else 0, uploadBytes=int(uploadBytes))
+        self.records[key] = record
+        self.nCreated += 1
+        self.upload(uploadBytes)
+        self.siteCounts[record.site] += 1
+        self._checkSite(record)
+        return record
+
+    def released(self, kind, resourceNum):
+        '''
+        A resource was deleted on the renderer. Returns False if it was not registered
+        (e.g. already deleted).
+        '''
+        key = (resourceSpaces.get(kind, kind), int(resourceNum))
+        if key not in self.records: return False
+        self._remove(key)
+        self.nReleased += 1
+        return True
+
+    def closed(self):
+        '''
+        The renderer was closed, so everything on it is gone: count it all as
+        released (totals and upload counters are kept for reports).
+        '''
+        self.nReleased += len(self.records)
+        self.records.clear()
+        self.siteCounts.clear()
+        self._siteWarned.clear()
+
+    def _remove(self, key):
+        record = self.records.pop(key)
+        self.siteCounts[record.site] -= 1
+        if self.siteCounts[record.site] <= 0: del self.siteCounts[record.site]
+
+    def retag(self, kind, resourceNum, newKind=None, label=None):
+        '''
+        Change what a registered resource is (e.g. a texture made into a render target) or its label.
+        '''
+        record = self.records.get((resourceSpaces.get(kind, kind), int(resourceNum)))
+        if record is None: return None
+        if newKind is not None: record.kind = newKind
+        if label is not None: record.label = label
+        return record
+
+    ################################################################
+    # used / upload (called every frame, so kept cheap)
+    ################################################################
+    def used(self, kind, resourceNum):
+        record = self.records.get((resourceSpaces[kind], int(resourceNum)))
+        if record is not None:
+            record.lastUsedFrame = self.nFrames
+            record.nUses += 1
+
+    def updated(self, kind, resourceNum, nBytes, width=None, height=None):
+        '''
+        New contents were sent to a resource (e.g. imageUpdate).
+        '''
+        record = self.records.get((resourceSpaces[kind], int(resourceNum)))
+        if record is not None:
+            record.nUploads += 1
+            record.uploadBytes += nBytes
+            record.lastUsedFrame = self.nFrames
+            if width is not None and (width != record.width or height != record.height):
+                record.width, record.height = int(width), int(height)
+                record.nBytes = record.width * record.height * textureBytesPerPixel
+        self.upload(nBytes)
+
+    def upload(self, nBytes):
+        self.frameUploadBytes += nBytes
+        self.uploadBytes += nBytes
+
+    def download(self, nBytes):
+        self.downloadBytes += nBytes
+
+    def frameEnd(self):
+        '''
+        Called at each flush: closes the frame's upload count.
+        '''
+        index = self.nFrames % self.nFramesWindow
+        self._frameUploads[index] = self.frameUploadBytes
+        self._frameTimes[index] = time.perf_counter()
+        self.frameUploadBytes = 0
+        self.nFrames += 1
+
+    ################################################################
+    # snapshot
+    ################################################################
+    def snapshot(self, withRecords=True):
+        '''
+        What is held on the renderer now, and upload rates over the last nFramesWindow frames.
+
+        Returns:
+            dict: nResources and bytesResident by kind, totals, upload counters and
+            (withRecords) a dict for each resource.
+        '''
+        nResources, bytesResident = Counter(), Counter()
+        for record in self.records.values():
+            nResources[record.kind] += 1
+            bytesResident[record.kind] += record.nBytes
+        nWindow = min(self.nFrames, self.nFramesWindow)
+        uploads = self._frameUploads[:nWindow] if self.nFrames <= self.nFramesWindow else self._frameUploads
+        times = self._frameTimes[:nWindow]
+        duration = (times.max() - times.min()) if nWindow > 1 else 0.0
+        snapshot = {
+            "time": time.perf_counter() - self.startTime,
+            "nFrames": self.nFrames,
+            "nResources": dict(nResources),
+            "bytesResident": dict(bytesResident),
+            "totalResources": len(self.records),
+            "totalBytesResident": sum(bytesResident.values()),
+            "nCreated": self.nCreated,
+            "nReleased": self.nReleased,
+            "uploadBytes": self.uploadBytes,
+            "downloadBytes": self.downloadBytes,
+            "uploadBytesLastFrame": int(self._frameUploads[(self.nFrames - 1) % self.nFramesWindow]) if self.nFrames else 0,
+            "uploadBytesPerFrame": float(uploads.mean()) if nWindow else 0.0,
+            "uploadBytesPerFrameMax": int(uploads.max()) if nWindow else 0,
+            # bytes of the frames after the first in the window over the time they span
+            "uploadBytesPerSec": float((uploads.sum() - uploads[np.argmin(times)]) / duration) if duration > 0 else 0.0,
+        }
+        if withRecords: snapshot["resources"] = [asdict(record) for record in self.records.values()]
+        return snapshot
+
+    ################################################################
+    # check
+    ################################################################
+    def check(self, since=None, idleSecs=None, printWarnings=True):
+        '''
+        Look for resources that look leaked: ones that have not been used for
+        idleSecs, sites that have made many that are still alive, and growth since
+        an earlier snapshot.
+
+        Args:
+            since (dict, optional): Earlier snapshot to compare with.
+            idleSecs (float, optional): Seconds without use to report (default idleWarningSecs).
+            printWarnings (bool): Print what is found.
+
+        Returns:
+            list of str: Warnings.
+        '''
+        if idleSecs is None: idleSecs = self.idleWarningSecs
+        warnings = []
+        # idle, in frames at the measured frame period
+        framePeriod = self._framePeriod()
+        if framePeriod > 0:
+            idleFrames = idleSecs / framePeriod
+            idle = [r for r in self.records.values() if self.nFrames - r.lastUsedFrame > idleFrames]
+            if idle:
+                nBytes = sum(r.nBytes for r in idle)
+                sites = Counter(r.site for r in idle).most_common(3)
+                warnings.append(f"{len(idle)} resource(s) ({formatBytes(nBytes)}) not used for more than {idleSecs:g} s, made at: " +
+                                ", ".join(f"{site} ({n})" for site, n in sites))
+        # sites with many alive
+        for site, n in self.siteCounts.most_common():
+            if n < self.siteWarning: break
+            warnings.append(f"{n} resources alive that were made at {site}")
+        # growth
+        if since is not None:
+            now = self.snapshot(withRecords=False)
+            nGrowth = now["totalResources"] - since["totalResources"]
+            bytesGrowth = now["totalBytesResident"] - since["totalBytesResident"]
+            if nGrowth > 0 or bytesGrowth > 0:
+                nFrames = now["nFrames"] - since["nFrames"]
+                warnings.append(f"{nGrowth:+d} resources ({formatBytes(bytesGrowth, sign=True)}) over {nFrames} frames "
+                                f"({now['nCreated'] - since['nCreated']} made, {now['nReleased'] - since['nReleased']} deleted)")
+        if printWarnings:
+            for warning in warnings: print(f"(pglResources:check) ⚠️ {warning}")
+        return warnings
+
+    ################################################################
+    # print
+    ################################################################
+    def print(self, nSites=10):
+        '''
+        Print what is held by kind and by where it was made, and the upload rates.
+        '''
+        snapshot = self.snapshot(withRecords=False)
+        print(f"(pglResources) {snapshot['totalResources']} resources, {formatBytes(snapshot['totalBytesResident'])} resident after {snapshot['nFrames']} frames "
+              f"({snapshot['nCreated']} made, {snapshot['nReleased']} deleted)")
+        for kind in resourceKinds:
+            if kind in snapshot["nResources"]:
+                print(f"  {kind:<12} {snapshot['nResources'][kind]:6d} {formatBytes(snapshot['bytesResident'][kind]):>10}")
+        print(f"  uploads: {formatBytes(snapshot['uploadBytes'])} total, {formatBytes(snapshot['uploadBytesPerFrame'])}/frame "
+              f"(max {formatBytes(snapshot['uploadBytesPerFrameMax'])}), {formatBytes(snapshot['uploadBytesPerSec'])}/s; "
+              f"downloads: {formatBytes(snapshot['downloadBytes'])}")
+        bySite = {}
+        for record in self.records.values():
+            n, nBytes = bySite.get(record.site, (0, 0))
+            bySite[record.site] = (n + 1, nBytes + record.nBytes)
+        for site, (n, nBytes) in sorted(bySite.items(), key=lambda item: -item[1][1])[:nSites]:
+            print(f"  {n:6d} {formatBytes(nBytes):>10}  {site}")
+
+    ################################################################
+    # helpers
+    ################################################################
+    def _site(self):
+        # first frame outside pgl
+        frame = sys._getframe(2)
+        while frame is not None and os.path.dirname(os.path.abspath(frame.f_code.co_filename)) == pglDir:
+            frame = frame.f_back
+        if frame is None: return "pgl"
+        return f"{os.path.basename(frame.f_code.co_filename)}:{frame.f_lineno} ({frame.f_code.co_name})"
+
+    def _checkSite(self, record):
+        # warn as one site keeps making resources that stay alive
+        n = self.siteCounts[record.site]
+        if n >= self.siteWarning and n >= 2 * self._siteWarned.get(record.site, self.siteWarning // 2):
+            self._siteWarned[record.site] = n
+            warning = getattr(self.pgl, 'oneTimeWarning', None) or print
+            warning(f"(pglResources) ⚠️ {n} resources made at {record.site} are alive (the last a {record.width}x{record.height} {record.kind}). "
+                    f"Delete ones that are no longer needed (imageDelete, delete)")
+
+    def _framePeriod(self):
+        nWindow = min(self.nFrames, self.nFramesWindow)
+        if nWindow < 2: return 0.0
+        times = self._frameTimes[:nWindow]
+        return (times.max() - times.min()) / (nWindow - 1)
+
+#############
+# formatBytes
+#############
+def formatBytes(nBytes, sign=False):
+    '''
+    Bytes as B, KB, MB or GB.
+    '''
+    if abs(nBytes) < 1024: return f"{nBytes:+.0f} B" if sign else f"{nBytes:.0f} B"
+    for unit in ("KB", "MB", "GB"):
+        nBytes /= 1024
+        if abs(nBytes) < 1024 or unit == "GB": return f"{nBytes:+.1f} {unit}" if sign else f"{nBytes:.1f} {unit}"
@@ -0,0 +1,530 @@
+################################################################
+#   filename: pglSimulation.py
+#    purpose: Running experiments in simulated time. pglVirtualClock
+#             stands in for getSecs, pglSimulatedDisplay (mixed in
+#             ahead of pgl as pglSimulated) draws to a
+#             pglStandInServer that presents frames on that clock,
+#             pglSimulatedKeyboard types keys at scheduled times, and
+#             pglExperimentSimulator runs a pglExperiment with volume
+#             triggers on schedule and subject responses from a
+#             pglObserverModel or a script. A frame takes as long as
+#             the computer takes to make it rather than a refresh, so
+#             an hour long protocol runs in the time its task code
+#             takes, and saves the same pglExperimentData as a real run.
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import heapq
+import itertools
+import random
+import threading
+import time
+import numpy as np
+from . import _pglComm as pglComm
+from . import _pglEventListener
+from ._pglStandIn import pglStandInServer, commandTypesFilename
+from .pglDevice import pglDevice
+from .pglKeyboardMouse import pglKeyboardMouse, pglEventKeyboard
+from .pglRefreshTracker import pglRefreshTracker
+
+#################################################################
+# pglVirtualClock
+#################################################################
+class pglVirtualClock:
+    '''
+    Simulated time. It stands still until it is moved on, by waitSecs or by
+    a pglStandInServer waiting for the vsync a frame is presented on.
+    '''
+    def __init__(self, startTime=0.0):
+        self.now = float(startTime)
+        self._lock = threading.Lock()
+
+    def getSecs(self):
+        return self.now
+
+    def waitSecs(self, secs):
+        self.advanceTo(self.now + secs)
+
+    def advanceTo(self, t):
+        '''
+        Move the clock on to t (it never goes back).
+        '''
+        with self._lock:
+            if t > self.now: self.now = float(t)
+
+#################################################################
+# pglSimulatedKeyboard
+#################################################################
+class pglSimulatedKeyboard(pglKeyboardMouse):
+    '''
+    Keyboard whose keys are pressed by schedule (press) rather than by hand.
+    poll returns the events that are due on the clock, made and stamped the
+    way pglKeyboardMouse makes them (with onsetLatency and onsetId from the
+    onsets marked with pgl.markOnset), so the experiment can not tell them apart.
+    '''
+    def __init__(self, clock, pgl=None, holdTime=0.05):
+        '''
+        Args:
+            clock (pglVirtualClock): Clock the key presses are scheduled on.
+            pgl (optional): The display the keyboard belongs to.
+            holdTime (float): Time from keydown to keyup.
+        '''
+        # no event listener to start
+        pglDevice.__init__(self, deviceType="pglKeyboard")
+        self.clock = clock
+        self.pgl = pgl
+        self.holdTime = holdTime
+        self.eatKeyCodes = []
+        self.running = True
+        # heap of (time, order, keyCode, eventType) not yet due
+        self.pending = []
+        self._order = itertools.count()
+        # called with the time at each poll, before taking the events that are due
+        self.pollCallbacks = []
+
+    def __del__(self):
+        pass
+
+    def start(self, eatKeys=None):
+        self.running = True
+
+    def stop(self):
+        self.running = False
+
+    def isRunning(self):
+        return self.running
+
+    def clear(self):
+        '''
+        Drop the events that are already due (as pglKeyboardMouse drops what is queued).
+        '''
+        now = self.clock.getSecs()
+        while self.pending and self.pending[0][0] <= now: heapq.heappop(self.pending)
+
+    def setEatKeys(self, keyCodes=None, keyChars=None):
+        self.eatKeyCodes = list(keyCodes or []) + [self.charToKeyCode(c) for c in (keyChars or [])]
+
+    def press(self, key, when=None, holdTime=None):
+        '''
+        Schedule a key press: a keydown at when and a keyup holdTime later.
+
+        Args:
+            key (str or int): Key (e.g. "1", "space", "`", as for charToKeyCode) or key code.
+            when (float, optional): Time on the clock, defaults to now.
+            holdTime (float, optional): Time the key is held, defaults to self.holdTime.
+        '''
+        keyCode = int(key) if isinstance(key, (int, np.integer)) else self.charToKeyCode(key)
+        if keyCode is None:
+            print(f"(pglSimulatedKeyboard:press) ❌ Unknown key: {key}")
+            return
+        if when is None: when = self.clock.getSecs()
+        if holdTime is None: holdTime = self.holdTime
+        heapq.heappush(self.pending, (when, next(self._order), keyCode, "keydown"))
+        heapq.heappush(self.pending, (when + holdTime, next(self._order), keyCode, "keyup"))
+
+    def poll(self):
+        '''
+        Events that are due on the clock.
+        '''
+        eventList = []
+        if not self.running: return eventList
+        now = self.clock.getSecs()
+        for callback in self.pollCallbacks: callback(now)
+
+        while self.pending and self.pending[0][0] <= now:
+            timestamp, _, keyCode, eventType = heapq.heappop(self.pending)
+            onsetLatency, onsetId = self.onsetLatency(timestamp)
+            eventList.append(pglEventKeyboard(
+                keyChar=self.keyCodeToChar(keyCode),
+                keyCode=keyCode,
+                key={'keyCode': keyCode, 'eventType': eventType, 'timestamp': timestamp},
+                eventType=eventType,
+                timestamp=timestamp,
+                shift=False,
+                ctrl=False,
+                alt=False,
+                cmd=False,
+                onsetLatency=onsetLatency,
+                onsetId=onsetId
+            ))
+        return eventList
+
+    def onsetLatency(self, timestamp):
+        '''
+        Latency from the most recent onset presented at or before timestamp, and its onsetId,
+        from the onsets pgl.flush publishes to the event listener, looked up the same way
+        the listener stamps real key presses.
+        '''
+        found = _pglEventListener.onsetLatency(timestamp)
+        return found if found is not None else (None, None)
+
+#################################################################
+# pglSimulatedDisplay
+#################################################################
+class pglSimulatedDisplay:
+    '''
+    Mixed in ahead of pgl (see pglSimulated) to run it in simulated time:
+    open starts a pglStandInServer presenting frames on a pglVirtualClock
+    instead of starting mglMetal, getSecs and waitSecs use that clock, and a
+    pglSimulatedKeyboard is the keyboard. Drawing goes through the same
+    socket code as it does to mglMetal, so what a frame costs shows up as
+    wall clock time (kept in frameWallTimes).
+
+    e.g.
+    display = pglSimulated(frameRate=60)
+    display.open()
+    '''
+    def __init__(self, *args, frameRate=60.0, screenWidth=1920, screenHeight=1080, renderTime=0.002, chargeComputeTime=False, **kwargs):
+        '''
+        Args:
+            frameRate (float): Refresh rate of the simulated display.
+            screenWidth, screenHeight (int): Size of the simulated screen in pixels (for full screen opens).
+            renderTime (float): Simulated time for the renderer to finish a frame after a flush.
+            chargeComputeTime (bool): Move the clock on by the wall clock time each frame took to
+              make, so task code that is too slow drops frames in the simulated data too.
+        '''
+        self.clock = pglVirtualClock()
+        self.simulatedFrameRate = frameRate
+        self.simulatedScreenSize = (screenWidth, screenHeight)
+        self.renderTime = renderTime
+        self.chargeComputeTime = chargeComputeTime
+        self.standInServer = None
+        # wall clock time from each flush returning to the next flush
+        self.frameWallTimes = []
+        self._frameWallStart = None
+        super().__init__(*args, **kwargs)
+
+        # the keyboard the experiment finds
+        self.keyboard = pglSimulatedKeyboard(self.clock, pgl=self)
+        self.devicesAdd(self.keyboard)
+
+    def checkOS(self):
+        # the stand-in renderer runs on any OS
+        self.cpuInfo = {}
+        self.gpuInfo = {"Simulated": {"Displays": [{"DisplayName": "Simulated"}]}}
+        return True
+
+    def open(self, whichScreen=None, screenWidth=None, screenHeight=None, screenX=None, screenY=None, backgroundColor=None, **kwargs):
+        '''
+        Open a simulated screen (see pglBase.open). Full screen opens are simulatedScreenSize.
+        '''
+        if self.isOpen(): self.close()
+        self.printHeader("pglSimulatedDisplay:open")
+        self.standInServer = pglStandInServer(frameRate=self.simulatedFrameRate, renderTime=self.renderTime, renderJitter=0.0, clock=self.clock).start()
+        self.s = pglComm._pglComm(self.standInServer.socketName, self)
+        if not self.s.isOpen():
+            print("(pglSimulatedDisplay:open) ❌ Error: Could not connect to pglStandInServer.")
+            self.s = None
+            self.standInServer.stop()
+            self.standInServer = None
+            return False
+        self.s.parseCommandValues(commandTypesFilename)
+        self.s.resultDetail = self._resultDetail
+
+        # window size
+        if screenWidth is None: screenWidth = self.simulatedScreenSize[0]
+        if screenHeight is None: screenHeight = self.simulatedScreenSize[1]
+        self.setWindowFrameInDisplay(whichScreen or 0, screenX or 0, screenY or 0, screenWidth, screenHeight)
+        self.getWindowFrameInDisplay()
+
+        # onsets published on an earlier simulated clock are not this run's
+        _pglEventListener.clearOnsets()
+
+        self.frameRate = self.simulatedFrameRate
+        self.refreshTracker = pglRefreshTracker(nominalFrameRate=self.frameRate, verbose=self.verbose)
+
+        # clear screen
+        if backgroundColor is None:
+            backgroundColor = [0.4, 0.2, 0.5]
+        self.clearScreen(backgroundColor)
+        self.flush()
+
+        self.printHeader()
+        return True
+
+    def close(self):
+        '''
+        Close the connection and stop the pglStandInServer.
+        '''
+        if self.s is not None:
+            try:
+                self.s.s.close()
+            except OSError:
+                pass
+            self.s = None
+        if self.standInServer is not None:
+            self.standInServer.stop()
+            self.standInServer = None
+        # what the stand-in held went with it
+        if self._resources is not None: self._resources.closed()
+        return True
+
+    def flush(self):
+        '''
+        Flush (see pglBase.flush), keeping the wall clock time the frame took to make.
+        '''
+        if self._frameWallStart is not None:
+            workTime = time.perf_counter() - self._frameWallStart
+            self.frameWallTimes.append(workTime)
+            if self.chargeComputeTime: self.clock.waitSecs(workTime)
+        presentedTime = super().flush()
+        self._frameWallStart = time.perf_counter()
+        return presentedTime
+
+    def getSecs(self):
+        return self.clock.getSecs()
+
+    def waitSecs(self, secs):
+        self.clock.waitSecs(secs)
+
+    def getFrameRate(self, whichScreen=None):
+        return self.simulatedFrameRate
+
+#################################################################
+# response policies
+#################################################################
+class pglResponsePolicy:
+    '''
+    Decides the simulated subject's response in a trial. pglExperimentSimulator
+    calls it at the start of every segment; it answers in responseSegment
+    (-1 for the last segment of the trial) of task (None for any task) with
+    what respond returns: None for no response, or (response, reactionTime)
+    where response indexes the experiment's response keys and reactionTime
+    is from the start of the segment.
+    '''
+    def __init__(self, responseSegment=-1, task=None):
+        self.responseSegment = responseSegment
+        self.task = task
+
+    def __call__(self, task, params, trialNum, segmentNum):
+        if self.task is not None and task is not self.task: return None
+        responseSegment = self.responseSegment if self.responseSegment >= 0 else task.settings.nSegments + self.responseSegment
+        if segmentNum != responseSegment: return None
+        return self.respond(task, params, trialNum)
+
+    def respond(self, task, params, trialNum):
+        return None
+
+    @staticmethod
+    def getValue(value, task, params):
+        # a parameter name, or a function of the task and its parameters
+        return value(task, params) if callable(value) else params[value]
+
+class pglObserverPolicy(pglResponsePolicy):
+    '''
+    Responses of a pglObserverModel in a 2AFC task: correct with the probability
+    its psychometric function gives for the trial's stimulus value.
+
+    e.g. for pglFixationTaskLeftRight, where the staircase sets the decrement
+    pglObserverPolicy(pglObserverModel(threshold=0.1), stimulusValue=lambda task, params: task.decrement,
+                      correctResponse=lambda task, params: 0 if params['side'] == -1 else 1)
+    '''
+    def __init__(self, observer, stimulusValue, correctResponse, responses=(0, 1), reactionTime=0.6, reactionTimeSD=0.15, **kwargs):
+        '''
+        Args:
+            observer (pglObserverModel): The observer.
+            stimulusValue (str or callable): Parameter name, or function(task, params), giving the stimulus value.
+            correctResponse (str or callable): Parameter name, or function(task, params), giving the correct response.
+            responses (tuple): The responses to choose from.
+            reactionTime, reactionTimeSD (float): Mean and standard deviation of reaction times.
+            responseSegment, task: see pglResponsePolicy.
+        '''
+        super().__init__(**kwargs)
+        self.observer = observer
+        self.stimulusValue = stimulusValue
+        self.correctResponse = correctResponse
+        self.responses = responses
+        self.reactionTime = reactionTime
+        self.reactionTimeSD = reactionTimeSD
+
+    def respond(self, task, params, trialNum):
+        correctResponse = self.getValue(self.correctResponse, task, params)
+        if self.observer.get2AFCResponse(self.getValue(self.stimulusValue, task, params), 0):
+            response = correctResponse
+        else:
+            response = random.choice([r for r in self.responses if r != correctResponse])
+        return response, max(0.1, random.gauss(self.reactionTime, self.reactionTimeSD))
+
+class pglScriptedPolicy(pglResponsePolicy):
+    '''
+    Responses given in advance: a list with one per trial, or a dict by trial
+    number, of responses (None for no response) or (response, reactionTime).
+    Trials past the end of the list get no response.
+    '''
+    def __init__(self, responses, reactionTime=0.5, **kwargs):
+        super().__init__(**kwargs)
+        self.responses = responses
+        self.reactionTime = reactionTime
+
+    def respond(self, task, params, trialNum):
+        if isinstance(self.responses, dict):
+            response = self.responses.get(trialNum)
+        else:
+            response = self.responses[trialNum] if trialNum < len(self.responses) else None
+        if response is None or isinstance(response, tuple): return response
+        return response, self.reactionTime
+
+#################################################################
+# pglExperimentSimulator
+#################################################################
+class pglExperimentSimulator:
+    '''
+    Runs a pglExperiment on a pglSimulated display as fast as the computer
+    allows. Presses the start key, the volume trigger key on schedule, the
+    response keys the policy decides on and any scripted keys, then runs
+    the experiment as usual (pglExperiment.run), so it saves the same data
+    as a real run. No eye tracker or luminance calibration is used.
+
+    e.g. a 10 minute fMRI run, which takes about a minute (about 10x faster than
+    real time, depending on how long the tasks take to draw; run reports the speed up)
+    display = pglSimulated(frameRate=60)
+    e = pglExperiment(display, settings=settings)
+    e.addTask(pglFixationTaskLeftRight(display))
+    simulator = pglExperimentSimulator(e, volumePeriod=1.5, duration=600, policy=pglObserverPolicy(...))
+    results = simulator.run()
+    '''
+    # reaction time for policies that only return a response
+    defaultReactionTime = 0.5
+
+    def __init__(self, experiment, volumePeriod=None, nVolumes=None, firstVolume=1.0, startTime=0.5, policy=None, keyPresses=None, duration=None, seed=None):
+        '''
+        Args:
+            experiment (pglExperiment): Experiment made with a pglSimulated display and its tasks added.
+            volumePeriod (float, optional): Seconds between volume triggers, None for no triggers.
+            nVolumes (int, optional): Number of volume triggers, None to trigger until the experiment ends.
+            firstVolume (float): Time of the first volume trigger.
+            startTime (float): Time the start key is pressed (if the experiment waits for it).
+            policy (callable, optional): pglResponsePolicy, or function(task, params, trialNum, segmentNum)
+              called at the start of each segment, returning None, a response, or (response, reactionTime).
+            keyPresses (list, optional): (time, key) presses to make, e.g. [(300, "escape")].
+            duration (float, optional): Time to end the run with the end key, None to let the tasks end it.
+            seed (int, optional): Seeds random and numpy.random so that the run can be repeated.
+        Times are in seconds on the simulated clock from when run is called.
+        '''
+        self.experiment = experiment
+        self.volumePeriod = volumePeriod
+        self.nVolumes = nVolumes
+        self.firstVolume = firstVolume
+        self.startTime = startTime
+        self.policy = policy
+        self.keyPresses = keyPresses or []
+        self.duration = duration
+        self.seed = seed
+        self.results = None
+        self._hardwareSettings = None
+
+    def initScreen(self):
+        '''
+        Open the simulated screen (pglExperiment.initScreen) with no eye tracker or luminance
+        calibration, as there is no hardware. Call before making tasks that need the screen
+        (run calls it otherwise). The settings are put back when run ends.
+        '''
+        e = self.experiment
+        if not isinstance(e.pgl, pglSimulatedDisplay):
+            print("(pglExperimentSimulator:initScreen) ❌ The experiment must be made with a pglSimulated display.")
+            return False
+        if self._hardwareSettings is None:
+            # the first of each list is the one used
+            self._hardwareSettings = {name: list(getattr(e.settings, name)) for name in ("eyetracker", "calibration")}
+            for name, choices in self._hardwareSettings.items():
+                setattr(e.settings, name, ["None"] + [choice for choice in choices if choice != "None"])
+        if not e.state.openScreen: e.initScreen()
+        if not e.state.openScreen:
+            print("(pglExperimentSimulator:initScreen) ❌ Could not open the simulated screen.")
+            return False
+        return True
+
+    def run(self):
+        '''
+        Run the experiment in simulated time.
+
+        Returns:
+            dict: Simulated and wall clock durations, frames, volumes, responses and the wall clock
+            time frames took to make (median, p95, max and how many took longer than a frame).
+        '''
+        e = self.experiment
+        display = e.pgl
+        wallStart = time.perf_counter()
+        if not self.initScreen(): return None
+        if self.seed is not None:
+            random.seed(self.seed)
+            np.random.seed(self.seed)
+        keyboard = display.keyboard
+        try:
+            # schedule the keys
+            self._t0 = display.getSecs()
+            settings = e.settings
+            if settings.manualPreStart or not settings.startOnVolumeTrigger:
+                keyboard.press(settings.startKey, self._t0 + self.startTime)
+            for when, key in self.keyPresses:
+                keyboard.press(key, self._t0 + when)
+            if self.duration is not None:
+                keyboard.press(settings.endKey, self._t0 + self.duration)
+            self._nextVolumeTime = self._t0 + self.firstVolume if self.volumePeriod else None
+            self._nVolumesPressed = 0
+            self._nResponses = 0
+            self._lastSegments = {}
+            keyboard.pollCallbacks.append(self._onPoll)
+
+            # run the experiment
+            firstFrame = len(display.frameWallTimes)
+            e.run()
+        finally:
+            if self._onPoll in keyboard.pollCallbacks: keyboard.pollCallbacks.remove(self._onPoll)
+            for name, choices in self._hardwareSettings.items(): setattr(e.settings, name, choices)
+            self._hardwareSettings = None
+        wallTime = time.perf_counter() - wallStart
+
+        # what it took
+        frameWallTimes = np.array(display.frameWallTimes[firstFrame:])
+        if len(frameWallTimes) == 0: frameWallTimes = np.zeros(1)
+        simulatedTime = display.getSecs() - self._t0
+        self.results = {
+            "simulatedTime": simulatedTime,
+            "wallTime": wallTime,
+            "speedUp": simulatedTime / wallTime if wallTime > 0 else float("inf"),
+            "nFrames": len(display.frameWallTimes) - firstFrame,
+            "nVolumes": self._nVolumesPressed,
+            "nResponses": self._nResponses,
+            "frameWallMedian": float(np.median(frameWallTimes)),
+            "frameWallP95": float(np.percentile(frameWallTimes, 95)),
+            "frameWallMax": float(np.max(frameWallTimes)),
+            "nFramesOverPeriod": int(np.sum(frameWallTimes > 1 / display.simulatedFrameRate)),
+        }
+        r = self.results
+        print(f"(pglExperimentSimulator:run) Simulated {display.formatDuration(r['simulatedTime'])} in {r['wallTime']:.2f}s ({r['speedUp']:.0f}x): "
+              f"{r['nFrames']} frames, {r['nVolumes']} volumes, {r['nResponses']} responses")
+        print(f"(pglExperimentSimulator:run) Time to make a frame: median {1000*r['frameWallMedian']:.3f} ms, p95 {1000*r['frameWallP95']:.3f} ms, "
+              f"max {1000*r['frameWallMax']:.3f} ms, {r['nFramesOverPeriod']} longer than a frame")
+        return self.results
+
+    def _onPoll(self, now):
+        e = self.experiment
+        keyboard = e.pgl.keyboard
+
+        # volume triggers that are due
+        while self._nextVolumeTime is not None and self._nextVolumeTime <= now:
+            keyboard.press(e.settings.volumeTriggerKey, self._nextVolumeTime)
+            self._nVolumesPressed += 1
+            if self.nVolumes is not None and self._nVolumesPressed >= self.nVolumes:
+                self._nextVolumeTime = None
+            else:
+                self._nextVolumeTime += self.volumePeriod
+
+        # responses to segments that have started since the last poll
+        if self.policy is None: return
+        for task in getattr(e, 'currentTasks', []):
+            trialNum, segmentNum = task.state.currentTrial, task.state.currentSegment
+            if self._lastSegments.get(id(task)) == (trialNum, segmentNum): continue
+            self._lastSegments[id(task)] = (trialNum, segmentNum)
+            if trialNum >= task.settings.nTrials or task.data.endTime is not None: continue
+            response = self.policy(task, task.currentParams, trialNum, segmentNum)
+            if response is None: continue
+            if not isinstance(response, tuple): response = (response, self.defaultReactionTime)
+            response, reactionTime = response
+            keyboard.press(e.responseKeysList[response], task.state.segmentStartTime + reactionTime)
+            self._nResponses += 1
@@ -9,6 +9,7 @@
 # Import modules
 #############
 import numpy as np
+import os
 import itertools
 import random
 from . import pglParameter
@@ -27,6 +28,9 @@ class pglStaircase():
     Class representing a staircase parameter in the experiment.
     This can be added to an experiment as a parameter
     '''
+    # class used for each staircase's data
+    dataClass = None
+
     def __init__(self, description="staircase"):
         '''
         Initialize the staircase, by setting up structures to save data. this
@@ -69,8 +73,8 @@ class pglStaircase():
         this should be called after you initialize the staircase parameters
         so they get stored in the history correctly.
         '''
-        # initialize data
-        self.data = pglStaircaseData()
+        # initialize data (subclasses can keep extra data with dataClass)
+        self.data = (self.dataClass or pglStaircaseData)()
         # save in our list of all data
         self.allData.append(self.data)
         # save the description
@@ -285,6 +289,232 @@ class pglStaircaseUpDown(pglStaircase):
         if len(self.data.reversals) >= self.settings.numReversalsToFinish:
             return True
 
+
+##########################
+# Psi (QUEST+) Staircase class
+##########################
+class pglStaircasePsi(pglStaircase):
+    '''
+    Bayesian adaptive staircase (Psi method, Kontsevich & Tyler 1999,
+    equivalent to QUEST+ for a single stimulus dimension). Keeps a posterior
+    over a grid of Weibull psychometric functions
+
+        p(correct) = guess + (1-guess-lapse) * (1-exp(-(x/threshold)^slope))
+
+    (the same function as pglObserverModel, which is guess=0.5, lapse=0) and
+    on each trial tests the stimulus value that minimizes the expected entropy
+    of the posterior. The likelihood of a correct response for every stimulus
+    and grid cell is computed once when the staircase is made, and the posterior
+    update and stimulus selection are done in place by the native engine in
+    _pglPsi, so that each trial costs around a millisecond even for grids of
+    10^6 cells (see make bench and bench/pglBenchStaircase.py). If _pglPsi has
+    not been compiled, a (slower) numpy version of the same computation is used.
+
+    e.g.
+    staircase = pglStaircasePsi(stimulusValues=np.geomspace(0.005, 0.5, 40))
+    staircase.startStaircase()
+    value = staircase.get()
+    staircase.update(value, correct)
+    staircase.getThresholdEstimate()
+    '''
+    def __init__(self, stimulusValues=None, thresholds=None, slopes=None, lapses=None,
+                 guess=0.5, nTrials=60, nThreads=1, description="psiStaircase"):
+        '''
+        Initialize the Psi staircase.
+
+        Args:
+            stimulusValues (list, optional): Stimulus values that can be tested. Defaults to 40 log-spaced values from 0.005 to 0.5.
+            thresholds (list, optional): Threshold values in the posterior grid. Defaults to 50 log-spaced values from 0.01 to 0.3.
+            slopes (list, optional): Slope values in the posterior grid. Defaults to 20 log-spaced values from 1 to 8.
+            lapses (list, optional): Lapse rates in the posterior grid. Defaults to [0, 0.025, 0.05].
+            guess (float, optional): Guess rate (0.5 for 2AFC).
+            nTrials (int, optional): Number of trials after which the staircase finishes.
+            nThreads (int, optional): Number of threads for stimulus selection (0 for one per core).
+            description (str, optional): Description of the staircase.
+        '''
+        # default grid
+        if stimulusValues is None: stimulusValues = np.geomspace(0.005, 0.5, 40)
+        if thresholds is None: thresholds = np.geomspace(0.01, 0.3, 50)
+        if slopes is None: slopes = np.geomspace(1.0, 8.0, 20)
+        if lapses is None: lapses = [0.0, 0.025, 0.05]
+
+        # staircase parameters
+        self.settings = pglStaircasePsiSettings()
+        self.settings.stimulusValues = [float(x) for x in stimulusValues]
+        self.settings.thresholds = [float(x) for x in thresholds]
+        self.settings.slopes = [float(x) for x in slopes]
+        self.settings.lapses = [float(x) for x in lapses]
+        self.settings.guess = guess
+        self.settings.nTrials = nTrials
+        self.settings.nThreads = nThreads
+
+        # check for the native engine
+        try:
+            from . import _pglPsi
+            self._pglPsi = _pglPsi
+        except ImportError as e:
+            self._pglPsi = None
+            print("(pglStaircasePsi) ❌ Could not import _pglPsi, using numpy instead: You may need to compile by going to pgl in terminal and running 'make force'")
+
+        # precompute the likelihood tables
+        self.computeLikelihoodTables()
+
+        # run init to start the staircase history (this needs to come
+        # after the parameters are set)
+        super().__init__(description)
+
+    def computeLikelihoodTables(self):
+        '''
+        Compute the probability of a correct response (and its logs) for every
+        stimulus value and grid cell. These are nStimuli x nParams arrays where
+        the params are the flattened (threshold, slope, lapse) grid.
+        '''
+        # flattened grid values of each parameter, for computing estimates
+        gridShape = (len(self.settings.thresholds), len(self.settings.slopes), len(self.settings.lapses))
+        self.gridShape = gridShape
+        self.nParams = int(np.prod(gridShape))
+        grid = np.meshgrid(self.settings.thresholds, self.settings.slopes, self.settings.lapses, indexing='ij')
+        self.gridThresholds, self.gridSlopes, self.gridLapses = [g.ravel() for g in grid]
+        self.stimulusValues = np.asarray(self.settings.stimulusValues, dtype=np.float64)
+
+        if self._pglPsi is not None:
+            self.pCorrect, self.logCorrect, self.logIncorrect = self._pglPsi.weibullTable(
+                self.stimulusValues, self.settings.thresholds, self.settings.slopes, self.settings.lapses, float(self.settings.guess))
+        else:
+            x = np.abs(self.stimulusValues)[:, np.newaxis]
+            detect = 1 - np.exp(-(x / self.gridThresholds) ** self.gridSlopes)
+            self.pCorrect = np.clip(self.settings.guess + (1 - self.settings.guess - self.gridLapses) * detect, self.minProbability, 1 - self.minProbability)
+            self.logCorrect = np.log(self.pCorrect)
+            self.logIncorrect = np.log1p(-self.pCorrect)
+
+        # work space for stimulus selection
+        self.expectedEntropy = np.zeros(len(self.stimulusValues), dtype=np.float64)
+
+    # same clamp as the native engine (kPsiMinProbability) so the log tables are finite
+    minProbability = 1e-10
+
+    def startStaircase(self, startVal=None):
+        '''
+        start the staircase with a uniform prior over the grid
+        '''
+        # initialize posterior
+        self.posterior = np.full(self.nParams, 1.0 / self.nParams, dtype=np.float64)
+
+        # call superclass method to initialize data
+        super().startStaircase(startVal)
+
+        # choose the first stimulus (or use the one asked for)
+        if startVal is not None:
+            self.currentIndex = self.nearestStimulusIndex(startVal)
+        else:
+            self.currentIndex = self.selectStimulus()
+
+    def get(self):
+        '''
+        Get the test value for the current trial.
+        '''
+        return float(self.stimulusValues[self.currentIndex])
+
+    def update(self, value, response):
+        '''
+        Update the posterior with the latest trial result and choose the next stimulus.
+        '''
+        # update the history by calling superclass method
+        super().update(value, response)
+
+        # time the update and selection, which has to fit between trials
+        startTime = self.pglTimestamp.getSecs()
+
+        # multiply in the likelihood of the response
+        stimulusIndex = self.nearestStimulusIndex(value)
+        if self._pglPsi is not None:
+            probability = self._pglPsi.update(self.posterior, self.pCorrect, stimulusIndex, bool(response))
+        else:
+            likelihood = self.pCorrect[stimulusIndex] if response else 1 - self.pCorrect[stimulusIndex]
+            probability = np.dot(self.posterior, likelihood)
+            if probability > 0: self.posterior *= likelihood / probability
+        if probability <= 0:
+            print(f"(pglStaircasePsi:update) ❌ Response {response} to {value} has zero probability under the posterior, ignoring")
+
+        # next stimulus
+        self.currentIndex = self.selectStimulus()
+        self.data.computeTimes.append(self.pglTimestamp.getSecs() - startTime)
+
+        # keep the estimates
+        estimates = self.getEstimates()
+        self.data.thresholdEstimates.append(estimates['threshold'])
+        self.data.thresholdSDs.append(estimates['thresholdSD'])
+        self.data.entropy.append(self.getEntropy())
+
+    def selectStimulus(self):
+        '''
+        Return the index of the stimulus value with the smallest expected posterior entropy.
+        '''
+        if self._pglPsi is not None:
+            nThreads = self.settings.nThreads if self.settings.nThreads > 0 else (os.cpu_count() or 1)
+            return self._pglPsi.selectStimulus(self.posterior, self.pCorrect, self.logCorrect, self.logIncorrect, self.expectedEntropy, nThreads)
+
+        # numpy version of pglPsiSelectStimulus (see _pglPsiCore.c for the derivation)
+        logPosterior = np.log(np.where(self.posterior > 0, self.posterior, 1.0))
+        joint = self.posterior * self.pCorrect
+        sumCorrect = joint.sum(axis=1)
+        sumIncorrect = 1 - sumCorrect
+        sumCorrectLogPosterior = joint @ logPosterior
+        sumIncorrectLogPosterior = np.dot(self.posterior, logPosterior) - sumCorrectLogPosterior
+        with np.errstate(divide='ignore', invalid='ignore'):
+            self.expectedEntropy[:] = (np.where(sumCorrect > 0, sumCorrect * np.log(sumCorrect), 0)
+                                       + np.where(sumIncorrect > 0, sumIncorrect * np.log(sumIncorrect), 0)
+                                       - sumCorrectLogPosterior - (joint * self.logCorrect).sum(axis=1)
+                                       - sumIncorrectLogPosterior - ((self.posterior - joint) * self.logIncorrect).sum(axis=1))
+        return int(np.argmin(self.expectedEntropy))
+
+    def nearestStimulusIndex(self, value):
+        '''
+        Index of the stimulus value closest to value.
+        '''
+        return int(np.argmin(np.abs(self.stimulusValues - value)))
+
+    def getEntropy(self):
+        '''
+        Entropy (nats) of the current posterior.
+        '''
+        if self._pglPsi is not None:
+            return self._pglPsi.entropy(self.posterior)
+        p = self.posterior[self.posterior > 0]
+        return float(-np.sum(p * np.log(p)))
+
+    def getEstimates(self):
+        '''
+        Posterior means and standard deviations of threshold, slope and lapse.
+        '''
+        estimates = {}
+        for name, values in (('threshold', self.gridThresholds), ('slope', self.gridSlopes), ('lapse', self.gridLapses)):
+            mean = float(np.dot(self.posterior, values))
+            estimates[name] = mean
+            estimates[name + 'SD'] = float(np.sqrt(max(np.dot(self.posterior, values**2) - mean**2, 0)))
+        return estimates
+
+    def getThresholdEstimate(self):
+        '''
+        Get the current threshold estimate (posterior mean).
+        '''
+        return self.getEstimates()['threshold']
+
+    def getMarginal(self, name='threshold'):
+        '''
+        Marginal posterior over threshold, slope or lapse.
+        '''
+        axes = {'threshold': (1, 2), 'slope': (0, 2), 'lapse': (0, 1)}
+        if name not in axes:
+            print(f"(pglStaircasePsi:getMarginal) ❌ Unknown parameter {name}, should be one of {list(axes.keys())}")
+            return None
+        return self.posterior.reshape(self.gridShape).sum(axis=axes[name])
+
+    def finished(self):
+        '''
+        returns whether the staircase should finish.
+        '''
+        return self.data.nTrials >= self.settings.nTrials
             
 @dataclass
 class pglStaircaseData(pglSerialize):
@@ -315,6 +545,32 @@ class pglStaircaseData(pglSerialize):
             ax.legend()
         return ax
 
+@dataclass
+class pglStaircaseDataPsi(pglStaircaseData):
+    '''
+    Data from a Psi staircase, adds the estimates after each trial.
+    '''
+    thresholdEstimates: list = field(default_factory=list)
+    thresholdSDs: list = field(default_factory=list)
+    entropy: list = field(default_factory=list)
+    computeTimes: list = field(default_factory=list)
+
+    def plot(self, ax=None):
+        '''
+        Plot the staircase data with the threshold estimate.
+        '''
+        ax = super().plot(ax)
+        if self.thresholdEstimates:
+            trials = np.arange(1, len(self.thresholdEstimates) + 1)
+            estimates = np.array(self.thresholdEstimates)
+            sds = np.array(self.thresholdSDs)
+            ax.plot(trials, estimates, color='k', label='Threshold estimate')
+            ax.fill_between(trials, estimates - sds, estimates + sds, color='k', alpha=0.2)
+            ax.legend()
+        return ax
+
+pglStaircasePsi.dataClass = pglStaircaseDataPsi
+
 class pglStaircaseSettings(pglSettingsEditable):
     nDown = Int(2, min=0, step=1, help="Number of trials in a row before increasing difficulty")
     nUp = Int(1, min=0, step=1, help="Number of trials in a row before increasing difficulty")
@@ -325,3 +581,12 @@ class pglStaircaseSettings(pglSettingsEditable):
     stepChangeSizes = List(Float(), default_value=[0.5, 0.25, 0.125], help="Step sizes to change to at each reversal count")
     stepChangeReversals = List(Int(), default_value=[2, 4, 6], help="Reversal counts at which to change step size")
     numReversalsToFinish = Int(8, min=1, help="Number of reversals at which the staircase is considered to have converged and should therefore finish")
+
+class pglStaircasePsiSettings(pglSettingsEditable):
+    stimulusValues = List(Float(), default_value=[], help="Stimulus values that the staircase can test")
+    thresholds = List(Float(), default_value=[], help="Threshold values of the posterior grid")
+    slopes = List(Float(), default_value=[], help="Slope values of the posterior grid")
+    lapses = List(Float(), default_value=[0.0], help="Lapse rates of the posterior grid")
+    guess = Float(0.5, min=0.0, max=1.0, help="Guess rate (0.5 for 2AFC)")
+    nTrials = Int(60, min=1, help="Number of trials after which the staircase finishes")
+    nThreads = Int(1, min=0, help="Number of threads for choosing the next stimulus (0 for one per core)")
@@ -11,9 +11,16 @@
 #############
 from datetime import time
 import threading
+import queue
+import weakref
 
 import numpy as np
 import matplotlib.pyplot as plt
+from .pglTrace import traceLog
+
+# trace log events (see pglTrace)
+traceImageSequence = traceLog.define("pglStimulusImage:display", "image {image} of {nImages}", ("image", "nImages"))
+traceNoiseLate = traceLog.define("pglStimulusNoise:display", "frame {noiseFrame} late ({nLate} late)", ("noiseFrame", "nLate"))
 
 #############
 # Stimuli class
@@ -65,8 +72,8 @@ class pglStimuli:
 
         # create a squence of frames for this temporal frequency
         if temporalFrequency != 0:
-            # get deltaT of monitor
-            deltaT = 1 / self.getFrameRate()
+            # get deltaT of monitor (measured, so e.g. 59.94 Hz is not taken as 59 Hz)
+            deltaT = self.getFramePeriod()
             # calculate on period
             period = 1 / temporalFrequency
             # get time points to compute images from
@@ -251,6 +258,41 @@ class pglStimuli:
         rdk = pglStimulusRandomDots(self, width, height, color, aperture, density, dotSize, dotShape, dotAntialiasingBorder, noiseType)
         return rdk
 
+    ####################################################
+    # noise
+    ####################################################
+    def noise(self, x=0, y=0, width=None, height=None, type='white', spatialFrequency=2.0, bandwidth=1.0, orientation=0.0, orientationBandwidth=30.0, exponent=1.0, contrast=0.25, pixelsPerNoise=1, nFrames=60, framesPerNoise=1, seed=None, regenerate=False, nThreads=0):
+        '''
+        Dynamic noise stimulus, a new noise frame every framesPerNoise video frames.
+
+        Frames are made ahead of time by the native generator (on several threads)
+        and kept as textures on the renderer, so displaying a frame is one texture
+        draw. With regenerate=True frames are instead made in the background as
+        they are needed (for sequences too long to keep), at the cost of sending
+        each frame to its texture when it comes up.
+
+        Args:
+            x, y: Center of the stimulus in degrees.
+            width, height: Size in degrees (default is the screen).
+            type: 'white', 'pink' (amplitude falls as 1/f^exponent), 'bandpass'
+                (log Gaussian around spatialFrequency, bandwidth in octaves full width at
+                half height) or 'orientation' (band-pass, and Gaussian in orientation around
+                orientation with orientationBandwidth in degrees full width at half height,
+                bandwidth=None for no band-pass).
+            contrast: RMS contrast of the noise.
+            pixelsPerNoise: Size of each noise element in pixels.
+            nFrames: Number of frames to make (and then repeat) when not regenerating.
+            framesPerNoise: Video frames each noise frame is displayed for.
+            seed: Seed of the sequence (frame n is always the same for the same seed and
+                parameters). Default is a random seed, kept in the stimulus.
+            regenerate: Make new frames in the background rather than repeat nFrames.
+            nThreads: Threads the generator uses (0 for one per processor).
+
+        Returns:
+        - A pglStimulusNoise instance.
+        '''
+        return pglStimulusNoise(self, x, y, width, height, type, spatialFrequency, bandwidth, orientation, orientationBandwidth, exponent, contrast, pixelsPerNoise, nFrames, framesPerNoise, seed, regenerate, nThreads)
+
     ####################################################
     # checkerboard
     ####################################################
@@ -555,7 +597,7 @@ class pglStimulusFlicker(_pglStimulus):
     def __repr__(self):
         return f"<pglStimulusFlicker: temporalFrequency={self.temporalFrequency}, type={self.type}, x={self.x}, y={self.y}, width={self.width}, height={self.height}>"
 
-    def display(self, useTargetPresentationTimestamp=True):
+    def display(self, useTargetPresentationTimestamp=True, usePredictedVsync=False):
         '''
         Display the flicker stimulus
 
@@ -563,6 +605,8 @@ class pglStimulusFlicker(_pglStimulus):
             useTargetPresentationTimestamp (bool): If True, target presentation timestamp is used, rather that getSecs to decide
                 which phase of the stimulus to show. targetPresentationTimestamp gives the time
                 that Metal predicts that the frame will be displayed (rather than the current cpu time)
+            usePredictedVsync (bool): If True, the next vsync predicted from the measured refresh period
+                and phase (pgl.getNextVsync) is used instead, which avoids a round trip to mglMetal every frame
 
         Returns:
             bool: True if a new cycle just started on this frame, False otherwise
@@ -573,7 +617,10 @@ class pglStimulusFlicker(_pglStimulus):
             newCycle = (self.frameCount % self.framesPerCycle) < 1
             self.frameCount += 1
         else:
-            if useTargetPresentationTimestamp:
+            if usePredictedVsync:
+                # predicted from when previous frames were presented
+                currentTime = self.pgl.getNextVsync()
+            elif useTargetPresentationTimestamp:
                 # get the target presentation timestamp for this frame
                 currentTime = self.pgl.getTargetPresentationTimestamp()
             else:
@@ -708,8 +755,9 @@ class pglStimulusRandomDots(_pglStimulus):
 
         # update positions based on direction and speed
         if speed != 0:
-            self.x += (speed * np.cos(direction))/self.pgl.frameRate
-            self.y += (speed * np.sin(direction))/self.pgl.frameRate
+            framePeriod = self.pgl.getFramePeriod()
+            self.x += speed * np.cos(direction) * framePeriod
+            self.y += speed * np.sin(direction) * framePeriod
 
 ################################################################
 # Image stimulus class
@@ -759,6 +807,7 @@ class pglStimulusImage(_pglStimulus):
         
         # Print information about the stimulus
         if self.pgl.verbose>1: print(f"(pgl:pglStimulus:display) Displaying image {self.currentImage} of {self.nImages}.")
+        if traceLog.on: traceLog.record(traceImageSequence, self.currentImage, self.nImages)
 
         # display current image        
         self.imageList[self.currentImage].display()
@@ -775,6 +824,203 @@ class pglStimulusImage(_pglStimulus):
         for iImage in range(self.nImages):
             self.imageList[iImage].print()
 
+################################################################
+# Dynamic noise stimulus class
+################################################################
+class pglStimulusNoise(_pglStimulus):
+    '''
+    Dynamic noise (white, pink, band-pass or orientation filtered), see
+    pglStimuli.noise. Frames are made by the native generator in _pglNoise
+    from the seed and the frame number, kept as 8 bit levels (a quarter of
+    the size of one float channel) and expanded to texture values through
+    a table of the 256 levels, which is where the display calibration
+    comes in when a color space is set (see pglColor).
+    '''
+    _pglNoise = None
+    # frames made ahead of display when regenerating
+    regenerateAhead = 8
+    # textures that frames are sent to in turn when regenerating
+    regenerateTextures = 3
+
+    def __init__(self, pgl, x=0, y=0, width=None, height=None, type='white', spatialFrequency=2.0, bandwidth=1.0, orientation=0.0, orientationBandwidth=30.0, exponent=1.0, contrast=0.25, pixelsPerNoise=1, nFrames=60, framesPerNoise=1, seed=None, regenerate=False, nThreads=0):
+        super().__init__(pgl)
+        self.x, self.y = x, y
+        self.width = pgl.screenWidth.deg if width is None else width
+        self.height = pgl.screenHeight.deg if height is None else height
+        if type not in ('white', 'pink', 'bandpass', 'orientation'):
+            print(f"(pgl:pglStimulusNoise) Unknown noise type '{type}'. Use 'white', 'pink', 'bandpass' or 'orientation'. Defaulting to white.")
+            type = 'white'
+        self.type = type
+        self.spatialFrequency, self.bandwidth, self.exponent = spatialFrequency, bandwidth, exponent
+        self.orientation, self.orientationBandwidth = orientation, orientationBandwidth
+        self.contrast = contrast
+        self.nFrames = max(1, int(nFrames))
+        self.framesPerNoise = max(1, int(framesPerNoise))
+        self.seed = int(np.random.randint(0, 2**63, dtype=np.int64)) if seed is None else int(seed)
+        self.regenerate = regenerate
+        self.nThreads = nThreads
+        self.frameCount = 0
+        self.noiseFrame = -1
+        self.nLate = 0
+        self._frameDue = False
+        self.textures = []
+        self._thread = None
+
+        # check for the native generator
+        if pglStimulusNoise._pglNoise is None:
+            try:
+                from . import _pglNoise
+                pglStimulusNoise._pglNoise = _pglNoise
+            except ImportError:
+                print("(pgl:pglStimulusNoise) ❌ Could not import _pglNoise: You may need to compile by going to pgl in terminal and running 'make force'")
+                return
+
+        # noise elements across and down
+        self.nx = max(1, int(round(self.width * pgl.xDeg2Pix / pixelsPerNoise)))
+        self.ny = max(1, int(round(self.height * pgl.yDeg2Pix / pixelsPerNoise)))
+        self.amplitude = self._amplitudeSpectrum()
+        self.levelTable = self._levelTable()
+        if pgl.verbose>1: print(f"(pgl:pglStimulusNoise) Creating {self.type} noise {self.nx}x{self.ny} (seed {self.seed}, {'regenerated' if regenerate else f'{self.nFrames} frames'})")
+
+        if not regenerate:
+            # every frame made now and kept on the renderer
+            self.levels = self.generate(0, self.nFrames)
+            for frameLevels in self.levels:
+                self.textures.append(self._createTexture(frameLevels))
+        else:
+            # frames made in the background and sent to a few textures in turn
+            for iTexture in range(self.regenerateTextures):
+                self.textures.append(self._createTexture(np.full((self.ny, self.nx), 128, dtype=np.uint8)))
+            self._queue = queue.Queue(maxsize=self.regenerateAhead)
+            self._stop = threading.Event()
+            # the thread refers to the stimulus only weakly, so that dropping the stimulus stops it
+            self._thread = threading.Thread(target=pglStimulusNoise._generateAhead, args=(weakref.ref(self), self._stop, self._queue), daemon=True)
+            self._thread.start()
+
+    def __repr__(self):
+        frames = "regenerated" if self.regenerate else f"{self.nFrames} frames"
+        return f"<pglStimulusNoise: {self.type} {self.nx}x{self.ny}, contrast={self.contrast}, seed={self.seed}, {frames}, frame {self.noiseFrame}>"
+
+    def _amplitudeSpectrum(self):
+        '''
+        Amplitude at each frequency of the FFT the frames are made with (None for white noise)
+        '''
+        if self.type == 'white': return None
+        fftWidth, fftHeight = (1 << int(np.ceil(np.log2(n))) for n in (self.nx, self.ny))
+        # frequencies in cycles per degree
+        fx, fy = np.meshgrid(np.fft.fftfreq(fftWidth, d=self.width / self.nx), np.fft.fftfreq(fftHeight, d=self.height / self.ny))
+        f = np.hypot(fx, fy)
+        amplitude = np.ones_like(f)
+        with np.errstate(divide='ignore'):
+            if self.type == 'pink':
+                amplitude = np.where(f > 0, f ** -self.exponent, 0)
+            elif self.bandwidth is not None:
+                sigma = self.bandwidth / (2 * np.sqrt(2 * np.log(2)))
+                amplitude = np.where(f > 0, np.exp(-np.log2(f / self.spatialFrequency) ** 2 / (2 * sigma ** 2)), 0)
+        if self.type == 'orientation':
+            # distance from the orientation (frequencies of either sign)
+            offset = np.angle(np.exp(2j * (np.arctan2(fy, fx) - np.deg2rad(self.orientation)))) / 2
+            sigma = np.deg2rad(self.orientationBandwidth) / (2 * np.sqrt(2 * np.log(2)))
+            amplitude = amplitude * np.exp(-offset ** 2 / (2 * sigma ** 2))
+        amplitude[0, 0] = 0
+        return amplitude.astype(np.float32)
+
+    def _levelTable(self):
+        '''
+        Texture value for each of the 256 levels (128 is the background)
+        '''
+        levelContrast = (np.arange(256) - 128) / 127.0
+        table = np.ones((256, 4), dtype=np.float32)
+        if getattr(self.pgl, 'colorSpace', 'rgb') != 'rgb':
+            table[:, 0:3] = np.asarray(self.pgl.convertColor(levelContrast[:, None], 'contrast'))
+        else:
+            table[:, 0:3] = ((1 + levelContrast) / 2)[:, None]
+        return table
+
+    def _createTexture(self, frameLevels):
+        texture = self.pgl.imageCreate(pglStimulusNoise._pglNoise.expand(frameLevels, self.levelTable))
+        if texture is None: return None
+        # each noise element is a block of pixels
+        texture.minMagFilter = 0
+        texture.mipFilter = 0
+        return texture
+
+    def generate(self, firstFrame, nFrames=1):
+        '''
+        Levels of noise frames (nFrames x height x width uint8, 128 is the background).
+        The same frame number always gives the same frame, so a sequence can be made
+        again for analysis from the seed.
+        '''
+        return pglStimulusNoise._pglNoise.generate(self.nx, self.ny, nFrames, self.seed, firstFrame, self.contrast, self.amplitude, self.nThreads)
+
+    @staticmethod
+    def _generateAhead(stimulusRef, stop, frameQueue):
+        # make frames in batches, and wait for room to hand them over, holding
+        # the stimulus only while making a batch so that it can be collected
+        nextFrame = 0
+        while not stop.is_set():
+            stimulus = stimulusRef()
+            if stimulus is None: return
+            batch = [pglStimulusNoise._pglNoise.expand(frameLevels, stimulus.levelTable) for frameLevels in stimulus.generate(nextFrame, stimulus.regenerateAhead)]
+            del stimulus
+            for values in batch:
+                while not stop.is_set():
+                    if stimulusRef() is None: return
+                    try:
+                        frameQueue.put((nextFrame, values), timeout=0.1)
+                        break
+                    except queue.Full:
+                        pass
+                nextFrame += 1
+
+    def display(self):
+        '''
+        Display the noise, going on to the next noise frame every framesPerNoise calls
+        '''
+        if not self.textures:
+            print("(pgl:pglStimulusNoise:display) No noise frames to display.")
+            return None
+        if (self.frameCount % self.framesPerNoise) == 0: self._frameDue = True
+        if not self.regenerate:
+            if self._frameDue: self.noiseFrame += 1
+            self._frameDue = False
+            texture = self.textures[self.noiseFrame % self.nFrames]
+        else:
+            if self._frameDue:
+                try:
+                    self.noiseFrame, values = self._queue.get_nowait()
+                    self.pgl.imageUpdate(self.textures[self.noiseFrame % len(self.textures)], values)
+                    self._frameDue = False
+                except queue.Empty:
+                    # the generator is behind: the frame is shown late rather than skipped
+                    self.nLate += 1
+                    if traceLog.on: traceLog.record(traceNoiseLate, self.noiseFrame + 1, self.nLate)
+            texture = self.textures[max(self.noiseFrame, 0) % len(self.textures)]
+        self.pgl.imageDisplay(texture, self.x, self.y, self.width, self.height)
+        self.frameCount += 1
+
+    def delete(self):
+        '''
+        Stop making frames and free the textures
+        '''
+        thread = getattr(self, '_thread', None)
+        if thread is not None:
+            self._stop.set()
+            # the last reference can go away on the thread itself, which then just returns
+            if thread is not threading.current_thread(): thread.join()
+            self._thread = None
+        self.textures = []
+
+    def __del__(self):
+        self.delete()
+
+    def print(self):
+        '''
+        Print information about the stimulus.
+        '''
+        print(self.__repr__())
+        if self.regenerate: print(f"  {self.nLate} frames late")
+
 ################################################################
 # Checkerboard stimulus class
 ################################################################
@@ -1292,6 +1538,8 @@ class pglStimulusMovie(_pglStimulus):
         
         # get command results
         self.commandResults = self.pgl.s.readCommandResults(ackTime)
+        # frames are decoded on the renderer, so only the size is known (once it is read)
+        self.pgl.resources.created("movie", self.movieNum, self.width or 0, self.height or 0, format="movie", nBytes=0, label=filename, uploadBytes=0)
         
         # do positionParams if given, this can block as setDisplayPosition
         # will keep calling status until dimensions are read
@@ -1318,6 +1566,8 @@ class pglStimulusMovie(_pglStimulus):
         self.preferredTransform.d = self.pgl.s.read(np.float64)
         self.preferredTransform.tx = self.pgl.s.read(np.float64)
         self.preferredTransform.ty = self.pgl.s.read(np.float64)
+        record = self.pgl.resources.retag("movie", self.movieNum) if self.movieNum is not None else None
+        if record is not None: record.width, record.height = int(self.width), int(self.height)
         self.dimensionsReady.set() 
 
         return True
@@ -1334,6 +1584,7 @@ class pglStimulusMovie(_pglStimulus):
         self.pgl.s.write(np.uint32(self.movieNum))
         success = self.pgl.s.read(np.float64)
         self.commandResults = self.pgl.s.readCommandResults(ackTime)
+        self.pgl.resources.released("movie", self.movieNum)
         self.movieNum = None
         return success
 
@@ -1679,7 +1930,7 @@ class pglStimulusMovie(_pglStimulus):
 
         # Expected frame durations, based on multiples of the refresh rate
         multiples = np.array([1, 1.5, 2, 2.5, 3, 3.5, 4])
-        refreshRate = self.pgl.getFrameRate()
+        refreshRate = 1 / self.pgl.getFramePeriod()
         expectedFrameDuration = 1000 * multiples / refreshRate  # milliseconds per frame
         labels = [f"{int(refreshRate / m)}Hz" for m in multiples]
 
@@ -0,0 +1,333 @@
+################################################################
+#   filename: pglTrace.py
+#    purpose: Binary trace log for diagnostics that can stay on
+#             during an experiment. Hot paths record fixed size
+#             records (time, event, up to 4 numbers) to a ring per
+#             thread in _pglTrace instead of printing; the records
+#             are saved to a file by a background thread (or on
+#             demand) and decoded to text afterwards with
+#             pglTraceDecode or
+#             python -m pgl.pglTrace file.pgltrace
+#         by: JLG
+#       date: October 18, 2026
+################################################################
+
+#############
+# Import modules
+#############
+import sys
+import json
+import struct
+import threading
+import numpy as np
+from . import _pglTrace
+
+# records as they come out of _pglTrace (see _pglTraceCore.h)
+traceRecordDtype = np.dtype([('time', np.double), ('event', np.uint32), ('thread', np.uint32), ('args', np.double, (4,))])
+if traceRecordDtype.itemsize != _pglTrace.recordSize:
+    raise ImportError(f"(pglTrace) Trace records are {_pglTrace.recordSize} bytes, expected {traceRecordDtype.itemsize}")
+
+# file: magic and version, then chunks of a 4 byte tag, a uint32
+# length and the payload. "TABL" chunks are the JSON table of events,
+# strings and threads (a later one replaces an earlier one), "RECS"
+# chunks are records
+traceMagic = b"PGLTRACE"
+traceVersion = 1
+
+#################################################################
+# pglTraceLog
+#################################################################
+class pglTraceLog:
+    '''
+    The trace log of the process (there is one, traceLog). Events are
+    defined once, by name, with a format for the decoder and the names of
+    their numbers; a number named "name:s" is a string given by
+    traceLog.string. Hot paths check traceLog.on, so that a record costs
+    nothing when the log is off:
+
+    traceCommand = traceLog.define("_pglComm:writeCommand", "{command}", ("command:s",))
+    ...
+    if traceLog.on: traceLog.record(traceCommand, traceLog.string(commandName))
+
+    and record from any thread.
+    '''
+    def __init__(self):
+        self.on = False
+        # record(event, a, b, c, d), straight to the C extension
+        self.record = _pglTrace.record
+        self.events = []
+        self.eventIds = {}
+        self.strings = []
+        self.stringIds = {}
+        self.threadNames = {}
+        self.path = None
+        self._file = None
+        self._tableWritten = None
+        self._lock = threading.Lock()
+        self._writeLock = threading.Lock()
+        self._drainThread = None
+        self._stopDrain = threading.Event()
+
+    ################################################################
+    # define
+    ################################################################
+    def define(self, name, format="", args=()):
+        '''
+        Define an event (or get the id of one already defined).
+
+        Args:
+            name (str): Name, e.g. "pglImage:imageCreate".
+            format (str): str.format string of the numbers by name, e.g. "{width}x{height}".
+            args (tuple): Names of the up to 4 numbers, "name:s" for a string id.
+
+        Returns:
+            int: Event id to record with.
+        '''
+        if name in self.eventIds: return self.eventIds[name]
+        if len(args) > 4:
+            print(f"(pglTrace:define) ❌ Event {name} has more than 4 numbers")
+            return None
+        with self._lock:
+            self.eventIds[name] = len(self.events)
+            self.events.append({"name": name, "format": format, "args": list(args)})
+        return self.eventIds[name]
+
+    def string(self, text):
+        '''
+        Id of a string (e.g. a command name) to record as a number.
+        '''
+        stringId = self.stringIds.get(text)
+        if stringId is None:
+            with self._lock:
+                stringId = self.stringIds.setdefault(text, len(self.strings))
+                if stringId == len(self.strings): self.strings.append(text)
+        return stringId
+
+    def nameThread(self, name=None):
+        '''
+        Name the calling thread in the decoded log (defaults to its Python name).
+        '''
+        self.threadNames[_pglTrace.threadIndex()] = name or threading.current_thread().name
+
+    ################################################################
+    # start
+    ################################################################
+    def start(self, path=None, capacity=65536, drainInterval=0.25):
+        '''
+        Start recording.
+
+        Args:
+            path (str, optional): File to save records to as they come (by a background
+                thread every drainInterval seconds). Without one, records stay in the rings
+                until dump or getRecords.
+            capacity (int): Records in each thread's ring. A thread whose ring is full drops records.
+            drainInterval (float): Seconds between saves to path.
+        '''
+        if self.on: self.stop()
+        _pglTrace.enable(int(capacity))
+        self.nameThread()
+        if path is not None:
+            self.path = str(path)
+            self._file = open(self.path, "wb")
+            self._file.write(traceMagic + struct.pack('<I', traceVersion))
+            self._tableWritten = None
+            self._stopDrain.clear()
+            self._drainThread = threading.Thread(target=self._drainLoop, args=(drainInterval,), name="pglTrace", daemon=True)
+            self._drainThread.start()
+        self.on = True
+
+    def stop(self):
+        '''
+        Stop recording, and save what is left to the file if there is one.
+
+        Returns:
+            int: Number of records dropped because a ring was full.
+        '''
+        self.on = False
+        _pglTrace.disable()
+        if self._drainThread is not None:
+            self._stopDrain.set()
+            self._drainThread.join()
+            self._drainThread = None
+        if self._file is not None:
+            self._write(_pglTrace.drain(), force=True)
+            with self._writeLock:
+                self._file.close()
+                self._file = None
+            print(f"(pglTrace:stop) Saved trace to {self.path}")
+        nDropped = _pglTrace.dropped()
+        if nDropped > 0: print(f"(pglTrace:stop) ⚠️ {nDropped} records were dropped because a ring was full")
+        return nDropped
+
+    ################################################################
+    # dump
+    ################################################################
+    def dump(self, path=None):
+        '''
+        Save the records waiting in the rings now: to the file being written, or
+        to path (a new file).
+        '''
+        if path is None:
+            if self._file is None:
+                print("(pglTrace:dump) ❌ No trace file open, give a path")
+                return
+            self._write(_pglTrace.drain(), force=True)
+            return
+        with open(path, "wb") as f:
+            f.write(traceMagic + struct.pack('<I', traceVersion))
+            f.write(self._chunk(b"TABL", json.dumps(self._table()).encode()))
+            f.write(self._chunk(b"RECS", _pglTrace.drain()))
+
+    def getRecords(self):
+        '''
+        Take the records waiting in the rings, as a numpy array of traceRecordDtype.
+        '''
+        return np.frombuffer(_pglTrace.drain(), dtype=traceRecordDtype)
+
+    def decode(self, records=None):
+        '''
+        Text lines for records (getRecords() if not given), with this log's table.
+        '''
+        if records is None: records = self.getRecords()
+        return decodeRecords(records, self._table())
+
+    ################################################################
+    # file writing
+    ################################################################
+    def _drainLoop(self, drainInterval):
+        while not self._stopDrain.wait(drainInterval):
+            self._write(_pglTrace.drain())
+
+    def _table(self):
+        with self._lock:
+            return {"events": list(self.events), "strings": list(self.strings),
+                    "threads": {str(k): v for k, v in self.threadNames.items()}, "dropped": _pglTrace.dropped()}
+
+    def _chunk(self, tag, payload):
+        return tag + struct.pack('<I', len(payload)) + payload
+
+    def _write(self, records, force=False):
+        with self._writeLock:
+            if self._file is None: return
+            # the table goes before records that may use what was added to it
+            table = self._table()
+            tableKey = (len(table["events"]), len(table["strings"]), len(table["threads"]), table["dropped"])
+            if force or tableKey != self._tableWritten:
+                self._file.write(self._chunk(b"TABL", json.dumps(table).encode()))
+                self._tableWritten = tableKey
+            if len(records) > 0: self._file.write(self._chunk(b"RECS", records))
+            self._file.flush()
+
+# the trace log of the process
+traceLog = pglTraceLog()
+
+#################################################################
+# decoding
+#################################################################
+def readTraceFile(path):
+    '''
+    Read a trace file.
+
+    Returns:
+        (records, table): numpy array of traceRecordDtype sorted by time, and the
+        last table in the file.
+    '''
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:len(traceMagic)] != traceMagic:
+        raise ValueError(f"(pglTrace:readTraceFile) {path} is not a pgl trace file")
+    offset = len(traceMagic) + 4
+    table, recordChunks = {"events": [], "strings": [], "threads": {}, "dropped": 0}, []
+    while offset + 8 <= len(data):
+        tag = data[offset:offset+4]
+        length, = struct.unpack('<I', data[offset+4:offset+8])
+        payload = data[offset+8:offset+8+length]
+        offset += 8 + length
+        if tag == b"TABL": table = json.loads(payload)
+        elif tag == b"RECS": recordChunks.append(np.frombuffer(payload, dtype=traceRecordDtype, count=len(payload) // traceRecordDtype.itemsize))
+    records = np.concatenate(recordChunks) if recordChunks else np.zeros(0, dtype=traceRecordDtype)
+    return records[np.argsort(records['time'], kind='stable')], table
+
+def decodeRecords(records, table):
+    '''
+    Text lines for records: time from the first record, thread, event and its numbers.
+    '''
+    events, strings, threads = table["events"], table["strings"], table["threads"]
+    records = records[np.argsort(records['time'], kind='stable')]
+    startTime = records['time'][0] if len(records) else 0
+    lines = []
+    for record in records:
+        thread = threads.get(str(int(record['thread'])), f"thread {int(record['thread'])}")
+        if record['event'] >= len(events):
+            lines.append(f"{record['time'] - startTime:12.6f} [{thread}] event {int(record['event'])}: {list(record['args'])}")
+            continue
+        event = events[record['event']]
+        values = {}
+        for argName, value in zip(event["args"], record['args']):
+            if argName.endswith(":s"):
+                index = int(value)
+                values[argName[:-2]] = strings[index] if 0 <= index < len(strings) else f"<string {index}>"
+            else:
+                values[argName] = int(value) if float(value).is_integer() else float(value)
+        try:
+            text = event["format"].format(**values)
+        except (KeyError, IndexError, ValueError):
+            text = " ".join(f"{k}={v}" for k, v in values.items())
+        lines.append(f"{record['time'] - startTime:12.6f} [{thread}] {event['name']}: {text}")
+    if table.get("dropped", 0) > 0: lines.append(f"(pglTrace) {table['dropped']} records were dropped because a ring was full")
+    return lines
+
+def pglTraceDecode(path, outputPath=None):
+    '''
+    Decode a trace file to text, written to outputPath or returned as a list of lines.
+    '''
+    lines = decodeRecords(*readTraceFile(path))
+    if outputPath is None: return lines
+    with open(outputPath, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+#################################################################
+# pglTrace
+#################################################################
+class pglTrace:
+    '''
+    Trace log methods of pgl: traceStart / traceStop around an experiment
+    record what the hot paths do (commands and bytes sent, results read,
+    flushes, images and stimuli) without printing, e.g.
+
+    pgl.traceStart("run1.pgltrace")
+    ...
+    pgl.traceStop()
+    print("\\n".join(pglTraceDecode("run1.pgltrace")))
+    '''
+    def traceStart(self, path=None, capacity=65536, drainInterval=0.25):
+        '''
+        Start the trace log (see pglTraceLog.start).
+        '''
+        traceLog.start(path, capacity, drainInterval)
+        if self.verbose > 0: print(f"(pglTrace:traceStart) Tracing{f' to {path}' if path else ''}")
+
+    def traceStop(self):
+        '''
+        Stop the trace log, saving what is left.
+
+        Returns:
+            int: Number of records dropped.
+        '''
+        return traceLog.stop()
+
+    def traceDump(self, path=None):
+        '''
+        Save the records waiting now (see pglTraceLog.dump).
+        '''
+        traceLog.dump(path)
+
+#################################################################
+# main: decode a trace file
+#################################################################
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print("usage: python -m pgl.pglTrace file.pgltrace [output.txt]")
+        sys.exit(1)
+    decoded = pglTraceDecode(sys.argv[1], sys.argv[2] if len(sys.argv) > 2 else None)
+    if decoded is not None: print("\n".join(decoded))
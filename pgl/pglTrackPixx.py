@@ -10,8 +10,10 @@
 #############
 from pgl import pglEyeTracker
 from pgl import pglDevice
+import threading
 import numpy as np
 import matplotlib.pyplot as plt
+from .pglCameraPreview import pglCameraPreview, pglCameraSourceTrackPixx
 
 ###################################
 # TrackPixx3 device
@@ -39,6 +41,13 @@ class pglTrackPixx3(pglEyeTracker):
         # set tracker (higher level API to none, and open when needed in start function)
         self.tracker = None
 
+        # _libdpx is not thread safe, so calls that can overlap with the
+        # camera preview thread go through this lock
+        self.dpLock = threading.Lock()
+        # persistent texture for getCameraImage and the live camera preview
+        self.cameraImage = None
+        self.cameraPreview = None
+
         #-->    # It is mandatory to call 'DPxOpen()' prior to using any VPixx device
         self.dp.DPxOpen()
         if not self.dp.DPxDetectDevice("TRACKPIXX"):
@@ -186,108 +195,130 @@ class pglTrackPixx3(pglEyeTracker):
         thisTime = self.dp.DPxGetTime()
         print(f"(pglTrackPixx3:calibrateEyeImage) Initial time: {lastTime} {thisTime}")
 
-        # stay in a loop, drawing camera images and allowing experimenter/subject to adjust parameters
-        loopCalibration = True
-        while loopCalibration:
+        # grab camera images in the background, so that the loop never waits on the camera
+        preview = self.startCameraPreview()
 
-            # wait for a duration of 1/60 second.
-            if (thisTime - lastTime) > 1/60: 
-                # clear screen
-                self.pgl.clearScreen((0,0,0))
-
-                # get camera image
-                cameraImage = self.getCameraImage()
-                if cameraImage is None:
-                    print("(pglTrackPixx3:calibrateEyeImage) No camera image available. Cannot display.")
-                    loopCalibration = False
-                cameraImage.display()
-
-                # Get eye data in camera space
-                expectedIrisSize = self.dp.TPxGetIrisExpectedSize()
-                (ppLeftMajor, _, ppRightMajor, _) = self.dp.TPxGetPupilSize() 
-                (ppLeftX, ppLeftY, ppRightX, ppRightY) = self.dp.TPxGetPupilCoordinatesInPixels() 
-                
-                # display instructions
-                self.pgl.text("Adjust camera position and focus", line=1)
-                self.pgl.text("Press right white (thumb) button when finished",line=2)
-
-                # covert to degrees for display
-                ppLeftXDeg = cameraImage.displayLeft + (cameraImage.displayRight - cameraImage.displayLeft) * (ppLeftX / cameraImage.width.pix)
-                ppLeftYDeg = cameraImage.displayTop + (cameraImage.displayBottom - cameraImage.displayTop) * (ppLeftY / cameraImage.height.pix)
-                ppRightXDeg = cameraImage.displayLeft + (cameraImage.displayRight - cameraImage.displayLeft) * (ppRightX / cameraImage.width.pix)
-                ppRightYDeg = cameraImage.displayTop + (cameraImage.displayBottom - cameraImage.displayTop) * (ppRightY / cameraImage.height.pix)
-
-                # get center of left and right pupils in degrees
-                eyeLeft = (ppLeftXDeg, ppLeftYDeg)
-                eyeRight = (ppRightXDeg, ppRightYDeg)
-
-                # draw cross at the pupil center
-                if ppLeftMajor > 0:
-                    #self.pgl.line(eyeLeft[0], eyeLeft[1]+self.pgl.yPix2Deg * ppLeftMajor/2, eyeLeft[0], eyeLeft[1]-self.pgl.yPix2Deg * ppLeftMajor/2, color=[0,1,0])
-                    #self.pgl.line(eyeLeft[0]-self.pgl.xPix2Deg * ppLeftMajor/2, eyeLeft[1], eyeLeft[0]+self.pgl.xPix2Deg * ppLeftMajor/2, eyeLeft[1], color=[0,1,0])
-                    self.pgl.fixationCross(x=eyeLeft[0],y=eyeLeft[1],color=[0,1,0])
-                else:
-                    self.pgl.fixationCross(1,cameraImage.displayLeft, cameraImage.displayTop, color=[0.5,0,0.5])
-                if ppRightMajor > 0:
-                    #self.pgl.line(eyeRight[0], eyeRight[1]+self.pgl.yPix2Deg * ppRightMajor/2, eyeRight[0], eyeRight[1]-self.pgl.yPix2Deg * ppRightMajor/2, color=[0,1,1])
-                    #self.pgl.line(eyeRight[0]-self.pgl.xPix2Deg * ppRightMajor/2, eyeRight[1], eyeRight[0]+self.pgl.xPix2Deg * ppRightMajor/2, eyeRight[1], color=[0,1,1])
-                    self.pgl.fixationCross(x=eyeRight[0],y=eyeRight[1],color=[0,1,1])
-                else:
-                    self.pgl.fixationCross(1,cameraImage.displayRight, cameraImage.displayTop, color=[1,0,0])
-
-                # flush screen
-                self.pgl.flush()
-
-                # restart frame time counter
-                lastTime = thisTime
-            # If not time for a full refresh, just update time
-            else:
-                # update timer (TPx)
-                self.dp.DPxUpdateRegCache()
-                thisTime = self.dp.DPxGetTime()
-
-                # poll for button press events
-                events = self.pgl.poll()
-                if events is None: continue
-                #print(events)
-                for event in events:
-                    # handle the events
-                    if event.id == "white left":
-                        # exit the calibration loop
-                        print("(pglTrackPixx3:calibrateEyeImage) Exiting calibrate eye image loop")
-                        self.pgl.clearScreen((0,0,0))
-                        self.pgl.flush()
-                        self.pgl.clearScreen((0,0,0))
+        # stop the preview however the loop ends
+        try:
+            # stay in a loop, drawing camera images and allowing experimenter/subject to adjust parameters
+            loopCalibration = True
+            while loopCalibration:
+
+                # wait for a duration of 1/60 second.
+                if (thisTime - lastTime) > 1/60: 
+                    # clear screen
+                    self.pgl.clearScreen((0,0,0))
+
+                    # the grabber stops if the camera fails (and prints why)
+                    if not preview.isRunning():
+                        print("(pglTrackPixx3:calibrateEyeImage) ❌ No camera image available. Cannot display.")
+                        break
+
+                    # get the newest camera image
+                    cameraImage = preview.update()
+                    if cameraImage is None:
+                        # no frame from the camera yet
+                        self.pgl.text("Waiting for camera image", line=1)
                         self.pgl.flush()
-                        loopCalibration = False
-                    elif event.id == "yellow left":
-                        # decrease LED intensity
-                        self.ledIntensity = max(0, self.ledIntensity - 1)
-                        self.dp.TPxSetLEDIntensity(self.ledIntensity)
-                        self.dp.DPxUpdateRegCache()
+                        lastTime = thisTime
+                        continue
+                    cameraImage.display()
+
+                    # Get eye data in camera space
+                    with self.dpLock:
+                        expectedIrisSize = self.dp.TPxGetIrisExpectedSize()
+                        (ppLeftMajor, _, ppRightMajor, _) = self.dp.TPxGetPupilSize() 
+                        (ppLeftX, ppLeftY, ppRightX, ppRightY) = self.dp.TPxGetPupilCoordinatesInPixels() 
+                
+                    # display instructions
+                    self.pgl.text("Adjust camera position and focus", line=1)
+                    self.pgl.text("Press right white (thumb) button when finished",line=2)
+
+                    # covert to degrees for display
+                    ppLeftXDeg = cameraImage.displayLeft + (cameraImage.displayRight - cameraImage.displayLeft) * (ppLeftX / cameraImage.width.pix)
+                    ppLeftYDeg = cameraImage.displayTop + (cameraImage.displayBottom - cameraImage.displayTop) * (ppLeftY / cameraImage.height.pix)
+                    ppRightXDeg = cameraImage.displayLeft + (cameraImage.displayRight - cameraImage.displayLeft) * (ppRightX / cameraImage.width.pix)
+                    ppRightYDeg = cameraImage.displayTop + (cameraImage.displayBottom - cameraImage.displayTop) * (ppRightY / cameraImage.height.pix)
+
+                    # get center of left and right pupils in degrees
+                    eyeLeft = (ppLeftXDeg, ppLeftYDeg)
+                    eyeRight = (ppRightXDeg, ppRightYDeg)
+
+                    # draw cross at the pupil center
+                    if ppLeftMajor > 0:
+                        #self.pgl.line(eyeLeft[0], eyeLeft[1]+self.pgl.yPix2Deg * ppLeftMajor/2, eyeLeft[0], eyeLeft[1]-self.pgl.yPix2Deg * ppLeftMajor/2, color=[0,1,0])
+                        #self.pgl.line(eyeLeft[0]-self.pgl.xPix2Deg * ppLeftMajor/2, eyeLeft[1], eyeLeft[0]+self.pgl.xPix2Deg * ppLeftMajor/2, eyeLeft[1], color=[0,1,0])
+                        self.pgl.fixationCross(x=eyeLeft[0],y=eyeLeft[1],color=[0,1,0])
+                    else:
+                        self.pgl.fixationCross(1,cameraImage.displayLeft, cameraImage.displayTop, color=[0.5,0,0.5])
+                    if ppRightMajor > 0:
+                        #self.pgl.line(eyeRight[0], eyeRight[1]+self.pgl.yPix2Deg * ppRightMajor/2, eyeRight[0], eyeRight[1]-self.pgl.yPix2Deg * ppRightMajor/2, color=[0,1,1])
+                        #self.pgl.line(eyeRight[0]-self.pgl.xPix2Deg * ppRightMajor/2, eyeRight[1], eyeRight[0]+self.pgl.xPix2Deg * ppRightMajor/2, eyeRight[1], color=[0,1,1])
+                        self.pgl.fixationCross(x=eyeRight[0],y=eyeRight[1],color=[0,1,1])
+                    else:
+                        self.pgl.fixationCross(1,cameraImage.displayRight, cameraImage.displayTop, color=[1,0,0])
 
-                        print(f"(pglTrackPixx3:calibrateEyeImage) Decreased LED intensity to {self.ledIntensity} {self.dp.TPxGetLEDIntensity()}.")
+                    # flush screen
+                    self.pgl.flush()
 
-                    elif event.id == "red left":
-                        # increase LED intensity
-                        self.ledIntensity = min(8, self.ledIntensity + 1)
-                        self.dp.TPxSetLEDIntensity(self.ledIntensity)
-                        self.dp.DPxUpdateRegCache()
-                        print(f"(pglTrackPixx3:calibrateEyeImage) Increased LED intensity to {self.ledIntensity}.")
-                    elif event.id == "green left":
-                        # increase lens
-                        self.lens = min(2, self.lens + 1)
-                        self.dp.TPxSetLens(self.lens)
-                        self.dp.DPxUpdateRegCache()
-                        print(f"(pglTrackPixx3:calibrateEyeImage) Increased lens focal length to {self.lens*25+25} mm.")
-                    elif event.id == "blue left":
-                        # decrease lens
-                        self.lens = max(0, self.lens - 1)
+                    # restart frame time counter
+                    lastTime = thisTime
+                # If not time for a full refresh, just update time
+                else:
+                    # update timer (TPx)
+                    with self.dpLock:
                         self.dp.DPxUpdateRegCache()
-                        self.dp.TPxSetLens(self.lens)
-                        print(f"(pglTrackPixx3:calibrateEyeImage) Decreased lens focal length to {self.lens*25+25} mm.")
-                    else:
-                        print(f"(pglTrackPixx3:calibrateEyeImage) Unknown event: {event}")
+                        thisTime = self.dp.DPxGetTime()
+
+                    # poll for button press events
+                    events = self.pgl.poll()
+                    if events is None: continue
+                    #print(events)
+                    for event in events:
+                        # handle the events
+                        if event.id == "white left":
+                            # exit the calibration loop
+                            print("(pglTrackPixx3:calibrateEyeImage) Exiting calibrate eye image loop")
+                            self.pgl.clearScreen((0,0,0))
+                            self.pgl.flush()
+                            self.pgl.clearScreen((0,0,0))
+                            self.pgl.flush()
+                            loopCalibration = False
+                        elif event.id == "yellow left":
+                            # decrease LED intensity
+                            self.ledIntensity = max(0, self.ledIntensity - 1)
+                            with self.dpLock:
+                                self.dp.TPxSetLEDIntensity(self.ledIntensity)
+                                self.dp.DPxUpdateRegCache()
+                                ledIntensity = self.dp.TPxGetLEDIntensity()
+                            print(f"(pglTrackPixx3:calibrateEyeImage) Decreased LED intensity to {self.ledIntensity} {ledIntensity}.")
+
+
+                        elif event.id == "red left":
+                            # increase LED intensity
+                            self.ledIntensity = min(8, self.ledIntensity + 1)
+                            with self.dpLock:
+                                self.dp.TPxSetLEDIntensity(self.ledIntensity)
+                                self.dp.DPxUpdateRegCache()
+                            print(f"(pglTrackPixx3:calibrateEyeImage) Increased LED intensity to {self.ledIntensity}.")
+                        elif event.id == "green left":
+                            # increase lens
+                            self.lens = min(2, self.lens + 1)
+                            with self.dpLock:
+                                self.dp.TPxSetLens(self.lens)
+                                self.dp.DPxUpdateRegCache()
+                            print(f"(pglTrackPixx3:calibrateEyeImage) Increased lens focal length to {self.lens*25+25} mm.")
+                        elif event.id == "blue left":
+                            # decrease lens
+                            self.lens = max(0, self.lens - 1)
+                            with self.dpLock:
+                                self.dp.TPxSetLens(self.lens)
+                                self.dp.DPxUpdateRegCache()
+                            print(f"(pglTrackPixx3:calibrateEyeImage) Decreased lens focal length to {self.lens*25+25} mm.")
+                        else:
+                            print(f"(pglTrackPixx3:calibrateEyeImage) Unknown event: {event}")
+        finally:
+            self.stopCameraPreview()
     #################################################
     # calibrateEyePosition
     ################################################
@@ -703,15 +734,51 @@ class pglTrackPixx3(pglEyeTracker):
             return None
         
         # Get the camera image
-        self.dp.DPxUpdateRegCache()
-        image = self.dp.TPxGetEyeImage()
+        with self.dpLock:
+            self.dp.DPxUpdateRegCache()
+            image = self.dp.TPxGetEyeImage()
         if image is None:
             print("(pglTrackPixx3) Failed to get camera image.")
             return None
-        # convert to pglImage
-        image = self.pgl.imageCreate(image)
-        return image
+        # convert to pglImage, reusing the texture from the last call
+        if self.cameraImage is None:
+            self.cameraImage = self.pgl.imageCreate(image)
+        elif not self.pgl.imageUpdate(self.cameraImage, image):
+            return None
+        return self.cameraImage
     
+    #################################################
+    # startCameraPreview
+    #################################################
+    def startCameraPreview(self, source=None, frameRate=60.0):
+        """
+        Start grabbing camera images in the background for a live preview
+        (see pglCameraPreview). Call update on what is returned once per frame
+        to get the texture with the newest camera image.
+
+        Args:
+            source (pglCameraSource, optional): Where to get frames from, defaults to the
+              TrackPixx3 camera (use pglCameraSourceFake to test without a tracker).
+            frameRate (float, optional): Rate to grab camera frames at.
+
+        Returns:
+            pglCameraPreview: The running preview.
+        """
+        if self.cameraPreview is not None: self.stopCameraPreview()
+        if source is None: source = pglCameraSourceTrackPixx(self.dp, self.dpLock, frameRate)
+        self.cameraPreview = pglCameraPreview(self.pgl, source)
+        self.cameraPreview.start()
+        return self.cameraPreview
+
+    def stopCameraPreview(self):
+        """
+        Stop the live camera preview and report dropped and late frames.
+        """
+        if self.cameraPreview is None: return
+        self.cameraPreview.stop()
+        self.cameraPreview.getStats()
+        self.cameraPreview = None
+
     ################################################
     # isPGLOpen
     #################################################
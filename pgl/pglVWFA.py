@@ -11,9 +11,8 @@
 from .pglExperiment import pglTask
 from .pglStaircase import pglStaircaseUpDown
 import numpy as np
-from .pglParameter import pglParameter, pglParameterBlock
+from .pglParameter import pglParameter, pglParameterBlock, pglParameterNestedBlock
 import os
-from PIL import Image as PILImage
 import scipy.io as sio
 import h5py
 
@@ -37,22 +36,23 @@ def _load_mat(filepath, old_ver=False):
         return out
     
 #############
-def _gray_to_rgba_pil(img_uint8: np.ndarray) -> PILImage.Image:
-    """ convert a raw 2-D uint8 grayscale image array -> RGBA PIL Image
+def _gray_to_rgba(img_uint8: np.ndarray) -> np.ndarray:
+    """ convert a raw 2-D uint8 grayscale image array -> RGBA float32 array (0-1),
+    ready to be made into a texture.
     Pixels with value 128 are treated as background and become transparent
-    (alpha = 0).  All other pixels are opaque (alpha = 255).
+    (alpha = 0).  All other pixels are opaque (alpha = 1).
     In mglVWFA: 
     - alpha(img == 128) = 0;
     - rgba = cat(3, img, img, img, alpha);
     """
     h, w = img_uint8.shape
-    rgba = np.zeros((h, w, 4), dtype=np.uint8)
-    rgba[:, :, 0] = img_uint8   # R
-    rgba[:, :, 1] = img_uint8   # G
-    rgba[:, :, 2] = img_uint8   # B
-    rgba[:, :, 3] = 255         # fully opaque by default
-    rgba[img_uint8 == 128, 3] = 0  # transparent background
-    return PILImage.fromarray(rgba, mode="RGBA")
+    rgba = np.empty((h, w, 4), dtype=np.float32)
+    rgba[:, :, 0] = img_uint8 / 255.0   # R
+    rgba[:, :, 1] = rgba[:, :, 0]       # G
+    rgba[:, :, 2] = rgba[:, :, 0]       # B
+    rgba[:, :, 3] = 1                   # fully opaque by default
+    rgba[img_uint8 == 128, 3] = 0       # transparent background
+    return rgba
 
 #############
 # Main Task
@@ -107,14 +107,15 @@ class pglVWFATask(pglTask):
             pglParameter("instance",  list(range(self._instStart, self._instEnd + 1))),
         ]))
 
-        # Preload file paths (textures are loaded per-trial for memory)
+        # Preload file paths (textures are loaded a couple of trials ahead
+        # by the pglTask prefetcher, see getTrialAssets / loadAsset)
         self.stimulusFolder = stimulusFolder
         self.filePaths = self._build_file_paths()
  
         # Per-trial state (populated in startTrial / startSegment)
-        self._currentImages: list = []   # list of 4 PIL RGBA images
+        self._currentImages: list = []   # list of 4 image textures
         self._currentNames: list = []    # list of 4 name strings
-        self._currentSegImage = None     # PIL image currently on screen (or None)
+        self._currentSegImage = None     # image texture currently on screen (or None)
         self._isRepeat = False           # whether all 4 names in trial are identical
         self._gotResponse = False
         self._trialStartTime = None
@@ -135,7 +136,7 @@ class pglVWFATask(pglTask):
                 paths[(condIdx, inst)] = fpath
         return paths
  
-    # Load 4 RGBA PIL images and their names from the .mat file.
+    # Load 4 RGBA images and their names from the .mat file.
     def _load_images(self, condIdx: int, instIdx: int):
         fpath = self.filePaths.get((condIdx, instIdx))
         if fpath is None or not os.path.isfile(fpath):
@@ -157,7 +158,7 @@ class pglVWFATask(pglTask):
         raw_names = mat.get("names", None)
         names = self._parse_names(raw_names, n=raw.shape[2] if raw.ndim == 3 else 4)
  
-        # Build PIL images
+        # Build RGBA images
         images = []
         n_imgs = raw.shape[2] if raw.ndim == 3 else 0
         for k in range(n_imgs):
@@ -165,7 +166,7 @@ class pglVWFATask(pglTask):
             # Ensure uint8
             if img_slice.dtype != np.uint8:
                 img_slice = np.clip(img_slice, 0, 255).astype(np.uint8)
-            images.append(_gray_to_rgba_pil(img_slice))
+            images.append(_gray_to_rgba(img_slice))
  
         return images, names
  
@@ -192,6 +193,25 @@ class pglVWFATask(pglTask):
  
         return [str(raw_names)] * n
  
+    ########################
+    def getTrialAssets(self, params):
+        """The stimulus file a trial needs (blank trials need none)"""
+        if params["condition"] < 9:
+            return [(params["condition"], params["instance"])]
+        return []
+
+    ########################
+    def loadAsset(self, key):
+        """Load a trial's images and names (runs in the background, a couple of trials ahead)"""
+        return self._load_images(*key)
+
+    ########################
+    def _trialImages(self):
+        """Textures and names for the current trial"""
+        key = (self.currentParams["condition"], self.currentParams["instance"])
+        images, names = self.trialAssets.get(key) or ([], [])
+        return images, names
+
     ########################
     def startTrial(self, startTime):
         """Called once at the beginning of each trial"""
@@ -200,14 +220,12 @@ class pglVWFATask(pglTask):
         self._gotResponse = False
         self._currentImages = []
         self._currentNames  = []
-        self._currentSegImage = None
         self._trialStartTime = startTime
  
         cond = self.currentParams["condition"]
-        inst = self.currentParams["instance"]
  
         if cond < 9:
-            imgs, names = self._load_images(cond, inst)
+            imgs, names = self._trialImages()
             self._currentImages = imgs
             self._currentNames  = names
  
@@ -236,10 +254,12 @@ class pglVWFATask(pglTask):
         STIM_SEGS = {1, 3, 5, 7}
         seg_image_idx = {1: 0, 3: 1, 5: 2, 7: 3}
  
-        if seg in STIM_SEGS and cond < 9 and self._currentImages:
+        # (the first segment starts before startTrial has set _currentImages)
+        images, _ = self._trialImages()
+        if seg in STIM_SEGS and cond < 9 and images:
             k = seg_image_idx[seg]
-            if k < len(self._currentImages):
-                self._currentSegImage = self._currentImages[k]
+            if k < len(images):
+                self._currentSegImage = images[k]
             else:
                 self._currentSegImage = None
         else:
@@ -2,46 +2,112 @@ import numpy
 from setuptools import setup, find_packages, Extension
 import sys
 
-if sys.platform != 'darwin':
-    raise RuntimeError("This package only works on macOS")
-
-displayInfoExtension = Extension(
-    'pgl._resolution', 
-    sources=['pgl/_resolution.m'],
-    extra_compile_args=['-ObjC'],
-    extra_link_args=[
+# Each extension is a thin Python layer over a portable core, plus a
+# platform backend: macOS talks to CoreGraphics / CGEventTap, Linux
+# uses clock_gettime, a synthetic event source and a mock display,
+# and scheduling is mach time constraints or SCHED_FIFO / SCHED_DEADLINE
+# (see _pglClock.h, _pglEventBackend.h, _pglDisplay.h and _pglSched.h)
+if sys.platform == 'darwin':
+    clockBackend = ['pgl/_pglClockMac.c']
+    schedBackend = ['pgl/_pglSchedMac.c']
+    eventBackend = ['pgl/_pglEventBackendMac.c']
+    displayBackend = ['pgl/_pglDisplayMac.m']
+    displayCompileArgs = ['-ObjC']
+    displayLinkArgs = [
         '-framework', 'CoreGraphics',
         '-framework', 'Cocoa',
         '-framework', 'CoreFoundation'
     ]
+    eventLinkArgs = [
+        '-framework', 'ApplicationServices',
+        '-framework', 'Carbon'
+    ]
+elif sys.platform.startswith('linux'):
+    clockBackend = ['pgl/_pglClockLinux.c']
+    schedBackend = ['pgl/_pglSchedLinux.c']
+    eventBackend = ['pgl/_pglEventBackendLinux.c']
+    displayBackend = ['pgl/_pglDisplayMock.c']
+    displayCompileArgs = []
+    displayLinkArgs = ['-lm']
+    eventLinkArgs = ['-lpthread']
+else:
+    raise RuntimeError("This package only works on macOS or Linux")
+
+displayInfoExtension = Extension(
+    'pgl._resolution', 
+    sources=['pgl/_resolution.c', 'pgl/_pglDisplayCore.c'] + displayBackend,
+    extra_compile_args=displayCompileArgs,
+    extra_link_args=displayLinkArgs
 )
 
 gammaTableExtension = Extension(
     'pgl._pglGammaTable',
-    sources=['pgl/_pglGammaTable.m'],
+    sources=['pgl/_pglGammaTable.c', 'pgl/_pglDisplayCore.c'] + displayBackend,
     include_dirs=[numpy.get_include()], 
-    extra_compile_args=['-ObjC'],
-    extra_link_args=[
-        '-framework', 'CoreGraphics',
-        '-framework', 'Cocoa',
-        '-framework', 'CoreFoundation'
-    ]
+    extra_compile_args=displayCompileArgs,
+    extra_link_args=displayLinkArgs
 )
 
 timestampExtension = Extension(
     'pgl._pglTimestamp',
-    sources=['pgl/_pglTimestamp.c'],  
+    sources=['pgl/_pglTimestamp.c'] + clockBackend,  
     extra_compile_args=[],
     extra_link_args=[]
 )
 
 eventListenerExtension = Extension(
     'pgl._pglEventListener',
-    sources=['pgl/_pglEventListener.cpp'],
-    extra_link_args=[
-        '-framework', 'ApplicationServices',
-        '-framework', 'Carbon'
-    ]
+    sources=['pgl/_pglEventListener.cpp', 'pgl/_pglEventCore.c', 'pgl/_pglSchedCore.c'] + eventBackend + schedBackend + clockBackend,
+    extra_link_args=eventLinkArgs
+)
+
+psiExtension = Extension(
+    'pgl._pglPsi',
+    sources=['pgl/_pglPsi.c', 'pgl/_pglPsiCore.c'],
+    include_dirs=[numpy.get_include()],
+    extra_compile_args=['-O3'],
+    extra_link_args=['-lpthread'] if sys.platform.startswith('linux') else []
+)
+
+paletteExtension = Extension(
+    'pgl._pglPalette',
+    sources=['pgl/_pglPalette.c'],
+    extra_compile_args=['-O3']
+)
+
+tessExtension = Extension(
+    'pgl._pglTess',
+    sources=['pgl/_pglTess.c', 'pgl/_pglTessCore.c'],
+    include_dirs=[numpy.get_include()],
+    extra_compile_args=['-O3']
+)
+
+colorExtension = Extension(
+    'pgl._pglColor',
+    sources=['pgl/_pglColor.c', 'pgl/_pglColorCore.c'],
+    include_dirs=[numpy.get_include()],
+    extra_compile_args=['-O3']
+)
+
+noiseExtension = Extension(
+    'pgl._pglNoise',
+    sources=['pgl/_pglNoise.c', 'pgl/_pglNoiseCore.c'],
+    include_dirs=[numpy.get_include()],
+    extra_compile_args=['-O3'],
+    extra_link_args=['-lpthread'] if sys.platform.startswith('linux') else []
+)
+
+traceExtension = Extension(
+    'pgl._pglTrace',
+    sources=['pgl/_pglTrace.c', 'pgl/_pglTraceCore.c'] + clockBackend,
+    extra_compile_args=['-O3'],
+    extra_link_args=['-lpthread'] if sys.platform.startswith('linux') else []
+)
+
+realtimeExtension = Extension(
+    'pgl._pglRealtime',
+    sources=['pgl/_pglRealtime.c', 'pgl/_pglSchedCore.c'] + schedBackend + clockBackend,
+    extra_link_args=['-lpthread'] if sys.platform.startswith('linux') else []
 )
 
 setup(
@@ -50,5 +116,5 @@ setup(
     packages=find_packages(), 
     description='PGL Psychophysics and experiment library',
     python_requires='>=3.9',
-    ext_modules=[displayInfoExtension,gammaTableExtension,timestampExtension,eventListenerExtension]
-)
\ No newline at end of file
+    ext_modules=[displayInfoExtension,gammaTableExtension,timestampExtension,eventListenerExtension,psiExtension,paletteExtension,realtimeExtension,tessExtension,colorExtension,noiseExtension,traceExtension]
+)